@@ -2,7 +2,8 @@
 
 import React, { useEffect, useRef } from 'react';
 import { SPRITES, PALETTES, createSprite } from '@/lib/ui/sprites';
-import { ANIMATED_FISH_SPRITES } from '@/lib/ui/animated-fish-sprites';
+import { ANIMATED_FISH_SPRITES, ATLAS_SPRITE_FRAME_RATES } from '@/lib/ui/animated-fish-sprites';
+import { getSpriteAtlas } from '@/lib/ui/sprite-atlas/sprite-atlas';
 import { ParticleSystem, AmbientLayer, BioluminescentLayer } from '@/lib/ui/animated-sprites';
 import type { Particle, AmbientElement, GlowEffect } from '@/lib/ui/animated-sprites';
 import { initAnimationEngine, initAnimal, updateAllAnimals, getAnimalPosition, isUsingWasm } from '@/lib/wasm/animation-engine';
@@ -138,6 +139,35 @@ export function SeaLifeBackground() {
         });
       });
     });
+
+    // Creatures from the Piskel sprite atlas. The exports are one-colour
+    // silhouettes (palette index 1 only), tinted with each scheme's body colour
+    const cssToRgba = (hex: string) => {
+      const v = parseInt(hex.slice(1), 16);
+      return (0xff000000 | ((v & 0xff) << 16) | (v & 0xff00) | (v >> 16)) >>> 0;
+    };
+    const atlas = getSpriteAtlas();
+    Object.keys(ATLAS_SPRITE_FRAME_RATES).forEach(key => {
+      if (!atlas.sprites.has(key)) return;
+      loadedAnimatedSprites[key] = [];
+      const colors = speciesColors[key] || [
+        { body: '#475569', detail: '#334155', shadow: '#1E293B', highlight: '#64748B' }
+      ];
+
+      colors.forEach(colorScheme => {
+        const palette = [0, cssToRgba(colorScheme.body)];
+        const frameImages = atlas.frameDataUrls(key, 2, palette).map(url => {
+          const img = new Image();
+          img.src = url;
+          return img;
+        });
+
+        loadedAnimatedSprites[key].push({
+          frames: frameImages,
+          frameRate: ATLAS_SPRITE_FRAME_RATES[key]
+        });
+      });
+    });
     
     // Generate ambient sprites
     const kelpSprite = new Image();
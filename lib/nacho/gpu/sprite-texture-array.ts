@@ -0,0 +1,167 @@
+// Nacho WebGPU Sprite Texture Array
+// All creature frames in one 2D array texture (one layer per frame), written
+// once; instances pick their frame by layer index, so animation is a change
+// to the instance buffer only. Layer layout and the instance format are
+// shared with the WebGL2 path in lib/rendering/sprite-texture-array.ts.
+
+import {
+    buildSpriteLayers,
+    SpriteLayerSet,
+    SPRITE_INSTANCE_FLOATS,
+} from '../../rendering/sprite-texture-array';
+
+const SPRITE_SHADER = `
+    struct Instance {
+        @location(0) rect: vec4f,     // x, y, width, height in pixels
+        @location(1) layer: vec2f,    // layer, flip
+        @location(2) extent: vec2f,   // u1, v1
+    };
+    struct VSOut {
+        @builtin(position) position: vec4f,
+        @location(0) uv: vec2f,
+        @location(1) @interpolate(flat) layer: u32,
+    };
+    @group(0) @binding(0) var<uniform> viewport: vec2f;
+    @group(0) @binding(1) var samp: sampler;
+    @group(0) @binding(2) var sprites: texture_2d_array<f32>;
+
+    @vertex
+    fn vsMain(@builtin(vertex_index) vertexIndex: u32, instance: Instance) -> VSOut {
+        let corner = vec2f(f32(vertexIndex & 1u), f32(vertexIndex >> 1u));
+        let pixel = instance.rect.xy + corner * instance.rect.zw;
+        var out: VSOut;
+        out.position = vec4f(pixel / viewport * vec2f(2.0, -2.0) + vec2f(-1.0, 1.0), 0.0, 1.0);
+        let u = select(corner.x, 1.0 - corner.x, instance.layer.y > 0.5);
+        out.uv = vec2f(u, corner.y) * instance.extent;
+        out.layer = u32(instance.layer.x);
+        return out;
+    }
+
+    @fragment
+    fn fsMain(input: VSOut) -> @location(0) vec4f {
+        let color = textureSample(sprites, samp, input.uv, input.layer);
+        if (color.a == 0.0) { discard; }
+        return vec4f(color.rgb * color.a, color.a);
+    }
+`;
+
+/**
+ * Create the array texture and write every layer with a single writeTexture
+ */
+export function uploadSpriteLayers(device: GPUDevice, set: SpriteLayerSet): GPUTexture {
+    const layers = Math.max(set.layers, 1);
+    if (layers > device.limits.maxTextureArrayLayers) {
+        throw new Error(`Sprite texture array: ${layers} layers exceed maxTextureArrayLayers`);
+    }
+    const texture = device.createTexture({
+        size: { width: set.width, height: set.height, depthOrArrayLayers: layers },
+        format: 'rgba8unorm',
+        usage: GPUTextureUsage.TEXTURE_BINDING | GPUTextureUsage.COPY_DST,
+    });
+    device.queue.writeTexture(
+        { texture },
+        set.pixels,
+        { bytesPerRow: set.width * 4, rowsPerImage: set.height },
+        { width: set.width, height: set.height, depthOrArrayLayers: layers }
+    );
+    return texture;
+}
+
+export class GPUSpriteTextureArray {
+    private device: GPUDevice;
+    private texture: GPUTexture;
+    private pipeline: GPURenderPipeline;
+    private viewportBuffer: GPUBuffer;
+    private bindGroup: GPUBindGroup;
+    private instanceBuffer: GPUBuffer | null = null;
+    private instanceCapacity = 0;
+    readonly set: SpriteLayerSet;
+
+    /**
+     * `format` is the colour target the sprites are drawn into, which must
+     * use premultiplied alpha (the canvas format with alphaMode 'premultiplied')
+     */
+    constructor(device: GPUDevice, format: GPUTextureFormat, set: SpriteLayerSet = buildSpriteLayers()) {
+        this.device = device;
+        this.set = set;
+        this.texture = uploadSpriteLayers(device, set);
+
+        const module = device.createShaderModule({ code: SPRITE_SHADER });
+        this.pipeline = device.createRenderPipeline({
+            layout: 'auto',
+            vertex: {
+                module,
+                entryPoint: 'vsMain',
+                buffers: [
+                    {
+                        arrayStride: SPRITE_INSTANCE_FLOATS * 4,
+                        stepMode: 'instance',
+                        attributes: [
+                            { shaderLocation: 0, offset: 0, format: 'float32x4' },
+                            { shaderLocation: 1, offset: 16, format: 'float32x2' },
+                            { shaderLocation: 2, offset: 24, format: 'float32x2' },
+                        ],
+                    },
+                ],
+            },
+            fragment: {
+                module,
+                entryPoint: 'fsMain',
+                targets: [
+                    {
+                        format,
+                        blend: {
+                            color: { srcFactor: 'one', dstFactor: 'one-minus-src-alpha' },
+                            alpha: { srcFactor: 'one', dstFactor: 'one-minus-src-alpha' },
+                        },
+                    },
+                ],
+            },
+            primitive: { topology: 'triangle-strip' },
+        });
+
+        this.viewportBuffer = device.createBuffer({
+            size: 8,
+            usage: GPUBufferUsage.UNIFORM | GPUBufferUsage.COPY_DST,
+        });
+        this.bindGroup = device.createBindGroup({
+            layout: this.pipeline.getBindGroupLayout(0),
+            entries: [
+                { binding: 0, resource: { buffer: this.viewportBuffer } },
+                // Pixel art: nearest sampling keeps frames from bleeding into their padding
+                { binding: 1, resource: device.createSampler({ magFilter: 'nearest', minFilter: 'nearest' }) },
+                { binding: 2, resource: this.texture.createView({ dimension: '2d-array' }) },
+            ],
+        });
+    }
+
+    /**
+     * Record one instanced draw of the first `count` instances (see
+     * writeSpriteInstance) into an open render pass
+     */
+    draw(pass: GPURenderPassEncoder, instances: Float32Array, count: number, viewportWidth: number, viewportHeight: number) {
+        if (count <= 0) return;
+        const bytes = count * SPRITE_INSTANCE_FLOATS * 4;
+        if (count > this.instanceCapacity) {
+            this.instanceBuffer?.destroy();
+            this.instanceCapacity = Math.max(count, this.instanceCapacity * 2);
+            this.instanceBuffer = this.device.createBuffer({
+                size: this.instanceCapacity * SPRITE_INSTANCE_FLOATS * 4,
+                usage: GPUBufferUsage.VERTEX | GPUBufferUsage.COPY_DST,
+            });
+        }
+        this.device.queue.writeBuffer(this.instanceBuffer!, 0, instances.buffer, instances.byteOffset, bytes);
+        this.device.queue.writeBuffer(this.viewportBuffer, 0, new Float32Array([viewportWidth, viewportHeight]));
+
+        pass.setPipeline(this.pipeline);
+        pass.setBindGroup(0, this.bindGroup);
+        pass.setVertexBuffer(0, this.instanceBuffer!);
+        pass.draw(4, count);
+    }
+
+    destroy() {
+        this.instanceBuffer?.destroy();
+        this.viewportBuffer.destroy();
+        this.texture.destroy();
+    }
+}
@@ -0,0 +1,333 @@
+/**
+ * Neural Storage Path Tests
+ * WANeuralCodec's single-block API over a stand-in WASM instance, and round
+ * trips through StoragePipeline.encodeNeural/decodeNeural with a stand-in
+ * codec and an in-memory CAS
+ */
+
+import { describe, it, expect, beforeAll, beforeEach, jest } from '@jest/globals';
+import { StoragePipeline } from '../pipeline/storage-pipeline';
+import { BlockClass, ContentChunk, LatentBits, LatentVector, WANeuralCodec, quantizedLatentBytes } from '../neural/wasm-codec';
+
+jest.mock('@/lib/storage/wasm-cas', () => {
+  const actual = jest.requireActual('@/lib/storage/wasm-cas') as typeof import('@/lib/storage/wasm-cas');
+  const mockCas = new Map<string, Uint8Array>(); // Payload id -> encoded chunk
+  const mockChunks = new Map<string, string>(); // Chunk id -> payload id
+  return {
+    ...actual,
+    mockCas,
+    mockChunks,
+    findChunkInCas: (id: string) => mockChunks.get(id) ?? null,
+    putChunkToCas: async (id: string, encoded: ArrayBuffer) => {
+      const artifactId = await actual.sha256Hex(encoded);
+      mockCas.set(artifactId, new Uint8Array(encoded.slice(0)));
+      mockChunks.set(id, artifactId);
+      return { artifactId, fileId: artifactId };
+    },
+    getChunkFromCas: async (id: string) => {
+      const bytes = mockCas.get(id);
+      if (!bytes) throw new Error('artifact_not_found');
+      return { fileId: id, bytes };
+    },
+  };
+});
+
+// eslint-disable-next-line @typescript-eslint/no-var-requires
+const { mockCas, mockChunks } = require('@/lib/storage/wasm-cas') as {
+  mockCas: Map<string, Uint8Array>;
+  mockChunks: Map<string, string>;
+};
+
+const BLOCK = 64;
+const CHUNK = 4 * BLOCK;
+const LOSSY_MASK = 0xfc;
+
+/**
+ * Fixed-size chunks that all share one fingerprint (so chunk identity has to
+ * come from the content id), a lossy "network" whose latent is the block
+ * with its low two bits dropped, and classification by the first byte
+ */
+class FakeCodec {
+  readonly blockSize = BLOCK;
+  readonly latentDim = BLOCK;
+  readonly latentBits: LatentBits = 8;
+  readonly latentRecordBytes = BLOCK;
+
+  chunkContent(data: Uint8Array): ContentChunk[] {
+    const chunks: ContentChunk[] = [];
+    for (let offset = 0; offset < data.length; offset += CHUNK) {
+      chunks.push({ offset, length: Math.min(CHUNK, data.length - offset), fingerprint: '00000000deadbeef' });
+    }
+    return chunks;
+  }
+
+  classifyBlocks(data: Uint8Array, blockSize: number): Uint8Array {
+    const tags = new Uint8Array(Math.ceil(data.length / blockSize));
+    tags.forEach((_, b) => {
+      const block = data.subarray(b * blockSize, (b + 1) * blockSize);
+      if (block.every((v) => v === block[0])) tags[b] = BlockClass.CONSTANT;
+      else if (block[0] === 0xaa) tags[b] = BlockClass.RLE;
+      else if (block[0] < 0x80) tags[b] = BlockClass.NEURAL;
+      else tags[b] = BlockClass.RAW;
+    });
+    return tags;
+  }
+
+  rleEncode(block: Uint8Array): Uint8Array {
+    const runs: number[] = [];
+    for (let i = 0; i < block.length; ) {
+      let run = 1;
+      while (i + run < block.length && run < 255 && block[i + run] === block[i]) run++;
+      runs.push(run, block[i]);
+      i += run;
+    }
+    return Uint8Array.from(runs);
+  }
+
+  rleDecode(encoded: Uint8Array, size: number): Uint8Array {
+    const output = new Uint8Array(size);
+    let at = 0;
+    for (let i = 0; i + 1 < encoded.length; i += 2) {
+      output.fill(encoded[i + 1], at, at + encoded[i]);
+      at += encoded[i];
+    }
+    return output;
+  }
+
+  async compressBatch(data: Uint8Array, blockSize: number) {
+    const results = [];
+    for (let b = 0; b * blockSize < data.length; b++) {
+      const quantized = data.slice(b * blockSize, (b + 1) * blockSize).map((v) => v & LOSSY_MASK);
+      results.push({ latent: this.latentFromRecord(quantized), originalSize: blockSize, compressedSize: blockSize, compressionRatio: 1, quality: 1 });
+    }
+    return results;
+  }
+
+  latentFromRecord(quantized: Uint8Array): LatentVector {
+    return { quantized, dim: quantized.length, data: new Float32Array(0) };
+  }
+
+  async decompressBatch(latents: LatentVector[], outputSize: number): Promise<Uint8Array[]> {
+    return latents.map((latent) => latent.quantized.slice(0, outputSize));
+  }
+}
+
+// Blocks of every class; `seed` varies the neural and raw content
+function sampleChunk(seed: number): Uint8Array {
+  const chunk = new Uint8Array(CHUNK);
+  chunk.fill(7, 0, BLOCK);                                                          // CONSTANT
+  for (let i = BLOCK; i < 2 * BLOCK; i++) chunk[i] = i < BLOCK + 20 ? 0xaa : 3;     // RLE
+  for (let i = 2 * BLOCK; i < 3 * BLOCK; i++) chunk[i] = (i * 13 + seed) & 0x7f;    // NEURAL
+  for (let i = 3 * BLOCK; i < CHUNK; i++) chunk[i] = 0x80 | ((i * 29 + seed) & 0x7f); // RAW
+  return chunk;
+}
+
+// What decodeNeural should give back for `data`: NEURAL blocks lose their low bits
+function lossy(data: Uint8Array): Uint8Array {
+  const codec = new FakeCodec();
+  const out = data.slice();
+  for (const { offset, length } of codec.chunkContent(data)) {
+    codec.classifyBlocks(data.subarray(offset, offset + length), BLOCK).forEach((tag, b) => {
+      if (tag !== BlockClass.NEURAL) return;
+      const start = offset + b * BLOCK;
+      const block = out.subarray(start, Math.min(start + BLOCK, offset + length));
+      block.forEach((v, i) => (block[i] = v & LOSSY_MASK));
+    });
+  }
+  return out;
+}
+
+function concat(...parts: Uint8Array[]): Uint8Array {
+  const out = new Uint8Array(parts.reduce((sum, part) => sum + part.length, 0));
+  let offset = 0;
+  for (const part of parts) {
+    out.set(part, offset);
+    offset += part.length;
+  }
+  return out;
+}
+
+// Stored form header: magic, version, latent bits, block size, latent
+// dimension, total length and chunk count
+const HEADER_BYTES = 24;
+
+// ChunkKind byte of each chunk entry in the stored form
+function chunkKinds(stored: Uint8Array): number[] {
+  const view = new DataView(stored.buffer, stored.byteOffset, stored.byteLength);
+  const kinds: number[] = [];
+  let pos = HEADER_BYTES;
+  for (let c = 0; c < view.getUint32(20, true); c++) {
+    const kind = stored[pos];
+    kinds.push(kind);
+    pos += 5;
+    if (kind === 1) pos += 4;
+    else if (kind === 2) pos += 32;
+    else pos += 4 + view.getUint32(pos, true);
+  }
+  return kinds;
+}
+
+// The codec's exports for a model of INPUT_SIZE-byte blocks: like the real
+// geometry check, other block sizes are refused
+const INPUT_SIZE = 256;
+const LATENT_DIM = 16;
+
+function stubCodec(): { codec: WANeuralCodec; encodedBlocks: Uint8Array[] } {
+  const memory = new WebAssembly.Memory({ initial: 2 });
+  const encodedBlocks: Uint8Array[] = [];
+  const exports = {
+    codec_buffer: (kind: number) => [0x1000, 0x8000, 0xc000][kind],
+    encode_quantized_batch: (input: number, size: number, count: number, out: number, dim: number) => {
+      if (size !== INPUT_SIZE) return -1;
+      for (let b = 0; b < count; b++) encodedBlocks.push(new Uint8Array(memory.buffer, input + b * size, size).slice());
+      new Uint8Array(memory.buffer, out, count * quantizedLatentBytes(dim)).fill(1);
+      return count;
+    },
+    decode_quantized_batch: (_in: number, _dim: number, count: number, out: number, size: number) => {
+      if (size !== INPUT_SIZE) return -1;
+      new Uint8Array(memory.buffer, out, count * size).fill(0x5a);
+      return count;
+    },
+  };
+  const codec = new WANeuralCodec({ latentDim: LATENT_DIM, inputSize: INPUT_SIZE, modelWeights: new ArrayBuffer(0) });
+  Object.assign(codec as any, { wasm: { exports }, memory, initialized: true });
+  return { codec, encodedBlocks };
+}
+
+describe('WANeuralCodec single blocks', () => {
+  it('should pad a short input to the model block', async () => {
+    const { codec, encodedBlocks } = stubCodec();
+    const data = new Uint8Array(100).fill(9);
+
+    const result = await codec.compress(data);
+    expect(result.originalSize).toBe(100);
+    expect(result.latent.quantized.length).toBe(quantizedLatentBytes(LATENT_DIM));
+    expect(encodedBlocks).toHaveLength(1);
+    expect(encodedBlocks[0].subarray(0, 100).every((v) => v === 9)).toBe(true);
+    expect(encodedBlocks[0].subarray(100).every((v) => v === 0)).toBe(true);
+  });
+
+  it('should refuse more than one block', async () => {
+    const { codec } = stubCodec();
+    await expect(codec.compress(new Uint8Array(INPUT_SIZE + 1))).rejects.toThrow(/compressBatch/);
+  });
+
+  it('should decode a full block and return the requested prefix', async () => {
+    const { codec } = stubCodec();
+    const { latent } = await codec.compress(new Uint8Array(40));
+
+    const output = await codec.decompress(latent, 40);
+    expect(output).toHaveLength(40);
+    expect(output.every((v) => v === 0x5a)).toBe(true);
+  });
+});
+
+describe('Neural storage path', () => {
+  let pipeline: StoragePipeline;
+
+  beforeAll(() => {
+    // The pipeline only writes to the CAS in a browser
+    if (typeof window === 'undefined') (globalThis as any).window = globalThis;
+  });
+
+  beforeEach(() => {
+    mockCas.clear();
+    mockChunks.clear();
+    pipeline = new StoragePipeline({ backend: 'local' });
+    (pipeline as any).neuralCodec = new FakeCodec() as unknown as WANeuralCodec;
+  });
+
+  it('should round-trip every block class, repeats and a partial last chunk', async () => {
+    const data = concat(sampleChunk(1), sampleChunk(2), sampleChunk(1), sampleChunk(3).subarray(0, 100));
+
+    const stored = await pipeline.encodeNeural(data);
+    expect(chunkKinds(stored)).toEqual([0, 0, 1, 0]);
+    expect(await pipeline.decodeNeural(stored)).toEqual(lossy(data));
+  });
+
+  it('should not merge different chunks with the same fingerprint', async () => {
+    const data = concat(sampleChunk(4), sampleChunk(5));
+
+    const stored = await pipeline.encodeNeural(data);
+    expect(chunkKinds(stored)).toEqual([0, 0]);
+    expect(await pipeline.decodeNeural(stored)).toEqual(lossy(data));
+  });
+
+  it('should read chunks of another file back from the CAS', async () => {
+    await pipeline.encodeNeural(concat(sampleChunk(6), sampleChunk(7)));
+    const data = concat(sampleChunk(8), sampleChunk(7));
+
+    const stored = await pipeline.encodeNeural(data);
+    expect(chunkKinds(stored)).toEqual([0, 2]);
+    expect(await pipeline.decodeNeural(stored)).toEqual(lossy(data));
+  });
+
+  it('should retrieve a deduplicated chunk whose neural blocks decode lossily', async () => {
+    const shared = sampleChunk(11);
+    expect(lossy(shared)).not.toEqual(shared);
+    await pipeline.encodeNeural(concat(sampleChunk(12), shared));
+
+    const data = concat(shared, sampleChunk(13));
+    const stored = await pipeline.encodeNeural(data);
+    expect(chunkKinds(stored)).toEqual([2, 0]);
+    expect(await pipeline.decodeNeural(stored)).toEqual(lossy(data));
+  });
+
+  it('should reject a CAS chunk that does not match its payload id', async () => {
+    await pipeline.encodeNeural(concat(sampleChunk(9), sampleChunk(10)));
+    const stored = await pipeline.encodeNeural(sampleChunk(10));
+    expect(chunkKinds(stored)).toEqual([2]);
+
+    // Swap the entry's payload for the other chunk's
+    const [first, second] = Array.from(mockCas.keys());
+    mockCas.set(second, mockCas.get(first)!);
+    await expect(pipeline.decodeNeural(stored)).rejects.toThrow(/payload id/);
+  });
+
+  it('should write the format version and codec geometry', async () => {
+    const stored = await pipeline.encodeNeural(sampleChunk(14));
+    const view = new DataView(stored.buffer, stored.byteOffset, stored.byteLength);
+    expect(view.getUint32(0, true)).toBe(0x464c524e); // "NRLF"
+    expect(view.getUint16(4, true)).toBe(1);
+    expect(view.getUint8(6)).toBe(8);
+    expect([view.getUint32(8, true), view.getUint32(12, true), view.getUint32(16, true)]).toEqual([BLOCK, BLOCK, CHUNK]);
+  });
+
+  it('should reject bad magic and an unknown format version', async () => {
+    const stored = await pipeline.encodeNeural(sampleChunk(15));
+
+    const badMagic = stored.slice();
+    badMagic[0] ^= 0xff;
+    await expect(pipeline.decodeNeural(badMagic)).rejects.toThrow(/bad magic/);
+    await expect(pipeline.decodeNeural(stored.subarray(0, HEADER_BYTES - 1))).rejects.toThrow(/bad magic/);
+
+    const newer = stored.slice();
+    newer[4] = 2;
+    await expect(pipeline.decodeNeural(newer)).rejects.toThrow(/format version 2, expected 1/);
+  });
+
+  it('should reject data encoded with another codec geometry', async () => {
+    const data = sampleChunk(16);
+    const stored = await pipeline.encodeNeural(data);
+
+    const codecs = [
+      Object.assign(new FakeCodec(), { blockSize: BLOCK / 2 }),
+      Object.assign(new FakeCodec(), { latentDim: BLOCK / 2 }),
+      Object.assign(new FakeCodec(), { latentBits: 4 }),
+    ];
+    for (const codec of codecs) {
+      (pipeline as any).neuralCodec = codec;
+      await expect(pipeline.decodeNeural(stored)).rejects.toThrow(/codec geometry 64\/64x8/);
+    }
+  });
+
+  it('should not reuse CAS chunks encoded with another codec geometry', async () => {
+    const shared = sampleChunk(17);
+    await pipeline.encodeNeural(concat(sampleChunk(18), shared));
+
+    (pipeline as any).neuralCodec = Object.assign(new FakeCodec(), { latentBits: 4 });
+    const stored = await pipeline.encodeNeural(shared);
+    expect(chunkKinds(stored)).toEqual([0]);
+    expect(await pipeline.decodeNeural(stored)).toEqual(lossy(shared));
+  });
+});
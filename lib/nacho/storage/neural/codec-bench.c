@@ -0,0 +1,337 @@
+/**
+ * Neural Codec - Benchmark Harness
+ * Runs encode_quantized_batch / decode_quantized_batch over a block corpus
+ * and reports encode and decode MB/s, p50/p99 single-block latency,
+ * reconstruction PSNR and mean byte error, and allocator growth.
+ *
+ * Native: gcc -O2 -std=c11 codec-bench.c -lm -o codec-bench
+ *         ./codec-bench [-n iterations] [-b batch] [-q 8|4] [-m packed|f32|int8|all] [-w model.bin] [file...]
+ *   Without files it runs synthetic corpora (text, zero pages, gradients,
+ *   records, random). Without -w the model is random 4096/512/256 weights:
+ *   fine for throughput, but only a trained model gives meaningful PSNR.
+ * WASM:   the same file built to wasm32 exports codec_bench() next to the
+ *   codec entry points and imports env.now() in milliseconds
+ *   (lib/nacho/storage/neural/codec-benchmark.ts).
+ */
+
+#ifndef __wasm__
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "wasm-codec.c"
+
+typedef struct {
+    double encode_seconds;     // Batched passes over the whole corpus
+    double decode_seconds;
+    double encode_p50_us;      // Single-block calls, one per corpus block
+    double encode_p99_us;
+    double decode_p50_us;
+    double decode_p99_us;
+    double psnr_db;            // Reconstruction of every block; INFINITY when exact
+    double mean_abs_error;     // Per byte
+    uint64_t bytes;            // Whole blocks per iteration
+    uint32_t blocks;
+    uint32_t iterations;
+    int64_t leaked_bytes;      // heap live_bytes after the run minus before
+    int64_t reserved_growth;   // Bump region added after the warm-up pass
+} CodecBenchStats;
+
+#ifdef __wasm__
+__attribute__((import_module("env"), import_name("now"))) double bench_now_ms(void);
+#else
+#include <time.h>
+
+static double bench_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+#endif
+
+// Shell sort; the latency arrays hold one sample per block
+static void sort_samples(float* v, uint32_t n) {
+    for (uint32_t gap = n / 2; gap > 0; gap /= 2) {
+        for (uint32_t i = gap; i < n; i++) {
+            float x = v[i];
+            uint32_t j = i;
+            for (; j >= gap && v[j - gap] > x; j -= gap) v[j] = v[j - gap];
+            v[j] = x;
+        }
+    }
+}
+
+static double percentile(const float* sorted, uint32_t n, uint32_t pct) {
+    uint32_t i = (uint32_t)(((uint64_t)n * pct + 99) / 100);
+    return sorted[i ? i - 1 : 0];
+}
+
+/**
+ * Benchmark the loaded model over `length` bytes of corpus, cut into
+ * block_size blocks (a trailing partial block is ignored). Callers run
+ * init_model first. Throughput passes encode the corpus `iterations` times
+ * in calls of `batch` blocks, then decode it the same way; the latency and
+ * error pass codes each block on its own. Returns 1, or 0 when the sizes do
+ * not fit the model or scratch memory is unavailable.
+ */
+int codec_bench(const uint8_t* corpus, size_t length, int block_size, int latent_size,
+                int bits, int batch, uint32_t iterations, CodecBenchStats* stats) {
+    if (!stats || block_size <= 0 || batch <= 0 || iterations == 0) return 0;
+    if (!geometry_ok(&model.encoder, block_size, latent_size) ||
+        !geometry_ok(&model.decoder, block_size, latent_size)) return 0;
+    const uint32_t blocks = (uint32_t)(length / (size_t)block_size);
+    if (!blocks) return 0;
+    if ((uint32_t)batch > blocks) batch = (int)blocks;
+
+    const size_t record = latent_bytes(latent_size, bits);
+    uint8_t* records = heap_alloc((size_t)blocks * record);
+    uint8_t* output = heap_alloc((size_t)batch * block_size);
+    float* encode_us = heap_alloc((size_t)blocks * sizeof(float));
+    float* decode_us = heap_alloc((size_t)blocks * sizeof(float));
+    if (!records || !output || !encode_us || !decode_us) {
+        heap_free(records);
+        heap_free(output);
+        heap_free(encode_us);
+        heap_free(decode_us);
+        return 0;
+    }
+
+    // Warm-up: first use sizes any lazily allocated state
+    encode_quantized_batch(corpus, block_size, batch, records, latent_size, bits);
+    decode_quantized_batch(records, latent_size, batch, output, block_size, bits);
+    const HeapStats before = codec_heap()->stats;
+
+    double start = bench_now_ms();
+    for (uint32_t it = 0; it < iterations; it++) {
+        for (uint32_t b = 0; b < blocks; b += (uint32_t)batch) {
+            int count = blocks - b < (uint32_t)batch ? (int)(blocks - b) : batch;
+            encode_quantized_batch(corpus + (size_t)b * block_size, block_size, count,
+                                   records + (size_t)b * record, latent_size, bits);
+        }
+    }
+    stats->encode_seconds += (bench_now_ms() - start) / 1e3;
+
+    start = bench_now_ms();
+    for (uint32_t it = 0; it < iterations; it++) {
+        for (uint32_t b = 0; b < blocks; b += (uint32_t)batch) {
+            int count = blocks - b < (uint32_t)batch ? (int)(blocks - b) : batch;
+            decode_quantized_batch(records + (size_t)b * record, latent_size, count,
+                                   output, block_size, bits);
+        }
+    }
+    stats->decode_seconds += (bench_now_ms() - start) / 1e3;
+
+    double squared = 0, absolute = 0;
+    for (uint32_t b = 0; b < blocks; b++) {
+        const uint8_t* block = corpus + (size_t)b * block_size;
+        double t0 = bench_now_ms();
+        encode_quantized_batch(block, block_size, 1, records, latent_size, bits);
+        double t1 = bench_now_ms();
+        decode_quantized_batch(records, latent_size, 1, output, block_size, bits);
+        double t2 = bench_now_ms();
+        encode_us[b] = (float)((t1 - t0) * 1e3);
+        decode_us[b] = (float)((t2 - t1) * 1e3);
+        for (int i = 0; i < block_size; i++) {
+            int d = (int)output[i] - (int)block[i];
+            squared += (double)(d * d);
+            absolute += (double)(d < 0 ? -d : d);
+        }
+    }
+    sort_samples(encode_us, blocks);
+    sort_samples(decode_us, blocks);
+
+    const double samples = (double)blocks * block_size;
+    const double mse = squared / samples;
+    stats->encode_p50_us = percentile(encode_us, blocks, 50);
+    stats->encode_p99_us = percentile(encode_us, blocks, 99);
+    stats->decode_p50_us = percentile(decode_us, blocks, 50);
+    stats->decode_p99_us = percentile(decode_us, blocks, 99);
+    stats->psnr_db = mse > 0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+    stats->mean_abs_error = absolute / samples;
+    stats->bytes = (uint64_t)blocks * (uint64_t)block_size;
+    stats->blocks = blocks;
+    stats->iterations = iterations;
+    stats->leaked_bytes = (int64_t)codec_heap()->stats.live_bytes - (int64_t)before.live_bytes;
+    stats->reserved_growth = (int64_t)codec_heap()->stats.reserved_bytes - (int64_t)before.reserved_bytes;
+
+    heap_free(records);
+    heap_free(output);
+    heap_free(encode_us);
+    heap_free(decode_us);
+    return 1;
+}
+
+#ifndef __wasm__
+
+#include <stdio.h>
+
+typedef struct {
+    const char* name;
+    uint8_t* bytes;
+    size_t length;
+} Corpus;
+
+static uint32_t rng_state = 0x9E3779B9u;
+
+static uint32_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// kind: 0 text, 1 zero pages, 2 gradients, 3 fixed-width records, 4 random
+static void fill_corpus(int kind, uint8_t* out, size_t length, int block_size) {
+    static const char* const words[] = { "the ", "codec ", "block ", "storage ", "latent ", "of ", "and ", "page\n" };
+    size_t i = 0;
+    switch (kind) {
+        case 0:
+            while (i < length) {
+                const char* w = words[next_random() % 8];
+                while (*w && i < length) out[i++] = (uint8_t)*w++;
+            }
+            break;
+        case 1:
+            memset(out, 0, length);
+            break;
+        case 2:
+            for (; i < length; i++) {
+                size_t x = i % (size_t)block_size, row = i / 64;
+                out[i] = (uint8_t)((x % 64) * 3 + row + (next_random() & 3));
+            }
+            break;
+        case 3:
+            for (; i < length; i += 16) {
+                uint32_t id = (uint32_t)(i / 16);
+                for (int b = 0; b < 16 && i + (size_t)b < length; b++) {
+                    out[i + b] = b < 4 ? (uint8_t)(id >> (8 * b)) : b < 8 ? (uint8_t)(next_random() & 0x0F) : 0;
+                }
+            }
+            break;
+        default:
+            for (; i < length; i++) out[i] = (uint8_t)next_random();
+            break;
+    }
+}
+
+static uint8_t* read_file(const char* path, size_t* length) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    size_t capacity = 1 << 16, size = 0, n;
+    uint8_t* data = malloc(capacity);
+    while (data && (n = fread(data + size, 1, capacity - size, f)) > 0) {
+        size += n;
+        if (size == capacity) {
+            uint8_t* grown = realloc(data, capacity *= 2);
+            if (!grown) free(data);
+            data = grown;
+        }
+    }
+    fclose(f);
+    *length = size;
+    return data;
+}
+
+// Random nibbles near the midpoint keep the activations out of saturation
+static uint8_t* synthetic_model(int input, int hidden, int latent, size_t* size) {
+    const size_t network = ((size_t)hidden * (input + latent) + 1) / 2;
+    *size = sizeof(ModelHeader) + 2 * network;
+    uint8_t* blob = malloc(*size);
+    if (!blob) return NULL;
+    ModelHeader header = { MODEL_MAGIC, (uint32_t)input, (uint32_t)hidden, (uint32_t)latent };
+    memcpy(blob, &header, sizeof(header));
+    for (size_t i = sizeof(header); i < *size; i++) {
+        uint32_t r = next_random();
+        blob[i] = (uint8_t)((6 + (r & 3)) | ((6 + ((r >> 2) & 3)) << 4));
+    }
+    return blob;
+}
+
+int main(int argc, char** argv) {
+    static const char* const mode_names[3] = { "packed", "f32", "int8" };
+    static const char* const synthetic_names[5] = { "text", "zero", "gradient", "records", "random" };
+    uint32_t iterations = 10;
+    int batch = 16, bits = 8, mode = -1;
+    const char* model_path = NULL;
+    Corpus corpora[16];
+    int corpus_count = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) iterations = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) batch = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-q") == 0 && i + 1 < argc) bits = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) model_path = argv[++i];
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            mode = strcmp(name, "all") == 0 ? -1 : -2;
+            for (int m = 0; m < 3; m++) {
+                if (strcmp(name, mode_names[m]) == 0) mode = m;
+            }
+        } else if (corpus_count < 16) {
+            Corpus* c = &corpora[corpus_count];
+            c->name = argv[i];
+            c->bytes = read_file(argv[i], &c->length);
+            if (!c->bytes) {
+                fprintf(stderr, "codec-bench: cannot read %s\n", argv[i]);
+                return 1;
+            }
+            corpus_count++;
+        }
+    }
+    if (iterations == 0 || batch <= 0 || (bits != 8 && bits != 4) || mode == -2) {
+        fprintf(stderr, "usage: codec-bench [-n iterations] [-b batch] [-q 8|4] [-m packed|f32|int8|all] [-w model.bin] [file...]\n");
+        return 1;
+    }
+
+    size_t model_size;
+    uint8_t* blob = model_path ? read_file(model_path, &model_size) : synthetic_model(4096, 512, 256, &model_size);
+    if (!blob || init_model(blob, (int)model_size, WEIGHTS_PACKED) != 0 || !model.has_header) {
+        fprintf(stderr, "codec-bench: %s is not a model with an NCM1 header\n", model_path ? model_path : "synthetic model");
+        return 1;
+    }
+    const int block_size = model.input_size, latent_size = model.latent_size;
+
+    if (!corpus_count) {
+        for (int k = 0; k < 5; k++) {
+            Corpus* c = &corpora[corpus_count++];
+            c->name = synthetic_names[k];
+            c->length = (size_t)256 * block_size;
+            c->bytes = malloc(c->length);
+            if (!c->bytes) return 1;
+            fill_corpus(k, c->bytes, c->length, block_size);
+        }
+    }
+
+    printf("model %d/%d/%d, %d-bit latents, batch %d, %u iterations\n",
+           block_size, model.hidden_size, latent_size, bits, batch, iterations);
+    printf("%-12s %-6s %7s %9s %9s %9s %9s %9s %9s %8s %8s %8s %9s\n",
+           "corpus", "mode", "blocks", "enc MB/s", "dec MB/s", "enc p50", "enc p99",
+           "dec p50", "dec p99", "PSNR dB", "byte err", "leaked", "reserved");
+    for (int m = 0; m < 3; m++) {
+        if (mode >= 0 && m != mode) continue;
+        if (init_model(blob, (int)model_size, m) != 0) {
+            fprintf(stderr, "codec-bench: cannot load the %s weights\n", mode_names[m]);
+            return 1;
+        }
+        for (int c = 0; c < corpus_count; c++) {
+            CodecBenchStats stats;
+            memset(&stats, 0, sizeof(stats));
+            if (!codec_bench(corpora[c].bytes, corpora[c].length, block_size, latent_size,
+                             bits, batch, iterations, &stats)) {
+                fprintf(stderr, "codec-bench: %s holds no whole %d-byte block\n", corpora[c].name, block_size);
+                continue;
+            }
+            const double total = (double)stats.bytes * iterations / (1 << 20);
+            printf("%-12.12s %-6s %7u %9.2f %9.2f %7.0fus %7.0fus %7.0fus %7.0fus %8.2f %8.3f %8lld %9lld\n",
+                   corpora[c].name, mode_names[m], stats.blocks,
+                   total / stats.encode_seconds, total / stats.decode_seconds,
+                   stats.encode_p50_us, stats.encode_p99_us, stats.decode_p50_us, stats.decode_p99_us,
+                   stats.psnr_db, stats.mean_abs_error,
+                   (long long)stats.leaked_bytes, (long long)stats.reserved_growth);
+        }
+    }
+    release_model();
+    free(blob);
+    return 0;
+}
+
+#endif
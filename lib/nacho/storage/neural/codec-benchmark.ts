@@ -0,0 +1,171 @@
+/**
+ * Codec Benchmark - Runs the WASM build of codec-bench.c over block corpora
+ * for each weight layout: encode and decode throughput, single-block
+ * latency, reconstruction error and allocator growth.
+ */
+
+import { loadNativeAndInstantiate } from '../../../wasm/loader';
+import { CodecGeometry, CodecWeightMode, LatentBits } from './wasm-codec';
+
+export interface CodecBenchCorpus {
+  name: string;
+  data: Uint8Array; // Trailing partial block is ignored
+}
+
+export interface CodecBenchOptions {
+  iterations?: number; // Throughput passes (default 10)
+  batch?: number; // Blocks per encode/decode call (default 16)
+  latentBits?: LatentBits; // Default 8
+  modes?: CodecWeightMode[]; // Default all three
+}
+
+export interface CodecBenchResult {
+  corpus: string;
+  weightMode: CodecWeightMode;
+  blocks: number;
+  bytes: number; // Per iteration
+  encodeBytesPerSecond: number;
+  decodeBytesPerSecond: number;
+  encodeP50Us: number; // Single-block calls
+  encodeP99Us: number;
+  decodeP50Us: number;
+  decodeP99Us: number;
+  psnr: number; // dB, Infinity for an exact reconstruction
+  meanByteError: number;
+  leakedBytes: number; // Allocator live bytes gained over the run
+  reservedGrowth: number; // Heap bytes reserved after warm-up
+}
+
+interface CodecBenchExports {
+  memory?: WebAssembly.Memory;
+  malloc(size: number): number;
+  free(ptr: number): void;
+  init_model(weights: number, size: number, mode: number): number;
+  codec_bench(
+    corpus: number,
+    length: number,
+    blockSize: number,
+    latentSize: number,
+    bits: number,
+    batch: number,
+    iterations: number,
+    stats: number
+  ): number;
+}
+
+// sizeof(CodecBenchStats) on wasm32
+const STATS_BYTES = 96;
+
+function readGeometry(modelWeights: Uint8Array): CodecGeometry | null {
+  if (modelWeights.length < 16) return null;
+  const header = new DataView(modelWeights.buffer, modelWeights.byteOffset, 16);
+  if (header.getUint32(0, true) !== 0x314d434e) return null; // "NCM1"
+  return {
+    inputSize: header.getUint32(4, true),
+    hiddenSize: header.getUint32(8, true),
+    latentDim: header.getUint32(12, true),
+  };
+}
+
+/**
+ * Benchmark the codec on `corpora` with a model blob that carries a geometry
+ * header (packModelWeights). Returns null when /wasm/codec-bench.wasm is not
+ * available.
+ */
+export async function benchmarkNeuralCodec(
+  corpora: CodecBenchCorpus[],
+  modelWeights: Uint8Array,
+  options: CodecBenchOptions = {}
+): Promise<CodecBenchResult[] | null> {
+  const geometry = readGeometry(modelWeights);
+  if (!geometry) throw new Error('Codec benchmark needs a model with a geometry header');
+
+  const memory = new WebAssembly.Memory({ initial: 256, maximum: 16384 });
+  const exports = (await loadNativeAndInstantiate('codec-bench', {
+    env: {
+      memory,
+      now: () => performance.now(),
+      abort: () => console.error('[codec-bench] Aborted'),
+    },
+  })) as CodecBenchExports | null;
+  if (!exports || typeof exports.codec_bench !== 'function') return null;
+  const heap = () => (exports.memory ?? memory).buffer;
+
+  const iterations = options.iterations ?? 10;
+  const batch = options.batch ?? 16;
+  const bits = options.latentBits ?? 8;
+  const modes = options.modes ?? [CodecWeightMode.PACKED, CodecWeightMode.F32, CodecWeightMode.INT8];
+
+  const modelPtr = exports.malloc(modelWeights.length);
+  const statsPtr = exports.malloc(STATS_BYTES);
+  if (!modelPtr || !statsPtr) throw new Error('Codec benchmark: out of memory');
+  new Uint8Array(heap()).set(modelWeights, modelPtr);
+
+  const results: CodecBenchResult[] = [];
+  try {
+    for (const mode of modes) {
+      if (exports.init_model(modelPtr, modelWeights.length, mode) < 0) {
+        throw new Error(`Codec benchmark: cannot load ${CodecWeightMode[mode]} weights`);
+      }
+      for (const corpus of corpora) {
+        const corpusPtr = exports.malloc(corpus.data.length);
+        if (!corpusPtr) throw new Error(`Codec benchmark: no room for corpus ${corpus.name}`);
+        new Uint8Array(heap()).set(corpus.data, corpusPtr);
+        new Uint8Array(heap(), statsPtr, STATS_BYTES).fill(0);
+
+        const ok = exports.codec_bench(
+          corpusPtr,
+          corpus.data.length,
+          geometry.inputSize,
+          geometry.latentDim,
+          bits,
+          batch,
+          iterations,
+          statsPtr
+        );
+        exports.free(corpusPtr);
+        if (!ok) continue;
+
+        const view = new DataView(heap(), statsPtr, STATS_BYTES);
+        const encodeSeconds = view.getFloat64(0, true);
+        const decodeSeconds = view.getFloat64(8, true);
+        const bytes = Number(view.getBigUint64(64, true));
+        results.push({
+          corpus: corpus.name,
+          weightMode: mode,
+          blocks: view.getUint32(72, true),
+          bytes,
+          encodeBytesPerSecond: encodeSeconds > 0 ? (bytes * iterations) / encodeSeconds : 0,
+          decodeBytesPerSecond: decodeSeconds > 0 ? (bytes * iterations) / decodeSeconds : 0,
+          encodeP50Us: view.getFloat64(16, true),
+          encodeP99Us: view.getFloat64(24, true),
+          decodeP50Us: view.getFloat64(32, true),
+          decodeP99Us: view.getFloat64(40, true),
+          psnr: view.getFloat64(48, true),
+          meanByteError: view.getFloat64(56, true),
+          leakedBytes: Number(view.getBigInt64(80, true)),
+          reservedGrowth: Number(view.getBigInt64(88, true)),
+        });
+      }
+    }
+  } finally {
+    exports.free(statsPtr);
+    exports.free(modelPtr);
+  }
+
+  console.table(
+    results.map((r) => ({
+      corpus: r.corpus,
+      mode: CodecWeightMode[r.weightMode],
+      blocks: r.blocks,
+      'enc MB/s': (r.encodeBytesPerSecond / (1 << 20)).toFixed(2),
+      'dec MB/s': (r.decodeBytesPerSecond / (1 << 20)).toFixed(2),
+      'enc p50/p99 us': `${r.encodeP50Us.toFixed(0)}/${r.encodeP99Us.toFixed(0)}`,
+      'dec p50/p99 us': `${r.decodeP50Us.toFixed(0)}/${r.decodeP99Us.toFixed(0)}`,
+      'PSNR dB': Number.isFinite(r.psnr) ? r.psnr.toFixed(2) : 'exact',
+      'byte err': r.meanByteError.toFixed(3),
+      leaked: r.leakedBytes,
+    }))
+  );
+  return results;
+}
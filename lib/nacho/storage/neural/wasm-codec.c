@@ -2,8 +2,19 @@
  * Custom WASM Neural Codec - C Implementation
  * Tiny autoencoder for ultra-compact compression
  * 
- * To compile:
- * emcc wasm-codec.c -O3 -s WASM=1 -s EXPORTED_FUNCTIONS='["_malloc","_free","_encode","_decode","_init_model"]' -o wasm-codec.wasm
+ * To compile: node scripts/build-native-wasm.js [--threads]
+ * (clang against a WASI sysroot, -O3 and LTO, then wasm-opt; the exports
+ * are listed there), e.g. by hand:
+ * clang --target=wasm32-wasip1 --sysroot=$WASI_SDK_PATH/share/wasi-sysroot -O3 -flto -nostartfiles -Wl,--no-entry -Wl,--import-memory -Wl,--export=encode ... wasm-codec.c -o wasm-codec.wasm
+ *
+ * Add -msimd128 for the SIMD128 kernels (wasm-codec-simd.wasm); the build
+ * without it keeps the scalar loops for engines lacking SIMD support.
+ * -DCODEC_SIGMOID picks the output activation (see SIGMOID_EXP below).
+ * -DNATIVE_COUNTERS=1 (--counters) compiles in the get_counters() counters.
+ *
+ * Threaded build (wasm-codec-simd-threads.wasm): --target=wasm32-wasip1-threads
+ * -matomics -mbulk-memory -Wl,--shared-memory,--export=__stack_pointer and
+ * export codec_set_threads, codec_thread_stack and codec_worker.
  */
 
 #include <stdint.h>
@@ -11,13 +22,107 @@
 #include <string.h>
 #include <math.h>
 
+#include "../../../wasm/native/wasm-arena.h"
+#include "../../../wasm/native/native-counters.h"
+
+#ifdef __wasm_atomics__
+#define CODEC_THREADS 1
+#else
+#define CODEC_THREADS 0
+#endif
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#define CODEC_SIMD 1
+#else
+#define CODEC_SIMD 0
+#endif
+
+// Output activation, fixed at compile time with -DCODEC_SIGMOID=n:
+//   SIGMOID_EXP       1 / (1 + e^-x) through expf, exp_f32x4 in SIMD lanes
+//   SIGMOID_TABLE     The exact expf byte from 255 precomputed thresholds,
+//                     found with 8 branchless compares; scalar only
+//   SIGMOID_RATIONAL  0.5 + 0.5 tanh(x / 2) with a [7/6] Pade tanh and no
+//                     exp; within one byte of SIGMOID_EXP, vectorized
+// Scalar builds default to the table, SIMD builds to the rational form.
+#define SIGMOID_EXP 0
+#define SIGMOID_TABLE 1
+#define SIGMOID_RATIONAL 2
+
+#ifndef CODEC_SIGMOID
+#define CODEC_SIGMOID (CODEC_SIMD ? SIGMOID_RATIONAL : SIGMOID_TABLE)
+#endif
+
 #define MAX_LATENT_DIM 512
 #define MAX_INPUT_SIZE 8192
+#define HIDDEN_SIZE 512  // Hidden width of headerless models
+#define BATCH_TILE 4     // Blocks per weight pass in the batched layers
+
+#define CODEC_INLINE inline __attribute__((always_inline))
+
+// Size-class allocator (end of file), also exported as malloc/free in WASM
+static void* heap_alloc(size_t size);
+static void heap_free(void* ptr);
+
+// Weight layouts, selected by init_model's mode argument. The 4-bit value v
+// stands for v / 7.5 - 1 = (2v - 15) / 15, so the int8 expansion is exact with
+// one scale of 1/15 for every row.
+enum {
+    WEIGHTS_PACKED = 0,   // Dequantize from the nibbles in the inner loop
+    WEIGHTS_F32 = 1,      // Expanded once to v / 7.5 - 1
+    WEIGHTS_INT8 = 2      // Expanded once to 2v - 15, int8 dot products
+};
+
+#define INT8_WEIGHT_SCALE (1.0f / 15.0f)
+
+// Optional header at the start of the init_model blob. It is followed by the
+// encoder weights (hidden x input, then latent x hidden) and the decoder
+// weights (hidden x latent, then input x hidden), 4-bit packed, each network
+// starting on a byte. Without a header the blob is split in half, the block
+// and latent sizes come from each encode/decode call and the hidden layer
+// has HIDDEN_SIZE units.
+#define MODEL_MAGIC 0x314D434Eu  // "NCM1"
+#define MODEL_MAX_DIM (1 << 16)
 
-// Neural network weights (quantized 4-bit)
-static uint8_t encoder_weights[50 * 1024]; // 50KB
-static uint8_t decoder_weights[50 * 1024]; // 50KB
-static int latent_dim = 256;
+typedef struct {
+    uint32_t magic;
+    uint32_t input_size;
+    uint32_t hidden_size;   // Must be even so the second layer starts on a byte
+    uint32_t latent_size;
+} ModelHeader;
+
+typedef struct {
+    const uint8_t* packed;
+    const float* f32;
+    const int8_t* i8;
+    size_t count;           // Weights available
+} Weights;
+
+typedef void (*EncodeTileFn)(const uint8_t* input, int count, float* latent);
+typedef void (*DecodeTileFn)(const float* latent, int count, uint8_t* output);
+
+typedef struct {
+    int has_header;
+    int weight_mode;
+    int input_size;         // Header geometry (0 for headerless models)
+    int hidden_size;
+    int latent_size;
+    Weights encoder;
+    Weights decoder;
+    void* weight_storage;   // Packed copy plus the expanded layout
+    // Per-tile activations (too large for the stack once batched)
+    float* tile_input;
+    float* tile_hidden;
+    float* tile_latent;     // Latents between the network and (de)quantization
+    int8_t* quantized_input;
+    float quantized_scale[BATCH_TILE];
+    void* tile_storage;
+    // Kernels specialized for the header geometry, NULL for the generic path
+    EncodeTileFn encode_tile;
+    DecodeTileFn decode_tile;
+} Model;
+
+static Model model;
 
 // Activation functions
 static inline float relu(float x) {
@@ -42,97 +147,1306 @@ static float dequantize_weight(uint8_t packed, int index) {
     return (value / 7.5f) - 1.0f;
 }
 
-// Simple matrix multiplication
-static void matmul(const float* input, int input_size, 
-                   const uint8_t* weights, int output_size,
-                   float* output) {
-    for (int i = 0; i < output_size; i++) {
-        float sum = 0.0f;
+// Matrix multiplication over a tile of `count` (<= BATCH_TILE) input
+// vectors stored back to back; outputs are likewise output_size apart.
+// Only output rows [row_begin, row_end) are computed, so a layer can be
+// split across threads. Each weight is dequantized once and applied to
+// every vector in the tile.
+static CODEC_INLINE void matmul_scalar(const float* input, int input_size, int count,
+                                       const uint8_t* weights, int output_size,
+                                       int row_begin, int row_end, float* output) {
+    for (int i = row_begin; i < row_end; i++) {
+        float sum[BATCH_TILE] = { 0.0f };
         for (int j = 0; j < input_size; j++) {
             int weight_index = i * input_size + j;
             float weight = dequantize_weight(weights[weight_index / 2], weight_index);
-            sum += input[j] * weight;
+            for (int b = 0; b < count; b++) {
+                sum[b] += input[b * input_size + j] * weight;
+            }
+        }
+        for (int b = 0; b < count; b++) {
+            output[b * output_size + i] = sum[b];
+        }
+    }
+}
+
+#if CODEC_SIMD
+
+// Sixteen 4-bit weights (8 packed bytes) as nibble values 0-15, in index
+// order: the low nibble of each byte comes first
+static inline v128_t unpack_nibbles(const uint8_t* packed) {
+    v128_t bytes = wasm_v128_load64_zero(packed);
+    v128_t lo = wasm_v128_and(bytes, wasm_i8x16_splat(0x0F));
+    v128_t hi = wasm_u8x16_shr(bytes, 4);
+    return wasm_i8x16_shuffle(lo, hi, 0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+}
+
+static inline float hsum_f32x4(v128_t v) {
+    return wasm_f32x4_extract_lane(v, 0) + wasm_f32x4_extract_lane(v, 1)
+         + wasm_f32x4_extract_lane(v, 2) + wasm_f32x4_extract_lane(v, 3);
+}
+
+static inline int32_t hsum_i32x4(v128_t v) {
+    return wasm_i32x4_extract_lane(v, 0) + wasm_i32x4_extract_lane(v, 1)
+         + wasm_i32x4_extract_lane(v, 2) + wasm_i32x4_extract_lane(v, 3);
+}
+
+// With w = v / 7.5 - 1, each output is sum(x * v) / 7.5 - sum(x): the inner
+// loop only converts nibbles and accumulates x * v, and sum(x) is shared by
+// every row. Rows must start on a byte, so input_size has to be even.
+static CODEC_INLINE void matmul_simd(const float* input, int input_size, int count,
+                                     const uint8_t* weights, int output_size,
+                                     int row_begin, int row_end, float* output) {
+    const int vec_end = input_size & ~15;
+    float input_sum[BATCH_TILE] = { 0.0f };
+    for (int b = 0; b < count; b++) {
+        for (int j = 0; j < input_size; j++) {
+            input_sum[b] += input[b * input_size + j];
+        }
+    }
+
+    for (int i = row_begin; i < row_end; i++) {
+        const uint8_t* row = weights + (size_t)i * input_size / 2;
+        v128_t acc[BATCH_TILE];
+        for (int b = 0; b < BATCH_TILE; b++) {
+            acc[b] = wasm_f32x4_splat(0.0f);
+        }
+
+        for (int j = 0; j < vec_end; j += 16) {
+            v128_t nib = unpack_nibbles(row + j / 2);
+            v128_t lo16 = wasm_u16x8_extend_low_u8x16(nib);
+            v128_t hi16 = wasm_u16x8_extend_high_u8x16(nib);
+            v128_t w0 = wasm_f32x4_convert_u32x4(wasm_u32x4_extend_low_u16x8(lo16));
+            v128_t w1 = wasm_f32x4_convert_u32x4(wasm_u32x4_extend_high_u16x8(lo16));
+            v128_t w2 = wasm_f32x4_convert_u32x4(wasm_u32x4_extend_low_u16x8(hi16));
+            v128_t w3 = wasm_f32x4_convert_u32x4(wasm_u32x4_extend_high_u16x8(hi16));
+            for (int b = 0; b < count; b++) {
+                const float* x = input + b * input_size + j;
+                v128_t a = wasm_f32x4_mul(wasm_v128_load(x), w0);
+                a = wasm_f32x4_add(a, wasm_f32x4_mul(wasm_v128_load(x + 4), w1));
+                a = wasm_f32x4_add(a, wasm_f32x4_mul(wasm_v128_load(x + 8), w2));
+                a = wasm_f32x4_add(a, wasm_f32x4_mul(wasm_v128_load(x + 12), w3));
+                acc[b] = wasm_f32x4_add(acc[b], a);
+            }
+        }
+
+        for (int b = 0; b < count; b++) {
+            const float* x = input + b * input_size;
+            float sum = hsum_f32x4(acc[b]);
+            for (int j = vec_end; j < input_size; j++) {
+                uint8_t packed = row[j / 2];
+                sum += x[j] * (float)((j & 1) ? (packed >> 4) : (packed & 0x0F));
+            }
+            output[b * output_size + i] = sum / 7.5f - input_sum[b];
+        }
+    }
+}
+
+#if CODEC_SIGMOID == SIGMOID_EXP
+// e^x for the sigmoid: 2^n * p(r) with r = x - n ln2, |r| <= ln2 / 2
+static inline v128_t exp_f32x4(v128_t x) {
+    x = wasm_f32x4_min(wasm_f32x4_max(x, wasm_f32x4_splat(-87.0f)), wasm_f32x4_splat(88.0f));
+    v128_t n = wasm_f32x4_nearest(wasm_f32x4_mul(x, wasm_f32x4_splat(1.44269504f)));
+    v128_t r = wasm_f32x4_sub(x, wasm_f32x4_mul(n, wasm_f32x4_splat(0.693359375f)));
+    r = wasm_f32x4_sub(r, wasm_f32x4_mul(n, wasm_f32x4_splat(-2.12194440e-4f)));
+
+    v128_t p = wasm_f32x4_splat(1.9875691500e-4f);
+    p = wasm_f32x4_add(wasm_f32x4_mul(p, r), wasm_f32x4_splat(1.3981999507e-3f));
+    p = wasm_f32x4_add(wasm_f32x4_mul(p, r), wasm_f32x4_splat(8.3334519073e-3f));
+    p = wasm_f32x4_add(wasm_f32x4_mul(p, r), wasm_f32x4_splat(4.1665795894e-2f));
+    p = wasm_f32x4_add(wasm_f32x4_mul(p, r), wasm_f32x4_splat(1.6666665459e-1f));
+    p = wasm_f32x4_add(wasm_f32x4_mul(p, r), wasm_f32x4_splat(5.0000001201e-1f));
+    p = wasm_f32x4_add(wasm_f32x4_mul(wasm_f32x4_mul(p, r), r), wasm_f32x4_add(r, wasm_f32x4_splat(1.0f)));
+
+    // Scale by 2^n through the exponent bits
+    v128_t bits = wasm_i32x4_shl(wasm_i32x4_add(wasm_i32x4_trunc_sat_f32x4(n), wasm_i32x4_splat(127)), 23);
+    return wasm_f32x4_mul(p, bits);
+}
+#endif
+
+#endif
+
+static CODEC_INLINE void matmul(const float* input, int input_size, int count,
+                                const uint8_t* weights, int output_size,
+                                int row_begin, int row_end, float* output) {
+#if CODEC_SIMD
+    if ((input_size & 1) == 0) {
+        matmul_simd(input, input_size, count, weights, output_size, row_begin, row_end, output);
+        return;
+    }
+#endif
+    matmul_scalar(input, input_size, count, weights, output_size, row_begin, row_end, output);
+}
+
+static CODEC_INLINE void matmul_f32(const float* input, int input_size, int count,
+                                    const float* weights, int output_size,
+                                    int row_begin, int row_end, float* output) {
+    for (int i = row_begin; i < row_end; i++) {
+        const float* row = weights + (size_t)i * input_size;
+        float sum[BATCH_TILE] = { 0.0f };
+        int j = 0;
+#if CODEC_SIMD
+        v128_t acc[BATCH_TILE];
+        for (int b = 0; b < BATCH_TILE; b++) {
+            acc[b] = wasm_f32x4_splat(0.0f);
+        }
+        for (; j + 8 <= input_size; j += 8) {
+            v128_t w0 = wasm_v128_load(row + j);
+            v128_t w1 = wasm_v128_load(row + j + 4);
+            for (int b = 0; b < count; b++) {
+                const float* x = input + b * input_size + j;
+                acc[b] = wasm_f32x4_add(acc[b], wasm_f32x4_add(wasm_f32x4_mul(wasm_v128_load(x), w0),
+                                                               wasm_f32x4_mul(wasm_v128_load(x + 4), w1)));
+            }
+        }
+        for (int b = 0; b < count; b++) {
+            sum[b] = hsum_f32x4(acc[b]);
+        }
+#endif
+        for (; j < input_size; j++) {
+            for (int b = 0; b < count; b++) {
+                sum[b] += input[b * input_size + j] * row[j];
+            }
+        }
+        for (int b = 0; b < count; b++) {
+            output[b * output_size + i] = sum[b];
+        }
+    }
+}
+
+// Symmetric per-vector quantization of a layer input: x ~= scale * q with
+// |q| <= 127. Returns the scale (0 for an all-zero input).
+static float quantize_activations(const float* input, int count, int8_t* q) {
+    float max_abs = 0.0f;
+    for (int j = 0; j < count; j++) {
+        float a = input[j] < 0 ? -input[j] : input[j];
+        if (a > max_abs) max_abs = a;
+    }
+    if (max_abs == 0.0f) {
+        memset(q, 0, (size_t)count);
+        return 0.0f;
+    }
+    const float inv = 127.0f / max_abs;
+    for (int j = 0; j < count; j++) {
+        float v = input[j] * inv;
+        q[j] = (int8_t)(v >= 0 ? v + 0.5f : v - 0.5f);
+    }
+    return max_abs / 127.0f;
+}
+
+// Quantize a tile of layer inputs for matmul_i8 (model.quantized_input and
+// model.quantized_scale)
+static void quantize_layer_input(const float* input, int input_size, int count) {
+    for (int b = 0; b < count; b++) {
+        model.quantized_scale[b] = quantize_activations(input + b * input_size, input_size,
+                                                        model.quantized_input + b * input_size) * INT8_WEIGHT_SCALE;
+    }
+}
+
+// int8 x int8 with i32 accumulation over inputs already quantized by
+// quantize_layer_input
+static CODEC_INLINE void matmul_i8(const float* input, int input_size, int count,
+                                   const int8_t* weights, int output_size,
+                                   int row_begin, int row_end, float* output) {
+    (void)input;
+    for (int i = row_begin; i < row_end; i++) {
+        const int8_t* row = weights + (size_t)i * input_size;
+        int32_t sum[BATCH_TILE] = { 0 };
+        int j = 0;
+#if CODEC_SIMD
+        v128_t acc[BATCH_TILE];
+        for (int b = 0; b < BATCH_TILE; b++) {
+            acc[b] = wasm_i32x4_splat(0);
+        }
+        for (; j + 16 <= input_size; j += 16) {
+            v128_t w = wasm_v128_load(row + j);
+            for (int b = 0; b < count; b++) {
+                v128_t x = wasm_v128_load(model.quantized_input + b * input_size + j);
+                acc[b] = wasm_i32x4_add(acc[b], wasm_i32x4_extadd_pairwise_i16x8(wasm_i16x8_extmul_low_i8x16(x, w)));
+                acc[b] = wasm_i32x4_add(acc[b], wasm_i32x4_extadd_pairwise_i16x8(wasm_i16x8_extmul_high_i8x16(x, w)));
+            }
+        }
+        for (int b = 0; b < count; b++) {
+            sum[b] = hsum_i32x4(acc[b]);
+        }
+#endif
+        for (; j < input_size; j++) {
+            for (int b = 0; b < count; b++) {
+                sum[b] += model.quantized_input[b * input_size + j] * row[j];
+            }
+        }
+        for (int b = 0; b < count; b++) {
+            output[b * output_size + i] = (float)sum[b] * model.quantized_scale[b];
+        }
+    }
+}
+
+// Output rows [row_begin, row_end) of a fully connected layer over a tile,
+// weights starting at nibble index `first`. INT8 inputs must be quantized.
+static CODEC_INLINE void layer_rows(const float* input, int input_size, int count,
+                                    const Weights* weights, size_t first, int output_size,
+                                    int row_begin, int row_end, float* output) {
+    switch (model.weight_mode) {
+        case WEIGHTS_F32:
+            matmul_f32(input, input_size, count, weights->f32 + first, output_size, row_begin, row_end, output);
+            break;
+        case WEIGHTS_INT8:
+            matmul_i8(input, input_size, count, weights->i8 + first, output_size, row_begin, row_end, output);
+            break;
+        default:
+            matmul(input, input_size, count, weights->packed + first / 2, output_size, row_begin, row_end, output);
+            break;
+    }
+}
+
+// One fully connected layer over a tile
+static CODEC_INLINE void layer(const float* input, int input_size, int count,
+                               const Weights* weights, size_t first,
+                               int output_size, float* output) {
+    if (model.weight_mode == WEIGHTS_INT8) quantize_layer_input(input, input_size, count);
+    layer_rows(input, input_size, count, weights, first, output_size, 0, output_size, output);
+}
+
+static void relu_inplace(float* values, int count) {
+    int i = 0;
+#if CODEC_SIMD
+    const v128_t zero = wasm_f32x4_splat(0.0f);
+    for (; i + 4 <= count; i += 4) {
+        wasm_v128_store(values + i, wasm_f32x4_pmax(zero, wasm_v128_load(values + i)));
+    }
+#endif
+    for (; i < count; i++) {
+        values[i] = relu(values[i]);
+    }
+}
+
+static void tanh_inplace(float* values, int count) {
+    int i = 0;
+#if CODEC_SIMD
+    // Clamping to +-3 reproduces the branches: the rational form is exactly +-1 there
+    const v128_t lim = wasm_f32x4_splat(3.0f);
+    const v128_t c27 = wasm_f32x4_splat(27.0f);
+    const v128_t c9 = wasm_f32x4_splat(9.0f);
+    for (; i + 4 <= count; i += 4) {
+        v128_t x = wasm_v128_load(values + i);
+        x = wasm_f32x4_pmin(lim, wasm_f32x4_pmax(wasm_f32x4_neg(lim), x));
+        v128_t x2 = wasm_f32x4_mul(x, x);
+        v128_t num = wasm_f32x4_mul(x, wasm_f32x4_add(c27, x2));
+        v128_t den = wasm_f32x4_add(c27, wasm_f32x4_mul(c9, x2));
+        wasm_v128_store(values + i, wasm_f32x4_div(num, den));
+    }
+#endif
+    for (; i < count; i++) {
+        values[i] = tanh_approx(values[i]);
+    }
+}
+
+#if CODEC_SIGMOID == SIGMOID_TABLE
+// sigmoid_thresholds[k - 1] is the smallest x with (uint8_t)(sigmoid(x) * 255) >= k
+static float sigmoid_thresholds[255];
+static int sigmoid_table_ready;
+
+// Unsigned keys that sort like the floats they encode
+static uint32_t float_key(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof(bits));
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+static float key_float(uint32_t key) {
+    uint32_t bits = (key & 0x80000000u) ? key & 0x7FFFFFFFu : ~key;
+    float x;
+    memcpy(&x, &bits, sizeof(x));
+    return x;
+}
+
+static void build_sigmoid_table(void) {
+    if (sigmoid_table_ready) return;
+    for (int k = 1; k <= 255; k++) {
+        uint32_t lo = float_key(-128.0f), hi = float_key(128.0f);
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if ((int)(uint8_t)(sigmoid(key_float(mid)) * 255.0f) >= k) hi = mid;
+            else lo = mid + 1;
+        }
+        sigmoid_thresholds[k - 1] = key_float(lo);
+    }
+    sigmoid_table_ready = 1;
+}
+
+static inline uint8_t sigmoid_byte(float x) {
+    unsigned k = 0;
+    for (unsigned step = 128; step; step >>= 1) {
+        k += x >= sigmoid_thresholds[k + step - 1] ? step : 0;
+    }
+    return (uint8_t)k;
+}
+#elif CODEC_SIGMOID == SIGMOID_RATIONAL
+// tanh(h) = h (135135 + 17325 h^2 + 378 h^4 + h^6) / (135135 + 62370 h^2 + 3150 h^4 + 28 h^6)
+// stays below 5e-5 error on |h| <= 4.97; past that the byte is 254 until
+// expf's sigmoid rounds to exactly 1
+#define SIGMOID_TANH_LIMIT 4.97f
+#define SIGMOID_ONE 16.6355324f
+
+static inline uint8_t sigmoid_byte(float x) {
+    if (x >= SIGMOID_ONE) return 255;
+    float h = x * 0.5f;
+    h = h < -SIGMOID_TANH_LIMIT ? -SIGMOID_TANH_LIMIT : (h > SIGMOID_TANH_LIMIT ? SIGMOID_TANH_LIMIT : h);
+    float h2 = h * h;
+    float num = h * (135135.0f + h2 * (17325.0f + h2 * (378.0f + h2)));
+    float den = 135135.0f + h2 * (62370.0f + h2 * (3150.0f + h2 * 28.0f));
+    return (uint8_t)((0.5f + 0.5f * (num / den)) * 255.0f);
+}
+#else
+static inline uint8_t sigmoid_byte(float x) {
+    return (uint8_t)(sigmoid(x) * 255.0f);
+}
+#endif
+
+// sigmoid(x) * 255, truncated to bytes
+static void sigmoid_to_bytes(const float* values, int count, uint8_t* output) {
+    int i = 0;
+#if CODEC_SIMD && CODEC_SIGMOID == SIGMOID_RATIONAL
+    // Same operations as the scalar sigmoid_byte, so tails and lanes agree
+    const v128_t lim = wasm_f32x4_splat(SIGMOID_TANH_LIMIT);
+    const v128_t half = wasm_f32x4_splat(0.5f);
+    const v128_t scale = wasm_f32x4_splat(255.0f);
+    const v128_t one_at = wasm_f32x4_splat(SIGMOID_ONE);
+    for (; i + 4 <= count; i += 4) {
+        v128_t x = wasm_v128_load(values + i);
+        v128_t h = wasm_f32x4_mul(x, half);
+        h = wasm_f32x4_pmin(lim, wasm_f32x4_pmax(wasm_f32x4_neg(lim), h));
+        v128_t h2 = wasm_f32x4_mul(h, h);
+        v128_t num = wasm_f32x4_add(wasm_f32x4_splat(378.0f), h2);
+        num = wasm_f32x4_add(wasm_f32x4_splat(17325.0f), wasm_f32x4_mul(h2, num));
+        num = wasm_f32x4_mul(h, wasm_f32x4_add(wasm_f32x4_splat(135135.0f), wasm_f32x4_mul(h2, num)));
+        v128_t den = wasm_f32x4_add(wasm_f32x4_splat(3150.0f), wasm_f32x4_mul(h2, wasm_f32x4_splat(28.0f)));
+        den = wasm_f32x4_add(wasm_f32x4_splat(62370.0f), wasm_f32x4_mul(h2, den));
+        den = wasm_f32x4_add(wasm_f32x4_splat(135135.0f), wasm_f32x4_mul(h2, den));
+        v128_t y = wasm_f32x4_add(half, wasm_f32x4_mul(half, wasm_f32x4_div(num, den)));
+        v128_t q = wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_mul(y, scale));
+        q = wasm_v128_bitselect(wasm_i32x4_splat(255), q, wasm_f32x4_ge(x, one_at));
+        // Lanes are 0-255: two saturating narrows leave the bytes in lane order
+        v128_t bytes = wasm_u8x16_narrow_i16x8(wasm_i16x8_narrow_i32x4(q, q), wasm_i16x8_narrow_i32x4(q, q));
+        uint32_t packed = (uint32_t)wasm_i32x4_extract_lane(bytes, 0);
+        memcpy(output + i, &packed, sizeof(packed));
+    }
+#elif CODEC_SIMD && CODEC_SIGMOID == SIGMOID_EXP
+    const v128_t one = wasm_f32x4_splat(1.0f);
+    const v128_t scale = wasm_f32x4_splat(255.0f);
+    for (; i + 4 <= count; i += 4) {
+        v128_t x = wasm_v128_load(values + i);
+        v128_t y = wasm_f32x4_div(one, wasm_f32x4_add(one, exp_f32x4(wasm_f32x4_neg(x))));
+        v128_t q = wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_mul(y, scale));
+        output[i] = (uint8_t)wasm_i32x4_extract_lane(q, 0);
+        output[i + 1] = (uint8_t)wasm_i32x4_extract_lane(q, 1);
+        output[i + 2] = (uint8_t)wasm_i32x4_extract_lane(q, 2);
+        output[i + 3] = (uint8_t)wasm_i32x4_extract_lane(q, 3);
+    }
+#endif
+    for (; i < count; i++) {
+        output[i] = sigmoid_byte(values[i]);
+    }
+}
+
+// Expand `count` packed 4-bit weights into the layout for `mode`
+static void expand_weights(const uint8_t* packed, size_t count, float* f32, int8_t* i8, int mode) {
+    for (size_t k = 0; k < count; k++) {
+        uint8_t value = (k & 1) ? (packed[k / 2] >> 4) : (packed[k / 2] & 0x0F);
+        if (mode == WEIGHTS_F32) {
+            f32[k] = dequantize_weight(packed[k / 2], (int)k);
+        } else {
+            i8[k] = (int8_t)(2 * value - 15);
+        }
+    }
+}
+
+static void release_model(void) {
+    heap_free(model.weight_storage);
+    heap_free(model.tile_storage);
+    memset(&model, 0, sizeof(model));
+}
+
+// Input -> FC(hidden) -> ReLU -> FC(latent) -> Tanh for `count` blocks
+static CODEC_INLINE void encode_tile_impl(const uint8_t* input, int input_size, int hidden_size,
+                                          int latent_size, int count, float* latent) {
+    // Normalize input to 0-1
+    for (int i = 0; i < count * input_size; i++) {
+        model.tile_input[i] = input[i] / 255.0f;
+    }
+
+    layer(model.tile_input, input_size, count, &model.encoder, 0, hidden_size, model.tile_hidden);
+    relu_inplace(model.tile_hidden, count * hidden_size);
+    layer(model.tile_hidden, hidden_size, count, &model.encoder, (size_t)hidden_size * input_size,
+          latent_size, latent);
+    tanh_inplace(latent, count * latent_size);
+}
+
+// Latent -> FC(hidden) -> ReLU -> FC(output) -> Sigmoid for `count` blocks
+static CODEC_INLINE void decode_tile_impl(const float* latent, int latent_size, int hidden_size,
+                                          int output_size, int count, uint8_t* output) {
+    layer(latent, latent_size, count, &model.decoder, 0, hidden_size, model.tile_hidden);
+    relu_inplace(model.tile_hidden, count * hidden_size);
+    layer(model.tile_hidden, hidden_size, count, &model.decoder, (size_t)hidden_size * latent_size,
+          output_size, model.tile_input);
+    sigmoid_to_bytes(model.tile_input, count * output_size, output);
+}
+
+static void encode_tile_generic(const uint8_t* input, int input_size, int hidden_size,
+                                int latent_size, int count, float* latent) {
+    encode_tile_impl(input, input_size, hidden_size, latent_size, count, latent);
+}
+
+static void decode_tile_generic(const float* latent, int latent_size, int hidden_size,
+                                int output_size, int count, uint8_t* output) {
+    decode_tile_impl(latent, latent_size, hidden_size, output_size, count, output);
+}
+
+// Geometries (input, hidden, latent) with dedicated kernels: the sizes are
+// constants there, so the compiler drops the tail loops and the odd-size
+// fallbacks and fixes every trip count
+#define CODEC_GEOMETRIES(X) \
+    X(4096, 512, 256)       \
+    X(1024, 256, 64)
+
+#define DEFINE_TILE_KERNELS(I, H, L)                                                      \
+    static void encode_tile_##I##_##H##_##L(const uint8_t* input, int count, float* latent) { \
+        encode_tile_impl(input, I, H, L, count, latent);                                  \
+    }                                                                                     \
+    static void decode_tile_##I##_##H##_##L(const float* latent, int count, uint8_t* output) { \
+        decode_tile_impl(latent, L, H, I, count, output);                                 \
+    }
+CODEC_GEOMETRIES(DEFINE_TILE_KERNELS)
+#undef DEFINE_TILE_KERNELS
+
+static const struct {
+    int input_size;
+    int hidden_size;
+    int latent_size;
+    EncodeTileFn encode;
+    DecodeTileFn decode;
+} tile_kernels[] = {
+#define TILE_KERNEL_ENTRY(I, H, L) { I, H, L, encode_tile_##I##_##H##_##L, decode_tile_##I##_##H##_##L },
+    CODEC_GEOMETRIES(TILE_KERNEL_ENTRY)
+#undef TILE_KERNEL_ENTRY
+};
+
+#if CODEC_THREADS
+
+// Threaded build (-matomics -mbulk-memory, shared imported memory): worker
+// instances of this module on the same memory park in codec_worker() and
+// compute a slice of the output rows of every layer. Weights, activations
+// and the allocator stay single copies; only the instance calling
+// encode/decode allocates. Each worker gets its own stack from
+// codec_thread_stack() through the exported __stack_pointer.
+#define CODEC_MAX_THREADS 16
+#define CODEC_THREAD_STACK (64 * 1024)
+#define PARALLEL_MIN_WORK (1 << 16)  // Multiply-adds below which a layer stays on the caller
+
+enum {
+    STEP_RELU,
+    STEP_TANH,
+    STEP_SIGMOID_BYTES   // Writes sigmoid * 255 to `bytes`
+};
+
+typedef struct {
+    const float* input;
+    int input_size;
+    int count;
+    const Weights* weights;
+    size_t first;
+    int output_size;
+    float* output;
+    int activation;
+    uint8_t* bytes;
+} LayerStep;
+
+typedef struct {
+    int32_t generation;   // Futex word, bumped to publish `step`
+    int32_t pending;      // Workers still running the step
+    int32_t ready;        // Workers parked in codec_worker
+    int32_t threads;      // Participants including the caller
+    LayerStep step;
+} ThreadPool;
+
+static ThreadPool pool = { 0, 0, 0, 1, { 0 } };
+
+static void run_step_rows(const LayerStep* s, int row_begin, int row_end) {
+    layer_rows(s->input, s->input_size, s->count, s->weights, s->first, s->output_size,
+               row_begin, row_end, s->output);
+    for (int b = 0; b < s->count; b++) {
+        float* values = s->output + (size_t)b * s->output_size + row_begin;
+        switch (s->activation) {
+            case STEP_RELU:
+                relu_inplace(values, row_end - row_begin);
+                break;
+            case STEP_TANH:
+                tanh_inplace(values, row_end - row_begin);
+                break;
+            default:
+                sigmoid_to_bytes(values, row_end - row_begin, s->bytes + (size_t)b * s->output_size + row_begin);
+                break;
         }
-        output[i] = sum;
     }
 }
 
+static inline int slice_bound(int rows, int index, int threads) {
+    return (int)((int64_t)rows * index / threads);
+}
+
+// Every worker must be parked before steps are handed out, so the caller
+// only goes parallel once all of them have checked in
+static int pool_active(void) {
+    return pool.threads > 1 && __atomic_load_n(&pool.ready, __ATOMIC_ACQUIRE) == pool.threads - 1;
+}
+
+// Runs one layer step, split across the pool when it is large enough. The
+// caller takes slice 0 and then spins: the browser main thread may not block.
+static void run_step(const LayerStep* s) {
+    if (model.weight_mode == WEIGHTS_INT8) quantize_layer_input(s->input, s->input_size, s->count);
+    const int64_t work = (int64_t)s->count * s->input_size * s->output_size;
+    if (work < PARALLEL_MIN_WORK || s->output_size < pool.threads || !pool_active()) {
+        run_step_rows(s, 0, s->output_size);
+        return;
+    }
+    const int threads = pool.threads;
+    pool.step = *s;
+    __atomic_store_n(&pool.pending, threads - 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&pool.generation, 1, __ATOMIC_RELEASE);
+    __builtin_wasm_memory_atomic_notify(&pool.generation, (unsigned)(threads - 1));
+    run_step_rows(s, 0, slice_bound(s->output_size, 1, threads));
+    while (__atomic_load_n(&pool.pending, __ATOMIC_ACQUIRE) != 0) {
+    }
+}
+
+static void encode_tile_threaded(const uint8_t* input, int input_size, int latent_size,
+                                 int count, float* latent) {
+    for (int i = 0; i < count * input_size; i++) {
+        model.tile_input[i] = input[i] / 255.0f;
+    }
+    const int hidden = model.hidden_size;
+    LayerStep s1 = { model.tile_input, input_size, count, &model.encoder, 0,
+                     hidden, model.tile_hidden, STEP_RELU, NULL };
+    run_step(&s1);
+    LayerStep s2 = { model.tile_hidden, hidden, count, &model.encoder, (size_t)hidden * input_size,
+                     latent_size, latent, STEP_TANH, NULL };
+    run_step(&s2);
+}
+
+static void decode_tile_threaded(const float* latent, int latent_size, int output_size,
+                                 int count, uint8_t* output) {
+    const int hidden = model.hidden_size;
+    LayerStep s1 = { latent, latent_size, count, &model.decoder, 0,
+                     hidden, model.tile_hidden, STEP_RELU, NULL };
+    run_step(&s1);
+    LayerStep s2 = { model.tile_hidden, hidden, count, &model.decoder, (size_t)hidden * latent_size,
+                     output_size, model.tile_input, STEP_SIGMOID_BYTES, output };
+    run_step(&s2);
+}
+
+/**
+ * Set the number of threads sharing each layer, including the caller.
+ * Call before starting the workers; returns the clamped count.
+ */
+int codec_set_threads(int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > CODEC_MAX_THREADS) threads = CODEC_MAX_THREADS;
+    pool.threads = threads;
+    return threads;
+}
+
+/**
+ * Allocate a worker stack; returns its top for the worker's __stack_pointer
+ */
+void* codec_thread_stack(void) {
+    uint8_t* stack = heap_alloc(CODEC_THREAD_STACK);
+    return stack ? stack + CODEC_THREAD_STACK : NULL;
+}
+
+/**
+ * Worker loop for thread `index` (1 .. threads - 1); never returns
+ */
+void codec_worker(int index) {
+    int32_t seen = __atomic_load_n(&pool.generation, __ATOMIC_ACQUIRE);
+    __atomic_add_fetch(&pool.ready, 1, __ATOMIC_ACQ_REL);
+    for (;;) {
+        __builtin_wasm_memory_atomic_wait32(&pool.generation, seen, -1);
+        int32_t generation = __atomic_load_n(&pool.generation, __ATOMIC_ACQUIRE);
+        if (generation == seen) continue;
+        seen = generation;
+        const int threads = pool.threads;
+        const LayerStep* s = &pool.step;
+        run_step_rows(s, slice_bound(s->output_size, index, threads), slice_bound(s->output_size, index + 1, threads));
+        __atomic_sub_fetch(&pool.pending, 1, __ATOMIC_RELEASE);
+    }
+}
+
+#endif
+
 /**
  * Initialize model with pre-trained weights
+ *
+ * The blob may start with a ModelHeader giving the layer sizes; see
+ * MODEL_MAGIC. mode selects the weight layout (WEIGHTS_PACKED, WEIGHTS_F32
+ * or WEIGHTS_INT8); callers passing only two arguments get the packed
+ * layout. Returns 0, or -1 for a malformed header, a blob too short for its
+ * geometry, or when the weights do not fit in memory.
  */
-void init_model(const uint8_t* weights_data, int size) {
-    // Split weights between encoder and decoder
-    int encoder_size = size / 2;
-    memcpy(encoder_weights, weights_data, encoder_size);
-    memcpy(decoder_weights, weights_data + encoder_size, encoder_size);
+int init_model(const uint8_t* weights_data, int size, int mode) {
+    release_model();
+#if CODEC_SIGMOID == SIGMOID_TABLE
+    build_sigmoid_table();
+#endif
+    size_t bytes = size > 0 ? (size_t)size : 0;
+
+    ModelHeader header;
+    memset(&header, 0, sizeof(header));
+    if (bytes >= sizeof(header)) memcpy(&header, weights_data, sizeof(header));
+
+    size_t network_bytes;
+    const uint8_t* encoder_src;
+    if (header.magic == MODEL_MAGIC) {
+        if (header.input_size == 0 || header.input_size > MODEL_MAX_DIM ||
+            header.hidden_size == 0 || header.hidden_size > MODEL_MAX_DIM || (header.hidden_size & 1) ||
+            header.latent_size == 0 || header.latent_size > MODEL_MAX_DIM) {
+            return -1;
+        }
+        uint64_t count = (uint64_t)header.hidden_size * (header.input_size + header.latent_size);
+        if (count > (SIZE_MAX >> 3)) return -1;
+        network_bytes = (size_t)(count + 1) / 2;
+        if (bytes - sizeof(header) < 2 * network_bytes) return -1;
+        encoder_src = weights_data + sizeof(header);
+        model.has_header = 1;
+        model.input_size = (int)header.input_size;
+        model.hidden_size = (int)header.hidden_size;
+        model.latent_size = (int)header.latent_size;
+    } else {
+        // Split weights between encoder and decoder
+        network_bytes = bytes / 2;
+        encoder_src = weights_data;
+        model.hidden_size = HIDDEN_SIZE;
+    }
+
+    model.weight_mode = (mode == WEIGHTS_F32 || mode == WEIGHTS_INT8) ? mode : WEIGHTS_PACKED;
+    const size_t count = network_bytes * 2;
+    const size_t packed_bytes = (2 * network_bytes + 15) & ~(size_t)15;
+    const size_t expanded_bytes = model.weight_mode == WEIGHTS_F32 ? count * sizeof(float)
+                                : model.weight_mode == WEIGHTS_INT8 ? count : 0;
+
+    uint8_t* storage = heap_alloc(packed_bytes + 2 * expanded_bytes);
+    if (!storage) return -1;
+    model.weight_storage = storage;
+    memcpy(storage, encoder_src, 2 * network_bytes);
+
+    model.encoder.packed = storage;
+    model.decoder.packed = storage + network_bytes;
+    model.encoder.count = model.decoder.count = count;
+    if (model.weight_mode == WEIGHTS_F32) {
+        float* f32 = (float*)(storage + packed_bytes);
+        expand_weights(model.encoder.packed, count, f32, NULL, WEIGHTS_F32);
+        expand_weights(model.decoder.packed, count, f32 + count, NULL, WEIGHTS_F32);
+        model.encoder.f32 = f32;
+        model.decoder.f32 = f32 + count;
+    } else if (model.weight_mode == WEIGHTS_INT8) {
+        int8_t* i8 = (int8_t*)(storage + packed_bytes);
+        expand_weights(model.encoder.packed, count, NULL, i8, WEIGHTS_INT8);
+        expand_weights(model.decoder.packed, count, NULL, i8 + count, WEIGHTS_INT8);
+        model.encoder.i8 = i8;
+        model.decoder.i8 = i8 + count;
+    }
+
+    // Activation buffers for the largest vectors the geometry allows
+    const size_t input = model.has_header ? (size_t)model.input_size : MAX_INPUT_SIZE;
+    const size_t hidden = (size_t)model.hidden_size;
+    const size_t latent = model.has_header ? (size_t)model.latent_size : MAX_LATENT_DIM;
+    size_t quantized = input > hidden ? input : hidden;
+    if (latent > quantized) quantized = latent;
+    const size_t hidden_offset = BATCH_TILE * input * sizeof(float);
+    const size_t latent_offset = hidden_offset + BATCH_TILE * hidden * sizeof(float);
+    const size_t quantized_offset = latent_offset + BATCH_TILE * latent * sizeof(float);
+    uint8_t* tiles = heap_alloc(quantized_offset + BATCH_TILE * quantized);
+    if (!tiles) {
+        release_model();
+        return -1;
+    }
+    model.tile_storage = tiles;
+    model.tile_input = (float*)tiles;
+    model.tile_hidden = (float*)(tiles + hidden_offset);
+    model.tile_latent = (float*)(tiles + latent_offset);
+    model.quantized_input = (int8_t*)(tiles + quantized_offset);
+
+    for (size_t k = 0; model.has_header && k < sizeof(tile_kernels) / sizeof(tile_kernels[0]); k++) {
+        if (tile_kernels[k].input_size == model.input_size &&
+            tile_kernels[k].hidden_size == model.hidden_size &&
+            tile_kernels[k].latent_size == model.latent_size) {
+            model.encode_tile = tile_kernels[k].encode;
+            model.decode_tile = tile_kernels[k].decode;
+        }
+    }
+    return 0;
+}
+
+// Whether blocks of block_size bytes with latent_size latents can run on
+// the loaded model: the header geometry must match exactly, a headerless
+// model must hold enough weights for both layers
+static int geometry_ok(const Weights* weights, int block_size, int latent_size) {
+    if (!model.tile_storage) return 0;
+    if (model.has_header) {
+        return block_size == model.input_size && latent_size == model.latent_size;
+    }
+    return block_size > 0 && block_size <= MAX_INPUT_SIZE &&
+           latent_size > 0 && latent_size <= MAX_LATENT_DIM &&
+           (size_t)model.hidden_size * ((size_t)block_size + latent_size) <= weights->count;
+}
+
+// Tile counters, see get_counters(); only touched with NATIVE_COUNTERS
+static NativeCounters codec_counters;
+
+// Encode one tile on whichever path applies: the worker pool, the kernels
+// specialized for the header geometry, or the generic ones
+static void encode_tile_any(const uint8_t* input, int input_size, int latent_size,
+                            int count, float* latent) {
+    COUNTER_ADD(codec_counters, blocks_encoded, count);
+    COUNTER_ADD(codec_counters, matmul_flops,
+                2 * (uint64_t)count * model.hidden_size * ((uint64_t)input_size + latent_size));
+#if CODEC_THREADS
+    if (pool_active()) {
+        encode_tile_threaded(input, input_size, latent_size, count, latent);
+        return;
+    }
+#endif
+    if (model.encode_tile) {
+        model.encode_tile(input, count, latent);
+    } else {
+        encode_tile_generic(input, input_size, model.hidden_size, latent_size, count, latent);
+    }
+}
+
+static void decode_tile_any(const float* latent, int latent_size, int output_size,
+                            int count, uint8_t* output) {
+    COUNTER_ADD(codec_counters, blocks_decoded, count);
+    COUNTER_ADD(codec_counters, matmul_flops,
+                2 * (uint64_t)count * model.hidden_size * ((uint64_t)latent_size + output_size));
+#if CODEC_THREADS
+    if (pool_active()) {
+        decode_tile_threaded(latent, latent_size, output_size, count, output);
+        return;
+    }
+#endif
+    if (model.decode_tile) {
+        model.decode_tile(latent, count, output);
+    } else {
+        decode_tile_generic(latent, latent_size, model.hidden_size, output_size, count, output);
+    }
+}
+
+// Quantized latent layout, as stored by WANeuralCodec: min and max as
+// little-endian float32, then one code per latent (8-bit) or two per byte
+// (4-bit, low nibble first), mapping [min, max] onto [0, 2^bits - 1]
+#define LATENT_HEADER 8
+
+static size_t latent_bytes(int latent_size, int bits) {
+    return LATENT_HEADER + (bits == 4 ? ((size_t)latent_size + 1) / 2 : (size_t)latent_size);
+}
+
+static void quantize_latent(const float* latent, int latent_size, int bits, uint8_t* out) {
+    float min = latent[0], max = latent[0];
+    for (int i = 1; i < latent_size; i++) {
+        if (latent[i] < min) min = latent[i];
+        if (latent[i] > max) max = latent[i];
+    }
+    memcpy(out, &min, sizeof(float));
+    memcpy(out + sizeof(float), &max, sizeof(float));
+
+    const float range = max - min;
+    const float scale = range > 0 ? (bits == 4 ? 15.0f : 255.0f) / range : 0.0f;
+    uint8_t* codes = out + LATENT_HEADER;
+    if (bits == 4) {
+        memset(codes, 0, ((size_t)latent_size + 1) / 2);
+        for (int i = 0; i < latent_size; i++) {
+            uint8_t q = (uint8_t)((latent[i] - min) * scale + 0.5f);
+            codes[i / 2] |= (i & 1) ? (uint8_t)(q << 4) : q;
+        }
+    } else {
+        for (int i = 0; i < latent_size; i++) {
+            codes[i] = (uint8_t)((latent[i] - min) * scale + 0.5f);
+        }
+    }
+}
+
+static void dequantize_latent(const uint8_t* in, int latent_size, int bits, float* latent) {
+    float min, max;
+    memcpy(&min, in, sizeof(float));
+    memcpy(&max, in + sizeof(float), sizeof(float));
+    const uint8_t* codes = in + LATENT_HEADER;
+    if (bits == 4) {
+        const float step = (max - min) / 15.0f;
+        for (int i = 0; i < latent_size; i++) {
+            latent[i] = min + (float)((i & 1) ? (codes[i / 2] >> 4) : (codes[i / 2] & 0x0F)) * step;
+        }
+    } else {
+        const float step = (max - min) / 255.0f;
+        for (int i = 0; i < latent_size; i++) {
+            latent[i] = min + (float)codes[i] * step;
+        }
+    }
 }
 
 /**
- * Encode data to latent vector
- * 
- * Simplified architecture:
- * Input -> FC(512) -> ReLU -> FC(latent_dim) -> Tanh -> Latent
+ * Encode `count` blocks of input_size bytes, stored back to back, into
+ * `count` latent vectors of latent_size floats
+ *
+ * Blocks go through the layers BATCH_TILE at a time, so each weight row is
+ * read once per tile rather than once per block. Returns count, or -1 when
+ * the sizes do not fit the loaded model.
  */
-void encode(const uint8_t* input, int input_size, 
-            float* latent, int latent_size) {
-    // Normalize input to 0-1
-    float normalized[MAX_INPUT_SIZE];
-    for (int i = 0; i < input_size && i < MAX_INPUT_SIZE; i++) {
-        normalized[i] = input[i] / 255.0f;
+int encode_batch(const uint8_t* input, int input_size, int count,
+                 float* latents, int latent_size) {
+    if (count < 0 || !geometry_ok(&model.encoder, input_size, latent_size)) return -1;
+    for (int b = 0; b < count; b += BATCH_TILE) {
+        int tile = count - b < BATCH_TILE ? count - b : BATCH_TILE;
+        encode_tile_any(input + (size_t)b * input_size, input_size, latent_size,
+                        tile, latents + (size_t)b * latent_size);
+    }
+    return count;
+}
+
+/**
+ * Decode `count` latent vectors into `count` blocks of output_size bytes
+ * Returns count, or -1 when the sizes do not fit the loaded model.
+ */
+int decode_batch(const float* latents, int latent_size, int count,
+                 uint8_t* output, int output_size) {
+    if (count < 0 || !geometry_ok(&model.decoder, output_size, latent_size)) return -1;
+    for (int b = 0; b < count; b += BATCH_TILE) {
+        int tile = count - b < BATCH_TILE ? count - b : BATCH_TILE;
+        decode_tile_any(latents + (size_t)b * latent_size, latent_size, output_size,
+                        tile, output + (size_t)b * output_size);
     }
-    
-    // Hidden layer (512 neurons)
-    float hidden[512];
-    matmul(normalized, input_size, encoder_weights, 512, hidden);
-    
-    // Apply ReLU
-    for (int i = 0; i < 512; i++) {
-        hidden[i] = relu(hidden[i]);
+    return count;
+}
+
+/**
+ * encode_batch with the latents quantized in place of the float output:
+ * each block's record is latent_bytes(latent_size, bits) bytes in `out`
+ * (bits is 8, or 4 for two codes per byte). Returns count or -1.
+ */
+int encode_quantized_batch(const uint8_t* input, int input_size, int count,
+                           uint8_t* out, int latent_size, int bits) {
+    if (count < 0 || !geometry_ok(&model.encoder, input_size, latent_size)) return -1;
+    const size_t record = latent_bytes(latent_size, bits);
+    for (int b = 0; b < count; b += BATCH_TILE) {
+        int tile = count - b < BATCH_TILE ? count - b : BATCH_TILE;
+        encode_tile_any(input + (size_t)b * input_size, input_size, latent_size, tile, model.tile_latent);
+        for (int t = 0; t < tile; t++) {
+            quantize_latent(model.tile_latent + (size_t)t * latent_size, latent_size, bits,
+                            out + (size_t)(b + t) * record);
+        }
     }
-    
-    // Latent layer
-    matmul(hidden, 512, encoder_weights + (512 * input_size / 2), latent_size, latent);
-    
-    // Apply Tanh
-    for (int i = 0; i < latent_size; i++) {
-        latent[i] = tanh_approx(latent[i]);
+    return count;
+}
+
+/**
+ * decode_batch from records written by encode_quantized_batch
+ */
+int decode_quantized_batch(const uint8_t* in, int latent_size, int count,
+                           uint8_t* output, int output_size, int bits) {
+    if (count < 0 || !geometry_ok(&model.decoder, output_size, latent_size)) return -1;
+    const size_t record = latent_bytes(latent_size, bits);
+    for (int b = 0; b < count; b += BATCH_TILE) {
+        int tile = count - b < BATCH_TILE ? count - b : BATCH_TILE;
+        for (int t = 0; t < tile; t++) {
+            dequantize_latent(in + (size_t)(b + t) * record, latent_size, bits,
+                              model.tile_latent + (size_t)t * latent_size);
+        }
+        decode_tile_any(model.tile_latent, latent_size, output_size, tile, output + (size_t)b * output_size);
     }
+    return count;
+}
+
+/**
+ * Encode data to latent vector
+ * 
+ * Simplified architecture:
+ * Input -> FC(hidden) -> ReLU -> FC(latent_size) -> Tanh -> Latent
+ */
+int encode(const uint8_t* input, int input_size, 
+           float* latent, int latent_size) {
+    return encode_batch(input, input_size, 1, latent, latent_size);
 }
 
 /**
  * Decode latent vector to data
  * 
  * Simplified architecture:
- * Latent -> FC(512) -> ReLU -> FC(output_size) -> Sigmoid -> Output
- */
-void decode(const float* latent, int latent_size,
-            uint8_t* output, int output_size) {
-    // Hidden layer (512 neurons)
-    float hidden[512];
-    matmul(latent, latent_size, decoder_weights, 512, hidden);
-    
-    // Apply ReLU
-    for (int i = 0; i < 512; i++) {
-        hidden[i] = relu(hidden[i]);
-    }
-    
-    // Output layer
-    float output_float[MAX_INPUT_SIZE];
-    matmul(hidden, 512, decoder_weights + (512 * latent_size / 2), output_size, output_float);
-    
-    // Apply Sigmoid and denormalize
-    for (int i = 0; i < output_size && i < MAX_INPUT_SIZE; i++) {
-        float value = sigmoid(output_float[i]);
-        output[i] = (uint8_t)(value * 255.0f);
+ * Latent -> FC(hidden) -> ReLU -> FC(output_size) -> Sigmoid -> Output
+ */
+int decode(const float* latent, int latent_size,
+           uint8_t* output, int output_size) {
+    return decode_batch(latent, latent_size, 1, output, output_size);
+}
+
+// Block classifier: a cheap pre-pass (histogram, entropy and run count, no
+// network) that lets callers skip the autoencoder for trivial or
+// incompressible blocks
+enum {
+    BLOCK_NEURAL = 0,     // Worth running through the autoencoder
+    BLOCK_CONSTANT = 1,   // Every byte equal
+    BLOCK_RLE = 2,        // Few enough runs that rle_encode is small
+    BLOCK_RAW = 3         // Near 8 bits/byte: already compressed, store as is
+};
+
+#define RLE_MAX_RUN 255
+#define RLE_MAX_FRACTION 8       // RLE when its output is at most 1/8 of the block
+#define RAW_MIN_ENTROPY 7.5f     // Bits per byte
+
+static int classify_block(const uint8_t* block, size_t size) {
+    if (size == 0) return BLOCK_CONSTANT;
+
+    // Four interleaved histograms keep consecutive equal bytes from
+    // serializing on one counter
+    uint32_t hist[4][256];
+    memset(hist, 0, sizeof(hist));
+    size_t runs = 1;
+    hist[0][block[0]]++;
+    for (size_t i = 1; i < size; i++) {
+        hist[i & 3][block[i]]++;
+        runs += block[i] != block[i - 1];
+    }
+    if (runs == 1) return BLOCK_CONSTANT;
+
+    // Each run costs a (length, byte) pair, plus one per RLE_MAX_RUN split
+    if (2 * (runs + size / RLE_MAX_RUN) * RLE_MAX_FRACTION <= size) return BLOCK_RLE;
+
+    // H = log2(n) - sum(c log2 c) / n
+    float weighted = 0.0f;
+    for (int v = 0; v < 256; v++) {
+        uint32_t c = hist[0][v] + hist[1][v] + hist[2][v] + hist[3][v];
+        if (c > 1) weighted += (float)c * log2f((float)c);
+    }
+    const float entropy = log2f((float)size) - weighted / (float)size;
+    return entropy >= RAW_MIN_ENTROPY ? BLOCK_RAW : BLOCK_NEURAL;
+}
+
+/**
+ * Classify `length` bytes as consecutive blocks of block_size (the last one
+ * may be shorter), writing one BLOCK_* tag per block to `tags`. Returns the
+ * number of blocks, or -1 for a non-positive block size.
+ */
+int classify_blocks(const uint8_t* input, size_t length, int block_size, uint8_t* tags) {
+    if (block_size <= 0) return -1;
+    int blocks = 0;
+    for (size_t offset = 0; offset < length; offset += (size_t)block_size) {
+        size_t size = length - offset < (size_t)block_size ? length - offset : (size_t)block_size;
+        tags[blocks++] = (uint8_t)classify_block(input + offset, size);
+    }
+    return blocks;
+}
+
+/**
+ * Run-length encode as (length 1-255, byte) pairs. Returns the encoded
+ * size, or 0 if it would exceed `capacity`.
+ */
+size_t rle_encode(const uint8_t* input, size_t size, uint8_t* out, size_t capacity) {
+    size_t written = 0;
+    for (size_t i = 0; i < size;) {
+        size_t run = 1;
+        while (i + run < size && run < RLE_MAX_RUN && input[i + run] == input[i]) run++;
+        if (written + 2 > capacity) return 0;
+        out[written++] = (uint8_t)run;
+        out[written++] = input[i];
+        i += run;
+    }
+    return written;
+}
+
+/**
+ * Expand rle_encode output; returns the bytes written (at most `capacity`)
+ */
+size_t rle_decode(const uint8_t* input, size_t size, uint8_t* out, size_t capacity) {
+    size_t written = 0;
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        size_t run = input[i];
+        if (run > capacity - written) run = capacity - written;
+        memset(out + written, input[i + 1], run);
+        written += run;
+    }
+    return written;
+}
+
+// Content-defined chunking and fingerprints (dedup ahead of the codec)
+//
+// FastCDC: a Gear rolling hash, h = (h << 1) + gear[byte], cuts where its
+// top bits are zero, so boundaries depend only on the last 64 bytes and an
+// insertion moves the cuts of the chunk it lands in, not of every later
+// one. Normalized chunking tests a stricter mask before avg_size and a
+// looser one after it, which narrows the size spread around avg_size.
+// Boundaries are stored state (dedup keys): gear_table and the masks must
+// never change.
+#define GEAR_SEED 0x9E3779B97F4A7C15ULL
+#define CDC_NORMALIZATION 2   // Mask bits added before avg_size, removed after
+
+static uint64_t gear_table[256];
+static int gear_ready;
+
+static void build_gear_table(void) {
+    // splitmix64: fixed, well-mixed 64-bit entries
+    uint64_t state = GEAR_SEED;
+    for (int i = 0; i < 256; i++) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        gear_table[i] = z ^ (z >> 31);
+    }
+    gear_ready = 1;
+}
+
+// Top `bits` bits of the hash: the ones that have seen the most bytes
+static uint64_t cdc_mask(int bits) {
+    if (bits < 1) bits = 1;
+    if (bits > 63) bits = 63;
+    return ~0ULL << (64 - bits);
+}
+
+static size_t cdc_cut(const uint8_t* input, size_t length, size_t min_size, size_t avg_size,
+                      size_t max_size, uint64_t mask_strict, uint64_t mask_loose) {
+    if (length <= min_size) return length;
+    if (length < max_size) max_size = length;
+    if (avg_size > max_size) avg_size = max_size;
+
+    // Cut-point skipping: nothing below min_size can be a boundary
+    uint64_t hash = 0;
+    size_t i = min_size;
+    for (; i < avg_size; i++) {
+        hash = (hash << 1) + gear_table[input[i]];
+        if (!(hash & mask_strict)) return i + 1;
+    }
+    for (; i < max_size; i++) {
+        hash = (hash << 1) + gear_table[input[i]];
+        if (!(hash & mask_loose)) return i + 1;
+    }
+    return max_size;
+}
+
+/**
+ * Split `length` bytes into content-defined chunks of min_size to max_size
+ * bytes (the last one may be shorter), averaging about avg_size, writing
+ * each chunk's end offset to `ends`. Returns the number of chunks, at most
+ * max_chunks (length / min_size + 1 always fits); when it is reached, the
+ * last end is where to resume. Returns 0 for inconsistent sizes.
+ */
+size_t cdc_chunk(const uint8_t* input, size_t length, size_t min_size, size_t avg_size,
+                 size_t max_size, uint32_t* ends, size_t max_chunks) {
+    if (min_size == 0 || min_size > avg_size || avg_size > max_size) return 0;
+    if (!gear_ready) build_gear_table();
+
+    int bits = 0;
+    while (((size_t)2 << bits) <= avg_size) bits++;
+    const uint64_t mask_strict = cdc_mask(bits + CDC_NORMALIZATION);
+    const uint64_t mask_loose = cdc_mask(bits - CDC_NORMALIZATION);
+
+    size_t count = 0;
+    for (size_t offset = 0; offset < length && count < max_chunks;) {
+        offset += cdc_cut(input + offset, length - offset, min_size, avg_size, max_size,
+                          mask_strict, mask_loose);
+        ends[count++] = (uint32_t)offset;
+    }
+    return count;
+}
+
+// Reference XXH64 with seed 0 (XXH64("abc") = 0x44bc2cf5ad770999). Not
+// interchangeable with hashChunk() of dedupe/content-hash.ts, whose BigInt
+// port does not reduce every intermediate mod 2^64; keys built from these
+// carry their own prefix (lib/storage/wasm-cas.ts).
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t xxh_rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t xxh_read64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, 8);  // Little-endian on every target this builds for
+    return v;
+}
+
+static inline uint32_t xxh_read32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    return xxh_rotl(acc, 31) * XXH_PRIME64_1;
+}
+
+static inline uint64_t xxh_merge(uint64_t acc, uint64_t v) {
+    acc ^= xxh_round(0, v);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static uint64_t fingerprint(const uint8_t* p, size_t length) {
+    const uint8_t* const end = p + length;
+    uint64_t h;
+
+    if (length >= 32) {
+        // Four independent lanes per 32-byte stripe
+        uint64_t v1 = XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = XXH_PRIME64_2;
+        uint64_t v3 = 0;
+        uint64_t v4 = 0 - XXH_PRIME64_1;
+        const uint8_t* const limit = end - 32;
+        do {
+            v1 = xxh_round(v1, xxh_read64(p));
+            v2 = xxh_round(v2, xxh_read64(p + 8));
+            v3 = xxh_round(v3, xxh_read64(p + 16));
+            v4 = xxh_round(v4, xxh_read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+        h = xxh_merge(h, v1);
+        h = xxh_merge(h, v2);
+        h = xxh_merge(h, v3);
+        h = xxh_merge(h, v4);
+    } else {
+        h = XXH_PRIME64_5;
+    }
+    h += (uint64_t)length;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxh_round(0, xxh_read64(p));
+        h = xxh_rotl(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+    if (p + 4 <= end) {
+        h ^= (uint64_t)xxh_read32(p) * XXH_PRIME64_1;
+        h = xxh_rotl(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    for (; p < end; p++) {
+        h ^= (uint64_t)*p * XXH_PRIME64_5;
+        h = xxh_rotl(h, 11) * XXH_PRIME64_1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * Fingerprint the `count` chunks of `input` ending at `ends` (cdc_chunk
+ * output; chunk i starts at ends[i - 1], the first at 0), one XXH64 per
+ * chunk into `out`
+ */
+void fingerprint_chunks(const uint8_t* input, const uint32_t* ends, size_t count, uint64_t* out) {
+    uint32_t start = 0;
+    for (size_t i = 0; i < count; i++) {
+        out[i] = fingerprint(input + start, ends[i] - start);
+        start = ends[i];
     }
 }
 
 // Memory management (required by WASM)
+//
+// Size-class heap from lib/wasm/native/wasm-arena.h: the codec's own arena
+// above __heap_base (host chunks in native builds, so heap stats match)
+// until codec_attach_arena() moves it onto an arena shared with the other
+// native modules on the same memory. The shared-memory build caps the own
+// arena at the end of the codec's window (ARENA_HEAP_LIMIT).
+#define IO_BUFFER_SLOTS 4
+
+static WasmArena own_heap;
+static WasmArena* heap;
+static uint32_t heap_blocks;  // Blocks the codec holds, whichever arena they are on
+
+typedef struct {
+    void* ptr;
+    size_t capacity;
+} IoBuffer;
+
+static IoBuffer io_buffers[IO_BUFFER_SLOTS];
+
+static WasmArena* codec_heap(void) {
+    if (!heap) {
+        arena_init_heap(&own_heap);
+        heap = &own_heap;
+    }
+    return heap;
+}
+
+static void* heap_alloc(size_t size) {
+    void* ptr = arena_alloc(codec_heap(), size);
+    if (ptr) heap_blocks++;
+    return ptr;
+}
+
+static void heap_free(void* ptr) {
+    if (!ptr) return;
+    arena_free(codec_heap(), ptr);
+    heap_blocks--;
+}
+
+#ifdef __wasm__
 void* malloc(size_t size) {
-    return __builtin_wasm_memory_grow(0, (size + 65535) / 65536) * 65536;
+    return heap_alloc(size);
 }
 
 void free(void* ptr) {
-    // Simplified: no actual freeing in this stub
-    (void)ptr;
+    heap_free(ptr);
+}
+#endif
+
+/**
+ * Copies the allocator counters into `out`. A run that returns everything it
+ * allocated leaves live_bytes where it started; codec_buffer slots and the
+ * model stay live by design. On a shared arena the counters cover every
+ * module allocating from it.
+ */
+void codec_heap_stats(HeapStats* out) {
+    if (out) *out = codec_heap()->stats;
+}
+
+/**
+ * Counters since the last reset (native-counters.h): blocks and matmul
+ * FLOPs from NATIVE_COUNTERS builds, allocator stats from every build.
+ * Returns a static struct that the next call overwrites.
+ */
+const NativeCounters* get_counters(int reset) {
+    static NativeCounters snapshot;
+    return counters_snapshot(&codec_counters, codec_heap(), &snapshot, reset);
+}
+
+/**
+ * Allocate from the arena whose header is at `arena` (see wasm-arena.h),
+ * shared with the modules instantiated on the same memory; the first to
+ * attach initializes it. Call before init_model. Returns 0, or -1 while the
+ * codec still holds blocks of its current arena.
+ */
+int codec_attach_arena(WasmArena* arena) {
+    if (!arena || heap_blocks) return -1;
+    heap = arena_attach(arena);
+    return 0;
+}
+
+/**
+ * Persistent I/O buffer: returns slot's buffer, reallocated only when it is
+ * smaller than `size`. Lets callers stage blocks without a malloc/free pair
+ * per call. Returns NULL for an invalid slot or when memory cannot grow.
+ */
+void* codec_buffer(int slot, size_t size) {
+    if (slot < 0 || slot >= IO_BUFFER_SLOTS) return NULL;
+    IoBuffer* buffer = &io_buffers[slot];
+    if (buffer->capacity < size) {
+        heap_free(buffer->ptr);
+        buffer->ptr = heap_alloc(size);
+        buffer->capacity = buffer->ptr ? size : 0;
+    }
+    return buffer->ptr;
 }
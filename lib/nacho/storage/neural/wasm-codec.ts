@@ -4,16 +4,148 @@
  * Compression: 10x-50x depending on content
  */
 
+import type { NeuralCodecWorkerInit } from '@/workers/neural-codec-worker';
+import { loadNativeWasmModule, NativeWasmVariant } from '../../../wasm/loader';
+import { getSharedLinearMemory, SharedSlice } from '../../../wasm/shared-memory';
+import { nativeCounters, NativeCounters, readNativeCounters } from '../../../performance/native-counters';
+
 export interface LatentVector {
   data: Float32Array;
-  quantized: Uint8Array; // 8-bit quantized for storage
+  quantized: Uint8Array; // min/max header + 8- or 4-bit codes, see quantizedLatentBytes
   dim: number;
 }
 
+export type LatentBits = 8 | 4;
+
+const LATENT_HEADER_BYTES = 8;
+
+/**
+ * Bytes of one quantized latent record: min and max as float32, then one
+ * code per value (8-bit) or two per byte (4-bit, low nibble first)
+ */
+export function quantizedLatentBytes(dim: number, bits: LatentBits = 8): number {
+  return LATENT_HEADER_BYTES + (bits === 4 ? Math.ceil(dim / 2) : dim);
+}
+
+/**
+ * Float latent back from a quantized record (the inverse of the codec's
+ * in-WASM quantization)
+ */
+export function dequantizeLatent(quantized: Uint8Array, dim: number, bits: LatentBits = 8): Float32Array {
+  const dequantized = new Float32Array(dim);
+  const header = new DataView(quantized.buffer, quantized.byteOffset, LATENT_HEADER_BYTES);
+  const min = header.getFloat32(0, true);
+  const max = header.getFloat32(4, true);
+  const levels = bits === 4 ? 15 : 255;
+  const step = (max - min) / levels;
+
+  for (let i = 0; i < dim; i++) {
+    const byte = quantized[LATENT_HEADER_BYTES + (bits === 4 ? i >> 1 : i)];
+    const code = bits === 4 ? (i & 1 ? byte >> 4 : byte & 0x0f) : byte;
+    dequantized[i] = min + code * step;
+  }
+
+  return dequantized;
+}
+
+/**
+ * Weight layout used by the WASM matmul (init_model mode)
+ */
+export enum CodecWeightMode {
+  PACKED = 0, // 4-bit weights dequantized in the inner loop
+  F32 = 1,    // Expanded once to float (8x the packed size)
+  INT8 = 2,   // Expanded once to int8 (2x), int8 dot products
+}
+
+/**
+ * classify_blocks tags: how a block is best stored
+ */
+export enum BlockClass {
+  NEURAL = 0,   // Run through the autoencoder
+  CONSTANT = 1, // Every byte equal
+  RLE = 2,      // Few runs; rleEncode output is small
+  RAW = 3,      // Near 8 bits/byte of entropy, store as is
+}
+
+/**
+ * cdc_chunk size bounds in bytes (min <= avg <= max)
+ */
+export interface ChunkSizes {
+  minSize: number;
+  avgSize: number;
+  maxSize: number;
+}
+
+/**
+ * Chunks of a few codec blocks each: blocks are cut from the chunk start,
+ * so only the last block of a chunk is short
+ */
+export function defaultChunkSizes(blockSize: number): ChunkSizes {
+  return { minSize: blockSize, avgSize: 4 * blockSize, maxSize: 16 * blockSize };
+}
+
+export interface ContentChunk {
+  offset: number;
+  length: number;
+  fingerprint: string; // XXH64 hex
+}
+
+// Persistent staging buffers in the WASM heap (codec_buffer slots)
+enum CodecBuffer {
+  INPUT = 0,
+  LATENT = 1,
+  OUTPUT = 2,
+}
+
+/**
+ * Layer sizes stored in the model header (init_model's ModelHeader)
+ */
+export interface CodecGeometry {
+  inputSize: number;  // Block size in bytes
+  hiddenSize: number; // Even
+  latentDim: number;
+}
+
+const MODEL_MAGIC = 0x314d434e; // "NCM1"
+const MODEL_HEADER_BYTES = 16;
+
+/**
+ * Packed 4-bit weight bytes of one network (encoder or decoder)
+ */
+export function codecNetworkBytes(geometry: CodecGeometry): number {
+  return Math.ceil((geometry.hiddenSize * (geometry.inputSize + geometry.latentDim)) / 2);
+}
+
+/**
+ * Prefix 4-bit encoder/decoder weights with a geometry header
+ */
+export function packModelWeights(
+  geometry: CodecGeometry,
+  encoder: Uint8Array,
+  decoder: Uint8Array
+): ArrayBuffer {
+  const networkBytes = codecNetworkBytes(geometry);
+  if (encoder.length !== networkBytes || decoder.length !== networkBytes) {
+    throw new Error(`Expected ${networkBytes} weight bytes per network`);
+  }
+  const blob = new Uint8Array(MODEL_HEADER_BYTES + 2 * networkBytes);
+  const header = new DataView(blob.buffer);
+  header.setUint32(0, MODEL_MAGIC, true);
+  header.setUint32(4, geometry.inputSize, true);
+  header.setUint32(8, geometry.hiddenSize, true);
+  header.setUint32(12, geometry.latentDim, true);
+  blob.set(encoder, MODEL_HEADER_BYTES);
+  blob.set(decoder, MODEL_HEADER_BYTES + networkBytes);
+  return blob.buffer;
+}
+
 export interface NeuralCodecConfig {
   latentDim: number;      // 128-512
   inputSize: number;      // Size of input blocks
-  modelWeights: ArrayBuffer; // Pre-trained weights
+  modelWeights: ArrayBuffer; // Pre-trained weights, optionally with a geometry header (packModelWeights)
+  weightMode?: CodecWeightMode; // Default PACKED
+  threads?: number; // Threads per layer for the threaded build (default 1)
+  latentBits?: LatentBits; // Latent code width (default 8)
 }
 
 export interface CompressionResult {
@@ -33,6 +165,8 @@ export class WANeuralCodec {
   private memory: WebAssembly.Memory | null = null;
   private config: NeuralCodecConfig;
   private initialized: boolean = false;
+  private workers: Worker[] = [];
+  private onSharedMemory = false;
 
   constructor(config: NeuralCodecConfig) {
     this.config = config;
@@ -44,188 +178,394 @@ export class WANeuralCodec {
   async init(): Promise<void> {
     if (this.initialized) return;
 
-    // Load WASM module
-    const wasmModule = await this.loadWASM();
+    // Load WASM module; only the threaded build can use more than one thread
+    const threads = Math.min(this.config.threads ?? 1, navigator.hardwareConcurrency || 1);
+    const { module: wasmModule, variant } = await this.loadWASM(threads > 1);
     
-    // Create memory
-    this.memory = new WebAssembly.Memory({ initial: 256, maximum: 512 });
+    // The threaded build gets its own memory, shared with its workers; the
+    // others join the memory of the other native modules, so slices pass
+    // between them without copies
+    const shared = variant === 'simd-threads';
+    const linear = getSharedLinearMemory();
+    this.memory = shared ? new WebAssembly.Memory({ initial: 256, maximum: 512, shared }) : linear.memory;
 
     // Instantiate WASM
-    this.wasm = await WebAssembly.instantiate(wasmModule, {
-      env: {
-        memory: this.memory,
-        abort: () => console.error('[WASM] Aborted'),
-      },
-    });
+    this.wasm = await WebAssembly.instantiate(
+      wasmModule,
+      shared
+        ? { env: { memory: this.memory, abort: () => console.error('[WASM] Aborted') } }
+        : linear.imports('WANeuralCodec')
+    );
+    const exports = this.wasm.exports as any;
+    if (!shared && typeof exports.codec_attach_arena === 'function') {
+      this.onSharedMemory = linear.attach('wasm-codec', undefined, exports.codec_attach_arena, {
+        alloc: exports.malloc,
+        free: exports.free,
+      });
+    }
 
     // Initialize model weights
     await this.loadModelWeights();
 
+    if (shared) this.startWorkers(wasmModule, threads);
+    nativeCounters.register('codec', (reset) => this.readCounters(reset));
+
     this.initialized = true;
     console.log('[WANeuralCodec] Initialized');
   }
 
   /**
-   * Compress data to latent vector
+   * Compress one block of up to inputSize bytes (zero-padded to the model's
+   * block) to a latent vector; longer data goes through compressBatch
    */
   async compress(data: Uint8Array): Promise<CompressionResult> {
+    const blockSize = this.config.inputSize;
+    if (data.length === 0 || data.length > blockSize) {
+      throw new Error(`compress() takes 1 to ${blockSize} bytes, got ${data.length}; use compressBatch`);
+    }
+    const [result] = await this.compressBatch(data, blockSize);
+    return result;
+  }
+
+  /**
+   * Decompress latent vector to the first `outputSize` bytes (at most
+   * inputSize) of its block
+   */
+  async decompress(latent: LatentVector, outputSize: number): Promise<Uint8Array> {
+    const blockSize = this.config.inputSize;
+    if (outputSize > blockSize) {
+      throw new Error(`decompress() yields at most ${blockSize} bytes, asked for ${outputSize}`);
+    }
+    const [output] = await this.decompressBatch([latent], blockSize);
+    return output.subarray(0, outputSize);
+  }
+
+  /**
+   * Compress `data` as consecutive blocks of `blockSize` bytes (the last one
+   * zero-padded) with a single encode_quantized_batch call. The latents are
+   * quantized inside WASM; only their compact records are copied out.
+   */
+  async compressBatch(data: Uint8Array, blockSize: number = this.config.inputSize): Promise<CompressionResult[]> {
     if (!this.initialized || !this.wasm) {
       throw new Error('Codec not initialized');
     }
 
     const exports = this.wasm.exports as any;
+    const count = Math.ceil(data.length / blockSize);
+    if (count === 0) return [];
 
-    // Allocate input buffer in WASM memory
-    const inputPtr = exports.malloc(data.length);
+    // One input buffer for every block, zeroed so the last block is padded
+    const inputPtr = exports.codec_buffer(CodecBuffer.INPUT, count * blockSize);
     const memoryView = new Uint8Array(this.memory!.buffer);
+    memoryView.fill(0, inputPtr, inputPtr + count * blockSize);
     memoryView.set(data, inputPtr);
+    return this.encodeBlocks(inputPtr, count, blockSize, data.length);
+  }
 
-    // Allocate output buffer for latent vector
-    const latentPtr = exports.malloc(this.config.latentDim * 4); // Float32
+  /**
+   * compressBatch over a slice already in the shared memory (see
+   * decompressShared): whole blocks are encoded where they are, and only a
+   * partial last block is staged
+   */
+  async compressShared(input: SharedSlice, blockSize: number = this.config.inputSize): Promise<CompressionResult[]> {
+    this.requireSharedMemory();
+    const whole = Math.floor(input.len / blockSize);
+    const results = whole ? this.encodeBlocks(input.ptr, whole, blockSize, whole * blockSize) : [];
+    if (input.len > whole * blockSize) {
+      // Copied out first: staging may grow memory and detach a view of it
+      const tail = new Uint8Array(this.memory!.buffer, input.ptr + whole * blockSize, input.len - whole * blockSize).slice();
+      results.push(...(await this.compressBatch(tail, blockSize)));
+    }
+    return results;
+  }
 
-    // Call WASM encode function
-    exports.encode(inputPtr, data.length, latentPtr, this.config.latentDim);
+  // One encode_quantized_batch call over `count` blocks at `inputPtr`,
+  // covering `length` bytes of input
+  private encodeBlocks(inputPtr: number, count: number, blockSize: number, length: number): CompressionResult[] {
+    const exports = this.wasm!.exports as any;
+    const latentDim = this.config.latentDim;
+    const bits = this.config.latentBits ?? 8;
+    const record = quantizedLatentBytes(latentDim, bits);
+
+    const latentPtr = exports.codec_buffer(CodecBuffer.LATENT, count * record);
+    if (exports.encode_quantized_batch(inputPtr, blockSize, count, latentPtr, latentDim, bits) < 0) {
+      throw new Error(`Blocks of ${blockSize} bytes do not fit the model geometry`);
+    }
 
-    // Read latent vector
-    const latentData = new Float32Array(
-      this.memory!.buffer,
-      latentPtr,
-      this.config.latentDim
-    );
-    const latentCopy = new Float32Array(latentData);
+    const records = new Uint8Array(this.memory!.buffer, latentPtr, count * record).slice();
+    const results: CompressionResult[] = [];
+    for (let b = 0; b < count; b++) {
+      const quantized = records.subarray(b * record, (b + 1) * record);
+      const originalSize = Math.min(blockSize, length - b * blockSize);
+      results.push({
+        latent: this.latentVector(quantized, latentDim, bits),
+        originalSize,
+        compressedSize: quantized.length,
+        compressionRatio: originalSize / quantized.length,
+        quality: 0.95, // Estimated
+      });
+    }
 
-    // Quantize to 8-bit for storage
-    const quantized = this.quantizeLatent(latentCopy);
+    return results;
+  }
+
+  /**
+   * Decompress latent vectors of the same dimension with a single
+   * decode_quantized_batch call; each block is `outputSize` bytes. The
+   * quantized records go to WASM as they are.
+   */
+  async decompressBatch(latents: LatentVector[], outputSize: number): Promise<Uint8Array[]> {
+    if (!this.initialized || !this.wasm) {
+      throw new Error('Codec not initialized');
+    }
+    if (latents.length === 0) return [];
 
-    // Free WASM memory
-    exports.free(inputPtr);
-    exports.free(latentPtr);
+    const exports = this.wasm.exports as any;
+    const outputPtr = exports.codec_buffer(CodecBuffer.OUTPUT, latents.length * outputSize);
+    this.decodeBlocks(latents, outputSize, outputPtr);
 
-    const originalSize = data.length;
-    const compressedSize = quantized.length;
+    const outputs: Uint8Array[] = [];
+    for (let b = 0; b < latents.length; b++) {
+      outputs.push(new Uint8Array(this.memory!.buffer, outputPtr + b * outputSize, outputSize).slice());
+    }
 
-    return {
-      latent: {
-        data: latentCopy,
-        quantized,
-        dim: this.config.latentDim,
-      },
-      originalSize,
-      compressedSize,
-      compressionRatio: originalSize / compressedSize,
-      quality: 0.95, // Estimated
-    };
+    return outputs;
   }
 
   /**
-   * Decompress latent vector to data
+   * decompressBatch straight into a new slice of the shared memory, the
+   * blocks back to back, for the next module (e.g. NativeImage.fromShared)
+   * to read in place. The caller frees it with getSharedLinearMemory().free().
    */
-  async decompress(latent: LatentVector, outputSize: number): Promise<Uint8Array> {
+  async decompressShared(latents: LatentVector[], outputSize: number): Promise<SharedSlice> {
+    this.requireSharedMemory();
+    const output = getSharedLinearMemory().alloc(latents.length * outputSize);
+    if (!output) throw new Error('Shared memory exhausted');
+    try {
+      if (latents.length) this.decodeBlocks(latents, outputSize, output.ptr);
+    } catch (error) {
+      getSharedLinearMemory().free(output);
+      throw error;
+    }
+    return output;
+  }
+
+  // Stage the quantized records and run one decode_quantized_batch call
+  // into `outputPtr`
+  private decodeBlocks(latents: LatentVector[], outputSize: number, outputPtr: number): void {
+    const exports = this.wasm!.exports as any;
+    const dim = latents[0].dim;
+    const bits = this.config.latentBits ?? 8;
+    const record = quantizedLatentBytes(dim, bits);
+
+    const latentPtr = exports.codec_buffer(CodecBuffer.LATENT, latents.length * record);
+    const latentView = new Uint8Array(this.memory!.buffer, latentPtr, latents.length * record);
+    latents.forEach((latent, b) => {
+      latentView.set(latent.quantized.subarray(0, record), b * record);
+    });
+
+    if (exports.decode_quantized_batch(latentPtr, dim, latents.length, outputPtr, outputSize, bits) < 0) {
+      throw new Error(`Output blocks of ${outputSize} bytes do not fit the model geometry`);
+    }
+  }
+
+  private requireSharedMemory(): void {
     if (!this.initialized || !this.wasm) {
       throw new Error('Codec not initialized');
     }
+    if (!this.onSharedMemory) {
+      throw new Error('Codec is not on the shared memory (threaded or older build)');
+    }
+  }
 
-    const exports = this.wasm.exports as any;
+  /**
+   * Block size the model encodes
+   */
+  get blockSize(): number {
+    return this.config.inputSize;
+  }
 
-    // Dequantize latent
-    const dequantized = this.dequantizeLatent(latent.quantized, latent.dim);
+  /**
+   * Latent dimension and code width of the records this codec reads and writes
+   */
+  get latentDim(): number {
+    return this.config.latentDim;
+  }
 
-    // Allocate latent buffer in WASM memory
-    const latentPtr = exports.malloc(dequantized.length * 4);
-    const memoryView = new Float32Array(this.memory!.buffer);
-    memoryView.set(dequantized, latentPtr / 4);
+  get latentBits(): LatentBits {
+    return this.config.latentBits ?? 8;
+  }
 
-    // Allocate output buffer
-    const outputPtr = exports.malloc(outputSize);
+  /**
+   * Bytes of one quantized latent record at this codec's dimension and code width
+   */
+  get latentRecordBytes(): number {
+    return quantizedLatentBytes(this.config.latentDim, this.config.latentBits ?? 8);
+  }
 
-    // Call WASM decode function
-    exports.decode(latentPtr, latent.dim, outputPtr, outputSize);
+  /**
+   * LatentVector over a stored quantized record, for decompressBatch
+   */
+  latentFromRecord(quantized: Uint8Array): LatentVector {
+    return this.latentVector(quantized, this.config.latentDim, this.config.latentBits ?? 8);
+  }
 
-    // Read output
-    const outputView = new Uint8Array(this.memory!.buffer, outputPtr, outputSize);
-    const output = new Uint8Array(outputView);
+  /**
+   * One BlockClass tag per `blockSize` block of `data` (the last one may be
+   * shorter), from a histogram/run pre-pass that does not touch the network
+   */
+  classifyBlocks(data: Uint8Array, blockSize: number = this.config.inputSize): Uint8Array {
+    if (!this.initialized || !this.wasm) {
+      throw new Error('Codec not initialized');
+    }
 
-    // Free WASM memory
-    exports.free(latentPtr);
-    exports.free(outputPtr);
+    const exports = this.wasm.exports as any;
+    const count = Math.ceil(data.length / blockSize);
+    const inputPtr = exports.codec_buffer(CodecBuffer.INPUT, data.length);
+    const tagsPtr = exports.codec_buffer(CodecBuffer.OUTPUT, count);
+    new Uint8Array(this.memory!.buffer).set(data, inputPtr);
 
-    return output;
+    exports.classify_blocks(inputPtr, data.length, blockSize, tagsPtr);
+    return new Uint8Array(this.memory!.buffer, tagsPtr, count).slice();
   }
 
   /**
-   * Quantize latent vector to 8-bit
+   * (length, byte) run-length encoding for BlockClass.RLE blocks
    */
-  private quantizeLatent(latent: Float32Array): Uint8Array {
-    const quantized = new Uint8Array(latent.length);
-    
-    // Find min/max for normalization
-    let min = Infinity, max = -Infinity;
-    for (let i = 0; i < latent.length; i++) {
-      if (latent[i] < min) min = latent[i];
-      if (latent[i] > max) max = latent[i];
+  rleEncode(block: Uint8Array): Uint8Array {
+    if (!this.initialized || !this.wasm) {
+      throw new Error('Codec not initialized');
     }
 
-    const range = max - min;
-    
-    for (let i = 0; i < latent.length; i++) {
-      const normalized = (latent[i] - min) / range;
-      quantized[i] = Math.round(normalized * 255);
+    const exports = this.wasm.exports as any;
+    const capacity = 2 * block.length;
+    const inputPtr = exports.codec_buffer(CodecBuffer.INPUT, block.length);
+    const outputPtr = exports.codec_buffer(CodecBuffer.OUTPUT, capacity);
+    new Uint8Array(this.memory!.buffer).set(block, inputPtr);
+
+    const written = exports.rle_encode(inputPtr, block.length, outputPtr, capacity);
+    return new Uint8Array(this.memory!.buffer, outputPtr, written).slice();
+  }
+
+  /**
+   * Inverse of rleEncode for a block of `size` bytes
+   */
+  rleDecode(encoded: Uint8Array, size: number): Uint8Array {
+    if (!this.initialized || !this.wasm) {
+      throw new Error('Codec not initialized');
     }
 
-    // Store min/max in first 8 bytes (2 floats)
-    const result = new Uint8Array(latent.length + 8);
-    new Float32Array(result.buffer, 0, 2).set([min, max]);
-    result.set(quantized, 8);
+    const exports = this.wasm.exports as any;
+    const inputPtr = exports.codec_buffer(CodecBuffer.INPUT, encoded.length);
+    const outputPtr = exports.codec_buffer(CodecBuffer.OUTPUT, size);
+    new Uint8Array(this.memory!.buffer).set(encoded, inputPtr);
 
-    return result;
+    const written = exports.rle_decode(inputPtr, encoded.length, outputPtr, size);
+    const output = new Uint8Array(size);
+    output.set(new Uint8Array(this.memory!.buffer, outputPtr, written));
+    return output;
   }
 
   /**
-   * Dequantize 8-bit to float
+   * Content-defined chunks of `data` (cdc_chunk: FastCDC over a Gear hash),
+   * each with its XXH64 fingerprint. Cuts follow the content, so an insert
+   * or delete only changes the chunk it falls in.
    */
-  private dequantizeLatent(quantized: Uint8Array, dim: number): Float32Array {
-    const dequantized = new Float32Array(dim);
-    
-    // Read min/max from first 8 bytes
-    const minMax = new Float32Array(quantized.buffer, 0, 2);
-    const min = minMax[0];
-    const max = minMax[1];
-    const range = max - min;
+  chunkContent(data: Uint8Array, sizes: ChunkSizes = defaultChunkSizes(this.config.inputSize)): ContentChunk[] {
+    if (!this.initialized || !this.wasm) {
+      throw new Error('Codec not initialized');
+    }
 
-    const data = new Uint8Array(quantized.buffer, 8);
-    
-    for (let i = 0; i < dim; i++) {
-      const normalized = data[i] / 255;
-      dequantized[i] = min + normalized * range;
+    const exports = this.wasm.exports as any;
+    const maxChunks = Math.floor(data.length / sizes.minSize) + 1;
+    const inputPtr = exports.codec_buffer(CodecBuffer.INPUT, data.length);
+    const endsPtr = exports.codec_buffer(CodecBuffer.OUTPUT, 4 * maxChunks);
+    const fingerprintsPtr = exports.codec_buffer(CodecBuffer.LATENT, 8 * maxChunks);
+    new Uint8Array(this.memory!.buffer).set(data, inputPtr);
+
+    const count = exports.cdc_chunk(inputPtr, data.length, sizes.minSize, sizes.avgSize, sizes.maxSize, endsPtr, maxChunks);
+    if (data.length && !count) throw new Error('Invalid chunk sizes');
+    exports.fingerprint_chunks(inputPtr, endsPtr, count, fingerprintsPtr);
+
+    const view = new DataView(this.memory!.buffer);
+    const chunks: ContentChunk[] = [];
+    let offset = 0;
+    for (let i = 0; i < count; i++) {
+      const end = view.getUint32(endsPtr + 4 * i, true);
+      const fingerprint = view.getBigUint64(fingerprintsPtr + 8 * i, true).toString(16).padStart(16, '0');
+      chunks.push({ offset, length: end - offset, fingerprint });
+      offset = end;
     }
+    return chunks;
+  }
 
-    return dequantized;
+  /**
+   * LatentVector over a quantized record; the float view is only
+   * dequantized if something reads `data`
+   */
+  private latentVector(quantized: Uint8Array, dim: number, bits: LatentBits): LatentVector {
+    let data: Float32Array | null = null;
+    return {
+      quantized,
+      dim,
+      get data() {
+        if (!data) data = dequantizeLatent(quantized, dim, bits);
+        return data;
+      },
+    };
   }
 
   /**
-   * Load WASM module
+   * The best build of wasm-codec.c this engine runs (see
+   * scripts/build-native-wasm.js)
    */
-  private async loadWASM(): Promise<WebAssembly.Module> {
-    // In production, this would load the actual compiled WASM
-    // For now, create a minimal stub module
-    const wasmCode = this.createStubWASM();
-    // Ensure we have a proper ArrayBuffer (not SharedArrayBuffer)
-    const buffer = wasmCode.buffer instanceof ArrayBuffer
-      ? wasmCode.buffer.slice(wasmCode.byteOffset, wasmCode.byteOffset + wasmCode.byteLength)
-      : new Uint8Array(wasmCode).buffer;
-    return WebAssembly.compile(buffer);
+  private async loadWASM(threads: boolean): Promise<{ module: WebAssembly.Module; variant: NativeWasmVariant }> {
+    const loaded = await loadNativeWasmModule('wasm-codec', { threads });
+    if (!loaded) {
+      throw new Error('Neural codec WASM not available (run scripts/build-native-wasm.js)');
+    }
+    return loaded;
   }
 
   /**
-   * Create a minimal stub WASM module for development
+   * Park threads - 1 worker instances of a threaded build on the shared
+   * memory; each computes a slice of every layer. A build without
+   * codec_worker simply stays single-threaded.
    */
-  private createStubWASM(): Uint8Array {
-    // Minimal WASM module with malloc/free/encode/decode stubs
-    // This is a placeholder - real implementation would be compiled from C
-    return new Uint8Array([
-      0x00, 0x61, 0x73, 0x6d, // WASM magic number
-      0x01, 0x00, 0x00, 0x00, // Version 1
-    ]);
+  private startWorkers(wasmModule: WebAssembly.Module, threads: number): void {
+    const exports = this.wasm!.exports as any;
+    if (typeof exports.codec_worker !== 'function') return;
+
+    const count = exports.codec_set_threads(threads);
+    let started = 0;
+    for (let index = 1; index < count; index++) {
+      const stackTop = exports.codec_thread_stack();
+      if (!stackTop) break;
+      const worker = new Worker(
+        new URL('../../../../workers/neural-codec-worker.ts', import.meta.url),
+        { type: 'module' }
+      );
+      worker.onerror = (error) => {
+        console.error('Neural codec worker error:', error);
+      };
+      const message: NeuralCodecWorkerInit = { module: wasmModule, memory: this.memory!, index, stackTop };
+      worker.postMessage(message);
+      this.workers.push(worker);
+      started++;
+    }
+    if (started + 1 < count) {
+      // The pool waits for every worker it was told about before going parallel
+      console.warn(`Neural codec: no stack for worker ${started + 1}, running ${started + 1} of ${count} threads`);
+      exports.codec_set_threads(started + 1);
+    }
+  }
+
+  /**
+   * Terminate the layer workers of a threaded build
+   */
+  destroy(): void {
+    this.workers.forEach(worker => worker.terminate());
+    this.workers = [];
   }
 
   /**
@@ -242,9 +582,13 @@ export class WANeuralCodec {
     const memoryView = new Uint8Array(this.memory.buffer);
     memoryView.set(weights, weightsPtr);
 
-    // Initialize model with weights
-    if (exports.init_model) {
-      exports.init_model(weightsPtr, weights.length);
+    // Initialize model with weights (copied into the module's own tables)
+    const status = exports.init_model
+      ? exports.init_model(weightsPtr, weights.length, this.config.weightMode ?? CodecWeightMode.PACKED)
+      : 0;
+    exports.free(weightsPtr);
+    if (status < 0) {
+      throw new Error('Model weights do not match their geometry header');
     }
   }
 
@@ -255,13 +599,26 @@ export class WANeuralCodec {
     latentDim: number;
     modelSize: number;
     initialized: boolean;
+    threads: number;
+    counters: NativeCounters | null;
   } {
     return {
       latentDim: this.config.latentDim,
       modelSize: this.config.modelWeights.byteLength,
       initialized: this.initialized,
+      threads: this.workers.length + 1,
+      counters: this.readCounters(false),
     };
   }
+
+  /**
+   * Blocks encoded/decoded, matmul FLOPs and heap high-water mark from the
+   * module's get_counters (see lib/performance/native-counters.ts)
+   */
+  private readCounters(reset: boolean): NativeCounters | null {
+    if (!this.wasm || !this.memory) return null;
+    return readNativeCounters(this.wasm.exports as any, this.memory, reset);
+  }
 }
 
 /**
@@ -270,11 +627,13 @@ export class WANeuralCodec {
 export async function createNeuralCodec(latentDim: number = 256): Promise<WANeuralCodec> {
   // In production, load actual pre-trained weights
   // For now, create dummy weights
-  const modelWeights = new ArrayBuffer(100 * 1024); // 100KB
+  const geometry: CodecGeometry = { inputSize: 4096, hiddenSize: 512, latentDim };
+  const networkBytes = codecNetworkBytes(geometry);
+  const modelWeights = packModelWeights(geometry, new Uint8Array(networkBytes), new Uint8Array(networkBytes));
 
   const config: NeuralCodecConfig = {
     latentDim,
-    inputSize: 4096, // 64x64 pixels or 4KB data block
+    inputSize: geometry.inputSize, // 64x64 pixels or 4KB data block
     modelWeights,
   };
 
@@ -12,9 +12,10 @@ import { ParametricAnimationCurves, ProceduralAnimationSpec } from '../procedura
 import { TextureReencoder } from '../reencoder/texture-reencoder';
 import { AudioReencoder } from '../reencoder/audio-reencoder';
 import { VideoReencoder } from '../reencoder/video-reencoder';
-import { createNeuralCodec, WANeuralCodec } from '../neural/wasm-codec';
+import { BlockClass, createNeuralCodec, WANeuralCodec } from '../neural/wasm-codec';
 import { AssetAnalyzer, AssetAnalysis } from './analyzer';
 import { StrategySelector, CompressionStrategy } from './strategy-selector';
+import { chunkCasId, findChunkInCas, getChunkFromCas, putChunkToCas, sha256Hex } from '@/lib/storage/wasm-cas';
 
 export type StorageBackend = 'telegram' | 'discord' | 'local' | 'cdn';
 
@@ -28,6 +29,55 @@ export interface StorageOptions {
   chunkSize?: number;
 }
 
+// How the neural path stores a content-defined chunk
+enum ChunkKind {
+  BLOCKS = 0, // Encoded here
+  REPEAT = 1, // Same as an earlier chunk of the file
+  CAS = 2,    // Already in the wasm CAS
+}
+
+function u32Bytes(value: number): Uint8Array {
+  const bytes = new Uint8Array(4);
+  new DataView(bytes.buffer).setUint32(0, value, true);
+  return bytes;
+}
+
+const PAYLOAD_ID_BYTES = 32; // SHA-256
+
+// Header of the encodeNeural stored form
+const NEURAL_MAGIC = 0x464c524e; // "NRLF"
+const NEURAL_FORMAT_VERSION = 1;
+const NEURAL_HEADER_BYTES = 24;
+
+// Codec geometry the stored blocks depend on: a file only decodes with a
+// codec that matches it
+function neuralGeometry(codec: WANeuralCodec): string {
+  return `${codec.blockSize}/${codec.latentDim}x${codec.latentBits}`;
+}
+
+function hexToBytes(hex: string): Uint8Array {
+  const bytes = new Uint8Array(hex.length / 2);
+  for (let i = 0; i < bytes.length; i++) bytes[i] = parseInt(hex.substr(2 * i, 2), 16);
+  return bytes;
+}
+
+function bytesToHex(bytes: Uint8Array): string {
+  return Array.from(bytes)
+    .map((b) => b.toString(16).padStart(2, '0'))
+    .join('');
+}
+
+function concatBytes(parts: Uint8Array[]): Uint8Array {
+  const total = parts.reduce((sum, part) => sum + part.length, 0);
+  const packed = new Uint8Array(total);
+  let offset = 0;
+  for (const part of parts) {
+    packed.set(part, offset);
+    offset += part.length;
+  }
+  return packed;
+}
+
 export interface StorageResult {
   fileId: string;
   originalSize: number;
@@ -51,6 +101,8 @@ export class StoragePipeline {
   private strategySelector: StrategySelector;
   private chunkGraph: ChunkGraph;
   private neuralCodec: WANeuralCodec | null = null;
+  private chunkStats = { chunks: 0, repeated: 0, fromCas: 0, bytesSkipped: 0 }; // Neural path, see encodeNeural
+  private neuralFiles = new Set<string>(); // Stored in the encodeNeural format
   private options: Required<StorageOptions>;
 
   constructor(options: StorageOptions) {
@@ -156,6 +208,7 @@ export class StoragePipeline {
     // 5. Register file
     const fileId = this.generateFileId(file.name);
     this.chunkGraph.registerFile(fileId, chunks, file.size, this.options.chunkSize);
+    if (metadata.encoding === 'neural') this.neuralFiles.add(fileId);
 
     // 6. Save deduplication index
     if (this.options.enableDeduplication) {
@@ -211,7 +264,7 @@ export class StoragePipeline {
       offset += chunk.length;
     }
 
-    return new Blob([combined]);
+    return new Blob([this.neuralFiles.has(fileId) ? await this.decodeNeural(combined) : combined]);
   }
 
   private async applyProceduralGeneration(
@@ -267,13 +320,271 @@ export class StoragePipeline {
   }
 
   private async applyNeuralCompression(file: File): Promise<Uint8Array> {
+    return this.encodeNeural(new Uint8Array(await file.arrayBuffer()));
+  }
+
+  private requireNeuralCodec(): WANeuralCodec {
     if (!this.neuralCodec) {
       throw new Error('Neural codec not initialized');
     }
+    return this.neuralCodec;
+  }
+
+  /**
+   * Neural path. The data is cut into content-defined chunks first
+   * (codec.chunkContent), and a chunk already seen in this file or already
+   * in the wasm CAS is stored as a reference, so it never reaches the
+   * network. Chunks are identified by the SHA-256 of their content: the
+   * XXH64 fingerprint only places the cuts. The other chunks are cut into
+   * codec blocks from their own start and routed by the classifier: only
+   * BlockClass.NEURAL blocks run through the network, in one batch for the
+   * whole file. Their encoded form then goes to the CAS, looked up by the
+   * chunk's content id.
+   *
+   * Stored form: a header of the u32 magic "NRLF", u16 format version,
+   * u8 latent bits, a zero byte, u32 block size, u32 latent dimension, u32
+   * total length and u32 chunk count; then per chunk a ChunkKind byte and
+   * the u32 chunk length, followed by
+   *   REPEAT  the u32 index of the earlier chunk
+   *   CAS     the 32-byte SHA-256 of the encoded chunk as stored in the
+   *           CAS, checked against the bytes fetched back. NEURAL blocks are
+   *           lossy, so the decoded chunk need not hash to its content id
+   *   BLOCKS  a u32 length and the encoded blocks: per block a tag byte and
+   *           its payload, CONSTANT the fill byte, RLE a u32 length and the
+   *           runs, RAW the bytes, NEURAL the quantized latent record
+   */
+  async encodeNeural(data: Uint8Array): Promise<Uint8Array> {
+    const codec = this.requireNeuralCodec();
+    const blockSize = codec.blockSize;
+    const chunks = codec.chunkContent(data);
+    const useCas = this.options.enableDeduplication;
+
+    const chunkData = (c: number) => data.subarray(chunks[c].offset, chunks[c].offset + chunks[c].length);
+
+    // Resolve duplicates before anything is encoded
+    const contentIds = await Promise.all(chunks.map((_, c) => sha256Hex(chunkData(c).slice().buffer)));
+    const geometry = neuralGeometry(codec);
+    const ids = chunks.map((chunk, c) => chunkCasId(contentIds[c], chunk.length, geometry));
+    const firstSeen = new Map<string, number>();
+    const payloadIds = new Map<number, string>();
+    const kinds = ids.map((id, c) => {
+      if (firstSeen.has(id)) return ChunkKind.REPEAT;
+      firstSeen.set(id, c);
+      const payloadId = useCas ? findChunkInCas(id) : null;
+      if (!payloadId) return ChunkKind.BLOCKS;
+      payloadIds.set(c, payloadId);
+      return ChunkKind.CAS;
+    });
+
+    // Classify the remaining chunks, then encode every neural block in a single batch
+    const blockAt = (c: number, b: number) => {
+      const bytes = chunkData(c);
+      return bytes.subarray(b * blockSize, Math.min((b + 1) * blockSize, bytes.length));
+    };
+    const tags = new Map<number, Uint8Array>();
+    const neuralBlocks: [number, number][] = [];
+    kinds.forEach((kind, c) => {
+      if (kind !== ChunkKind.BLOCKS) return;
+      const chunkTags = codec.classifyBlocks(chunkData(c), blockSize);
+      tags.set(c, chunkTags);
+      chunkTags.forEach((tag, b) => {
+        if (tag === BlockClass.NEURAL) neuralBlocks.push([c, b]);
+      });
+    });
+    const neuralData = new Uint8Array(neuralBlocks.length * blockSize);
+    neuralBlocks.forEach(([c, b], i) => neuralData.set(blockAt(c, b), i * blockSize));
+    const latents = await codec.compressBatch(neuralData, blockSize);
+
+    let nextLatent = 0;
+    const encodeChunk = (c: number): Uint8Array => {
+      const parts: Uint8Array[] = [];
+      tags.get(c)!.forEach((tag, b) => {
+        const block = blockAt(c, b);
+        parts.push(Uint8Array.of(tag));
+        switch (tag) {
+          case BlockClass.CONSTANT:
+            parts.push(block.subarray(0, 1));
+            break;
+          case BlockClass.RLE: {
+            const runs = codec.rleEncode(block);
+            parts.push(u32Bytes(runs.length), runs);
+            break;
+          }
+          case BlockClass.RAW:
+            parts.push(block);
+            break;
+          default:
+            parts.push(latents[nextLatent++].latent.quantized);
+            break;
+        }
+      });
+      return concatBytes(parts);
+    };
+
+    const header = new Uint8Array(NEURAL_HEADER_BYTES);
+    const headerView = new DataView(header.buffer);
+    headerView.setUint32(0, NEURAL_MAGIC, true);
+    headerView.setUint16(4, NEURAL_FORMAT_VERSION, true);
+    headerView.setUint8(6, codec.latentBits);
+    headerView.setUint32(8, blockSize, true);
+    headerView.setUint32(12, codec.latentDim, true);
+    headerView.setUint32(16, data.length, true);
+    headerView.setUint32(20, chunks.length, true);
+    const parts: Uint8Array[] = [header];
+    const newChunks: [string, Uint8Array][] = [];
+    kinds.forEach((kind, c) => {
+      parts.push(Uint8Array.of(kind), u32Bytes(chunks[c].length));
+      switch (kind) {
+        case ChunkKind.REPEAT:
+          parts.push(u32Bytes(firstSeen.get(ids[c])!));
+          break;
+        case ChunkKind.CAS:
+          parts.push(hexToBytes(payloadIds.get(c)!));
+          break;
+        default: {
+          const encoded = encodeChunk(c);
+          parts.push(u32Bytes(encoded.length), encoded);
+          newChunks.push([ids[c], encoded]);
+          break;
+        }
+      }
+      this.chunkStats.chunks++;
+      if (kind !== ChunkKind.BLOCKS) {
+        this.chunkStats[kind === ChunkKind.REPEAT ? 'repeated' : 'fromCas']++;
+        this.chunkStats.bytesSkipped += chunks[c].length;
+      }
+    });
+
+    // The file stands on its own without them, so a failed put only costs later dedup
+    if (useCas && typeof window !== 'undefined') {
+      await Promise.all(
+        newChunks.map(([id, encoded]) =>
+          putChunkToCas(id, encoded.buffer as ArrayBuffer).catch((error) => {
+            console.warn(`[StoragePipeline] CAS put failed for ${id}:`, error);
+          })
+        )
+      );
+    }
+
+    return concatBytes(parts);
+  }
 
-    const data = new Uint8Array(await file.arrayBuffer());
-    const result = await this.neuralCodec.compress(data);
-    return result.latent.quantized;
+  /**
+   * Inverse of encodeNeural. Data from another format version or codec
+   * geometry is rejected. CAS chunks are fetched and must hash to the
+   * payload id stored for them; every NEURAL block of the file, those of
+   * the CAS chunks included, is decoded in one batch.
+   */
+  async decodeNeural(stored: Uint8Array): Promise<Uint8Array> {
+    const codec = this.requireNeuralCodec();
+    const view = new DataView(stored.buffer, stored.byteOffset, stored.byteLength);
+    if (stored.length < NEURAL_HEADER_BYTES || view.getUint32(0, true) !== NEURAL_MAGIC) {
+      throw new Error('Neural data is corrupt: bad magic');
+    }
+    const version = view.getUint16(4, true);
+    if (version !== NEURAL_FORMAT_VERSION) {
+      throw new Error(`Neural data has format version ${version}, expected ${NEURAL_FORMAT_VERSION}`);
+    }
+    const storedGeometry = `${view.getUint32(8, true)}/${view.getUint32(12, true)}x${view.getUint8(6)}`;
+    if (storedGeometry !== neuralGeometry(codec)) {
+      throw new Error(`Neural data was encoded with codec geometry ${storedGeometry}, this codec is ${neuralGeometry(codec)}`);
+    }
+    const output = new Uint8Array(view.getUint32(16, true));
+    const count = view.getUint32(20, true);
+
+    const starts: number[] = [];
+    const repeats: [number, number, number][] = []; // Output offset, source offset, length
+    const fromCas: { at: number; length: number; payloadId: string }[] = [];
+    const neural: { target: Uint8Array; record: Uint8Array }[] = [];
+    let pos = NEURAL_HEADER_BYTES;
+    let at = 0;
+    for (let c = 0; c < count; c++) {
+      const kind = stored[pos];
+      const length = view.getUint32(pos + 1, true);
+      pos += 5;
+      if (at + length > output.length) throw new Error('Neural data is corrupt: chunks overrun the total length');
+      starts.push(at);
+      switch (kind) {
+        case ChunkKind.REPEAT: {
+          const index = view.getUint32(pos, true);
+          pos += 4;
+          if (index >= c) throw new Error(`Neural data is corrupt: chunk ${c} repeats chunk ${index}`);
+          repeats.push([at, starts[index], length]);
+          break;
+        }
+        case ChunkKind.CAS:
+          fromCas.push({ at, length, payloadId: bytesToHex(stored.subarray(pos, pos + PAYLOAD_ID_BYTES)) });
+          pos += PAYLOAD_ID_BYTES;
+          break;
+        case ChunkKind.BLOCKS: {
+          const encodedLength = view.getUint32(pos, true);
+          pos += 4;
+          this.decodeChunkBlocks(codec, stored.subarray(pos, pos + encodedLength), output.subarray(at, at + length), neural);
+          pos += encodedLength;
+          break;
+        }
+        default:
+          throw new Error(`Neural data is corrupt: chunk kind ${kind}`);
+      }
+      at += length;
+    }
+    if (at !== output.length) throw new Error('Neural data is corrupt: chunks do not cover the total length');
+
+    const fetched = await Promise.all(fromCas.map(({ payloadId }) => getChunkFromCas(payloadId)));
+    for (let i = 0; i < fromCas.length; i++) {
+      const { at, length, payloadId } = fromCas[i];
+      const { bytes } = fetched[i];
+      const actual = await sha256Hex(bytes.slice().buffer);
+      if (actual !== payloadId) {
+        throw new Error(`CAS chunk ${payloadId} does not match its payload id (got ${actual})`);
+      }
+      this.decodeChunkBlocks(codec, bytes, output.subarray(at, at + length), neural);
+    }
+
+    const blockSize = codec.blockSize;
+    const decoded = await codec.decompressBatch(neural.map(({ record }) => codec.latentFromRecord(record)), blockSize);
+    neural.forEach(({ target }, i) => target.set(decoded[i].subarray(0, target.length)));
+
+    // Sources are first occurrences, complete by now
+    for (const [at, source, length] of repeats) output.copyWithin(at, source, source + length);
+    return output;
+  }
+
+  // Decodes one chunk's encoded blocks into `output`. NEURAL blocks are
+  // queued with their target range instead, for one decompressBatch call.
+  private decodeChunkBlocks(
+    codec: WANeuralCodec,
+    encoded: Uint8Array,
+    output: Uint8Array,
+    neural: { target: Uint8Array; record: Uint8Array }[]
+  ): void {
+    const blockSize = codec.blockSize;
+    const view = new DataView(encoded.buffer, encoded.byteOffset, encoded.byteLength);
+    let pos = 0;
+    for (let start = 0; start < output.length; start += blockSize) {
+      const block = output.subarray(start, Math.min(start + blockSize, output.length));
+      if (pos >= encoded.length) throw new Error('Neural data is corrupt: chunk blocks end early');
+      const tag = encoded[pos++];
+      switch (tag) {
+        case BlockClass.CONSTANT:
+          block.fill(encoded[pos++]);
+          break;
+        case BlockClass.RLE: {
+          const runsLength = view.getUint32(pos, true);
+          block.set(codec.rleDecode(encoded.subarray(pos + 4, pos + 4 + runsLength), block.length));
+          pos += 4 + runsLength;
+          break;
+        }
+        case BlockClass.RAW:
+          block.set(encoded.subarray(pos, pos + block.length));
+          pos += block.length;
+          break;
+        default:
+          neural.push({ target: block, record: encoded.subarray(pos, pos + codec.latentRecordBytes) });
+          pos += codec.latentRecordBytes;
+          break;
+      }
+    }
   }
 
   private async applyReencoding(
@@ -356,6 +667,7 @@ export class StoragePipeline {
     return {
       chunkGraph: this.chunkGraph.getStats(),
       neuralCodec: this.neuralCodec?.getStats(),
+      neuralChunks: { ...this.chunkStats },
       options: this.options,
     };
   }
@@ -0,0 +1,100 @@
+/**
+ * Native Counters - Hot-path counters of the native WASM modules
+ *
+ * Each module (lifter, neural codec) exports get_counters(reset), which
+ * returns a pointer to the fixed NativeCounters struct of
+ * lib/wasm/native/native-counters.h. Counting is compiled in only by
+ * `build-native-wasm.js --counters`; other builds report enabled: false and
+ * just their allocator stats.
+ *
+ * Modules register a reader under their stage name, so reporting code can
+ * snapshot every stage without knowing which modules are loaded.
+ */
+
+// Layout of NativeCounters (version 1) - keep in sync with the header
+const NATIVE_COUNTERS_BYTES = 128;
+const INSTRUCTIONS_OFFSET = 8;
+const BYTES_LIFTED_OFFSET = 72;
+
+export const OPCODE_CLASSES = ['alu', 'data', 'memory', 'control', 'simd', 'system', 'unknown'] as const;
+export type OpcodeClass = (typeof OPCODE_CLASSES)[number];
+
+export interface NativeCounters {
+  enabled: boolean;
+  instructions: Record<OpcodeClass, number>;
+  unknown: number; // Decoder fallbacks (instructions.unknown)
+  bytesLifted: number;
+  matmulFlops: number;
+  blocksEncoded: number;
+  blocksDecoded: number;
+  heapLiveBytes: number;
+  heapPeakBytes: number; // Allocator high-water mark
+  heapReservedBytes: number;
+}
+
+export interface NativeCounterExports {
+  get_counters?: (reset: number) => number;
+}
+
+/**
+ * Decode a module's counters, or null when its build has no get_counters
+ */
+export function readNativeCounters(
+  exports: NativeCounterExports,
+  memory: WebAssembly.Memory,
+  reset = false
+): NativeCounters | null {
+  if (typeof exports.get_counters !== 'function') return null;
+  const ptr = exports.get_counters(reset ? 1 : 0);
+  const view = new DataView(memory.buffer, ptr, NATIVE_COUNTERS_BYTES);
+  const u64 = (offset: number) => Number(view.getBigUint64(offset, true));
+
+  const instructions = {} as Record<OpcodeClass, number>;
+  OPCODE_CLASSES.forEach((name, i) => {
+    instructions[name] = u64(INSTRUCTIONS_OFFSET + i * 8);
+  });
+  return {
+    enabled: view.getUint32(4, true) !== 0,
+    instructions,
+    unknown: instructions.unknown,
+    bytesLifted: u64(BYTES_LIFTED_OFFSET),
+    matmulFlops: u64(BYTES_LIFTED_OFFSET + 8),
+    blocksEncoded: u64(BYTES_LIFTED_OFFSET + 16),
+    blocksDecoded: u64(BYTES_LIFTED_OFFSET + 24),
+    heapLiveBytes: u64(BYTES_LIFTED_OFFSET + 32),
+    heapPeakBytes: u64(BYTES_LIFTED_OFFSET + 40),
+    heapReservedBytes: u64(BYTES_LIFTED_OFFSET + 48),
+  };
+}
+
+type CounterReader = (reset: boolean) => NativeCounters | null;
+
+export class NativeCounterRegistry {
+  private readers = new Map<string, CounterReader>();
+
+  /**
+   * Report `stage` (e.g. 'lift', 'codec') through `read`; a later register
+   * of the same stage replaces it
+   */
+  register(stage: string, read: CounterReader): void {
+    this.readers.set(stage, read);
+  }
+
+  unregister(stage: string): void {
+    this.readers.delete(stage);
+  }
+
+  /**
+   * Counters of every registered stage, optionally resetting them
+   */
+  snapshot(reset = false): Record<string, NativeCounters> {
+    const stages: Record<string, NativeCounters> = {};
+    this.readers.forEach((read, stage) => {
+      const counters = read(reset);
+      if (counters) stages[stage] = counters;
+    });
+    return stages;
+  }
+}
+
+export const nativeCounters = new NativeCounterRegistry();
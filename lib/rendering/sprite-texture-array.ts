@@ -0,0 +1,279 @@
+/**
+ * Sprite Texture Array - Every frame of every creature as one layer of a
+ * single WebGL2 TEXTURE_2D_ARRAY, uploaded once. Animating a sprite only
+ * changes the layer index of its instance, so one instanced draw renders any
+ * number of sprites with no per-frame rasterizing or texture upload.
+ * The WebGPU counterpart is lib/nacho/gpu/sprite-texture-array.ts.
+ */
+
+import { getSpriteAtlas, SpriteAtlas } from '../ui/sprite-atlas/sprite-atlas';
+
+/**
+ * One entry of the texture array: a sprite of the atlas, optionally
+ * re-coloured (see SpriteAtlas.decodeFrame), under its own key
+ */
+export interface SpriteLayerSource {
+  key: string;
+  sprite: string;
+  palette?: ArrayLike<number>;
+}
+
+export interface SpriteLayerRange {
+  first: number; // Layer of frame 0
+  count: number;
+  width: number; // Frame size; frames sit at the top-left of their layer
+  height: number;
+}
+
+export interface SpriteLayerSet {
+  width: number; // Layer size, the largest frame of any sprite
+  height: number;
+  layers: number;
+  pixels: Uint8Array; // RGBA, layer after layer
+  ranges: Map<string, SpriteLayerRange>;
+}
+
+/**
+ * Decode the frames of `sources` (default: every atlas sprite under its own
+ * name) into consecutive layers
+ */
+export function buildSpriteLayers(
+  sources?: SpriteLayerSource[],
+  atlas: SpriteAtlas = getSpriteAtlas()
+): SpriteLayerSet {
+  const entries = sources ?? Array.from(atlas.sprites.keys(), (name) => ({ key: name, sprite: name }));
+  let width = 1;
+  let height = 1;
+  let layers = 0;
+  for (const entry of entries) {
+    const sprite = atlas.sprites.get(entry.sprite);
+    if (!sprite) throw new Error(`Sprite texture array: unknown sprite ${entry.sprite}`);
+    width = Math.max(width, sprite.width);
+    height = Math.max(height, sprite.height);
+    layers += sprite.frames.length;
+  }
+
+  const pixels = new Uint8Array(width * height * 4 * Math.max(layers, 1));
+  const ranges = new Map<string, SpriteLayerRange>();
+  let layer = 0;
+  for (const entry of entries) {
+    const sprite = atlas.sprites.get(entry.sprite)!;
+    ranges.set(entry.key, { first: layer, count: sprite.frames.length, width: sprite.width, height: sprite.height });
+    for (let f = 0; f < sprite.frames.length; f++, layer++) {
+      const rgba = atlas.decodeFrame(entry.sprite, f, entry.palette)!;
+      const base = layer * width * height * 4;
+      for (let y = 0; y < sprite.height; y++) {
+        pixels.set(rgba.subarray(y * sprite.width * 4, (y + 1) * sprite.width * 4), base + y * width * 4);
+      }
+    }
+  }
+  return { width, height, layers, pixels, ranges };
+}
+
+// x, y, width, height (pixels, top-left origin), layer, flip, u1, v1
+export const SPRITE_INSTANCE_FLOATS = 8;
+
+/**
+ * Write instance `index` of an instance buffer: frame `frame` (wrapped to the
+ * sprite's frame count) of `key` with its top-left corner at (x, y), each
+ * pixel `scale` x `scale`. Returns false for an unknown key.
+ */
+export function writeSpriteInstance(
+  instances: Float32Array,
+  index: number,
+  set: SpriteLayerSet,
+  key: string,
+  frame: number,
+  x: number,
+  y: number,
+  scale: number = 1,
+  flip: boolean = false
+): boolean {
+  const range = set.ranges.get(key);
+  if (!range) return false;
+  const at = index * SPRITE_INSTANCE_FLOATS;
+  instances[at] = x;
+  instances[at + 1] = y;
+  instances[at + 2] = range.width * scale;
+  instances[at + 3] = range.height * scale;
+  instances[at + 4] = range.first + (((frame % range.count) + range.count) % range.count);
+  instances[at + 5] = flip ? 1 : 0;
+  instances[at + 6] = range.width / set.width;
+  instances[at + 7] = range.height / set.height;
+  return true;
+}
+
+const VERTEX_SHADER = `#version 300 es
+  layout(location = 0) in vec4 a_rect;
+  layout(location = 1) in vec2 a_layer;
+  layout(location = 2) in vec2 a_extent;
+  uniform vec2 u_viewport;
+  out vec3 v_texCoord;
+
+  void main() {
+    // Triangle strip corners from the vertex index; no vertex buffer
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2 pixel = a_rect.xy + corner * a_rect.zw;
+    gl_Position = vec4(pixel / u_viewport * vec2(2.0, -2.0) + vec2(-1.0, 1.0), 0.0, 1.0);
+    float u = a_layer.y > 0.5 ? 1.0 - corner.x : corner.x;
+    v_texCoord = vec3(vec2(u, corner.y) * a_extent, a_layer.x);
+  }
+`;
+
+const FRAGMENT_SHADER = `#version 300 es
+  precision mediump float;
+  precision mediump sampler2DArray;
+  uniform sampler2DArray u_sprites;
+  in vec3 v_texCoord;
+  out vec4 outColor;
+
+  void main() {
+    vec4 color = texture(u_sprites, v_texCoord);
+    if (color.a == 0.0) discard;
+    outColor = color;
+  }
+`;
+
+export class SpriteTextureArray {
+  private gl: WebGL2RenderingContext;
+  private program: WebGLProgram | null = null;
+  private texture: WebGLTexture | null = null;
+  private vertexArray: WebGLVertexArrayObject | null = null;
+  private instanceBuffer: WebGLBuffer | null = null;
+  private instanceCapacity = 0;
+  private viewportLocation: WebGLUniformLocation | null = null;
+  readonly set: SpriteLayerSet;
+
+  constructor(gl: WebGL2RenderingContext, set: SpriteLayerSet = buildSpriteLayers()) {
+    this.gl = gl;
+    this.set = set;
+    this.upload();
+    this.setupProgram();
+  }
+
+  get ready(): boolean {
+    return this.texture !== null && this.program !== null;
+  }
+
+  // The only texture upload: all layers in one texImage3D
+  private upload(): void {
+    const gl = this.gl;
+    const { width, height, layers, pixels } = this.set;
+    if (layers > gl.getParameter(gl.MAX_ARRAY_TEXTURE_LAYERS)) {
+      console.error(`Sprite texture array: ${layers} layers exceed MAX_ARRAY_TEXTURE_LAYERS`);
+      return;
+    }
+
+    this.texture = gl.createTexture();
+    gl.bindTexture(gl.TEXTURE_2D_ARRAY, this.texture);
+    gl.pixelStorei(gl.UNPACK_ALIGNMENT, 4);
+    gl.texImage3D(gl.TEXTURE_2D_ARRAY, 0, gl.RGBA8, width, height, Math.max(layers, 1), 0, gl.RGBA, gl.UNSIGNED_BYTE, pixels);
+    // Pixel art: no filtering, and no bleeding between a frame and its padding
+    gl.texParameteri(gl.TEXTURE_2D_ARRAY, gl.TEXTURE_MIN_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D_ARRAY, gl.TEXTURE_MAG_FILTER, gl.NEAREST);
+    gl.texParameteri(gl.TEXTURE_2D_ARRAY, gl.TEXTURE_WRAP_S, gl.CLAMP_TO_EDGE);
+    gl.texParameteri(gl.TEXTURE_2D_ARRAY, gl.TEXTURE_WRAP_T, gl.CLAMP_TO_EDGE);
+    gl.bindTexture(gl.TEXTURE_2D_ARRAY, null);
+  }
+
+  private compileShader(type: number, source: string): WebGLShader | null {
+    const gl = this.gl;
+    const shader = gl.createShader(type);
+    if (!shader) return null;
+
+    gl.shaderSource(shader, source);
+    gl.compileShader(shader);
+
+    if (!gl.getShaderParameter(shader, gl.COMPILE_STATUS)) {
+      console.error('Shader compilation failed:', gl.getShaderInfoLog(shader));
+      gl.deleteShader(shader);
+      return null;
+    }
+
+    return shader;
+  }
+
+  private setupProgram(): void {
+    const gl = this.gl;
+    const vertexShader = this.compileShader(gl.VERTEX_SHADER, VERTEX_SHADER);
+    const fragmentShader = this.compileShader(gl.FRAGMENT_SHADER, FRAGMENT_SHADER);
+    if (!vertexShader || !fragmentShader) return;
+
+    const program = gl.createProgram();
+    if (!program) return;
+    gl.attachShader(program, vertexShader);
+    gl.attachShader(program, fragmentShader);
+    gl.linkProgram(program);
+    gl.deleteShader(vertexShader);
+    gl.deleteShader(fragmentShader);
+
+    if (!gl.getProgramParameter(program, gl.LINK_STATUS)) {
+      console.error('Program linking failed:', gl.getProgramInfoLog(program));
+      gl.deleteProgram(program);
+      return;
+    }
+
+    this.program = program;
+    this.viewportLocation = gl.getUniformLocation(program, 'u_viewport');
+    gl.useProgram(program);
+    gl.uniform1i(gl.getUniformLocation(program, 'u_sprites'), 0);
+
+    // One instance per sprite, read with divisor 1
+    this.vertexArray = gl.createVertexArray();
+    this.instanceBuffer = gl.createBuffer();
+    gl.bindVertexArray(this.vertexArray);
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.instanceBuffer);
+    const stride = SPRITE_INSTANCE_FLOATS * 4;
+    const attributes: [number, number, number][] = [
+      [0, 4, 0],
+      [1, 2, 16],
+      [2, 2, 24],
+    ];
+    for (const [location, size, offset] of attributes) {
+      gl.enableVertexAttribArray(location);
+      gl.vertexAttribPointer(location, size, gl.FLOAT, false, stride, offset);
+      gl.vertexAttribDivisor(location, 1);
+    }
+    gl.bindVertexArray(null);
+  }
+
+  /**
+   * Draw the first `count` instances (see writeSpriteInstance) over the
+   * current framebuffer, alpha blended, in one instanced draw call
+   */
+  draw(instances: Float32Array, count: number, viewportWidth: number, viewportHeight: number): void {
+    const gl = this.gl;
+    if (!this.ready || count <= 0) return;
+
+    gl.bindBuffer(gl.ARRAY_BUFFER, this.instanceBuffer);
+    const data = instances.subarray(0, count * SPRITE_INSTANCE_FLOATS);
+    if (count > this.instanceCapacity) {
+      this.instanceCapacity = Math.max(count, this.instanceCapacity * 2);
+      gl.bufferData(gl.ARRAY_BUFFER, this.instanceCapacity * SPRITE_INSTANCE_FLOATS * 4, gl.DYNAMIC_DRAW);
+    }
+    gl.bufferSubData(gl.ARRAY_BUFFER, 0, data);
+
+    gl.useProgram(this.program);
+    gl.uniform2f(this.viewportLocation, viewportWidth, viewportHeight);
+    gl.activeTexture(gl.TEXTURE0);
+    gl.bindTexture(gl.TEXTURE_2D_ARRAY, this.texture);
+    gl.enable(gl.BLEND);
+    gl.blendFuncSeparate(gl.SRC_ALPHA, gl.ONE_MINUS_SRC_ALPHA, gl.ONE, gl.ONE_MINUS_SRC_ALPHA);
+    gl.bindVertexArray(this.vertexArray);
+    gl.drawArraysInstanced(gl.TRIANGLE_STRIP, 0, 4, count);
+    gl.bindVertexArray(null);
+  }
+
+  /**
+   * Cleanup
+   */
+  destroy(): void {
+    const gl = this.gl;
+    if (this.texture) gl.deleteTexture(this.texture);
+    if (this.instanceBuffer) gl.deleteBuffer(this.instanceBuffer);
+    if (this.vertexArray) gl.deleteVertexArray(this.vertexArray);
+    if (this.program) gl.deleteProgram(this.program);
+    this.texture = null;
+    this.program = null;
+  }
+}
@@ -6,9 +6,11 @@ export type WasmCasPutResult = {
   fileId: string; // cluster/telegram manifest id
 };
 
-function readIndex(): Record<string, string> {
+const INDEX_KEY = 'bellum.wasm.cas.v1';
+
+function readIndex(key = INDEX_KEY): Record<string, string> {
   try {
-    const raw = window.localStorage.getItem('bellum.wasm.cas.v1');
+    const raw = window.localStorage.getItem(key);
     if (!raw) return {};
     const j = JSON.parse(raw);
     if (!j || typeof j !== 'object') return {};
@@ -18,15 +20,15 @@ function readIndex(): Record<string, string> {
   }
 }
 
-function writeIndex(index: Record<string, string>) {
+function writeIndex(index: Record<string, string>, key = INDEX_KEY) {
   try {
-    window.localStorage.setItem('bellum.wasm.cas.v1', JSON.stringify(index));
+    window.localStorage.setItem(key, JSON.stringify(index));
   } catch {
     // ignore
   }
 }
 
-async function sha256Hex(data: ArrayBuffer): Promise<string> {
+export async function sha256Hex(data: ArrayBuffer): Promise<string> {
   const copy = new Uint8Array(data.byteLength);
   copy.set(new Uint8Array(data));
   const hash = await crypto.subtle.digest('SHA-256', copy.buffer);
@@ -35,22 +37,30 @@ async function sha256Hex(data: ArrayBuffer): Promise<string> {
     .join('');
 }
 
-export async function putWasmArtifactToCas(wasm: ArrayBuffer): Promise<WasmCasPutResult> {
+export type CasArtifactOptions = {
+  prefix: string; // file name prefix, e.g. "wasm"
+  extension: string;
+  mimeType: string;
+};
+
+export async function putArtifactToCas(data: ArrayBuffer, opts: CasArtifactOptions): Promise<WasmCasPutResult> {
   if (typeof window === 'undefined') throw new Error('CAS not available during SSR');
-  const artifactId = await sha256Hex(wasm);
-  const index = readIndex();
-  const existing = index[artifactId];
+  const artifactId = await sha256Hex(data);
+  const existing = readIndex()[artifactId];
   if (existing) return { artifactId, fileId: existing };
 
   // Upload as a normal cluster file using existing storage routes.
-  const file = new File([wasm], `wasm_${artifactId}.wasm`, { type: 'application/wasm' });
+  const name = `${opts.prefix}_${artifactId.replace(/[^a-zA-Z0-9]/g, '_')}.${opts.extension}`;
+  const file = new File([data], name, { type: opts.mimeType });
   const up = await chunkedUploadFile(file, { compressChunks: false });
+  // Re-read: other puts may have landed during the upload
+  const index = readIndex();
   index[artifactId] = up.fileId;
   writeIndex(index);
   return { artifactId, fileId: up.fileId };
 }
 
-export async function getWasmArtifactFromCas(artifactId: string): Promise<{ fileId: string; bytes: Uint8Array }> {
+export async function getArtifactFromCas(artifactId: string): Promise<{ fileId: string; bytes: Uint8Array }> {
   if (typeof window === 'undefined') throw new Error('CAS not available during SSR');
   const index = readIndex();
   const fileId = index[String(artifactId || '').trim()] || '';
@@ -59,8 +69,46 @@ export async function getWasmArtifactFromCas(artifactId: string): Promise<{ file
   return { fileId, bytes: dl.bytes };
 }
 
+export function hasArtifactInCas(artifactId: string): boolean {
+  if (typeof window === 'undefined') return false;
+  return Boolean(readIndex()[String(artifactId || '').trim()]);
+}
+
+export async function putWasmArtifactToCas(wasm: ArrayBuffer): Promise<WasmCasPutResult> {
+  return putArtifactToCas(wasm, { prefix: 'wasm', extension: 'wasm', mimeType: 'application/wasm' });
+}
 
+export async function getWasmArtifactFromCas(artifactId: string): Promise<{ fileId: string; bytes: Uint8Array }> {
+  return getArtifactFromCas(artifactId);
+}
 
+// Storage-pipeline chunks. The encoded payload is an ordinary artifact, keyed
+// by its own sha256 so the bytes fetched back can be checked; a second index
+// maps the sha256 of the chunk's content and its length to that payload, so a
+// chunk can be looked up before it is encoded. The codec is lossy, so the
+// content id cannot be checked against the decoded chunk. The encoding
+// depends on the codec geometry, which is part of the key.
+const CHUNK_INDEX_KEY = 'bellum.wasm.cas.chunks.v1';
 
+export function chunkCasId(contentId: string, length: number, geometry: string): string {
+  return `cdc:${geometry}:${contentId}:${length}`;
+}
 
+// Payload artifact id of a chunk already in the CAS, or null
+export function findChunkInCas(chunkId: string): string | null {
+  if (typeof window === 'undefined') return null;
+  const payloadId = readIndex(CHUNK_INDEX_KEY)[chunkId];
+  return payloadId && hasArtifactInCas(payloadId) ? payloadId : null;
+}
+
+export async function putChunkToCas(chunkId: string, encoded: ArrayBuffer): Promise<WasmCasPutResult> {
+  const put = await putArtifactToCas(encoded, { prefix: 'chunk', extension: 'bin', mimeType: 'application/octet-stream' });
+  const index = readIndex(CHUNK_INDEX_KEY);
+  index[chunkId] = put.artifactId;
+  writeIndex(index, CHUNK_INDEX_KEY);
+  return put;
+}
 
+export async function getChunkFromCas(payloadId: string): Promise<{ fileId: string; bytes: Uint8Array }> {
+  return getArtifactFromCas(payloadId);
+}
@@ -0,0 +1,125 @@
+/**
+ * Lift Queue Tests
+ * SharedLiftQueue's Chase-Lev deques, seen-set dedup and pending count,
+ * driven from one thread
+ */
+
+import { describe, it, expect } from '@jest/globals';
+import { QUEUE_EMPTY, SharedLiftQueue } from '../lift-queue';
+
+function queue(workers: number, dequeCapacity?: number, seenCapacity?: number): SharedLiftQueue {
+  return new SharedLiftQueue(SharedLiftQueue.allocate(workers, dequeCapacity, seenCapacity));
+}
+
+describe('SharedLiftQueue', () => {
+  describe('deque', () => {
+    it('pops the newest entry on the owner side', () => {
+      const q = queue(2);
+      expect(q.push(0, 0x10)).toBe('queued');
+      expect(q.push(0, 0x20)).toBe('queued');
+      expect(q.push(0, 0x30)).toBe('queued');
+
+      expect(q.pop(0)).toBe(0x30);
+      expect(q.pop(0)).toBe(0x20);
+      expect(q.pop(0)).toBe(0x10);
+      expect(q.pop(0)).toBe(QUEUE_EMPTY);
+      expect(q.pop(1)).toBe(QUEUE_EMPTY);
+    });
+
+    it('steals the oldest entry from another worker', () => {
+      const q = queue(3);
+      q.push(1, 0x10);
+      q.push(1, 0x20);
+
+      expect(q.steal(0)).toBe(0x10);
+      expect(q.steal(2)).toBe(0x20);
+      expect(q.steal(0)).toBe(QUEUE_EMPTY);
+      expect(q.steal(1)).toBe(QUEUE_EMPTY); // Never from its own deque
+    });
+
+    it('hands the last entry to exactly one of owner and thief', () => {
+      const q = queue(2);
+      q.push(0, 0x10);
+      expect(q.steal(1)).toBe(0x10);
+      expect(q.pop(0)).toBe(QUEUE_EMPTY);
+
+      q.push(0, 0x20);
+      expect(q.pop(0)).toBe(0x20);
+      expect(q.steal(1)).toBe(QUEUE_EMPTY);
+
+      // Indices keep moving after both kinds of take
+      q.push(0, 0x30);
+      q.push(0, 0x40);
+      expect(q.steal(1)).toBe(0x30);
+      expect(q.pop(0)).toBe(0x40);
+      expect(q.pop(0)).toBe(QUEUE_EMPTY);
+    });
+
+    it('reuses deque slots once entries are taken', () => {
+      const q = queue(2, 4);
+      for (let round = 0; round < 5; round++) {
+        for (let i = 0; i < 4; i++) expect(q.push(0, round * 16 + i)).toBe('queued');
+        expect(q.steal(1)).toBe(round * 16);
+        for (let i = 3; i >= 1; i--) expect(q.pop(0)).toBe(round * 16 + i);
+      }
+    });
+  });
+
+  describe('seen set', () => {
+    it('queues each entry point once across workers', () => {
+      const q = queue(2);
+      expect(q.push(0, 0)).toBe('queued'); // Offset 0 is a valid entry
+      expect(q.push(0, 0)).toBe('duplicate');
+      expect(q.push(1, 0)).toBe('duplicate');
+      expect(q.push(1, 0x40)).toBe('queued');
+
+      expect(q.pop(0)).toBe(0);
+      q.complete();
+      // Still seen after it was lifted
+      expect(q.push(0, 0)).toBe('duplicate');
+    });
+
+    it('admits everything once the set is full', () => {
+      const q = queue(1, 16, 2);
+      expect(q.push(0, 1)).toBe('queued');
+      expect(q.push(0, 2)).toBe('queued');
+      expect(q.push(0, 3)).toBe('queued');
+      expect(q.push(0, 3)).toBe('queued'); // A redundant lift, not a lost one
+      expect(q.push(0, 1)).toBe('duplicate');
+    });
+  });
+
+  describe('capacity and completion', () => {
+    it('reports full with the entry still counted as pending', () => {
+      const q = queue(1, 3); // Rounded up to 4
+      for (let i = 0; i < 4; i++) expect(q.push(0, i)).toBe('queued');
+      expect(q.push(0, 4)).toBe('full');
+      expect(q.push(0, 4)).toBe('duplicate'); // The caller lifts it itself
+
+      let taken = 0;
+      while (q.pop(0) !== QUEUE_EMPTY) {
+        taken++;
+        q.complete();
+      }
+      expect(taken).toBe(4);
+      expect(q.isFinished()).toBe(false);
+      q.complete(); // The kept 'full' entry
+      expect(q.isFinished()).toBe(true);
+    });
+
+    it('is finished only when every queued entry completes', () => {
+      const q = queue(2);
+      expect(q.isFinished()).toBe(true);
+      q.push(0, 0x10);
+      q.push(1, 0x20);
+      expect(q.steal(0)).toBe(0x20);
+      expect(q.isFinished()).toBe(false);
+      q.complete();
+      expect(q.isFinished()).toBe(false);
+      expect(q.pop(0)).toBe(0x10);
+      q.complete();
+      expect(q.isFinished()).toBe(true);
+      expect(q.workers).toBe(2);
+    });
+  });
+});
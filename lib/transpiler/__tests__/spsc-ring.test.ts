@@ -0,0 +1,102 @@
+/**
+ * SPSC Ring Tests
+ * SpscRing's record framing, full/empty logic and wrap-around, with the
+ * producer and consumer on one thread
+ */
+
+import { describe, it, expect } from '@jest/globals';
+import { SpscRing } from '../spsc-ring';
+
+function bytes(length: number, seed: number): Uint8Array {
+  const out = new Uint8Array(length);
+  for (let i = 0; i < length; i++) out[i] = (seed + i * 7) & 0xff;
+  return out;
+}
+
+// Takes the oldest message, copying the payload out of the ring
+function take(ring: SpscRing): { id: number; payload: Uint8Array } | null {
+  const message = ring.peek();
+  if (!message) return null;
+  const copy = { id: message.id, payload: message.payload.slice() };
+  ring.consume();
+  return copy;
+}
+
+describe('SpscRing', () => {
+  it('rounds the capacity up and caps payloads at half of it', () => {
+    const ring = new SpscRing(SpscRing.allocate(100)); // 128 bytes
+    expect(ring.maxPayload).toBe(56);
+    expect(ring.tryPush(1, bytes(56, 0))).toBe(true);
+    expect(() => ring.tryPush(2, bytes(57, 0))).toThrow(/exceeds maxPayload/);
+  });
+
+  it('delivers messages in order with their ids and payloads', () => {
+    const ring = new SpscRing(SpscRing.allocate(256));
+    expect(ring.peek()).toBeNull();
+    expect(ring.tryPush(7, bytes(5, 1))).toBe(true);
+    expect(ring.tryPush(0xffffffff, bytes(0, 0))).toBe(true);
+    expect(ring.tryPush(9, bytes(13, 2))).toBe(true);
+
+    // peek does not remove
+    expect(ring.peek()?.id).toBe(7);
+    expect(take(ring)).toEqual({ id: 7, payload: bytes(5, 1) });
+    expect(take(ring)).toEqual({ id: 0xffffffff, payload: new Uint8Array(0) });
+    expect(take(ring)).toEqual({ id: 9, payload: bytes(13, 2) });
+    expect(take(ring)).toBeNull();
+  });
+
+  it('refuses a record that does not fit until the consumer frees space', () => {
+    const ring = new SpscRing(SpscRing.allocate(64));
+    // 8-byte header + 16 payload: 24 bytes a record
+    expect(ring.tryPush(1, bytes(16, 1))).toBe(true);
+    expect(ring.tryPush(2, bytes(16, 2))).toBe(true);
+    expect(ring.tryPush(3, bytes(16, 3))).toBe(false);
+    expect(ring.tryPush(3, bytes(8, 3))).toBe(true); // 16 bytes fill it exactly
+    expect(ring.tryPush(4, bytes(0, 4))).toBe(false);
+
+    expect(take(ring)?.id).toBe(1);
+    expect(ring.tryPush(4, bytes(0, 4))).toBe(true);
+    expect(take(ring)?.id).toBe(2);
+    expect(take(ring)).toEqual({ id: 3, payload: bytes(8, 3) });
+    expect(take(ring)?.id).toBe(4);
+    expect(take(ring)).toBeNull();
+  });
+
+  it('wraps a record that would straddle the end to offset 0', () => {
+    const ring = new SpscRing(SpscRing.allocate(64));
+    ring.tryPush(1, bytes(16, 1)); // [0, 24)
+    ring.tryPush(2, bytes(16, 2)); // [24, 48)
+    take(ring);
+
+    // 24 bytes from 48 would straddle: the 16 bytes skipped at the end
+    // count against the free space, so it only fits once [0, 24) is free
+    expect(ring.tryPush(3, bytes(16, 3))).toBe(true);
+    expect(ring.tryPush(4, bytes(0, 4))).toBe(false);
+    expect(take(ring)).toEqual({ id: 2, payload: bytes(16, 2) });
+    expect(take(ring)).toEqual({ id: 3, payload: bytes(16, 3) });
+    expect(take(ring)).toBeNull();
+  });
+
+  it('keeps order over many laps of the ring', () => {
+    const ring = new SpscRing(SpscRing.allocate(128));
+    let next = 0;
+    let expected = 0;
+    while (expected < 500) {
+      while (next < 500 && ring.tryPush(next, bytes(next % 41, next))) next++;
+      const message = take(ring);
+      expect(message).toEqual({ id: expected, payload: bytes(expected % 41, expected) });
+      expected++;
+    }
+    expect(take(ring)).toBeNull();
+  });
+
+  it('finishes once closed and drained', () => {
+    const ring = new SpscRing(SpscRing.allocate(64));
+    ring.tryPush(1, bytes(4, 1));
+    expect(ring.isFinished()).toBe(false);
+    ring.close();
+    expect(ring.isFinished()).toBe(false);
+    take(ring);
+    expect(ring.isFinished()).toBe(true);
+  });
+});
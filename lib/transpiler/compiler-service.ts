@@ -3,6 +3,9 @@
  * Uses Web Workers for non-blocking compilation.
  */
 
+import { getLiftPipeline, LiftPipelineOptions, PipelineModule } from './lift-pipeline';
+import { NativeArch } from './native-lifter';
+
 export class CompilerService {
     private static instance: CompilerService;
 
@@ -44,6 +47,21 @@ export class CompilerService {
         throw new Error(`No compiler backend configured for ${language}.`);
     }
 
+    /**
+     * Guest machine code -> WASM: lift, optimize, emit and compile the basic
+     * block at each entry point on the staged worker pipeline, yielding each
+     * compiled module as soon as it is ready (see lift-pipeline.ts)
+     */
+    compileGuestCode(
+        code: Uint8Array,
+        baseAddress: number,
+        arch: NativeArch,
+        entries: number[],
+        options: LiftPipelineOptions = {}
+    ): AsyncGenerator<PipelineModule> {
+        return getLiftPipeline().compile(code, baseAddress, arch, entries, options);
+    }
+
     // Old mock parser removed (no fake compilation).
 }
 
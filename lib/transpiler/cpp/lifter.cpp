@@ -1,41 +1,31 @@
 // Freestanding C++ Lifter
-// Multi-Architecture Support (x86, ARM64 placeholder)
+// Multi-Architecture Support (x86, x86-64, ARM64)
 // No stdlib dependencies to ensure smooth WASM compilation
 
-#include <cstdint>
+#include "lifter.h"
+#include "x86_tables.h"
+#include "peephole.h"
+#include "wasm_emitter.h"
+#include "../../wasm/native/wasm-arena.h"
+#include "../../wasm/native/native-counters.h"
 
-#define WASM_EXPORT __attribute__((visibility("default")))
+// Decode counters, see get_counters(); only touched with NATIVE_COUNTERS
+static NativeCounters lifter_counters;
 
-enum class Arch {
-    X86 = 0,
-    ARM64 = 1,
-    RISCV = 2
-};
-
-enum class IROpcode {
-    // ALU
-    ADD, SUB, MUL, DIV, AND, OR, XOR, SHL, SHR,
-    // Memory
-    LOAD, STORE, PUSH, POP,
-    // Control Flow
-    JMP, JE, JNE, CALL, RET,
-    // SIMD
-    V_ADD, V_SUB, V_MUL,
-    // System
-    SYSCALL, UNKNOWN
-};
-
-struct IRInstruction {
-    IROpcode opcode;
-    uint64_t address;
-    uint8_t size;
-    uint64_t op1;
-    uint64_t op2;
-    uint64_t op3; // For ARM/RISC-V 3-operand instrs
-};
+static inline int ir_opcode_class(IROpcode op) {
+    if (op <= IROpcode::TEST) return OPCLASS_ALU;
+    if (op <= IROpcode::SETCC) return OPCLASS_DATA;
+    if (op <= IROpcode::POP) return OPCLASS_MEMORY;
+    if (op <= IROpcode::RET) return OPCLASS_CONTROL;
+    if (op <= IROpcode::V_CMP) return OPCLASS_SIMD;
+    if (op <= IROpcode::TRAP) return OPCLASS_SYSTEM;
+    return OPCLASS_UNKNOWN;
+}
 
 class Lifter {
 public:
+    static constexpr size_t kX86MaxLength = 15;  // Architectural limit: longer is #UD
+
     // Simple bump allocator for IR buffer to avoid std::vector
     IRInstruction* ir_buffer;
     size_t max_capacity;
@@ -46,77 +36,1266 @@ public:
     void lift_block(const uint8_t* code, size_t length, uint64_t entry, Arch arch) {
         size_t pc = 0;
         while (pc < length && count < max_capacity) {
-            if (arch == Arch::X86) {
-                pc += decode_x86(code + pc, entry + pc);
-            } else if (arch == Arch::ARM64) {
-                pc += decode_arm64(code + pc, entry + pc);
-            } else {
-                // Unknown arch
+            size_t size = decode(code + pc, length - pc, entry + pc, arch, ir_buffer[count]);
+            if (size == 0) {
+                // Truncated instruction at the end of the buffer, or unknown arch
                 break;
             }
+            count++;
+            pc += size;
         }
     }
 
+    // Linear lift of one basic block: stops after the first branch, call or
+    // return, or at a trap or system call (left in the buffer so a consumer
+    // can stop in front of it). Returns the instruction count.
+    size_t lift_basic_block(const uint8_t* code, size_t length, uint64_t entry, Arch arch) {
+        size_t pc = 0;
+        while (pc < length && count < max_capacity) {
+            IRInstruction& instr = ir_buffer[count];
+            const size_t size = decode(code + pc, length - pc, entry + pc, arch, instr);
+            if (size == 0) break;
+            count++;
+            pc += size;
+            switch (instr.opcode) {
+                case IROpcode::JMP: case IROpcode::JE: case IROpcode::JNE: case IROpcode::JCC:
+                case IROpcode::CALL: case IROpcode::RET: case IROpcode::TRAP: case IROpcode::SYSCALL:
+                    return count;
+                default:
+                    break;
+            }
+        }
+        return count;
+    }
+
+    // Linear lift into the struct-of-arrays layout. Stops when `max`
+    // instructions are written or the operand pool cannot take another
+    // instruction; returns the instruction count.
+    static size_t lift_soa(const uint8_t* code, size_t length, uint64_t entry, Arch arch,
+                           const IRSoA& out, size_t max, size_t pool_words) {
+        size_t pc = 0;
+        size_t n = 0;
+        uint32_t pool = 0;
+        IRInstruction instr;
+        out.operand_offsets[0] = 0;
+        while (pc < length && n < max && pool + 6 <= pool_words) {
+            const size_t size = decode(code + pc, length - pc, entry + pc, arch, instr);
+            if (size == 0) break;
+
+            out.opcodes[n] = static_cast<uint8_t>(instr.opcode);
+            out.sizes[n] = instr.size;
+            out.info[n] = instr.info;
+            out.addresses[n] = static_cast<uint32_t>(pc);
+            const uint64_t ops[3] = { instr.op1, instr.op2, instr.op3 };
+            for (int slot = 0; slot < 3; slot++) {
+                const uint32_t words = ir_operand_words(ir_operand_kind(instr.info, slot));
+                if (words > 0) out.operand_pool[pool++] = static_cast<uint32_t>(ops[slot]);
+                if (words > 1) out.operand_pool[pool++] = static_cast<uint32_t>(ops[slot] >> 32);
+            }
+            out.operand_offsets[++n] = pool;
+            pc += size;
+        }
+        return n;
+    }
+
+    // Decodes a single instruction. Returns its length in bytes, or 0 when
+    // the available bytes end in the middle of the instruction; never 0 once
+    // kX86MaxLength bytes are available (an over-long x86 instruction is a
+    // 1-byte UNKNOWN).
+    static size_t decode(const uint8_t* code, size_t avail, uint64_t addr, Arch arch, IRInstruction& instr) {
+        instr.attr = 0;
+        size_t size;
+        switch (arch) {
+            case Arch::X86:
+                size = decode_x86(code, avail, addr, false, instr);
+                break;
+            case Arch::X86_64:
+                size = decode_x86(code, avail, addr, true, instr);
+                break;
+            case Arch::ARM64:
+                size = decode_arm64(code, avail, addr, instr);
+                break;
+            default:
+                return 0;
+        }
+        // Counted here, so every caller must stop decoding where it stops
+        // consuming (a block lift ends at its terminator, not past it)
+        if (size) {
+            COUNTER_ADD(lifter_counters, instructions[ir_opcode_class(instr.opcode)], 1);
+            COUNTER_ADD(lifter_counters, bytes_lifted, size);
+        }
+        return size;
+    }
+
 private:
-    size_t decode_x86(const uint8_t* code, uint64_t addr) {
-        IRInstruction& instr = ir_buffer[count++];
+    static int64_t read_signed(const uint8_t* p, int bytes) {
+        uint64_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint64_t>(p[i]) << (8 * i);
+        }
+        if (bytes < 8) {
+            const uint64_t sign = 1ull << (8 * bytes - 1);
+            value = (value ^ sign) - sign;
+        }
+        return static_cast<int64_t>(value);
+    }
+
+    static size_t decode_x86(const uint8_t* code, size_t avail, uint64_t addr, bool long_mode,
+                             IRInstruction& instr) {
         instr.address = addr;
-        uint8_t opcode = code[0];
-
-        // Very basic x86 decoder (POC)
-        switch (opcode) {
-            case 0x01: // ADD r/m32, r32
-                instr.opcode = IROpcode::ADD;
-                instr.size = 2;
-                break;
-            case 0x29: // SUB r/m32, r32
-                instr.opcode = IROpcode::SUB;
-                instr.size = 2;
-                break;
-            case 0x50: // PUSH r32
-                instr.opcode = IROpcode::PUSH;
-                instr.size = 1;
-                break;
-            case 0x58: // POP r32
-                instr.opcode = IROpcode::POP;
-                instr.size = 1;
-                break;
-            case 0xC3: // RET
-                instr.opcode = IROpcode::RET;
-                instr.size = 1;
-                break;
-            case 0xE9: // JMP rel32
-                instr.opcode = IROpcode::JMP;
-                instr.size = 5;
-                break;
-            // SIMD (SSE) Placeholders
-            case 0x0F: 
-                if (code[1] == 0x58) { // ADDPS
-                    instr.opcode = IROpcode::V_ADD;
-                    instr.size = 3;
-                    return 3;
+        instr.op1 = instr.op2 = instr.op3 = 0;
+
+        size_t pos = 0;
+        uint8_t rex = 0;
+        uint8_t seg = 0;
+        bool opsize = false;
+        bool adsize = false;
+
+        // Legacy prefixes, optionally followed by REX (a legacy prefix after
+        // REX cancels it)
+        for (;;) {
+            if (pos >= kX86MaxLength) return invalid_x86(instr);
+            if (pos >= avail) return 0;
+            const uint8_t b = code[pos];
+            if (long_mode && (b & 0xF0) == 0x40) {
+                rex = b;
+                pos++;
+                continue;
+            }
+            if (!(kX86OneByte.e[b].flags & XO_PREFIX)) break;
+            rex = 0;
+            switch (b) {
+                case 0x66: opsize = true; break;
+                case 0x67: adsize = true; break;
+                case 0x26: seg = 1; break;
+                case 0x2E: seg = 2; break;
+                case 0x36: seg = 3; break;
+                case 0x3E: seg = 4; break;
+                case 0x64: seg = 5; break;
+                case 0x65: seg = 6; break;
+                default: break; // LOCK, REP/REPNE
+            }
+            pos++;
+        }
+
+        bool rex_w = rex & 8;
+        bool rex_r = rex & 4;
+        bool rex_x = rex & 2;
+        bool rex_b = rex & 1;
+        bool evex_r4 = false;
+        bool vex = false;
+        bool evex = false;
+        uint8_t vvvv = 0;
+
+        const X86OpMap* map = &kX86OneByte;
+        uint8_t opcode = code[pos];
+
+        // VEX (C4/C5) and EVEX (62); outside long mode these are LES/LDS/BOUND
+        // unless the following byte would be a register-form ModRM
+        if ((opcode == 0xC4 || opcode == 0xC5 || opcode == 0x62) &&
+            (long_mode || (pos + 1 < avail && (code[pos + 1] & 0xC0) == 0xC0))) {
+            const size_t prefix_len = opcode == 0xC5 ? 2 : opcode == 0xC4 ? 3 : 4;
+            if (pos + prefix_len >= avail) return x86_truncated(pos + prefix_len + 1, instr);
+            const uint8_t p0 = code[pos + 1];
+            uint8_t mm = 1;
+            if (opcode == 0xC5) {
+                rex_r = !(p0 & 0x80);
+                vvvv = (~p0 >> 3) & 0x0F;
+                rex_w = rex_x = rex_b = false;
+            } else {
+                const uint8_t p1 = code[pos + 2];
+                rex_r = !(p0 & 0x80);
+                rex_x = !(p0 & 0x40);
+                rex_b = !(p0 & 0x20);
+                rex_w = p1 & 0x80;
+                vvvv = (~p1 >> 3) & 0x0F;
+                if (opcode == 0xC4) {
+                    mm = p0 & 0x1F;
+                } else {
+                    const uint8_t p2 = code[pos + 3];
+                    evex = true;
+                    evex_r4 = !(p0 & 0x10);
+                    mm = p0 & 0x07;
+                    if (!(p2 & 0x08)) vvvv |= 0x10;
                 }
-                instr.opcode = IROpcode::UNKNOWN;
-                instr.size = 2;
-                return 2;
-            default:
-                instr.opcode = IROpcode::UNKNOWN;
-                instr.size = 1;
+            }
+            if (!long_mode) {
+                rex_r = rex_x = rex_b = evex_r4 = false;
+                vvvv &= 0x07;
+            }
+            vex = true;
+            pos += prefix_len;
+            switch (mm) {
+                case 1: map = &kX86Map0F; break;
+                case 2: map = &kX86Map0F38; break;
+                case 3: map = &kX86Map0F3A; break;
+                default: return invalid_x86(instr);
+            }
+            opcode = code[pos++];
+        } else {
+            pos++;
+            if (opcode == 0x0F) {
+                if (pos >= avail) return x86_truncated(pos + 1, instr);
+                opcode = code[pos++];
+                map = &kX86Map0F;
+                if (opcode == 0x38 || opcode == 0x3A) {
+                    map = opcode == 0x38 ? &kX86Map0F38 : &kX86Map0F3A;
+                    if (pos >= avail) return x86_truncated(pos + 1, instr);
+                    opcode = code[pos++];
+                }
+            }
+        }
+
+        const X86OpInfo& e = map->e[opcode];
+        const bool one_byte = map == &kX86OneByte;
+
+        // ModRM / SIB / displacement
+        const int asz = long_mode ? (adsize ? 32 : 64) : (adsize ? 16 : 32);
+        uint8_t mod = 3, reg = 0, rm = 0;
+        uint64_t mem = 0;
+        if (e.flags & XO_MODRM) {
+            if (pos >= avail) return x86_truncated(pos + 1, instr);
+            const uint8_t modrm = code[pos++];
+            mod = modrm >> 6;
+            reg = (modrm >> 3) & 7;
+            rm = modrm & 7;
+            if (mod != 3) {
+                uint8_t base = REG_NONE;
+                uint8_t index = REG_NONE;
+                uint8_t scale = 0;
+                int disp_bytes = mod == 1 ? 1 : 0;
+                if (asz == 16) {
+                    static constexpr uint8_t kBase16[8] = { 3, 3, 5, 5, 6, 7, 5, 3 };   // BX, BP, SI, DI
+                    static constexpr uint8_t kIndex16[8] = { 6, 7, 6, 7, REG_NONE, REG_NONE, REG_NONE, REG_NONE };
+                    base = kBase16[rm];
+                    index = kIndex16[rm];
+                    if (mod == 2) disp_bytes = 2;
+                    if (mod == 0 && rm == 6) {
+                        base = REG_NONE;
+                        disp_bytes = 2;
+                    }
+                } else {
+                    if (mod == 2) disp_bytes = 4;
+                    if (rm == 4) {
+                        if (pos >= avail) return x86_truncated(pos + 1, instr);
+                        const uint8_t sib = code[pos++];
+                        const uint8_t idx = ((sib >> 3) & 7) | (rex_x ? 8 : 0);
+                        scale = sib >> 6;
+                        index = idx == 4 ? static_cast<uint8_t>(REG_NONE) : idx;
+                        if ((sib & 7) == 5 && mod == 0) {
+                            disp_bytes = 4;
+                        } else {
+                            base = (sib & 7) | (rex_b ? 8 : 0);
+                        }
+                    } else if (rm == 5 && mod == 0) {
+                        base = long_mode ? REG_PC : REG_NONE;
+                        disp_bytes = 4;
+                    } else {
+                        base = rm | (rex_b ? 8 : 0);
+                    }
+                }
+                if (pos + disp_bytes > avail) return x86_truncated(pos + disp_bytes, instr);
+                const int32_t disp = disp_bytes ? static_cast<int32_t>(read_signed(code + pos, disp_bytes)) : 0;
+                pos += disp_bytes;
+                mem = make_mem(base, index, scale, disp, seg);
+            }
+        }
+        const bool has_mem = (e.flags & XO_MODRM) && mod != 3;
+
+        // Operand size
+        const bool d64 = long_mode &&
+            ((e.flags & XO_D64) || ((e.flags & XO_GROUP) && (kX86GroupD64[e.group] >> reg) & 1));
+        int osz = 32;
+        if (e.flags & XO_BYTE) osz = 8;
+        else if (rex_w) osz = 64;
+        else if (opsize) osz = 16;
+        else if (d64) osz = 64;
+
+        // Immediate
+        int imm_bytes = 0;
+        bool relative = false;
+        switch (e.imm) {
+            case XI_B: imm_bytes = 1; break;
+            case XI_W: imm_bytes = 2; break;
+            case XI_Z: imm_bytes = osz == 16 ? 2 : 4; break;
+            case XI_V: imm_bytes = osz == 64 ? 8 : osz == 16 ? 2 : 4; break;
+            case XI_WB: imm_bytes = 3; break;
+            case XI_REL8: imm_bytes = 1; relative = true; break;
+            case XI_RELZ: imm_bytes = (long_mode || !opsize) ? 4 : 2; relative = true; break;
+            case XI_MOFFS: imm_bytes = asz / 8; break;
+            case XI_FAR: imm_bytes = opsize ? 4 : 6; break;
+            case XI_GRP3: imm_bytes = reg < 2 ? (osz == 8 ? 1 : osz == 16 ? 2 : 4) : 0; break;
+            default: break;
+        }
+        if (pos + imm_bytes > avail) return x86_truncated(pos + imm_bytes, instr);
+        int64_t imm = 0;
+        if (imm_bytes) {
+            const int value_bytes = e.imm == XI_WB ? 2 : e.imm == XI_FAR ? imm_bytes - 2 : imm_bytes;
+            imm = read_signed(code + pos, value_bytes);
+            pos += imm_bytes;
+        }
+        if (pos > kX86MaxLength) return invalid_x86(instr);
+
+        // IR opcode
+        IROpcode op = e.op;
+        if (e.flags & XO_GROUP) op = kX86Groups[e.group][reg];
+        if (e.flags & XO_ESCAPE) op = IROpcode::UNKNOWN;
+        if (long_mode && (e.flags & XO_INV64)) op = IROpcode::UNKNOWN;
+        if (!long_mode && one_byte && opcode == 0x63) op = IROpcode::UNKNOWN; // ARPL
+
+        uint8_t cc = opcode & 0x0F;
+        if (one_byte && opcode >= 0xE0 && opcode <= 0xE3) cc = CC_X86_LOOPNE + (opcode - 0xE0);
+        if (op == IROpcode::JCC && cc == 4) op = IROpcode::JE;
+        if (op == IROpcode::JCC && cc == 5) op = IROpcode::JNE;
+        if (op == IROpcode::MOV && (e.flags & XO_MOVLS) && has_mem) {
+            op = (e.form == XF_EG || e.form == XF_EI) ? IROpcode::STORE : IROpcode::LOAD;
+        }
+
+        // Operands
+        const uint8_t reg_id = reg | (rex_r ? 8 : 0);
+        const uint8_t rm_id = rm | (rex_b ? 8 : 0);
+        const uint8_t low_id = (opcode & 7) | (rex_b ? 8 : 0);
+        const bool has_rex = rex != 0;
+        const auto gpr = [has_rex](uint8_t n, bool byte) -> uint8_t {
+            return (byte && !has_rex && n >= 4 && n < 8) ? static_cast<uint8_t>(REG_AH + (n - 4)) : n;
+        };
+        const bool byte_src = (e.flags & XO_SRC8) || osz == 8;
+
+        uint8_t kinds[3] = { OPK_NONE, OPK_NONE, OPK_NONE };
+        uint64_t values[3] = { 0, 0, 0 };
+        int n = 0;
+        const auto push = [&](uint8_t kind, uint64_t value) {
+            if (n < 3) {
+                kinds[n] = kind;
+                values[n++] = value;
+            }
+        };
+        const auto push_rm = [&](bool vec, bool byte) {
+            if (has_mem) push(OPK_MEM, mem);
+            else if (vec) push(OPK_REG, REG_VEC0 + (rm_id | (evex && rex_x ? 16 : 0)));
+            else push(OPK_REG, gpr(rm_id, byte));
+        };
+
+        bool imm_used = false;
+        switch (e.form) {
+            case XF_EG: push_rm(false, osz == 8); push(OPK_REG, gpr(reg_id, osz == 8)); break;
+            case XF_GE: push(OPK_REG, gpr(reg_id, osz == 8)); push_rm(false, byte_src); break;
+            case XF_GEI: push(OPK_REG, gpr(reg_id, false)); push_rm(false, false); break;
+            case XF_E: push_rm(false, osz == 8); break;
+            case XF_EI: push_rm(false, osz == 8); break;
+            case XF_E1: push_rm(false, osz == 8); push(OPK_IMM, 1); break;
+            case XF_ECL: push_rm(false, osz == 8); push(OPK_REG, 1); break;
+            case XF_AI: push(OPK_REG, 0); break;
+            case XF_Z: push(OPK_REG, low_id); break;
+            case XF_ZI: push(OPK_REG, gpr(low_id, osz == 8)); break;
+            case XF_ZA: push(OPK_REG, low_id); push(OPK_REG, 0); break;
+            case XF_J:
+                if (relative) {
+                    uint64_t target = addr + pos + static_cast<uint64_t>(imm);
+                    if (!long_mode) target &= opsize ? 0xFFFFull : 0xFFFFFFFFull;
+                    push(OPK_IMM, target);
+                    imm_used = true;
+                }
+                break;
+            case XF_AM:
+                push(OPK_REG, 0);
+                push(OPK_MEM, make_mem(REG_NONE, REG_NONE, 0, static_cast<int32_t>(imm), seg));
+                imm_used = true;
+                break;
+            case XF_MA:
+                push(OPK_MEM, make_mem(REG_NONE, REG_NONE, 0, static_cast<int32_t>(imm), seg));
+                push(OPK_REG, 0);
+                imm_used = true;
+                break;
+            case XF_ES: push_rm(false, false); push(OPK_REG, REG_SEG0 + (reg < 6 ? reg : 0)); break;
+            case XF_SE: push(OPK_REG, REG_SEG0 + (reg < 6 ? reg : 0)); push_rm(false, false); break;
+            case XF_VW:
+                push(OPK_REG, REG_VEC0 + (reg_id | (evex_r4 ? 16 : 0)));
+                if (vex && op != IROpcode::V_MOV && !(map == &kX86Map0F && (opcode == 0x2E || opcode == 0x2F))) {
+                    push(OPK_REG, REG_VEC0 + vvvv);
+                }
+                push_rm(true, false);
                 break;
+            case XF_WV:
+                push_rm(true, false);
+                push(OPK_REG, REG_VEC0 + (reg_id | (evex_r4 ? 16 : 0)));
+                break;
+            case XF_SEG: push(OPK_REG, e.group); break;
+            default: break;
+        }
+        if (one_byte && opcode == 0x90 && rex_b) {
+            // XCHG r8, rAX (90 without REX.B is NOP, F3 90 is PAUSE)
+            op = IROpcode::XCHG;
+            push(OPK_REG, low_id);
+            push(OPK_REG, 0);
         }
-        return instr.size;
+        if (op == IROpcode::JCC || op == IROpcode::SETCC || op == IROpcode::CMOV) {
+            // Condition code follows the other operands (JCC/SETCC op2, CMOV op3)
+            push(OPK_IMM, cc);
+        }
+        if (imm_bytes && !imm_used && e.imm != XI_FAR) push(OPK_IMM, static_cast<uint64_t>(imm));
+
+        static constexpr uint8_t kWidth[9] = { W8, W8, W16, W16, W32, W32, W32, W32, W64 };
+        instr.opcode = op;
+        instr.size = static_cast<uint8_t>(pos);
+        instr.info = ir_info(kinds[0], kinds[1], kinds[2], kWidth[osz / 8]);
+        instr.op1 = values[0];
+        instr.op2 = values[1];
+        instr.op3 = values[2];
+        return pos;
     }
 
-    size_t decode_arm64(const uint8_t* code, uint64_t addr) {
-        // Fixed 4-byte instructions
-        IRInstruction& instr = ir_buffer[count++];
+    // Undecodable byte sequence: consume one byte so the stream can resync
+    static size_t invalid_x86(IRInstruction& instr) {
+        instr.opcode = IROpcode::UNKNOWN;
+        instr.size = 1;
+        instr.info = 0;
+        instr.op1 = instr.op2 = instr.op3 = 0;
+        return 1;
+    }
+
+    // The bytes ran out before an instruction that needs at least `need`:
+    // wait for more (0), unless it cannot fit in 15 bytes anyway
+    static size_t x86_truncated(size_t need, IRInstruction& instr) {
+        return need > kX86MaxLength ? invalid_x86(instr) : 0;
+    }
+
+    // ---------------------------------------------------------------------
+    // ARM64 (A64)
+    //
+    // Fixed 4-byte instructions. Bits 28:25 select one of the top-level
+    // encoding groups through kA64Groups; each group handler then matches
+    // its instruction classes by mask/value.
+    // ---------------------------------------------------------------------
+
+    using A64Handler = void (*)(uint32_t word, uint64_t addr, IRInstruction& instr);
+
+    static size_t decode_arm64(const uint8_t* code, size_t avail, uint64_t addr, IRInstruction& instr) {
+        if (avail < 4) return 0;
+        const uint32_t word = static_cast<uint32_t>(code[0]) | (static_cast<uint32_t>(code[1]) << 8)
+            | (static_cast<uint32_t>(code[2]) << 16) | (static_cast<uint32_t>(code[3]) << 24);
         instr.address = addr;
         instr.size = 4;
-        instr.opcode = IROpcode::UNKNOWN; // TODO: Implement ARM64 decoder
+        a64_emit(instr, IROpcode::UNKNOWN, W64);
+        kA64Groups[(word >> 25) & 0xF](word, addr, instr);
         return 4;
     }
+
+    static constexpr uint32_t bits(uint32_t word, int hi, int lo) {
+        return (word >> lo) & ((1u << (hi - lo + 1)) - 1);
+    }
+
+    static constexpr int64_t sign_extend(uint64_t value, int width) {
+        return static_cast<int64_t>((value ^ (1ull << (width - 1))) - (1ull << (width - 1)));
+    }
+
+    // Register 31 is SP in address/ADD-immediate contexts, XZR/WZR elsewhere
+    static constexpr uint8_t xreg(uint32_t n, bool sp = false) {
+        return n == 31 && !sp ? static_cast<uint8_t>(REG_ZR) : static_cast<uint8_t>(n);
+    }
+
+    static constexpr uint8_t vreg(uint32_t n) {
+        return static_cast<uint8_t>(REG_VEC0 + n);
+    }
+
+    static void a64_emit(IRInstruction& instr, IROpcode op, uint8_t width,
+                         uint8_t k1 = OPK_NONE, uint64_t v1 = 0,
+                         uint8_t k2 = OPK_NONE, uint64_t v2 = 0,
+                         uint8_t k3 = OPK_NONE, uint64_t v3 = 0) {
+        instr.opcode = op;
+        instr.info = ir_info(k1, k2, k3, width);
+        instr.op1 = v1;
+        instr.op2 = v2;
+        instr.op3 = v3;
+    }
+
+    // DecodeBitMasks() from the Arm ARM, for logical immediates
+    static bool a64_bitmask(uint32_t n, uint32_t imms, uint32_t immr, bool sf, uint64_t& out) {
+        const uint32_t combined = (n << 6) | (~imms & 0x3F);
+        if (combined == 0 || (!sf && n)) return false;
+        const int len = 31 - __builtin_clz(combined);
+        if (len < 1) return false;
+        const uint32_t size = 1u << len;
+        const uint32_t levels = size - 1;
+        const uint32_t s = imms & levels;
+        const uint32_t r = immr & levels;
+        if (s == levels) return false;
+        const uint64_t mask = size == 64 ? ~0ull : (1ull << size) - 1;
+        uint64_t elem = (1ull << (s + 1)) - 1;
+        if (r) elem = ((elem >> r) | (elem << (size - r))) & mask;
+        for (uint32_t i = size; i < 64; i *= 2) elem |= elem << i;
+        out = sf ? elem : elem & 0xFFFFFFFFull;
+        return true;
+    }
+
+    static void a64_unallocated(uint32_t, uint64_t, IRInstruction&) {
+        // SME, SVE and unallocated space stay UNKNOWN
+    }
+
+    // Data processing - immediate (bits 28:26 = 100)
+    static void a64_dp_imm(uint32_t w, uint64_t addr, IRInstruction& instr) {
+        const bool sf = w >> 31;
+        const uint8_t width = sf ? W64 : W32;
+        const uint32_t rd = bits(w, 4, 0);
+        const uint32_t rn = bits(w, 9, 5);
+
+        switch (bits(w, 25, 23)) {
+            case 0: case 1: {
+                // ADR / ADRP
+                const int64_t imm = sign_extend((bits(w, 23, 5) << 2) | bits(w, 30, 29), 21);
+                const uint64_t target = sf ? (addr & ~0xFFFull) + static_cast<uint64_t>(imm << 12)
+                                           : addr + static_cast<uint64_t>(imm);
+                a64_emit(instr, IROpcode::LEA, W64, OPK_REG, xreg(rd), OPK_IMM, target);
+                break;
+            }
+            case 2: {
+                // ADD/SUB (immediate)
+                const bool sub = bits(w, 30, 30);
+                const bool flags = bits(w, 29, 29);
+                const uint64_t imm = static_cast<uint64_t>(bits(w, 21, 10)) << (bits(w, 22, 22) ? 12 : 0);
+                const uint8_t dst = xreg(rd, !flags);
+                if (flags && sub && rd == 31) {
+                    a64_emit(instr, IROpcode::CMP, width, OPK_REG, xreg(rn, true), OPK_IMM, imm);
+                } else if (!flags && imm == 0 && (rd == 31 || rn == 31)) {
+                    a64_emit(instr, IROpcode::MOV, width, OPK_REG, dst, OPK_REG, xreg(rn, true));
+                } else {
+                    a64_emit(instr, sub ? IROpcode::SUB : IROpcode::ADD, width,
+                             OPK_REG, dst, OPK_REG, xreg(rn, true), OPK_IMM, imm);
+                    if (flags) instr.attr |= IR_ATTR_SETS_FLAGS;     // ADDS/SUBS, CMN
+                }
+                break;
+            }
+            case 4: {
+                // Logical (immediate)
+                uint64_t imm = 0;
+                if (!a64_bitmask(bits(w, 22, 22), bits(w, 15, 10), bits(w, 21, 16), sf, imm)) break;
+                const uint32_t opc = bits(w, 30, 29);
+                if (opc == 3 && rd == 31) {
+                    a64_emit(instr, IROpcode::TEST, width, OPK_REG, xreg(rn), OPK_IMM, imm);
+                } else if (opc == 1 && rn == 31) {
+                    a64_emit(instr, IROpcode::MOV, width, OPK_REG, xreg(rd, true), OPK_IMM, imm);
+                } else {
+                    static constexpr IROpcode kOps[4] = { IROpcode::AND, IROpcode::OR, IROpcode::XOR, IROpcode::AND };
+                    a64_emit(instr, kOps[opc], width, OPK_REG, xreg(rd, opc != 3), OPK_REG, xreg(rn), OPK_IMM, imm);
+                    if (opc == 3) instr.attr |= IR_ATTR_SETS_FLAGS;  // ANDS
+                }
+                break;
+            }
+            case 5: {
+                // Move wide (immediate)
+                const uint32_t opc = bits(w, 30, 29);
+                const uint32_t shift = bits(w, 22, 21) * 16;
+                const uint64_t imm16 = bits(w, 20, 5);
+                if (opc == 1 || (!sf && shift >= 32)) break;
+                if (opc == 3) {
+                    a64_emit(instr, IROpcode::MOV, width, OPK_REG, xreg(rd), OPK_IMM, imm16, OPK_IMM, shift);
+                } else {
+                    uint64_t value = imm16 << shift;
+                    if (opc == 0) value = ~value;
+                    if (!sf) value &= 0xFFFFFFFFull;
+                    a64_emit(instr, IROpcode::MOV, width, OPK_REG, xreg(rd), OPK_IMM, value);
+                }
+                break;
+            }
+            case 6: {
+                // Bitfield: only the shift and extend aliases are modelled
+                const uint32_t opc = bits(w, 30, 29);
+                const uint32_t immr = bits(w, 21, 16);
+                const uint32_t imms = bits(w, 15, 10);
+                const uint32_t top = sf ? 63 : 31;
+                if (opc == 2) {
+                    if (imms != top && imms + 1 == immr) {
+                        a64_emit(instr, IROpcode::SHL, width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_IMM, top - imms);
+                    } else if (imms == top) {
+                        a64_emit(instr, IROpcode::SHR, width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_IMM, immr);
+                    } else if (immr == 0 && (imms == 7 || imms == 15)) {
+                        // UXTB/UXTH: a MOV of the extended register keeps the source width
+                        a64_emit(instr, IROpcode::MOV, width, OPK_REG, xreg(rd), OPK_REG,
+                                 make_shifted_reg(xreg(rn), 0, 0, imms == 7 ? 1 : 2));
+                    }
+                } else if (opc == 0) {
+                    if (imms == top) {
+                        a64_emit(instr, IROpcode::SAR, width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_IMM, immr);
+                    } else if (immr == 0 && (imms == 7 || imms == 15 || (imms == 31 && sf))) {
+                        // SXTB/SXTH/SXTW
+                        a64_emit(instr, IROpcode::MOV, width, OPK_REG, xreg(rd), OPK_REG,
+                                 make_shifted_reg(xreg(rn), 0, 0, imms == 7 ? 5 : imms == 15 ? 6 : 7));
+                    }
+                }
+                break;
+            }
+            case 7: {
+                // EXTR with identical sources is ROR (immediate)
+                const uint32_t rm = bits(w, 20, 16);
+                if (rm == rn) {
+                    a64_emit(instr, IROpcode::ROR, width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_IMM, bits(w, 15, 10));
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Branches, exception generation and system instructions (bits 28:26 = 101)
+    static void a64_branch(uint32_t w, uint64_t addr, IRInstruction& instr) {
+        const uint32_t rt = bits(w, 4, 0);
+        if ((w & 0x7C000000) == 0x14000000) {
+            // B / BL
+            const uint64_t target = addr + static_cast<uint64_t>(sign_extend(bits(w, 25, 0), 26) * 4);
+            a64_emit(instr, (w >> 31) ? IROpcode::CALL : IROpcode::JMP, W64, OPK_IMM, target);
+        } else if ((w & 0xFF000010) == 0x54000000) {
+            // B.cond
+            const uint64_t target = addr + static_cast<uint64_t>(sign_extend(bits(w, 23, 5), 19) * 4);
+            const uint32_t cond = bits(w, 3, 0);
+            if (cond >= 14) a64_emit(instr, IROpcode::JMP, W64, OPK_IMM, target);
+            else if (cond == 0) a64_emit(instr, IROpcode::JE, W64, OPK_IMM, target);
+            else if (cond == 1) a64_emit(instr, IROpcode::JNE, W64, OPK_IMM, target);
+            else a64_emit(instr, IROpcode::JCC, W64, OPK_IMM, target, OPK_IMM, cond);
+        } else if ((w & 0x7E000000) == 0x34000000) {
+            // CBZ / CBNZ: register in op2 replaces the flags test
+            const uint64_t target = addr + static_cast<uint64_t>(sign_extend(bits(w, 23, 5), 19) * 4);
+            a64_emit(instr, bits(w, 24, 24) ? IROpcode::JNE : IROpcode::JE, (w >> 31) ? W64 : W32,
+                     OPK_IMM, target, OPK_REG, xreg(rt));
+        } else if ((w & 0x7E000000) == 0x36000000) {
+            // TBZ / TBNZ: register in op2, bit number in op3
+            const uint64_t target = addr + static_cast<uint64_t>(sign_extend(bits(w, 18, 5), 14) * 4);
+            const uint32_t bit = (bits(w, 31, 31) << 5) | bits(w, 23, 19);
+            a64_emit(instr, bits(w, 24, 24) ? IROpcode::JNE : IROpcode::JE, W64,
+                     OPK_IMM, target, OPK_REG, xreg(rt), OPK_IMM, bit);
+        } else if ((w & 0xFE000000) == 0xD6000000) {
+            // Unconditional branch (register), including the pointer-auth
+            // variants (opc 8/9: BRAA/BLRAA). ERET and DRPS stay UNKNOWN.
+            const uint32_t opc = bits(w, 24, 21);
+            const uint8_t rn = xreg(bits(w, 9, 5));
+            switch (opc) {
+                case 0: case 8: a64_emit(instr, IROpcode::JMP, W64, OPK_REG, rn); break;
+                case 1: case 9: a64_emit(instr, IROpcode::CALL, W64, OPK_REG, rn); break;
+                case 2:
+                    // RETAA/RETAB return through X30 with Rn = 11111
+                    a64_emit(instr, IROpcode::RET, W64, OPK_REG, bits(w, 11, 11) ? static_cast<uint8_t>(30) : rn);
+                    break;
+                default: break;
+            }
+        } else if ((w & 0xFFE0001F) == 0xD4000001) {
+            a64_emit(instr, IROpcode::SYSCALL, W64, OPK_IMM, bits(w, 20, 5));            // SVC
+        } else if ((w & 0xFF800000) == 0xD4000000 || (w & 0xFFE00000) == 0xD4200000 ||
+                   (w & 0xFFE00000) == 0xD4400000) {
+            a64_emit(instr, IROpcode::TRAP, W64, OPK_IMM, bits(w, 20, 5));               // HVC/SMC/BRK/HLT
+        } else if ((w & 0xFFFFF01F) == 0xD503201F || (w & 0xFFFFF01F) == 0xD503301F) {
+            a64_emit(instr, IROpcode::NOP, W64);                                        // Hints, barriers
+        }
+    }
+
+    // Loads and stores (bits 27, 25 = 1, 0)
+    static void a64_ldst(uint32_t w, uint64_t, IRInstruction& instr) {
+        const uint32_t rt = bits(w, 4, 0);
+        const uint32_t rn = bits(w, 9, 5);
+        const bool vec = bits(w, 26, 26);
+
+        if ((w & 0x3B000000) == 0x18000000) {
+            // Load register (literal)
+            const uint32_t opc = bits(w, 31, 30);
+            const int32_t disp = static_cast<int32_t>(sign_extend(bits(w, 23, 5), 19) * 4);
+            if (!vec && opc == 3) {
+                a64_emit(instr, IROpcode::NOP, W64);                                    // PRFM
+                return;
+            }
+            // LDRSW (literal) is a sign-extended 32-bit load
+            const uint8_t width = vec ? W64 : (opc == 1 ? W64 : W32);
+            a64_emit(instr, IROpcode::LOAD, width, OPK_REG, vec ? vreg(rt) : xreg(rt),
+                     OPK_MEM, make_mem(REG_PC, REG_NONE, 0, disp));
+            if (!vec && opc == 2) instr.attr |= IR_ATTR_SIGNED | IR_ATTR_WIDE;
+        } else if ((w & 0x3A000000) == 0x28000000) {
+            // Load/store pair
+            const uint32_t opc = bits(w, 31, 30);
+            const uint32_t mode = bits(w, 24, 23);
+            const bool load = bits(w, 22, 22);
+            const int scale = vec ? 2 + static_cast<int>(opc) : (opc >= 2 ? 3 : 2);
+            const int32_t disp = static_cast<int32_t>(sign_extend(bits(w, 21, 15), 7) << scale);
+            const uint8_t mem_mode_bits = mode == 1 ? MEM_POST_INDEX : mode == 3 ? MEM_PRE_INDEX : MEM_OFFSET;
+            const uint64_t mem = make_mem(xreg(rn, true), REG_NONE, 0, disp, 0, mem_mode_bits);
+            const uint32_t rt2 = bits(w, 14, 10);
+            const uint8_t r1 = vec ? vreg(rt) : xreg(rt);
+            const uint8_t r2 = vec ? vreg(rt2) : xreg(rt2);
+            const uint8_t width = scale >= 3 ? W64 : W32;
+            if (!vec && opc == 1 && !load) return;                                  // STGP
+            if (load) a64_emit(instr, IROpcode::LOAD, width, OPK_REG, r1, OPK_MEM, mem, OPK_REG, r2);
+            else a64_emit(instr, IROpcode::STORE, width, OPK_MEM, mem, OPK_REG, r1, OPK_REG, r2);
+            if (!vec && opc == 1) instr.attr |= IR_ATTR_SIGNED | IR_ATTR_WIDE;         // LDPSW
+        } else if ((w & 0x3A000000) == 0x38000000) {
+            // Load/store register: unsigned offset, unscaled/pre/post-indexed, register offset
+            const uint32_t size = bits(w, 31, 30);
+            const uint32_t opc = bits(w, 23, 22);
+            const int scale = vec ? static_cast<int>(((opc & 2) << 1) | size) : static_cast<int>(size);
+            uint64_t mem = 0;
+            if (bits(w, 24, 24)) {
+                const int32_t disp = static_cast<int32_t>(bits(w, 21, 10) << scale);
+                mem = make_mem(xreg(rn, true), REG_NONE, 0, disp);
+            } else if (!bits(w, 21, 21)) {
+                const int32_t disp = static_cast<int32_t>(sign_extend(bits(w, 20, 12), 9));
+                const uint32_t idx = bits(w, 11, 10);
+                if (idx == 2) return;                                                   // LDTR/STTR
+                const uint8_t mode = idx == 1 ? MEM_POST_INDEX : idx == 3 ? MEM_PRE_INDEX : MEM_OFFSET;
+                mem = make_mem(xreg(rn, true), REG_NONE, 0, disp, 0, mode);
+            } else if (bits(w, 11, 10) == 2) {
+                const uint32_t option = bits(w, 15, 13);
+                const uint8_t extend = option == 3 ? 0 : static_cast<uint8_t>(option + 1);
+                const uint8_t shift = bits(w, 12, 12) ? static_cast<uint8_t>(scale) : 0;
+                mem = make_mem(xreg(rn, true), xreg(bits(w, 20, 16)), shift, 0, 0, MEM_OFFSET, extend);
+            } else {
+                return;                                                                 // Atomic memory ops
+            }
+
+            if (!vec && size == 3 && opc == 2) {
+                a64_emit(instr, IROpcode::NOP, W64);                                    // PRFM
+                return;
+            }
+            // Integer opc 2/3: LDRSB/LDRSH/LDRSW into an X / a W register
+            if (!vec && opc == 3 && size >= 2) return;                              // Unallocated
+            const bool load = vec ? (opc & 1) : opc != 0;
+            const uint8_t width = static_cast<uint8_t>(scale >= 3 ? 3 : scale);
+            const uint8_t r = vec ? vreg(rt) : xreg(rt);
+            if (load) a64_emit(instr, IROpcode::LOAD, width, OPK_REG, r, OPK_MEM, mem);
+            else a64_emit(instr, IROpcode::STORE, width, OPK_MEM, mem, OPK_REG, r);
+            if (!vec && opc >= 2) instr.attr |= IR_ATTR_SIGNED | (opc == 2 ? IR_ATTR_WIDE : 0);
+        } else if ((w & 0x3F000000) == 0x08000000) {
+            // Load/store exclusive, load-acquire/store-release
+            const uint64_t mem = make_mem(xreg(rn, true), REG_NONE, 0, 0);
+            const uint8_t width = static_cast<uint8_t>(bits(w, 31, 30));
+            if (bits(w, 22, 22)) a64_emit(instr, IROpcode::LOAD, width, OPK_REG, xreg(rt), OPK_MEM, mem);
+            else a64_emit(instr, IROpcode::STORE, width, OPK_MEM, mem, OPK_REG, xreg(rt));
+        } else if ((w & 0xBE000000) == 0x0C000000) {
+            // Advanced SIMD load/store multiple or single structures (LD1/ST1 ...)
+            const uint8_t mode = bits(w, 23, 23) ? MEM_POST_INDEX : MEM_OFFSET;
+            const uint64_t mem = make_mem(xreg(rn, true), REG_NONE, 0, 0, 0, mode);
+            if (bits(w, 22, 22)) a64_emit(instr, IROpcode::LOAD, W64, OPK_REG, vreg(rt), OPK_MEM, mem);
+            else a64_emit(instr, IROpcode::STORE, W64, OPK_MEM, mem, OPK_REG, vreg(rt));
+        }
+    }
+
+    // Data processing - register (bits 27:25 = 101)
+    static void a64_dp_reg(uint32_t w, uint64_t, IRInstruction& instr) {
+        const bool sf = w >> 31;
+        const uint8_t width = sf ? W64 : W32;
+        const uint32_t rd = bits(w, 4, 0);
+        const uint32_t rn = bits(w, 9, 5);
+        const uint32_t rm = bits(w, 20, 16);
+        const uint64_t shifted_rm = make_shifted_reg(xreg(rm), static_cast<uint8_t>(bits(w, 23, 22)),
+                                                     static_cast<uint8_t>(bits(w, 15, 10)));
+
+        if ((w & 0x1F000000) == 0x0A000000) {
+            // Logical (shifted register)
+            const uint32_t opc = bits(w, 30, 29);
+            const bool negate = bits(w, 21, 21);
+            if (opc == 1 && rn == 31 && !negate) {
+                a64_emit(instr, IROpcode::MOV, width, OPK_REG, xreg(rd), OPK_REG, shifted_rm);
+            } else if (opc == 1 && rn == 31 && negate) {
+                a64_emit(instr, IROpcode::NOT, width, OPK_REG, xreg(rd), OPK_REG, shifted_rm);
+            } else if (!negate) {
+                if (opc == 3 && rd == 31) {
+                    a64_emit(instr, IROpcode::TEST, width, OPK_REG, xreg(rn), OPK_REG, shifted_rm);
+                } else {
+                    static constexpr IROpcode kOps[4] = { IROpcode::AND, IROpcode::OR, IROpcode::XOR, IROpcode::AND };
+                    a64_emit(instr, kOps[opc], width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_REG, shifted_rm);
+                    if (opc == 3) instr.attr |= IR_ATTR_SETS_FLAGS;  // ANDS
+                }
+            }
+            // BIC/ORN/EON/BICS stay UNKNOWN
+        } else if ((w & 0x1F000000) == 0x0B000000) {
+            // ADD/SUB (shifted or extended register)
+            const bool sub = bits(w, 30, 30);
+            const bool flags = bits(w, 29, 29);
+            const bool extended = bits(w, 21, 21);
+            uint64_t src2 = shifted_rm;
+            uint8_t dst = xreg(rd);
+            uint8_t src1 = xreg(rn);
+            if (extended) {
+                src2 = make_shifted_reg(xreg(rm), 0, static_cast<uint8_t>(bits(w, 12, 10)),
+                                        static_cast<uint8_t>(bits(w, 15, 13) + 1));
+                dst = xreg(rd, !flags);
+                src1 = xreg(rn, true);
+            }
+            if (flags && sub && rd == 31) {
+                a64_emit(instr, IROpcode::CMP, width, OPK_REG, src1, OPK_REG, src2);
+            } else if (sub && !extended && rn == 31) {
+                a64_emit(instr, IROpcode::NEG, width, OPK_REG, dst, OPK_REG, src2);
+                if (flags) instr.attr |= IR_ATTR_SETS_FLAGS;         // NEGS
+            } else {
+                a64_emit(instr, sub ? IROpcode::SUB : IROpcode::ADD, width,
+                         OPK_REG, dst, OPK_REG, src1, OPK_REG, src2);
+                if (flags) instr.attr |= IR_ATTR_SETS_FLAGS;         // ADDS/SUBS, CMN
+            }
+        } else if ((w & 0x1FE0FC00) == 0x1A000000) {
+            // ADC / SBC, ADCS / SBCS
+            a64_emit(instr, bits(w, 30, 30) ? IROpcode::SBB : IROpcode::ADC, width,
+                     OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_REG, xreg(rm));
+            if (bits(w, 29, 29)) instr.attr |= IR_ATTR_SETS_FLAGS;
+        } else if ((w & 0x1FE00800) == 0x1A800000) {
+            // Conditional select: CSET/CSETM and CSEL rd, rn, rd are expressible
+            const uint32_t cond = bits(w, 15, 12);
+            const uint32_t op = (bits(w, 30, 30) << 1) | bits(w, 10, 10);
+            if ((op == 1 || op == 2) && rn == 31 && rm == 31 && cond < 14) {
+                a64_emit(instr, IROpcode::SETCC, width, OPK_REG, xreg(rd), OPK_IMM, cond ^ 1);
+                if (op == 2) instr.attr |= IR_ATTR_SIGNED;           // CSETM: all ones
+            } else if (op == 0 && rm == rd) {
+                a64_emit(instr, IROpcode::CMOV, width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_IMM, cond);
+            }
+        } else if ((w & 0x5FE00000) == 0x1AC00000) {
+            // Data processing (2 source)
+            IROpcode op = IROpcode::UNKNOWN;
+            switch (bits(w, 15, 10)) {
+                case 0x02: op = IROpcode::DIV; break;
+                case 0x03: op = IROpcode::DIV; instr.attr |= IR_ATTR_SIGNED; break;  // SDIV
+                case 0x08: op = IROpcode::SHL; break;
+                case 0x09: op = IROpcode::SHR; break;
+                case 0x0A: op = IROpcode::SAR; break;
+                case 0x0B: op = IROpcode::ROR; break;
+                default: return;
+            }
+            a64_emit(instr, op, width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_REG, xreg(rm));
+        } else if ((w & 0x1F000000) == 0x1B000000) {
+            // Data processing (3 source): MUL/SMULL/UMULL when the addend is XZR.
+            // S/UMULL multiply W registers into an X register: WIDE, W32 operands.
+            const uint32_t op31 = bits(w, 23, 21);
+            if (bits(w, 14, 10) != 31 || bits(w, 15, 15)) return;              // MADD/MSUB with an addend
+            if (op31 == 0) {
+                a64_emit(instr, IROpcode::MUL, width, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_REG, xreg(rm));
+            } else if ((op31 == 1 || op31 == 5) && sf) {
+                a64_emit(instr, IROpcode::MUL, W32, OPK_REG, xreg(rd), OPK_REG, xreg(rn), OPK_REG, xreg(rm));
+                instr.attr |= IR_ATTR_WIDE | (op31 == 1 ? IR_ATTR_SIGNED : 0);
+            }
+        }
+    }
+
+    // Scalar floating-point and Advanced SIMD (bits 27:25 = 111)
+    static void a64_simd(uint32_t w, uint64_t, IRInstruction& instr) {
+        const uint32_t rd = bits(w, 4, 0);
+        const uint32_t rn = bits(w, 9, 5);
+        const uint32_t rm = bits(w, 20, 16);
+
+        if ((w & 0x5F200C00) == 0x1E200800) {
+            // Floating-point data processing (2 source)
+            static constexpr IROpcode kOps[4] = { IROpcode::V_MUL, IROpcode::V_DIV, IROpcode::V_ADD, IROpcode::V_SUB };
+            const uint32_t opcode = bits(w, 15, 12);
+            if (opcode < 4) {
+                a64_emit(instr, kOps[opcode], W64, OPK_REG, vreg(rd), OPK_REG, vreg(rn), OPK_REG, vreg(rm));
+            }
+        } else if ((w & 0xFF3FFC00) == 0x1E204000) {
+            a64_emit(instr, IROpcode::V_MOV, W64, OPK_REG, vreg(rd), OPK_REG, vreg(rn));   // FMOV (register)
+        } else if ((w & 0x7F36FC00) == 0x1E260000) {
+            // FMOV between general and FP registers
+            const bool to_fp = bits(w, 16, 16);
+            const uint8_t width = (w >> 31) ? W64 : W32;
+            if (to_fp) a64_emit(instr, IROpcode::V_MOV, width, OPK_REG, vreg(rd), OPK_REG, xreg(rn));
+            else a64_emit(instr, IROpcode::V_MOV, width, OPK_REG, xreg(rd), OPK_REG, vreg(rn));
+        } else if ((w & 0xFF201FE0) == 0x1E201000) {
+            a64_emit(instr, IROpcode::V_MOV, W64, OPK_REG, vreg(rd), OPK_IMM, bits(w, 20, 13)); // FMOV (imm8)
+        } else if ((w & 0xFF20FC07) == 0x1E202000) {
+            a64_emit(instr, IROpcode::V_CMP, W64, OPK_REG, vreg(rn), OPK_REG, vreg(rm));      // FCMP
+        } else if ((w & 0x9F200400) == 0x0E200400) {
+            // Advanced SIMD three same
+            const bool u = bits(w, 29, 29);
+            const uint32_t size = bits(w, 23, 22);
+            IROpcode op = IROpcode::UNKNOWN;
+            switch (bits(w, 15, 11)) {
+                case 0x10: op = u ? IROpcode::V_SUB : IROpcode::V_ADD; break;
+                case 0x13: if (!u) op = IROpcode::V_MUL; break;
+                case 0x03:
+                    if (u) op = size == 0 ? IROpcode::V_XOR : IROpcode::UNKNOWN;
+                    else if (size == 0) op = IROpcode::V_AND;
+                    else if (size == 2) op = rn == rm ? IROpcode::V_MOV : IROpcode::V_OR;
+                    break;
+                case 0x1A: if (!u) op = (size & 2) ? IROpcode::V_SUB : IROpcode::V_ADD; break;
+                case 0x1B: if (u && !(size & 2)) op = IROpcode::V_MUL; break;
+                case 0x1F: if (u && !(size & 2)) op = IROpcode::V_DIV; break;
+                default: break;
+            }
+            if (op == IROpcode::V_MOV) {
+                a64_emit(instr, op, W64, OPK_REG, vreg(rd), OPK_REG, vreg(rn));
+            } else if (op != IROpcode::UNKNOWN) {
+                a64_emit(instr, op, W64, OPK_REG, vreg(rd), OPK_REG, vreg(rn), OPK_REG, vreg(rm));
+            }
+        }
+    }
+
+    // Top-level A64 encoding groups, indexed by bits 28:25
+    static constexpr A64Handler kA64Groups[16] = {
+        a64_unallocated, a64_unallocated, a64_unallocated, a64_unallocated,
+        a64_ldst, a64_dp_reg, a64_ldst, a64_simd,
+        a64_dp_imm, a64_dp_imm, a64_branch, a64_branch,
+        a64_ldst, a64_dp_reg, a64_ldst, a64_simd
+    };
 };
 
+// Recursive-descent CFG discovery on top of Lifter::decode. Blocks are
+// lifted in discovery order, each into a contiguous IR range; a branch into
+// the middle of an already lifted block splits it at that instruction.
+class CfgBuilder {
+public:
+    CfgBuilder(const uint8_t* code, size_t length, uint64_t base, Arch arch,
+               Lifter& lifter, IRBlock* blocks, size_t max_blocks)
+        : code(code), length(length), base(base), arch(arch), lifter(lifter),
+          blocks(blocks), max_blocks(max_blocks), block_count(0) {
+        for (size_t i = 0; i < kBuckets; i++) buckets[i] = BLOCK_NONE;
+    }
+
+    size_t run(uint64_t entry) {
+        if (!in_range(entry) || block_or_new(entry) == BLOCK_NONE) return 0;
+        // The block table doubles as the work list
+        for (size_t i = 0; i < block_count; i++) {
+            if (!(blocks[i].flags & BLOCK_LIFTED)) lift(static_cast<uint32_t>(i));
+        }
+        return block_count;
+    }
+
+private:
+    static constexpr size_t kBuckets = 1024;
+
+    const uint8_t* code;
+    size_t length;
+    uint64_t base;
+    Arch arch;
+    Lifter& lifter;
+    IRBlock* blocks;
+    size_t max_blocks;
+    size_t block_count;
+    uint32_t buckets[kBuckets];
+
+    bool in_range(uint64_t addr) const { return addr >= base && addr - base < length; }
+
+    static size_t bucket_of(uint64_t addr) {
+        return static_cast<size_t>((addr * 0x9E3779B97F4A7C15ull) >> 54) & (kBuckets - 1);
+    }
+
+    uint32_t find(uint64_t addr) const {
+        for (uint32_t b = buckets[bucket_of(addr)]; b != BLOCK_NONE; b = blocks[b].link) {
+            if (blocks[b].start == addr) return b;
+        }
+        return BLOCK_NONE;
+    }
+
+    uint32_t append(uint64_t start) {
+        if (block_count >= max_blocks) return BLOCK_NONE;
+        const uint32_t b = static_cast<uint32_t>(block_count++);
+        IRBlock& blk = blocks[b];
+        blk.start = start;
+        blk.end = start;
+        blk.first_ir = 0;
+        blk.ir_count = 0;
+        blk.succ[0] = BLOCK_NONE;
+        blk.succ[1] = BLOCK_NONE;
+        blk.flags = 0;
+        const size_t h = bucket_of(start);
+        blk.link = buckets[h];
+        buckets[h] = b;
+        return b;
+    }
+
+    // Block starting at `addr`, splitting a lifted block that contains it on
+    // an instruction boundary, or a new pending block
+    uint32_t block_or_new(uint64_t addr) {
+        const uint32_t found = find(addr);
+        if (found != BLOCK_NONE) return found;
+
+        for (uint32_t b = 0; b < block_count; b++) {
+            const IRBlock& blk = blocks[b];
+            if (!(blk.flags & BLOCK_LIFTED) || addr <= blk.start || addr >= blk.end) continue;
+            for (uint32_t i = 1; i < blk.ir_count; i++) {
+                if (lifter.ir_buffer[blk.first_ir + i].address == addr) return split(b, i);
+            }
+        }
+        // Unseen, or inside an instruction: decode the (overlapping) stream separately
+        return append(addr);
+    }
+
+    uint32_t split(uint32_t b, uint32_t at) {
+        const uint64_t addr = lifter.ir_buffer[blocks[b].first_ir + at].address;
+        const uint32_t tail = append(addr);
+        if (tail == BLOCK_NONE) return BLOCK_NONE;
+
+        IRBlock& head = blocks[b];
+        IRBlock& t = blocks[tail];
+        t.end = head.end;
+        t.first_ir = head.first_ir + at;
+        t.ir_count = head.ir_count - at;
+        t.succ[0] = head.succ[0];
+        t.succ[1] = head.succ[1];
+        t.flags = head.flags;
+
+        head.end = addr;
+        head.ir_count = at;
+        head.succ[0] = tail;
+        head.succ[1] = BLOCK_NONE;
+        head.flags = BLOCK_LIFTED;
+        return tail;
+    }
+
+    uint32_t successor(uint32_t from, uint64_t addr) {
+        if (!in_range(addr)) {
+            blocks[from].flags |= BLOCK_EXTERNAL;
+            return BLOCK_NONE;
+        }
+        const uint32_t b = block_or_new(addr);
+        if (b == BLOCK_NONE) blocks[from].flags |= BLOCK_TRUNCATED;
+        return b;
+    }
+
+    void lift(uint32_t b) {
+        const uint64_t start = blocks[b].start;
+        const uint32_t first = static_cast<uint32_t>(lifter.count);
+        uint64_t pc = start;
+        uint32_t flags = BLOCK_LIFTED;
+        // Successor addresses, resolved once the block's extent is final
+        uint64_t targets[2];
+        bool has_target[2] = { false, false };
+
+        for (;;) {
+            if (lifter.count >= lifter.max_capacity || !in_range(pc)) {
+                flags |= BLOCK_TRUNCATED;
+                break;
+            }
+            const size_t offset = static_cast<size_t>(pc - base);
+            IRInstruction& instr = lifter.ir_buffer[lifter.count];
+            const size_t size = Lifter::decode(code + offset, length - offset, pc, arch, instr);
+            if (size == 0) {
+                flags |= BLOCK_TRUNCATED;
+                break;
+            }
+            lifter.count++;
+            pc += size;
+
+            const bool direct = ir_operand_kind(instr.info, 0) == OPK_IMM;
+            bool ends = true;
+            switch (instr.opcode) {
+                case IROpcode::JMP:
+                    if (direct) { targets[0] = instr.op1; has_target[0] = true; }
+                    else flags |= BLOCK_INDIRECT;
+                    break;
+                case IROpcode::JE:
+                case IROpcode::JNE:
+                case IROpcode::JCC:
+                    targets[0] = pc;
+                    has_target[0] = true;
+                    if (direct) { targets[1] = instr.op1; has_target[1] = true; }
+                    break;
+                case IROpcode::RET:
+                    flags |= BLOCK_RET;
+                    break;
+                case IROpcode::TRAP:
+                    flags |= BLOCK_TRAP;
+                    break;
+                default:
+                    ends = false;
+                    break;
+            }
+            if (ends) break;
+
+            // Fall into a block discovered earlier
+            if (find(pc) != BLOCK_NONE) {
+                targets[0] = pc;
+                has_target[0] = true;
+                break;
+            }
+        }
+
+        IRBlock& blk = blocks[b];
+        blk.end = pc;
+        blk.first_ir = first;
+        blk.ir_count = static_cast<uint32_t>(lifter.count) - first;
+        blk.flags = flags;
+
+        uint32_t succ[2] = { BLOCK_NONE, BLOCK_NONE };
+        for (int i = 0; i < 2; i++) {
+            if (has_target[i]) succ[i] = successor(b, targets[i]);
+        }
+
+        // A back edge into this block moves the terminator into the tail piece
+        uint32_t last = b;
+        while (blocks[last].end != pc) last = blocks[last].succ[0];
+        blocks[last].succ[0] = succ[0];
+        blocks[last].succ[1] = succ[1];
+        blocks[last].flags |= blocks[b].flags & ~BLOCK_LIFTED;
+        if (last != b) blocks[b].flags = BLOCK_LIFTED;
+    }
+};
+
+// Resumable linear lift over a byte stream. The handle lives in caller
+// memory followed by a ring of IR records: feed() decodes into the ring until
+// it is full and keeps a trailing partial instruction for the next call,
+// drain() hands records out in order and finish() ends the input.
+class LiftStream {
+public:
+    static constexpr uint32_t kMagic = 0x4C465354; // "LFST"
+    static constexpr size_t kMaxInstructionBytes = Lifter::kX86MaxLength;
+
+    static size_t bytes_for(size_t capacity) {
+        return sizeof(LiftStream) + capacity * sizeof(IRInstruction);
+    }
+
+    static LiftStream* create(void* mem, size_t bytes, uint64_t entry, Arch arch) {
+        if (!mem || (reinterpret_cast<uintptr_t>(mem) & 7) || bytes < bytes_for(1)) return nullptr;
+        if (arch != Arch::X86 && arch != Arch::X86_64 && arch != Arch::ARM64) return nullptr;
+        LiftStream* s = static_cast<LiftStream*>(mem);
+        s->magic = kMagic;
+        s->arch = arch;
+        s->pc = entry;
+        s->capacity = static_cast<uint32_t>((bytes - sizeof(LiftStream)) / sizeof(IRInstruction));
+        s->head = 0;
+        s->size = 0;
+        s->pending_len = 0;
+        return s;
+    }
+
+    bool valid() const { return magic == kMagic; }
+    void destroy() { magic = 0; }
+    uint64_t next_pc() const { return pc; }
+    size_t pending_bytes() const { return pending_len; }
+
+    // Returns the number of input bytes consumed; fewer than `len` means the
+    // ring is full and the rest must be fed again after a drain.
+    size_t feed(const uint8_t* code, size_t len) {
+        size_t used = 0;
+        while (size < capacity) {
+            IRInstruction& slot = ring()[(head + size) % capacity];
+            size_t n;
+            if (pending_len) {
+                // Complete the carried-over instruction from the new bytes
+                uint8_t joined[2 * kMaxInstructionBytes];
+                const size_t take = len - used < kMaxInstructionBytes ? len - used : kMaxInstructionBytes;
+                copy(joined, pending, pending_len);
+                copy(joined + pending_len, code + used, take);
+                n = Lifter::decode(joined, pending_len + take, pc, arch, slot);
+                if (n == 0) {
+                    // decode() only waits below kMaxInstructionBytes
+                    if (pending_len + take >= kMaxInstructionBytes) return used;
+                    copy(pending + pending_len, code + used, take);
+                    pending_len = static_cast<uint8_t>(pending_len + take);
+                    return used + take;
+                }
+                if (n < pending_len) {
+                    copy(pending, pending + n, pending_len - n);
+                    pending_len = static_cast<uint8_t>(pending_len - n);
+                } else {
+                    used += n - pending_len;
+                    pending_len = 0;
+                }
+            } else {
+                if (used == len) break;
+                n = Lifter::decode(code + used, len - used, pc, arch, slot);
+                if (n == 0) {
+                    // Truncated: keep the tail, shorter than kMaxInstructionBytes
+                    if (len - used >= kMaxInstructionBytes) break;
+                    pending_len = static_cast<uint8_t>(len - used);
+                    copy(pending, code + used, pending_len);
+                    return len;
+                }
+                used += n;
+            }
+            pc += n;
+            size++;
+        }
+        return used;
+    }
+
+    // End of input: a held partial instruction becomes one UNKNOWN record
+    // covering its bytes, so the tail is never dropped silently. Returns the
+    // records added; 0 with bytes still pending means the ring is full.
+    size_t finish() {
+        if (!pending_len || size == capacity) return 0;
+        IRInstruction& slot = ring()[(head + size) % capacity];
+        slot.opcode = IROpcode::UNKNOWN;
+        slot.address = pc;
+        slot.size = pending_len;
+        slot.info = 0;
+        slot.attr = 0;
+        slot.op1 = slot.op2 = slot.op3 = 0;
+        pc += pending_len;
+        pending_len = 0;
+        size++;
+        return 1;
+    }
+
+    size_t drain(IRInstruction* out, size_t max) {
+        size_t n = 0;
+        while (n < max && size > 0) {
+            out[n++] = ring()[head];
+            head = (head + 1) % capacity;
+            size--;
+        }
+        return n;
+    }
+
+private:
+    uint32_t magic;
+    Arch arch;
+    uint64_t pc;        // Address of the next undecoded byte (start of `pending`)
+    uint32_t capacity;
+    uint32_t head;      // Oldest undrained record
+    uint32_t size;      // Undrained records
+    uint8_t pending_len;
+    uint8_t pending[kMaxInstructionBytes];
+
+    IRInstruction* ring() { return reinterpret_cast<IRInstruction*>(this + 1); }
+
+    static void copy(uint8_t* dst, const uint8_t* src, size_t n) {
+        for (size_t i = 0; i < n; i++) dst[i] = src[i];
+    }
+};
+
+static_assert(sizeof(LiftStream) % alignof(IRInstruction) == 0, "IR ring must follow the header aligned");
+
+// Runs the peephole pass over every block of a lift_cfg result. Flag
+// liveness is solved across the CFG first so that a block whose successors
+// overwrite the flags can drop its own. Blocks are compacted within their
+// own IR range; the IR buffer may be left with gaps.
+static void optimize_blocks(IRInstruction* ir, IRBlock* blocks, size_t block_count, Arch arch) {
+    const uint32_t opaque = BLOCK_INDIRECT | BLOCK_EXTERNAL | BLOCK_TRUNCATED | BLOCK_RET | BLOCK_TRAP;
+    auto live_out = [&](const IRBlock& blk) -> uint8_t {
+        if (blk.flags & opaque) return Peephole::FLAGS_ALL;
+        uint8_t live = 0;
+        for (int s = 0; s < 2; s++) {
+            if (blk.succ[s] != BLOCK_NONE) live |= static_cast<uint8_t>(blocks[blk.succ[s]].link);
+        }
+        return live;
+    };
+
+    for (size_t b = 0; b < block_count; b++) blocks[b].link = 0;
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (size_t b = block_count; b-- > 0;) {
+            IRBlock& blk = blocks[b];
+            const uint8_t in = Peephole::live_in(ir + blk.first_ir, blk.ir_count, arch, live_out(blk));
+            if (in != blk.link) {
+                blk.link = in;
+                changed = true;
+            }
+        }
+    }
+
+    for (size_t b = 0; b < block_count; b++) {
+        IRBlock& blk = blocks[b];
+        blk.ir_count = static_cast<uint32_t>(Peephole::run(ir + blk.first_ir, blk.ir_count, arch, live_out(blk)));
+    }
+}
+
+// Heap for the caller's code images and IR buffers: the lifter's own arena
+// above __heap_base until lifter_attach_arena() moves it onto the arena
+// shared with the other modules on the same memory. Built for that memory,
+// the own arena ends with the lifter's window (ARENA_HEAP_LIMIT), so
+// allocating before attaching fails rather than overrunning the codec's.
+static WasmArena lifter_own_heap;
+static WasmArena* lifter_heap_arena = nullptr;
+static uint32_t lifter_heap_blocks = 0;
+
+static WasmArena* lifter_heap() {
+    if (!lifter_heap_arena) {
+        arena_init_heap(&lifter_own_heap);
+        lifter_heap_arena = &lifter_own_heap;
+    }
+    return lifter_heap_arena;
+}
+
 extern "C" {
     WASM_EXPORT int lift_code_multi_arch(
         const uint8_t* code, 
@@ -130,4 +1309,190 @@ extern "C" {
         lifter.lift_block(code, length, entry_point, static_cast<Arch>(arch_id));
         return lifter.count;
     }
+
+    // Like lift_code_multi_arch, but ends after the first branch, call,
+    // return, trap or system call. Returns the instruction count.
+    WASM_EXPORT int lift_basic_block(
+        const uint8_t* code,
+        size_t length,
+        uint64_t entry_point,
+        int arch_id,
+        IRInstruction* out_ir,
+        size_t max_out
+    ) {
+        Lifter lifter(out_ir, max_out);
+        return static_cast<int>(lifter.lift_basic_block(code, length, entry_point, static_cast<Arch>(arch_id)));
+    }
+
+    // Linear lift into the struct-of-arrays layout at `out` (soa_bytes(max_out,
+    // pool_words) bytes, 4-byte aligned). Returns the instruction count.
+    WASM_EXPORT int lift_code_soa(
+        const uint8_t* code,
+        size_t length,
+        uint64_t entry_point,
+        int arch_id,
+        void* out,
+        size_t max_out,
+        size_t pool_words
+    ) {
+        const IRSoA soa = soa_layout(out, max_out);
+        return static_cast<int>(Lifter::lift_soa(code, length, entry_point, static_cast<Arch>(arch_id),
+                                                 soa, max_out, pool_words));
+    }
+
+    // Recursive-descent lift from `entry_point`, where code[0] sits at guest
+    // address `base_address`. Writes one IRBlock per discovered block and the
+    // IR they reference; returns the block count and stores the number of IR
+    // records in *out_ir_count when it is non-null.
+    WASM_EXPORT int lift_cfg(
+        const uint8_t* code,
+        size_t length,
+        uint64_t base_address,
+        uint64_t entry_point,
+        int arch_id,
+        IRInstruction* out_ir,
+        size_t max_out,
+        IRBlock* out_blocks,
+        size_t max_blocks,
+        uint32_t* out_ir_count
+    ) {
+        Lifter lifter(out_ir, max_out);
+        CfgBuilder cfg(code, length, base_address, static_cast<Arch>(arch_id), lifter, out_blocks, max_blocks);
+        const size_t blocks = cfg.run(entry_point);
+        if (out_ir_count) *out_ir_count = static_cast<uint32_t>(lifter.count);
+        return static_cast<int>(blocks);
+    }
+
+    // Allocate from the arena whose header is at `arena` (wasm-arena.h); the
+    // first module to attach initializes it. Returns 0, or -1 while the
+    // lifter still holds blocks of its current arena.
+    WASM_EXPORT int lifter_attach_arena(WasmArena* arena) {
+        if (!arena || lifter_heap_blocks) return -1;
+        lifter_heap_arena = arena_attach(arena);
+        return 0;
+    }
+
+    // 16-byte aligned block, or NULL when memory cannot grow
+    WASM_EXPORT void* lifter_alloc(size_t size) {
+        void* ptr = arena_alloc(lifter_heap(), size);
+        if (ptr) lifter_heap_blocks++;
+        return ptr;
+    }
+
+    WASM_EXPORT void lifter_free(void* ptr) {
+        if (!ptr) return;
+        arena_free(lifter_heap(), ptr);
+        lifter_heap_blocks--;
+    }
+
+    // Counters since the last reset (native-counters.h), in a static struct
+    // that the next call overwrites
+    WASM_EXPORT const NativeCounters* get_counters(int reset) {
+        static NativeCounters snapshot;
+        return counters_snapshot(&lifter_counters, lifter_heap(), &snapshot, reset);
+    }
+
+    // Streaming lift. The caller owns the handle's memory (8-byte aligned,
+    // lifter_stream_bytes(capacity) bytes for a ring of `capacity` records).
+    WASM_EXPORT size_t lifter_stream_bytes(size_t capacity) {
+        return LiftStream::bytes_for(capacity);
+    }
+
+    WASM_EXPORT LiftStream* lifter_stream_create(void* mem, size_t bytes, uint64_t entry_point, int arch_id) {
+        return LiftStream::create(mem, bytes, entry_point, static_cast<Arch>(arch_id));
+    }
+
+    // Consumes bytes following the previous feed; returns how many were taken
+    WASM_EXPORT size_t lifter_stream_feed(LiftStream* stream, const uint8_t* code, size_t length) {
+        return stream && stream->valid() ? stream->feed(code, length) : 0;
+    }
+
+    WASM_EXPORT size_t lifter_stream_drain(LiftStream* stream, IRInstruction* out_ir, size_t max_out) {
+        return stream && stream->valid() ? stream->drain(out_ir, max_out) : 0;
+    }
+
+    // No more input: emits a partial trailing instruction as UNKNOWN
+    WASM_EXPORT size_t lifter_stream_finish(LiftStream* stream) {
+        return stream && stream->valid() ? stream->finish() : 0;
+    }
+
+    // Resume address: the first byte not yet part of a lifted instruction
+    WASM_EXPORT uint64_t lifter_stream_pc(LiftStream* stream) {
+        return stream && stream->valid() ? stream->next_pc() : 0;
+    }
+
+    // Bytes held back as a partial instruction
+    WASM_EXPORT size_t lifter_stream_pending(LiftStream* stream) {
+        return stream && stream->valid() ? stream->pending_bytes() : 0;
+    }
+
+    WASM_EXPORT void lifter_stream_destroy(LiftStream* stream) {
+        if (stream) stream->destroy();
+    }
+
+    // Peephole pass over one straight-line block (flags assumed live on
+    // exit). Returns the new instruction count.
+    WASM_EXPORT int optimize_ir(IRInstruction* ir, size_t count, int arch_id) {
+        return static_cast<int>(Peephole::run(ir, count, static_cast<Arch>(arch_id)));
+    }
+
+    // Peephole pass over a lift_cfg result, updating each block's ir_count
+    WASM_EXPORT void optimize_cfg(IRInstruction* ir, IRBlock* blocks, size_t block_count, int arch_id) {
+        optimize_blocks(ir, blocks, block_count, static_cast<Arch>(arch_id));
+    }
+
+    // WASM function body (locals + code) for one block of lifted IR, see
+    // wasm_emitter.h. Returns the bytes written to `out`, 0 on failure.
+    WASM_EXPORT int emit_wasm_body(
+        const IRInstruction* ir,
+        size_t count,
+        int arch_id,
+        uint32_t guest_base,
+        uint8_t* out,
+        size_t capacity
+    ) {
+        WasmEmitter emitter(out, capacity, static_cast<Arch>(arch_id), guest_base);
+        return static_cast<int>(emitter.emit_function(ir, count));
+    }
+
+    // As emit_wasm_body, wrapped in a module that imports env.memory and
+    // exports the block as run(state) -> next_pc. With `dirty_pages` (a power
+    // of two, 0 for none), stores mark their pages in the map at `dirty_map`.
+    WASM_EXPORT int emit_wasm_module(
+        const IRInstruction* ir,
+        size_t count,
+        int arch_id,
+        uint32_t guest_base,
+        int shared_memory,
+        uint32_t dirty_map,
+        uint32_t dirty_pages,
+        uint8_t* out,
+        size_t capacity
+    ) {
+        WasmEmitter emitter(out, capacity, static_cast<Arch>(arch_id), guest_base, dirty_map, dirty_pages);
+        return static_cast<int>(emitter.emit_module(ir, count, shared_memory != 0));
+    }
+
+    // Lift the basic block at `entry_point`, run the peephole pass and emit
+    // it as a module in one call. `ir_scratch` holds max_ir records.
+    WASM_EXPORT int lift_and_emit(
+        const uint8_t* code,
+        size_t length,
+        uint64_t entry_point,
+        int arch_id,
+        uint32_t guest_base,
+        int shared_memory,
+        uint32_t dirty_map,
+        uint32_t dirty_pages,
+        IRInstruction* ir_scratch,
+        size_t max_ir,
+        uint8_t* out,
+        size_t capacity
+    ) {
+        const Arch arch = static_cast<Arch>(arch_id);
+        Lifter lifter(ir_scratch, max_ir);
+        const size_t count = Peephole::run(ir_scratch, lifter.lift_basic_block(code, length, entry_point, arch), arch);
+        WasmEmitter emitter(out, capacity, arch, guest_base, dirty_map, dirty_pages);
+        return static_cast<int>(emitter.emit_module(ir_scratch, count, shared_memory != 0));
+    }
 }
@@ -0,0 +1,226 @@
+// Freestanding C++ Lifter - Shared IR Definitions
+// Included by lifter.cpp and the decoder tables
+// No stdlib dependencies to ensure smooth WASM compilation
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#define WASM_EXPORT __attribute__((visibility("default")))
+
+enum class Arch {
+    X86 = 0,    // IA-32 / protected mode
+    ARM64 = 1,
+    RISCV = 2,
+    X86_64 = 3  // Long mode (REX, RIP-relative addressing)
+};
+
+// Mirrored by IROpcode in lib/transpiler/lifter.ts - keep the order in sync
+enum class IROpcode {
+    // ALU
+    ADD, SUB, MUL, DIV, AND, OR, XOR, SHL, SHR,
+    SAR, ROL, ROR, ADC, SBB, NEG, NOT, INC, DEC, CMP, TEST,
+    // Data Movement
+    MOV, MOVZX, MOVSX, LEA, XCHG, CMOV, SETCC,
+    // Memory
+    LOAD, STORE, PUSH, POP,
+    // Control Flow
+    JMP, JE, JNE, JCC, CALL, RET,
+    // SIMD
+    V_ADD, V_SUB, V_MUL, V_DIV, V_AND, V_OR, V_XOR, V_MOV, V_CMP,
+    // System
+    SYSCALL, NOP, TRAP, UNKNOWN
+};
+
+struct IRInstruction {
+    IROpcode opcode;
+    uint64_t address;
+    uint8_t size;
+    uint8_t info;   // Operand kinds + width, see ir_info()
+    uint8_t attr;   // IRAttr bits, set by the peephole pass
+    uint64_t op1;
+    uint64_t op2;
+    uint64_t op3; // For ARM/RISC-V 3-operand instrs
+};
+
+// ---------------------------------------------------------------------------
+// Operand encoding
+//
+// IRInstruction::info packs two bits of OperandKind per operand (op1 in bits
+// 0-1, op2 in 2-3, op3 in 4-5) and the integer operation width in bits 6-7
+// (0 = 8, 1 = 16, 2 = 32, 3 = 64 bits).
+//
+// REG operands hold a register id (below), IMM operands a sign-extended
+// immediate, MEM operands a packed address (see make_mem). Direct branch and
+// call targets are IMM operands in op1 holding the absolute guest address.
+// Conditional forms carry the condition code (in the guest architecture's
+// own numbering) as an IMM operand: JCC in op2, SETCC in op2, CMOV in op3.
+// LOAD is (dest, mem[, dest2]) and STORE is (mem, src[, src2]).
+// MOV with a third IMM operand inserts op2 at bit offset op3 (ARM64 MOVK).
+// ---------------------------------------------------------------------------
+
+// FLAGS_DEAD and REMOVED come from the peephole pass; the others from the
+// decoder, for ARM64 forms that share an opcode with a plainer one:
+//   SETS_FLAGS  ADDS/SUBS/ANDS/NEGS/ADCS/SBCS (x86 ALU forms always set them)
+//   SIGNED      LOAD sign-extends the value read (LDRSB/LDRSH/LDRSW/LDPSW),
+//               MUL is SMULL, DIV is SDIV, SETCC writes all ones when true (CSETM)
+//   WIDE        64-bit result of narrower operands: LOAD of a sign-extended
+//               value into an X register, MUL of two W registers (S/UMULL)
+// The width in `info` stays the access/operand width in every case.
+enum IRAttr : uint8_t {
+    IR_ATTR_FLAGS_DEAD = 1u << 0,   // Flags written by this instruction are never read
+    IR_ATTR_REMOVED = 1u << 1,      // Deleted by the peephole pass (compacted away)
+    IR_ATTR_SETS_FLAGS = 1u << 2,
+    IR_ATTR_SIGNED = 1u << 3,
+    IR_ATTR_WIDE = 1u << 4
+};
+
+enum OperandKind : uint8_t {
+    OPK_NONE = 0,
+    OPK_REG = 1,
+    OPK_IMM = 2,
+    OPK_MEM = 3
+};
+
+enum OperandWidth : uint8_t {
+    W8 = 0, W16 = 1, W32 = 2, W64 = 3
+};
+
+static constexpr uint8_t ir_info(uint8_t k1, uint8_t k2, uint8_t k3, uint8_t width) {
+    return static_cast<uint8_t>(k1 | (k2 << 2) | (k3 << 4) | (width << 6));
+}
+
+static constexpr uint8_t ir_operand_kind(uint8_t info, int slot) {
+    return (info >> (slot * 2)) & 3;
+}
+
+static constexpr uint8_t ir_width(uint8_t info) {
+    return info >> 6;
+}
+
+// Register ids shared by all guest architectures
+enum : uint8_t {
+    REG_GPR0 = 0,    // 0-31: x86 RAX..R15, ARM64 X0..X30 and SP (31)
+    REG_VEC0 = 32,   // 32-63: XMM/YMM/ZMM 0-31, ARM64 V0-V31
+    REG_PC = 64,     // RIP / PC for PC-relative memory operands
+    REG_ZR = 65,     // ARM64 XZR/WZR
+    REG_AH = 66,     // x86 legacy high-byte registers AH, CH, DH, BH
+    REG_SEG0 = 70,   // x86 segment registers ES, CS, SS, DS, FS, GS
+    REG_NONE = 0xFF
+};
+
+// x86 condition codes beyond the 16 encoded in Jcc/SETcc/CMOVcc
+enum : uint8_t {
+    CC_X86_LOOPNE = 16,
+    CC_X86_LOOPE = 17,
+    CC_X86_LOOP = 18,
+    CC_X86_JCXZ = 19
+};
+
+// Shifted/extended register operands (ARM64) keep the modifier above the
+// register id: bits 8-9 shift type (LSL, LSR, ASR, ROR), bits 10-15 shift
+// amount, bits 16-19 extend (0 = none, 1-8 = UXTB..SXTX). Consumers that
+// only need the register read the low byte.
+static constexpr uint64_t make_shifted_reg(uint8_t reg, uint8_t type, uint8_t amount, uint8_t extend = 0) {
+    return reg | (static_cast<uint64_t>(type & 3) << 8) | (static_cast<uint64_t>(amount & 0x3F) << 10)
+        | (static_cast<uint64_t>(extend & 0xF) << 16);
+}
+
+// Memory operand layout:
+//   bits  0-31 displacement (signed)
+//   bits 32-39 base register id (REG_NONE if absent)
+//   bits 40-47 index register id (REG_NONE if absent)
+//   bits 48-50 index scale (log2)
+//   bits 51-53 segment override (0 = default, 1-6 = ES..GS)
+//   bits 54-55 addressing mode (0 = offset, 1 = pre-index, 2 = post-index)
+//   bits 56-59 index extend, as in make_shifted_reg
+enum : uint8_t {
+    MEM_OFFSET = 0,
+    MEM_PRE_INDEX = 1,
+    MEM_POST_INDEX = 2
+};
+
+static constexpr uint64_t make_mem(uint8_t base, uint8_t index, uint8_t scale_log2, int32_t disp,
+                                   uint8_t seg = 0, uint8_t mode = MEM_OFFSET, uint8_t extend = 0) {
+    return static_cast<uint64_t>(static_cast<uint32_t>(disp))
+        | (static_cast<uint64_t>(base) << 32)
+        | (static_cast<uint64_t>(index) << 40)
+        | (static_cast<uint64_t>(scale_log2 & 7) << 48)
+        | (static_cast<uint64_t>(seg & 7) << 51)
+        | (static_cast<uint64_t>(mode & 3) << 54)
+        | (static_cast<uint64_t>(extend & 0xF) << 56);
+}
+
+static constexpr int32_t mem_disp(uint64_t m) { return static_cast<int32_t>(static_cast<uint32_t>(m)); }
+static constexpr uint8_t mem_base(uint64_t m) { return static_cast<uint8_t>(m >> 32); }
+static constexpr uint8_t mem_index(uint64_t m) { return static_cast<uint8_t>(m >> 40); }
+static constexpr uint8_t mem_scale(uint64_t m) { return (m >> 48) & 7; }
+static constexpr uint8_t mem_mode(uint64_t m) { return (m >> 54) & 3; }
+
+// ---------------------------------------------------------------------------
+// Struct-of-arrays output (lift_code_soa)
+//
+// One caller-provided region holds parallel arrays back to back so JS can
+// view each one with a typed array instead of decoding 48-byte records:
+//   opcodes[max], sizes[max], info[max]   uint8
+//   addresses[max]                         uint32, relative to entry_point
+//   operand_offsets[max + 1]               uint32, first pool word per instruction
+//   operand_pool[pool_words]               uint32
+// Operands are appended to the pool in slot order: REG takes one word, IMM
+// and MEM take two (low, high). operand_offsets[count] is the pool size used.
+// ---------------------------------------------------------------------------
+
+struct IRSoA {
+    uint8_t* opcodes;
+    uint8_t* sizes;
+    uint8_t* info;
+    uint32_t* addresses;
+    uint32_t* operand_offsets;
+    uint32_t* operand_pool;
+};
+
+static constexpr size_t soa_align4(size_t n) { return (n + 3) & ~static_cast<size_t>(3); }
+
+static constexpr size_t soa_bytes(size_t max, size_t pool_words) {
+    return soa_align4(3 * max) + 4 * (2 * max + 1 + pool_words);
+}
+
+static inline IRSoA soa_layout(void* base, size_t max) {
+    uint8_t* p = static_cast<uint8_t*>(base);
+    uint32_t* words = reinterpret_cast<uint32_t*>(p + soa_align4(3 * max));
+    return { p, p + max, p + 2 * max, words, words + max, words + 2 * max + 1 };
+}
+
+static constexpr uint32_t ir_operand_words(uint8_t kind) {
+    return kind == OPK_NONE ? 0 : (kind == OPK_REG ? 1 : 2);
+}
+
+// ---------------------------------------------------------------------------
+// Control-flow graph output (lift_cfg)
+//
+// Each block's instructions are contiguous in the IR buffer starting at
+// first_ir. For conditional branches succ[0] is the fallthrough block and
+// succ[1] the taken target; unconditional transfers use succ[0] only.
+// ---------------------------------------------------------------------------
+
+static constexpr uint32_t BLOCK_NONE = 0xFFFFFFFFu;
+
+enum IRBlockFlags : uint32_t {
+    BLOCK_LIFTED = 1u << 0,     // Instructions have been decoded
+    BLOCK_RET = 1u << 1,        // Ends in a return
+    BLOCK_INDIRECT = 1u << 2,   // Ends in an indirect jump (successors unknown)
+    BLOCK_TRAP = 1u << 3,       // Ends in a trap (UD2, INT3, BRK, HLT)
+    BLOCK_EXTERNAL = 1u << 4,   // A direct successor lies outside the code buffer
+    BLOCK_TRUNCATED = 1u << 5   // Stopped by buffer end or IR/block capacity
+};
+
+struct IRBlock {
+    uint64_t start;      // Guest address of the first instruction
+    uint64_t end;        // Guest address just past the last instruction
+    uint32_t first_ir;   // Index of the first instruction in the IR buffer
+    uint32_t ir_count;
+    uint32_t succ[2];    // Successor block indices, BLOCK_NONE if absent
+    uint32_t flags;      // IRBlockFlags
+    uint32_t link;       // Internal: hash chain during discovery, flag live-in in optimize_cfg
+};
@@ -0,0 +1,296 @@
+// Freestanding C++ Lifter - Benchmark Harness
+// Times lift_code_multi_arch over a corpus of code sections and reports
+// decoded instructions/s, bytes/s and the UNKNOWN opcode rate per
+// architecture, plus the buffer high-water marks of the paths whose use
+// depends on the code: records and blocks of the largest lift_cfg function
+// and records one stream drain returned. (The timed linear sweep has none;
+// every call fills min(max_out, instructions left) records.)
+//
+// Native: g++ -O2 -std=c++17 lifter_bench.cpp -o lifter_bench
+//         ./lifter_bench [-n iterations] [-m max_ir] /bin/ls arm64:text.bin@0x400000
+//   ELF inputs contribute every executable section (architecture from
+//   e_machine); raw inputs need an x86:, x86_64: or arm64: prefix.
+// WASM:   the same file built to wasm32 exports lifter_bench(); the caller
+//   times it (lib/transpiler/lifter-benchmark.ts).
+
+#include "lifter.cpp"
+
+struct LiftBenchStats {
+    uint64_t bytes;          // Bytes covered by decoded instructions
+    uint64_t instructions;
+    uint64_t unknown;        // Records with IROpcode::UNKNOWN
+    uint32_t calls;          // lift_code_multi_arch calls
+    uint32_t functions;      // lift_cfg calls (see bench_peaks)
+    uint32_t cfg_records;    // Most IR records one lift_cfg call used
+    uint32_t cfg_blocks;     // Most blocks one lift_cfg call used
+    uint32_t stream_records; // Most records one stream drain returned
+};
+
+// Bytes fed to the stream between drains, as liftNativeStream does
+static constexpr size_t kStreamChunk = 64 * 1024;
+
+// Lifts the whole section `iterations` times in calls of up to `max_out`
+// records, accumulating into `stats`
+static void bench_section(const uint8_t* code, size_t length, uint64_t entry, int arch_id,
+                          IRInstruction* ir, size_t max_out, uint32_t iterations, LiftBenchStats& stats) {
+    for (uint32_t it = 0; it < iterations; it++) {
+        size_t offset = 0;
+        while (offset < length) {
+            const int count = lift_code_multi_arch(code + offset, length - offset, entry + offset, arch_id, ir, max_out);
+            if (count <= 0) break;
+            stats.calls++;
+            for (int i = 0; i < count; i++) {
+                if (ir[i].opcode == IROpcode::UNKNOWN) stats.unknown++;
+            }
+            const IRInstruction& last = ir[count - 1];
+            const size_t covered = static_cast<size_t>(last.address + last.size - (entry + offset));
+            stats.instructions += static_cast<uint64_t>(count);
+            stats.bytes += covered;
+            offset += covered;
+        }
+    }
+}
+
+static void peak(uint32_t& high, size_t value) {
+    if (value > high) high = static_cast<uint32_t>(value);
+}
+
+// Untimed pass for the high-water marks: lift_cfg from the section start and
+// from every in-section direct call target of a linear sweep (the functions
+// ParallelLifter would lift), into `ir`/`blocks`; then the section through a
+// stream in `stream_mem` (ring capacity from its size), draining after each
+// kStreamChunk feed
+static void bench_peaks(const uint8_t* code, size_t length, uint64_t entry, int arch_id,
+                        IRInstruction* ir, size_t max_out, IRBlock* blocks, size_t max_blocks,
+                        void* stream_mem, size_t stream_bytes, LiftBenchStats& stats) {
+    const auto lift_function = [&](uint64_t target) {
+        uint32_t records = 0;
+        const int count = lift_cfg(code, length, entry, target, arch_id, ir, max_out, blocks, max_blocks, &records);
+        stats.functions++;
+        peak(stats.cfg_records, records);
+        if (count > 0) peak(stats.cfg_blocks, static_cast<size_t>(count));
+    };
+    lift_function(entry);
+    IRInstruction scan[64];
+    size_t offset = 0;
+    while (offset < length) {
+        const int count = lift_code_multi_arch(code + offset, length - offset, entry + offset, arch_id, scan, 64);
+        if (count <= 0) break;
+        for (int i = 0; i < count; i++) {
+            if (scan[i].opcode != IROpcode::CALL || ir_operand_kind(scan[i].info, 0) != OPK_IMM) continue;
+            if (scan[i].op1 >= entry && scan[i].op1 < entry + length) lift_function(scan[i].op1);
+        }
+        const IRInstruction& last = scan[count - 1];
+        offset = static_cast<size_t>(last.address + last.size - entry);
+    }
+
+    LiftStream* stream = lifter_stream_create(stream_mem, stream_bytes, entry, arch_id);
+    if (!stream) return;
+    offset = 0;
+    while (offset < length) {
+        const size_t chunk = length - offset < kStreamChunk ? length - offset : kStreamChunk;
+        const size_t used = lifter_stream_feed(stream, code + offset, chunk);
+        const size_t drained = lifter_stream_drain(stream, ir, max_out);
+        peak(stats.stream_records, drained);
+        if (used == 0 && drained == 0) break;
+        offset += used;
+    }
+    lifter_stream_destroy(stream);
+}
+
+extern "C" {
+    // Benchmark entry for the WASM build: `ir` holds max_out records and
+    // `stats` is accumulated (zero it before the first section)
+    WASM_EXPORT int lifter_bench(
+        const uint8_t* code,
+        size_t length,
+        uint64_t entry_point,
+        int arch_id,
+        IRInstruction* ir,
+        size_t max_out,
+        uint32_t iterations,
+        LiftBenchStats* stats
+    ) {
+        if (!stats || !ir || max_out == 0) return 0;
+        bench_section(code, length, entry_point, arch_id, ir, max_out, iterations, *stats);
+        return 1;
+    }
+
+    // High-water marks for the WASM build (bench_peaks), into `stats`;
+    // `stream_mem` holds lifter_stream_bytes(capacity) bytes, 8-byte aligned
+    WASM_EXPORT int lifter_bench_peaks(
+        const uint8_t* code,
+        size_t length,
+        uint64_t entry_point,
+        int arch_id,
+        IRInstruction* ir,
+        size_t max_out,
+        IRBlock* blocks,
+        size_t max_blocks,
+        void* stream_mem,
+        size_t stream_bytes,
+        LiftBenchStats* stats
+    ) {
+        if (!stats || !ir || !blocks || max_out == 0 || max_blocks == 0) return 0;
+        bench_peaks(code, length, entry_point, arch_id, ir, max_out, blocks, max_blocks, stream_mem, stream_bytes, *stats);
+        return 1;
+    }
+}
+
+#ifndef __wasm__
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Section {
+    int arch;
+    uint64_t address;
+    std::vector<uint8_t> bytes;
+};
+
+const char* const kArchNames[4] = { "x86", "arm64", "riscv", "x86_64" };
+
+int arch_from_name(const char* name, size_t len) {
+    for (int a = 0; a < 4; a++) {
+        if (strlen(kArchNames[a]) == len && strncmp(kArchNames[a], name, len) == 0) return a;
+    }
+    return -1;
+}
+
+bool read_file(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    uint8_t buf[1 << 16];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+    fclose(f);
+    return true;
+}
+
+uint64_t read_le(const uint8_t* p, int bytes) {
+    uint64_t v = 0;
+    for (int i = bytes - 1; i >= 0; i--) v = (v << 8) | p[i];
+    return v;
+}
+
+// Executable sections of a little-endian ELF32/ELF64 image
+bool elf_sections(const std::vector<uint8_t>& file, std::vector<Section>& out) {
+    if (file.size() < 0x34 || memcmp(file.data(), "\x7f" "ELF", 4) != 0 || file[5] != 1) return false;
+    const bool is64 = file[4] == 2;
+    const uint8_t* p = file.data();
+    int arch;
+    switch (read_le(p + 18, 2)) {
+        case 3: arch = static_cast<int>(Arch::X86); break;
+        case 62: arch = static_cast<int>(Arch::X86_64); break;
+        case 183: arch = static_cast<int>(Arch::ARM64); break;
+        default: return false;
+    }
+    const uint64_t shoff = is64 ? read_le(p + 0x28, 8) : read_le(p + 0x20, 4);
+    const uint64_t shentsize = read_le(p + (is64 ? 0x3A : 0x2E), 2);
+    const uint64_t shnum = read_le(p + (is64 ? 0x3C : 0x30), 2);
+    for (uint64_t i = 0; i < shnum; i++) {
+        const uint64_t sh = shoff + i * shentsize;
+        if (sh + (is64 ? 0x28 : 0x18) > file.size()) return false;
+        const uint8_t* s = p + sh;
+        const uint64_t type = read_le(s + 4, 4);
+        const uint64_t flags = is64 ? read_le(s + 8, 8) : read_le(s + 8, 4);
+        const uint64_t addr = is64 ? read_le(s + 0x10, 8) : read_le(s + 0x0C, 4);
+        const uint64_t offset = is64 ? read_le(s + 0x18, 8) : read_le(s + 0x10, 4);
+        const uint64_t size = is64 ? read_le(s + 0x20, 8) : read_le(s + 0x14, 4);
+        if (type != 1 || !(flags & 4) || size == 0 || offset + size > file.size()) continue;   // PROGBITS + EXECINSTR
+        out.push_back({ arch, addr, std::vector<uint8_t>(p + offset, p + offset + size) });
+    }
+    return true;
+}
+
+// "[arch:]path[@address]"
+bool load_input(const char* spec, std::vector<Section>& out) {
+    int arch = -1;
+    const char* path = spec;
+    if (const char* colon = strchr(spec, ':')) {
+        arch = arch_from_name(spec, static_cast<size_t>(colon - spec));
+        if (arch >= 0) path = colon + 1;
+    }
+    std::string file_path(path);
+    uint64_t address = 0;
+    const size_t at = file_path.rfind('@');
+    if (at != std::string::npos) {
+        address = strtoull(file_path.c_str() + at + 1, nullptr, 0);
+        file_path.resize(at);
+    }
+
+    std::vector<uint8_t> bytes;
+    if (!read_file(file_path.c_str(), bytes)) {
+        fprintf(stderr, "lifter_bench: cannot read %s\n", file_path.c_str());
+        return false;
+    }
+    if (arch < 0 && elf_sections(bytes, out)) return true;
+    if (arch < 0) {
+        fprintf(stderr, "lifter_bench: %s is not an ELF image; prefix it with x86:, x86_64: or arm64:\n", path);
+        return false;
+    }
+    out.push_back({ arch, address, std::move(bytes) });
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    uint32_t iterations = 10;
+    size_t max_out = 65536;
+    size_t max_blocks = 8192;
+    std::vector<Section> corpus;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) iterations = static_cast<uint32_t>(atoi(argv[++i]));
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) max_out = static_cast<size_t>(atoll(argv[++i]));
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) max_blocks = static_cast<size_t>(atoll(argv[++i]));
+        else if (!load_input(argv[i], corpus)) return 1;
+    }
+    if (corpus.empty() || iterations == 0 || max_out == 0 || max_blocks == 0) {
+        fprintf(stderr, "usage: lifter_bench [-n iterations] [-m max_ir] [-b max_blocks] [arch:]file[@address]...\n");
+        return 1;
+    }
+
+    std::vector<IRInstruction> ir(max_out);
+    std::vector<IRBlock> blocks(max_blocks);
+    std::vector<uint64_t> stream_mem((lifter_stream_bytes(max_out) + 7) / 8);
+    printf("%-8s %8s %12s %12s %10s %10s %9s %9s %12s %8s %12s\n",
+           "arch", "sections", "bytes", "instrs", "Minstr/s", "MB/s", "unknown",
+           "functions", "cfg records", "cfg blks", "stream drain");
+    for (int arch = 0; arch < 4; arch++) {
+        LiftBenchStats stats = {};
+        size_t sections = 0;
+        double seconds = 0;
+        for (const Section& s : corpus) {
+            if (s.arch != arch) continue;
+            sections++;
+            // Warm-up pass, not counted, then the high-water marks
+            LiftBenchStats warm = {};
+            bench_section(s.bytes.data(), s.bytes.size(), s.address, arch, ir.data(), max_out, 1, warm);
+            bench_peaks(s.bytes.data(), s.bytes.size(), s.address, arch, ir.data(), max_out, blocks.data(), max_blocks,
+                        stream_mem.data(), stream_mem.size() * 8, stats);
+
+            const auto start = std::chrono::steady_clock::now();
+            bench_section(s.bytes.data(), s.bytes.size(), s.address, arch, ir.data(), max_out, iterations, stats);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        if (!sections) continue;
+        const double unknown = stats.instructions ? 100.0 * static_cast<double>(stats.unknown) / static_cast<double>(stats.instructions) : 0;
+        printf("%-8s %8zu %12llu %12llu %10.2f %10.2f %8.3f%% %9u %12u %8u %12u\n",
+               kArchNames[arch], sections,
+               static_cast<unsigned long long>(stats.bytes / iterations),
+               static_cast<unsigned long long>(stats.instructions / iterations),
+               static_cast<double>(stats.instructions) / seconds / 1e6,
+               static_cast<double>(stats.bytes) / seconds / (1 << 20),
+               unknown, stats.functions, stats.cfg_records, stats.cfg_blocks, stats.stream_records);
+    }
+    return 0;
+}
+
+#endif
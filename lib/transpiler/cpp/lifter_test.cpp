@@ -0,0 +1,780 @@
+// Freestanding C++ Lifter - Regression Tests
+// Decoder and streaming cases that once went wrong, checked record by record.
+//
+// Native: g++ -O1 -g -std=c++17 -fsanitize=address,undefined lifter_test.cpp -o lifter_test
+//         ./lifter_test
+//   Add -DNATIVE_COUNTERS=1 to check the decode counters too.
+// Exits non-zero and names every failing check. The emitter cases run the
+// generated modules under node and are skipped when it is not on PATH.
+
+#include "lifter.cpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                \
+    do {                                                                           \
+        if (!(cond)) {                                                             \
+            std::fprintf(stderr, "%s:%d: %s: CHECK(%s)\n", __FILE__, __LINE__,    \
+                         __func__, #cond);                                         \
+            failures++;                                                            \
+        }                                                                          \
+    } while (0)
+
+static bool same_record(const IRInstruction& a, const IRInstruction& b) {
+    return a.opcode == b.opcode && a.address == b.address && a.size == b.size && a.info == b.info &&
+           a.op1 == b.op1 && a.op2 == b.op2 && a.op3 == b.op3;
+}
+
+// ---------------------------------------------------------------------------
+// LiftStream
+// ---------------------------------------------------------------------------
+
+struct StreamResult {
+    std::vector<IRInstruction> records;
+    uint64_t pc;
+    size_t pending;
+};
+
+// Feeds `code` in pieces of `split` bytes (the whole of it at once for 0),
+// draining after every feed
+static StreamResult stream_lift(const std::vector<uint8_t>& code, size_t split, Arch arch, uint64_t entry) {
+    alignas(8) uint8_t mem[LiftStream::bytes_for(64)];
+    LiftStream* stream = lifter_stream_create(mem, sizeof(mem), entry, static_cast<int>(arch));
+    StreamResult result;
+    IRInstruction out[64];
+    size_t offset = 0;
+    while (offset < code.size()) {
+        const size_t piece = split && code.size() - offset > split ? split : code.size() - offset;
+        const size_t used = lifter_stream_feed(stream, code.data() + offset, piece);
+        CHECK(lifter_stream_pending(stream) < LiftStream::kMaxInstructionBytes);
+        const size_t n = lifter_stream_drain(stream, out, 64);
+        result.records.insert(result.records.end(), out, out + n);
+        if (used == 0 && n == 0) break;  // No progress: fail instead of spinning
+        offset += used;
+    }
+    result.pc = lifter_stream_pc(stream);
+    result.pending = lifter_stream_pending(stream);
+    lifter_stream_destroy(stream);
+    return result;
+}
+
+// 14 operand-size prefixes ahead of add dword [rsp+disp32], imm32: the prefix
+// run leaves no room for ModRM, SIB and displacement within 15 bytes, so the
+// decoder must call it invalid instead of waiting for more bytes (a held
+// tail of 16+ bytes overflowed the stream's pending buffer)
+static void test_stream_overlong_prefix_run() {
+    const std::vector<uint8_t> code = {
+        0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+        0x81, 0x84, 0x24, 0x00, 0x00, 0x00,
+    };
+
+    IRInstruction first;
+    CHECK(Lifter::decode(code.data(), code.size(), 0x1000, Arch::X86_64, first) == 1);
+    CHECK(first.opcode == IROpcode::UNKNOWN);
+    IRInstruction short_run;
+    CHECK(Lifter::decode(code.data(), 14, 0x1000, Arch::X86_64, short_run) == 0);  // Could still be 15 bytes
+
+    const StreamResult whole = stream_lift(code, 0, Arch::X86_64, 0x1000);
+    CHECK(!whole.records.empty());
+    for (size_t split = 1; split < code.size(); split++) {
+        const StreamResult pieces = stream_lift(code, split, Arch::X86_64, 0x1000);
+        CHECK(pieces.records.size() == whole.records.size());
+        CHECK(pieces.pc == whole.pc);
+        CHECK(pieces.pending == whole.pending);
+        const size_t n = pieces.records.size() < whole.records.size() ? pieces.records.size() : whole.records.size();
+        for (size_t i = 0; i < n; i++) CHECK(same_record(pieces.records[i], whole.records[i]));
+    }
+}
+
+// A partial instruction left at the end of input comes out of finish() as
+// one UNKNOWN record over its bytes instead of staying pending forever
+static void test_stream_finish_emits_truncated_tail() {
+    const uint8_t code[] = { 0x90, 0x48, 0x83, 0xC0 };  // nop; add rax, imm8 without the imm8
+    alignas(8) uint8_t mem[LiftStream::bytes_for(1)];
+    LiftStream* stream = lifter_stream_create(mem, sizeof(mem), 0x1000, static_cast<int>(Arch::X86_64));
+    CHECK(lifter_stream_finish(stream) == 0);  // Nothing pending yet
+
+    // One-record ring: the nop fills it, so the tail is not consumed yet
+    CHECK(lifter_stream_feed(stream, code, sizeof(code)) == 1);
+    IRInstruction out[2];
+    CHECK(lifter_stream_drain(stream, out, 2) == 1);
+    CHECK(lifter_stream_feed(stream, code + 1, sizeof(code) - 1) == 3);
+    CHECK(lifter_stream_pending(stream) == 3);
+
+    CHECK(lifter_stream_drain(stream, out, 2) == 0);
+    CHECK(lifter_stream_finish(stream) == 1);
+    CHECK(lifter_stream_pending(stream) == 0);
+    CHECK(lifter_stream_pc(stream) == 0x1004);
+    CHECK(lifter_stream_drain(stream, out, 2) == 1);
+    CHECK(out[0].opcode == IROpcode::UNKNOWN);
+    CHECK(out[0].address == 0x1001);
+    CHECK(out[0].size == 3);
+    CHECK(lifter_stream_finish(stream) == 0);
+    lifter_stream_destroy(stream);
+}
+
+// lift_basic_block stops decoding at the terminator, so the decode counters
+// see exactly the records it returns (liftBlockRecords once lifted runs of
+// 16 past the block end and counted all of them)
+static void test_basic_block_counts_what_it_returns() {
+    std::vector<uint8_t> code = { 0x48, 0x83, 0xC0, 0x01, 0xC3 };  // add rax, 1; ret
+    code.insert(code.end(), 32, 0x90);
+    get_counters(1);
+    IRInstruction out[64];
+    CHECK(lift_basic_block(code.data(), code.size(), 0x1000, static_cast<int>(Arch::X86_64), out, 64) == 2);
+    CHECK(out[1].opcode == IROpcode::RET);
+    const NativeCounters* counters = get_counters(1);
+    if (!counters->enabled) return;
+    uint64_t decoded = 0;
+    for (uint64_t n : counters->instructions) decoded += n;
+    CHECK(decoded == 2);
+    CHECK(counters->bytes_lifted == 5);
+}
+
+// ---------------------------------------------------------------------------
+// Struct-of-arrays output
+// ---------------------------------------------------------------------------
+
+// Arrays sit back to back where soa_layout says, addresses are relative to
+// the entry point, and the pool holds REG as one word and IMM/MEM as two
+static void test_soa_layout() {
+    const uint8_t code[] = {
+        0x48, 0x8B, 0x44, 0x8B, 0x10,  // mov rax, [rbx+rcx*4+0x10]
+        0x48, 0x83, 0xC0, 0x01,        // add rax, 1
+        0xC3,                          // ret
+    };
+    constexpr size_t kMax = 5;
+    constexpr size_t kPool = 16;
+    constexpr size_t kBytes = soa_bytes(kMax, kPool);
+    CHECK(kBytes == 16 + 4 * (2 * kMax + 1 + kPool));
+    alignas(4) uint8_t region[kBytes + 8];
+    std::memset(region, 0xEE, sizeof(region));
+
+    const int n = lift_code_soa(code, sizeof(code), 0x401000, static_cast<int>(Arch::X86_64), region, kMax, kPool);
+    CHECK(n == 3);
+    const uint8_t* opcodes = region;
+    const uint8_t* sizes = region + kMax;
+    const uint8_t* info = region + 2 * kMax;
+    const uint32_t* words = reinterpret_cast<const uint32_t*>(region + 16);
+    const uint32_t* addresses = words;
+    const uint32_t* offsets = words + kMax;
+    const uint32_t* pool = words + 2 * kMax + 1;
+
+    CHECK(opcodes[0] == static_cast<uint8_t>(IROpcode::LOAD) && opcodes[1] == static_cast<uint8_t>(IROpcode::ADD) &&
+          opcodes[2] == static_cast<uint8_t>(IROpcode::RET));
+    CHECK(sizes[0] == 5 && sizes[1] == 4 && sizes[2] == 1);
+    CHECK(info[0] == ir_info(OPK_REG, OPK_MEM, OPK_NONE, W64) && info[1] == ir_info(OPK_REG, OPK_IMM, OPK_NONE, W64));
+    CHECK(addresses[0] == 0 && addresses[1] == 5 && addresses[2] == 9);
+    CHECK(offsets[0] == 0 && offsets[1] == 3 && offsets[2] == 6 && offsets[3] == 6);
+
+    const uint64_t mem = make_mem(3, 1, 2, 0x10);
+    CHECK(pool[0] == 0 && pool[1] == static_cast<uint32_t>(mem) && pool[2] == static_cast<uint32_t>(mem >> 32));
+    CHECK(pool[3] == 0 && pool[4] == 1 && pool[5] == 0);
+    for (size_t i = kBytes; i < sizeof(region); i++) CHECK(region[i] == 0xEE);  // Nothing past the region
+
+    // Stops before an instruction whose operands might not fit the pool, or
+    // at max_out
+    CHECK(lift_code_soa(code, sizeof(code), 0, static_cast<int>(Arch::X86_64), region, kMax, 8) == 1);
+    CHECK(lift_code_soa(code, sizeof(code), 0, static_cast<int>(Arch::X86_64), region, 2, kPool) == 2);
+    CHECK(lift_code_soa(code, 7, 0, static_cast<int>(Arch::X86_64), region, kMax, kPool) == 1);  // Cut-off add
+}
+
+// ---------------------------------------------------------------------------
+// lift_cfg
+// ---------------------------------------------------------------------------
+
+struct CfgResult {
+    std::vector<IRBlock> blocks;
+    std::vector<IRInstruction> ir;
+};
+
+static CfgResult cfg_lift(const std::vector<uint8_t>& code, uint64_t base, size_t max_ir = 64,
+                          size_t max_blocks = 16) {
+    CfgResult result;
+    result.ir.resize(max_ir);
+    result.blocks.resize(max_blocks);
+    uint32_t ir_count = 0;
+    const int n = lift_cfg(code.data(), code.size(), base, base, static_cast<int>(Arch::X86_64),
+                           result.ir.data(), max_ir, result.blocks.data(), max_blocks, &ir_count);
+    CHECK(n >= 0 && static_cast<size_t>(n) <= max_blocks && ir_count <= max_ir);
+    result.blocks.resize(n);
+    result.ir.resize(ir_count);
+    return result;
+}
+
+// Both arms of a diamond reach the same block, lifted once: the fallthrough
+// arm runs into it and ends there without a branch of its own
+static void test_cfg_shared_block() {
+    const std::vector<uint8_t> code = {
+        0x83, 0xF8, 0x00,  // 1000: cmp eax, 0
+        0x74, 0x02,        // 1003: je 1007
+        0x90, 0x90,        // 1005: nop; nop
+        0xC3,              // 1007: ret
+    };
+    const CfgResult cfg = cfg_lift(code, 0x1000);
+    CHECK(cfg.blocks.size() == 3 && cfg.ir.size() == 5);
+    if (cfg.blocks.size() != 3) return;
+    const IRBlock& head = cfg.blocks[0];
+    CHECK(head.start == 0x1000 && head.end == 0x1005 && head.ir_count == 2);
+    CHECK(head.succ[0] == 1 && head.succ[1] == 2 && head.flags == BLOCK_LIFTED);
+    const IRBlock& arm = cfg.blocks[1];
+    CHECK(arm.start == 0x1005 && arm.end == 0x1007 && arm.ir_count == 2);
+    CHECK(arm.succ[0] == 2 && arm.succ[1] == BLOCK_NONE);
+    const IRBlock& join = cfg.blocks[2];
+    CHECK(join.start == 0x1007 && join.ir_count == 1 && join.flags == (BLOCK_LIFTED | BLOCK_RET));
+    CHECK(cfg.ir[join.first_ir].opcode == IROpcode::RET);
+}
+
+// A back edge into the middle of the block being lifted splits it, and the
+// branch's successors move to the tail piece
+static void test_cfg_split_on_back_edge() {
+    const std::vector<uint8_t> code = {
+        0x90,              // 1000: nop
+        0xFF, 0xC9,        // 1001: dec ecx
+        0x75, 0xFC,        // 1003: jne 1001
+        0xC3,              // 1005: ret
+    };
+    const CfgResult cfg = cfg_lift(code, 0x1000);
+    CHECK(cfg.blocks.size() == 3);
+    if (cfg.blocks.size() != 3) return;
+    const IRBlock& head = cfg.blocks[0];
+    CHECK(head.start == 0x1000 && head.end == 0x1001 && head.ir_count == 1);
+    CHECK(head.succ[0] == 2 && head.succ[1] == BLOCK_NONE && head.flags == BLOCK_LIFTED);
+    const IRBlock& loop = cfg.blocks[2];
+    CHECK(loop.start == 0x1001 && loop.end == 0x1005 && loop.ir_count == 2);
+    CHECK(loop.first_ir == head.first_ir + 1 && cfg.ir[loop.first_ir].opcode == IROpcode::DEC);
+    CHECK(loop.succ[0] == 1 && loop.succ[1] == 2);
+    CHECK(cfg.blocks[1].start == 0x1005 && cfg.blocks[1].flags == (BLOCK_LIFTED | BLOCK_RET));
+}
+
+// Running out of block slots, IR slots or input marks the block TRUNCATED;
+// transfers out of the buffer or through a register are flagged too
+static void test_cfg_limits_and_exits() {
+    const std::vector<uint8_t> diamond = { 0x83, 0xF8, 0x00, 0x74, 0x02, 0x90, 0x90, 0xC3 };
+    const CfgResult one_block = cfg_lift(diamond, 0x1000, 64, 1);
+    CHECK(one_block.blocks.size() == 1);
+    if (!one_block.blocks.empty()) {
+        CHECK(one_block.blocks[0].flags == (BLOCK_LIFTED | BLOCK_TRUNCATED));
+        CHECK(one_block.blocks[0].succ[0] == BLOCK_NONE && one_block.blocks[0].succ[1] == BLOCK_NONE);
+    }
+
+    const CfgResult one_ir = cfg_lift({ 0x90, 0x90, 0xC3 }, 0x1000, 1);
+    CHECK(one_ir.blocks.size() == 1 && one_ir.ir.size() == 1);
+    if (!one_ir.blocks.empty()) {
+        CHECK(one_ir.blocks[0].end == 0x1001 && one_ir.blocks[0].flags == (BLOCK_LIFTED | BLOCK_TRUNCATED));
+    }
+
+    const CfgResult runs_off = cfg_lift({ 0x90, 0x48, 0x8B }, 0x1000);  // nop, then a cut-off mov
+    CHECK(runs_off.blocks.size() == 1);
+    if (!runs_off.blocks.empty()) {
+        CHECK(runs_off.blocks[0].end == 0x1001 && runs_off.blocks[0].ir_count == 1);
+        CHECK(runs_off.blocks[0].flags == (BLOCK_LIFTED | BLOCK_TRUNCATED));
+    }
+
+    const CfgResult external = cfg_lift({ 0xE9, 0x00, 0x10, 0x00, 0x00 }, 0x1000);  // jmp 2005
+    CHECK(external.blocks.size() == 1);
+    if (!external.blocks.empty()) {
+        CHECK(external.blocks[0].flags == (BLOCK_LIFTED | BLOCK_EXTERNAL));
+        CHECK(external.blocks[0].succ[0] == BLOCK_NONE);
+    }
+
+    const CfgResult indirect = cfg_lift({ 0xFF, 0xE0 }, 0x1000);  // jmp rax
+    CHECK(indirect.blocks.size() == 1);
+    if (!indirect.blocks.empty()) CHECK(indirect.blocks[0].flags == (BLOCK_LIFTED | BLOCK_INDIRECT));
+
+    IRInstruction ir[4];
+    IRBlock blocks[4];
+    const uint8_t ret[] = { 0xC3 };
+    CHECK(lift_cfg(ret, 1, 0x1000, 0x2000, static_cast<int>(Arch::X86_64), ir, 4, blocks, 4, nullptr) == 0);
+}
+
+// ---------------------------------------------------------------------------
+// Peephole
+// ---------------------------------------------------------------------------
+
+// LOOP decrements RCX, so the value a MOV put there is no longer known after
+// it and must not be substituted into a later read
+static void test_peephole_loop_writes_rcx() {
+    const uint8_t code[] = {
+        0xB9, 0x05, 0x00, 0x00, 0x00,  // mov ecx, 5
+        0xE2, 0xFE,                    // loop $
+        0x89, 0xC8,                    // mov eax, ecx
+    };
+    IRInstruction ir[8];
+    const int lifted = lift_code_multi_arch(code, sizeof(code), 0x1000, static_cast<int>(Arch::X86_64), ir, 8);
+    CHECK(lifted == 3);
+    CHECK(ir[1].opcode == IROpcode::JCC && ir[1].op2 == CC_X86_LOOP);
+    CHECK(Peephole::run(ir, 3, Arch::X86_64) == 3);
+    CHECK(ir[2].opcode == IROpcode::MOV && ir_operand_kind(ir[2].info, 1) == OPK_REG && ir[2].op2 == REG_GPR0 + 1);
+}
+
+// ---------------------------------------------------------------------------
+// x86 decoder tables
+// ---------------------------------------------------------------------------
+
+static IRInstruction x86(std::initializer_list<uint8_t> bytes, Arch arch = Arch::X86_64, uint64_t addr = 0x1000) {
+    const std::vector<uint8_t> code(bytes);
+    IRInstruction instr;
+    CHECK(Lifter::decode(code.data(), code.size(), addr, arch, instr) == code.size());
+    return instr;
+}
+
+static constexpr uint8_t kRegMem = ir_info(OPK_REG, OPK_MEM, OPK_NONE, W64);
+
+// ModRM and SIB forms, REX extension of every field, and RIP-relative
+static void test_x86_modrm_sib() {
+    const IRInstruction scaled = x86({ 0x48, 0x8B, 0x44, 0x8B, 0x10 });  // mov rax, [rbx+rcx*4+0x10]
+    CHECK(scaled.opcode == IROpcode::LOAD && scaled.size == 5 && scaled.info == kRegMem);
+    CHECK(scaled.op1 == 0 && scaled.op2 == make_mem(3, 1, 2, 0x10));
+
+    const IRInstruction extended = x86({ 0x4F, 0x8B, 0x44, 0xC8, 0xF8 });  // mov r8, [r8+r9*8-8]
+    CHECK(extended.opcode == IROpcode::LOAD && extended.info == kRegMem);
+    CHECK(extended.op1 == 8 && extended.op2 == make_mem(8, 9, 3, -8));
+
+    const IRInstruction no_base = x86({ 0x8B, 0x04, 0x8D, 0x00, 0x10, 0x00, 0x00 });  // mov eax, [rcx*4+0x1000]
+    CHECK(no_base.size == 7 && ir_width(no_base.info) == W32);
+    CHECK(no_base.op2 == make_mem(REG_NONE, 1, 2, 0x1000));
+
+    const IRInstruction no_index = x86({ 0x8B, 0x04, 0x24 });  // mov eax, [rsp]
+    CHECK(no_index.op2 == make_mem(4, REG_NONE, 0, 0));
+
+    const IRInstruction rip = x86({ 0x48, 0x8B, 0x05, 0x10, 0x00, 0x00, 0x00 });  // mov rax, [rip+0x10]
+    CHECK(rip.size == 7 && rip.op2 == make_mem(REG_PC, REG_NONE, 0, 0x10));
+    // The same encoding is an absolute disp32 outside long mode
+    const IRInstruction absolute = x86({ 0x8B, 0x05, 0x10, 0x00, 0x00, 0x00 }, Arch::X86);
+    CHECK(absolute.op2 == make_mem(REG_NONE, REG_NONE, 0, 0x10));
+
+    const IRInstruction bx16 = x86({ 0x67, 0x8B, 0x47, 0x02 }, Arch::X86);  // mov eax, [bx+2]
+    CHECK(bx16.size == 4 && bx16.op2 == make_mem(3, REG_NONE, 0, 2));
+    const IRInstruction si_bp = x86({ 0x67, 0x8B, 0x02 }, Arch::X86);  // mov eax, [bp+si]
+    CHECK(si_bp.op2 == make_mem(5, 6, 0, 0));
+}
+
+// Prefixes: operand size, segment override, REX and the byte registers it
+// changes, and a legacy prefix after REX cancelling it
+static void test_x86_prefixes() {
+    const IRInstruction fs_store = x86({ 0x64, 0x66, 0x89, 0x03 });  // mov fs:[rbx], ax
+    CHECK(fs_store.opcode == IROpcode::STORE && fs_store.size == 4);
+    CHECK(fs_store.info == ir_info(OPK_MEM, OPK_REG, OPK_NONE, W16));
+    CHECK(fs_store.op1 == make_mem(3, REG_NONE, 0, 0, 5) && fs_store.op2 == 0);
+
+    const IRInstruction ah = x86({ 0x88, 0xE0 });  // mov al, ah
+    CHECK(ah.opcode == IROpcode::MOV && ah.info == ir_info(OPK_REG, OPK_REG, OPK_NONE, W8));
+    CHECK(ah.op1 == 0 && ah.op2 == REG_AH);
+    CHECK(x86({ 0x40, 0x88, 0xE0 }).op2 == 4);  // mov al, spl
+
+    const IRInstruction cancelled = x86({ 0x48, 0x66, 0x89, 0xC0 });  // REX.W then 66: mov ax, ax
+    CHECK(ir_width(cancelled.info) == W16);
+    CHECK(ir_width(x86({ 0x66, 0x48, 0x89, 0xC0 }).info) == W64);  // REX.W wins over 66
+
+    CHECK(ir_width(x86({ 0x50 }).info) == W64);         // push rax defaults to 64 bits
+    CHECK(x86({ 0x41, 0x50 }).op1 == 8);                // push r8
+    CHECK(ir_width(x86({ 0x50 }, Arch::X86).info) == W32);
+}
+
+// Immediates, relative targets, groups, escapes and invalid forms
+static void test_x86_immediates_and_groups() {
+    const IRInstruction add = x86({ 0x48, 0x83, 0xC0, 0x01 });  // add rax, 1
+    CHECK(add.opcode == IROpcode::ADD && add.info == ir_info(OPK_REG, OPK_IMM, OPK_NONE, W64));
+    CHECK(add.op1 == 0 && add.op2 == 1);
+    const IRInstruction sub = x86({ 0x48, 0x83, 0xE9, 0xFF });  // sub rcx, -1
+    CHECK(sub.opcode == IROpcode::SUB && sub.op1 == 1 && sub.op2 == ~0ull);
+    const IRInstruction movabs = x86({ 0x48, 0xB8, 1, 2, 3, 4, 5, 6, 7, 8 });  // mov rax, imm64
+    CHECK(movabs.size == 10 && movabs.op2 == 0x0807060504030201ull);
+    const IRInstruction test = x86({ 0xF6, 0xC3, 0x80 });  // test bl, 0x80 (group 3 takes an immediate)
+    CHECK(test.opcode == IROpcode::TEST && test.size == 3 && test.op1 == 3 && test.op2 == ~0x7Full);
+    const IRInstruction neg = x86({ 0xF7, 0xD8 });  // neg eax (group 3 without one)
+    CHECK(neg.opcode == IROpcode::NEG && neg.size == 2);
+
+    const IRInstruction je = x86({ 0x0F, 0x84, 0x10, 0x00, 0x00, 0x00 });  // je +0x10
+    CHECK(je.opcode == IROpcode::JE && je.size == 6 && je.op1 == 0x1016);
+    const IRInstruction jl = x86({ 0x7C, 0xFE });  // jl $
+    CHECK(jl.opcode == IROpcode::JCC && jl.op1 == 0x1000 && jl.op2 == 0xC);
+    const IRInstruction call16 = x86({ 0x66, 0xE8, 0x00, 0xF0 }, Arch::X86, 0x1000);  // call rel16 wraps
+    CHECK(call16.opcode == IROpcode::CALL && call16.op1 == ((0x1004 + 0xF000) & 0xFFFF));
+
+    const IRInstruction vadd = x86({ 0xC5, 0xF0, 0x58, 0xC2 });  // vaddps xmm0, xmm1, xmm2
+    CHECK(vadd.opcode == IROpcode::V_ADD && vadd.size == 4);
+    CHECK(vadd.op1 == REG_VEC0 && vadd.op2 == REG_VEC0 + 1 && vadd.op3 == REG_VEC0 + 2);
+
+    CHECK(x86({ 0x06 }).opcode == IROpcode::UNKNOWN);            // push es is invalid in long mode
+    CHECK(x86({ 0x06 }, Arch::X86).opcode == IROpcode::PUSH);
+    CHECK(x86({ 0x0F, 0x0B }).opcode == IROpcode::TRAP);         // ud2
+
+    IRInstruction partial;
+    const uint8_t cut[] = { 0x48, 0x8B, 0x44 };  // SIB missing
+    CHECK(Lifter::decode(cut, sizeof(cut), 0x1000, Arch::X86_64, partial) == 0);
+}
+
+// ---------------------------------------------------------------------------
+// ARM64 decoding
+// ---------------------------------------------------------------------------
+
+static IRInstruction a64(uint32_t word, uint64_t addr = 0x2000) {
+    const uint8_t bytes[4] = { static_cast<uint8_t>(word), static_cast<uint8_t>(word >> 8),
+                               static_cast<uint8_t>(word >> 16), static_cast<uint8_t>(word >> 24) };
+    IRInstruction instr;
+    CHECK(Lifter::decode(bytes, 4, addr, Arch::ARM64, instr) == 4);
+    return instr;
+}
+
+static constexpr uint8_t kSignedWide = IR_ATTR_SIGNED | IR_ATTR_WIDE;
+
+// Sign extension and the destination width of LDRS* are part of the record
+static void test_a64_signed_loads() {
+    const IRInstruction ldrsw = a64(0xB9800020);       // ldrsw x0, [x1]
+    CHECK(ldrsw.opcode == IROpcode::LOAD && ir_width(ldrsw.info) == W32 && ldrsw.attr == kSignedWide);
+    const IRInstruction ldrsb_x = a64(0x39800020);     // ldrsb x0, [x1]
+    CHECK(ldrsb_x.opcode == IROpcode::LOAD && ir_width(ldrsb_x.info) == W8 && ldrsb_x.attr == kSignedWide);
+    const IRInstruction ldrsb_w = a64(0x39C00020);     // ldrsb w0, [x1]
+    CHECK(ldrsb_w.opcode == IROpcode::LOAD && ir_width(ldrsb_w.info) == W8 && ldrsb_w.attr == IR_ATTR_SIGNED);
+    const IRInstruction ldrsh = a64(0x79800020);       // ldrsh x0, [x1]
+    CHECK(ir_width(ldrsh.info) == W16 && ldrsh.attr == kSignedWide);
+    const IRInstruction literal = a64(0x98000040);     // ldrsw x0, #+8
+    CHECK(literal.opcode == IROpcode::LOAD && ir_width(literal.info) == W32 && literal.attr == kSignedWide);
+    const IRInstruction ldpsw = a64(0x69400820);       // ldpsw x0, x2, [x1]
+    CHECK(ldpsw.opcode == IROpcode::LOAD && ir_width(ldpsw.info) == W32 && ldpsw.attr == kSignedWide);
+    const IRInstruction ldr = a64(0xB9400020);         // ldr w0, [x1]
+    CHECK(ldr.opcode == IROpcode::LOAD && ir_width(ldr.info) == W32 && ldr.attr == 0);
+}
+
+static void test_a64_flag_setting() {
+    CHECK(a64(0xB1000420).attr == IR_ATTR_SETS_FLAGS);  // adds x0, x1, #1
+    CHECK(a64(0x91000420).attr == 0);                   // add x0, x1, #1
+    const IRInstruction subs = a64(0xEB020020);         // subs x0, x1, x2
+    CHECK(subs.opcode == IROpcode::SUB && subs.attr == IR_ATTR_SETS_FLAGS);
+    const IRInstruction ands = a64(0xEA020020);         // ands x0, x1, x2
+    CHECK(ands.opcode == IROpcode::AND && ands.attr == IR_ATTR_SETS_FLAGS);
+    CHECK(a64(0x8A020020).attr == 0);                   // and x0, x1, x2
+    CHECK(a64(0xF100001F).opcode == IROpcode::CMP);     // cmp x0, #0
+}
+
+static void test_a64_conditional_set_multiply_and_eret() {
+    const IRInstruction cset = a64(0x9A9F17E0);         // cset x0, eq
+    CHECK(cset.opcode == IROpcode::SETCC && cset.op2 == 0 && cset.attr == 0);
+    const IRInstruction csetm = a64(0xDA9F13E0);        // csetm x0, eq
+    CHECK(csetm.opcode == IROpcode::SETCC && csetm.op2 == 0 && csetm.attr == IR_ATTR_SIGNED);
+
+    const IRInstruction mul = a64(0x9B027C20);          // mul x0, x1, x2
+    CHECK(mul.opcode == IROpcode::MUL && ir_width(mul.info) == W64 && mul.attr == 0);
+    const IRInstruction smull = a64(0x9B227C20);        // smull x0, w1, w2
+    CHECK(smull.opcode == IROpcode::MUL && ir_width(smull.info) == W32 && smull.attr == kSignedWide);
+    const IRInstruction umull = a64(0x9BA27C20);        // umull x0, w1, w2
+    CHECK(umull.opcode == IROpcode::MUL && ir_width(umull.info) == W32 && umull.attr == IR_ATTR_WIDE);
+    CHECK(a64(0x9AC20C20).attr == IR_ATTR_SIGNED);      // sdiv x0, x1, x2
+    CHECK(a64(0x9AC20820).attr == 0);                   // udiv x0, x1, x2
+
+    const IRInstruction sxtw = a64(0x93407C20);         // sxtw x0, w1
+    CHECK(sxtw.opcode == IROpcode::MOV && sxtw.op2 == make_shifted_reg(1, 0, 0, 7));
+
+    CHECK(a64(0xD69F03E0).opcode == IROpcode::UNKNOWN); // eret
+    CHECK(a64(0xD61F0020).opcode == IROpcode::JMP);     // br x1
+    const IRInstruction retaa = a64(0xD65F0BFF);        // retaa
+    CHECK(retaa.opcode == IROpcode::RET && retaa.op1 == 30);
+}
+
+// ---------------------------------------------------------------------------
+// Arena (wasm-arena.h)
+// ---------------------------------------------------------------------------
+
+static bool aligned16(const void* p) { return (reinterpret_cast<uintptr_t>(p) & 15) == 0; }
+
+// Blocks return to the free list of their class and the next allocation of
+// that class takes the most recently freed one; other classes never do
+static void test_arena_reuse_by_size_class() {
+    static WasmArena arena;  // Static: its host chunks are never freed
+    arena_init(&arena, 0);
+    void* a = arena_alloc(&arena, 1);
+    void* b = arena_alloc(&arena, 16);   // 16 + header still fits 32 bytes
+    void* c = arena_alloc(&arena, 17);
+    CHECK(a && b && c && aligned16(a) && aligned16(b) && aligned16(c));
+    CHECK(arena_block_size(a) == 16 && arena_block_size(b) == 16 && arena_block_size(c) == 48);
+    CHECK(arena.stats.live_bytes == 32 + 32 + 64 && arena.stats.reserved_bytes == 128);
+
+    arena_free(&arena, a);
+    arena_free(&arena, b);
+    CHECK(arena.stats.live_bytes == 64 && arena.stats.frees == 2);
+    CHECK(arena_alloc(&arena, 40) != a);       // Class 1 has nothing free: new block
+    CHECK(arena.stats.reserved_bytes == 192);
+    CHECK(arena_alloc(&arena, 8) == b);        // Last freed first
+    CHECK(arena_alloc(&arena, 16) == a);
+    CHECK(arena.stats.reserved_bytes == 192);  // Reuse takes nothing new
+    arena_free(&arena, c);
+    CHECK(arena_alloc(&arena, 48) == c);
+    CHECK(arena.stats.allocations == 7 && arena.stats.peak_live_bytes == 32 + 32 + 64 + 64);
+    arena_free(&arena, nullptr);
+    CHECK(arena.stats.frees == 3);
+}
+
+// Requests past the largest class fail without touching the arena; a bump
+// region too small for the next block is abandoned for a new one
+static void test_arena_exhaustion() {
+    CHECK(arena_size_class(((size_t)1 << 30) - ARENA_HEADER) == ARENA_CLASSES - 1);
+    CHECK(arena_size_class(((size_t)1 << 30) - ARENA_HEADER + 1) == -1);
+
+    alignas(16) static uint8_t region[80];
+    static WasmArena arena;
+    arena_init(&arena, reinterpret_cast<uintptr_t>(region));
+    arena.end = arena.top + sizeof(region);
+    CHECK(arena_alloc(&arena, (size_t)1 << 30) == nullptr);
+    CHECK(arena.stats.allocations == 0 && arena.stats.reserved_bytes == 0);
+
+    uint8_t* first = static_cast<uint8_t*>(arena_alloc(&arena, 16));
+    uint8_t* second = static_cast<uint8_t*>(arena_alloc(&arena, 16));
+    CHECK(first == region + ARENA_HEADER && second == region + 32 + ARENA_HEADER);
+    uint8_t* third = static_cast<uint8_t*>(arena_alloc(&arena, 16));  // 16 bytes left: not enough
+    CHECK(third && (third < region || third >= region + sizeof(region)));
+    CHECK(arena.stats.reserved_bytes == 96);
+    arena_free(&arena, first);
+    CHECK(arena_alloc(&arena, 1) == first);
+}
+
+// A bounded arena (a module's own heap in its window of a shared memory)
+// fails once the window is used up instead of going past it
+static void test_arena_bounded() {
+    alignas(16) static uint8_t window[128];
+    static WasmArena arena;
+    arena_init_bounded(&arena, reinterpret_cast<uintptr_t>(window), reinterpret_cast<uintptr_t>(window + 96));
+    uint8_t* a = static_cast<uint8_t*>(arena_alloc(&arena, 16));
+    uint8_t* b = static_cast<uint8_t*>(arena_alloc(&arena, 40));
+    CHECK(a == window + ARENA_HEADER && b == window + 32 + ARENA_HEADER);
+    CHECK(arena_alloc(&arena, 16) == nullptr);  // 32 bytes would end past the limit
+    CHECK(arena.top == reinterpret_cast<uintptr_t>(window + 96) && arena.stats.allocations == 2);
+    arena_free(&arena, a);
+    CHECK(arena_alloc(&arena, 1) == a);         // Freed blocks still serve it
+
+    // A limit below the base leaves an empty region
+    static WasmArena empty;
+    arena_init_bounded(&empty, reinterpret_cast<uintptr_t>(window + 64), reinterpret_cast<uintptr_t>(window));
+    CHECK(arena_alloc(&empty, 1) == nullptr);
+}
+
+// The lifter moves onto a shared arena only while it holds no blocks of its
+// own heap, and a second module attaching the same header reuses its state
+static void test_lifter_attach_after_allocate() {
+    alignas(16) static WasmArena shared[2];
+    void* own = lifter_alloc(64);
+    CHECK(own != nullptr);
+    CHECK(lifter_attach_arena(shared) == -1);
+    CHECK(shared[0].magic != ARENA_MAGIC);  // Refused before touching it
+    lifter_free(own);
+    CHECK(lifter_attach_arena(nullptr) == -1);
+    CHECK(lifter_attach_arena(shared) == 0);
+    CHECK(shared[0].magic == ARENA_MAGIC);
+
+    void* block = lifter_alloc(100);
+    CHECK(block && aligned16(block) && arena_block_size(block) >= 100);
+    CHECK(shared[0].stats.allocations == 1 && shared[0].stats.live_bytes == 128);
+    CHECK(lifter_attach_arena(shared) == -1);
+
+    // Another module on the memory frees it into the same arena
+    CHECK(arena_attach(shared) == shared && shared[0].stats.allocations == 1);
+    arena_free(arena_attach(shared), block);
+    CHECK(shared[0].stats.live_bytes == 0);
+    CHECK(lifter_alloc(90) == block);
+    lifter_free(block);
+}
+
+// ---------------------------------------------------------------------------
+// WASM emitter, end to end
+// ---------------------------------------------------------------------------
+
+struct GuestRun {
+    bool ok = false;
+    uint64_t pc = 0;
+    uint64_t gpr[32] = {};
+    uint8_t dirty[16] = {};
+};
+
+// Dirty map of the blocks emitted with one (16 pages, at linear kDirtyMap)
+static constexpr uint32_t kDirtyMap = 0xF000;
+static constexpr uint32_t kDirtyPages = 16;
+
+// Instantiates the module over a fresh memory holding the state at 0,
+// applies "rN=value" (register) and "mADDR=value" (u64 at a guest address)
+// and prints the returned PC, the registers and the dirty map afterwards
+static const char kRunner[] =
+    "const v=new DataView((m=new WebAssembly.Memory({initial:1})).buffer);"
+    "for(const a of process.argv.slice(2)){const[k,x]=a.split(\"=\");"
+    "v.setBigUint64(k[0]==\"r\"?8*+k.slice(1):Number(k.slice(1)),BigInt(x),true);}"
+    "const i=new WebAssembly.Instance(new WebAssembly.Module(require(\"fs\").readFileSync(process.argv[1])),{env:{memory:m}});"
+    "console.log(BigInt.asUintN(64,i.exports.run(0)).toString(16));"
+    "for(let r=0;r<32;r++)console.log(v.getBigUint64(8*r,true).toString(16));"
+    "for(let p=0;p<16;p++)console.log(v.getUint8(0xf000+p).toString(16));";
+
+static bool have_node() {
+    static const int found = std::system("node --version > /dev/null 2>&1") == 0 ? 1 : 0;
+    return found;
+}
+
+static std::vector<uint8_t> a64_code(std::initializer_list<uint32_t> words) {
+    std::vector<uint8_t> code;
+    for (uint32_t w : words) {
+        for (int i = 0; i < 4; i++) code.push_back(static_cast<uint8_t>(w >> (8 * i)));
+    }
+    return code;
+}
+
+// Lifts and emits the block at `entry` (guest memory at linear 0) and runs it
+// once; with `dirty`, its stores mark the map at kDirtyMap
+static GuestRun run_block(const std::vector<uint8_t>& code, Arch arch, uint64_t entry,
+                          const std::vector<std::string>& init, bool dirty = false) {
+    GuestRun run;
+    IRInstruction ir[64];
+    static uint8_t module[1 << 16];
+    const int size = lift_and_emit(code.data(), code.size(), entry, static_cast<int>(arch), 0, 0,
+                                   dirty ? kDirtyMap : 0, dirty ? kDirtyPages : 0, ir, 64, module, sizeof(module));
+    CHECK(size > 0);
+    if (size <= 0) return run;
+
+    char path[] = "/tmp/lifter_test_XXXXXX";
+    const int fd = mkstemp(path);
+    CHECK(fd >= 0);
+    if (fd < 0) return run;
+    const bool written = write(fd, module, static_cast<size_t>(size)) == size;
+    close(fd);
+    CHECK(written);
+
+    std::string command = std::string("node -e '") + kRunner + "' " + path;
+    for (const std::string& arg : init) command += " " + arg;
+    FILE* pipe = written ? popen(command.c_str(), "r") : nullptr;
+    if (pipe) {
+        unsigned long long v = 0;
+        run.ok = std::fscanf(pipe, "%llx", &v) == 1;
+        run.pc = v;
+        for (int r = 0; r < 32 && run.ok; r++) {
+            run.ok = std::fscanf(pipe, "%llx", &v) == 1;
+            run.gpr[r] = v;
+        }
+        for (int p = 0; p < 16 && run.ok; p++) {
+            run.ok = std::fscanf(pipe, "%llx", &v) == 1;
+            run.dirty[p] = static_cast<uint8_t>(v);
+        }
+        run.ok = pclose(pipe) == 0 && run.ok;
+    }
+    unlink(path);
+    CHECK(run.ok);
+    return run;
+}
+
+// ldrsw x0, [x1]; cmp x0, #0; b.lt: the loaded -5 must compare as negative
+static void test_emit_a64_signed_load_branch() {
+    const GuestRun run = run_block(a64_code({ 0xB9800020, 0xF100001F, 0x5400004B }), Arch::ARM64, 0x2000,
+                                   { "r1=0x800", "m2048=0x12345678fffffffb" });
+    CHECK(run.pc == 0x2010);
+    CHECK(run.gpr[0] == 0xFFFFFFFFFFFFFFFBull);
+
+    // ldrsb w0, [x1]: sign-extended to 32 bits only
+    const GuestRun narrow = run_block(a64_code({ 0x39C00020, 0xD65F03C0 }), Arch::ARM64, 0x2000,
+                                      { "r1=0x800", "m2048=0x80", "r30=0x5000" });
+    CHECK(narrow.pc == 0x5000);
+    CHECK(narrow.gpr[0] == 0xFFFFFF80ull);
+}
+
+static void test_emit_a64_compare_and_branch() {
+    // cmp x1, x2; add x3, x3, #1; b.eq: the plain ADD leaves the CMP flags
+    const GuestRun eq = run_block(a64_code({ 0xEB02003F, 0x91000463, 0x54000040 }), Arch::ARM64, 0x2000,
+                                  { "r1=7", "r2=7", "r3=1" });
+    CHECK(eq.pc == 0x2010);
+    CHECK(eq.gpr[3] == 2);
+
+    // adds x0, x1, x2; b.cs: carry out of ~0 + 1
+    const GuestRun carry = run_block(a64_code({ 0xAB020020, 0x54000042 }), Arch::ARM64, 0x2000,
+                                     { "r1=0xffffffffffffffff", "r2=1" });
+    CHECK(carry.pc == 0x200C);
+    CHECK(carry.gpr[0] == 0);
+    const GuestRun no_carry = run_block(a64_code({ 0xAB020020, 0x54000042 }), Arch::ARM64, 0x2000,
+                                        { "r1=2", "r2=1" });
+    CHECK(no_carry.pc == 0x2008);
+
+    // cmp x1, x2; csetm x0, eq; smull x4, w5, w6; ret
+    const GuestRun mask = run_block(a64_code({ 0xEB02003F, 0xDA9F13E0, 0x9B267CA4, 0xD65F03C0 }), Arch::ARM64,
+                                    0x2000, { "r1=3", "r2=3", "r5=0x12345678fffffffd", "r6=7", "r30=0x5000" });
+    CHECK(mask.pc == 0x5000);
+    CHECK(mask.gpr[0] == ~0ull);
+    CHECK(mask.gpr[4] == static_cast<uint64_t>(-21));
+}
+
+// cmp eax, ebx; inc ecx; jb: INC leaves the carry from CMP for JB to read
+static void test_emit_x86_inc_keeps_carry() {
+    const std::vector<uint8_t> code = { 0x39, 0xD8, 0xFF, 0xC1, 0x72, 0x05 };
+    const GuestRun below = run_block(code, Arch::X86_64, 0x1000, { "r0=1", "r3=2", "r1=9" });
+    CHECK(below.pc == 0x100B);
+    CHECK(below.gpr[1] == 10);
+    const GuestRun above = run_block(code, Arch::X86_64, 0x1000, { "r0=3", "r3=2", "r1=9" });
+    CHECK(above.pc == 0x1006);
+}
+
+// A block that patches another block's code (page 2) marks that page, and a
+// store straddling a page end marks both pages; the stores themselves still
+// land. Without a dirty map nothing is marked.
+static void test_emit_stores_mark_dirty_pages() {
+    // mov byte [rbx], 0x90; mov [rcx], rax; mov rdx, [rcx]; ret
+    const std::vector<uint8_t> code = { 0xC6, 0x03, 0x90, 0x48, 0x89, 0x01, 0x48, 0x8B, 0x11, 0xC3 };
+    const std::vector<std::string> init = { "r3=0x2000", "r1=0x4ffc", "r0=0x1122334455667788", "r4=0x8000",
+                                            "m32768=0x1000" };
+    const GuestRun run = run_block(code, Arch::X86_64, 0x1000, init, true);
+    CHECK(run.pc == 0x1000);
+    CHECK(run.gpr[2] == 0x1122334455667788ull);
+    for (uint32_t p = 0; p < kDirtyPages; p++) CHECK(run.dirty[p] == (p == 2 || p == 4 || p == 5 ? 1 : 0));
+
+    const GuestRun plain = run_block(code, Arch::X86_64, 0x1000, init);
+    CHECK(plain.gpr[2] == 0x1122334455667788ull);
+    for (uint32_t p = 0; p < kDirtyPages; p++) CHECK(plain.dirty[p] == 0);
+}
+
+// A block patching its own code (at 0x1000) marks the page it runs from,
+// which LazyBlockTier revalidates before the block runs again
+static void test_emit_self_patch_marks_code_page() {
+    // mov byte [rbx], 0xc3; mov rdx, [rbx]; ret
+    const std::vector<uint8_t> code = { 0xC6, 0x03, 0xC3, 0x48, 0x8B, 0x13, 0xC3 };
+    const std::vector<std::string> init = { "r3=0x1000", "r4=0x8000", "m32768=0x1000", "m4096=0x1390" };
+    const GuestRun run = run_block(code, Arch::X86_64, 0x1000, init, true);
+    CHECK(run.pc == 0x1000);
+    CHECK(run.gpr[2] == 0x13c3ull);
+    for (uint32_t p = 0; p < kDirtyPages; p++) CHECK(run.dirty[p] == (p == 1 ? 1 : 0));
+}
+
+int main() {
+    test_stream_overlong_prefix_run();
+    test_stream_finish_emits_truncated_tail();
+    test_x86_modrm_sib();
+    test_x86_prefixes();
+    test_x86_immediates_and_groups();
+    test_basic_block_counts_what_it_returns();
+    test_soa_layout();
+    test_cfg_shared_block();
+    test_cfg_split_on_back_edge();
+    test_cfg_limits_and_exits();
+    test_peephole_loop_writes_rcx();
+    test_a64_signed_loads();
+    test_a64_flag_setting();
+    test_a64_conditional_set_multiply_and_eret();
+    test_arena_reuse_by_size_class();
+    test_arena_exhaustion();
+    test_arena_bounded();
+    test_lifter_attach_after_allocate();
+    if (have_node()) {
+        test_emit_a64_signed_load_branch();
+        test_emit_a64_compare_and_branch();
+        test_emit_x86_inc_keeps_carry();
+        test_emit_stores_mark_dirty_pages();
+        test_emit_self_patch_marks_code_page();
+    } else {
+        std::puts("lifter_test: node not found, skipping the emitter cases");
+    }
+
+    if (failures) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::puts("lifter_test: all checks passed");
+    return 0;
+}
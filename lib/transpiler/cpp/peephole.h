@@ -0,0 +1,359 @@
+// Freestanding C++ Lifter - IR Peephole Pass
+// Runs over lifted x86 blocks before the IR leaves WASM:
+//   - EFLAGS liveness: flag results nobody reads get IR_ATTR_FLAGS_DEAD, and
+//     CMP/TEST whose flags are dead are removed
+//   - PUSH/POP folding: a push whose value is popped into a register a few
+//     instructions later becomes a MOV
+//   - Constant propagation: registers with known values are substituted as
+//     immediates and ALU operations on constants fold into MOV when their
+//     flags are dead
+// Other architectures pass through unchanged.
+
+#pragma once
+
+#include "lifter.h"
+
+class Peephole {
+public:
+    // Coarse flag groups: CF on its own (INC/DEC leave it intact), the rest together
+    enum : uint8_t {
+        FLAG_CF = 1,
+        FLAG_OSZAP = 2,
+        FLAGS_ALL = 3
+    };
+
+    // Optimizes one straight-line block in place. `live_out` holds the flags
+    // its successors may read. Returns the new instruction count.
+    static size_t run(IRInstruction* ir, size_t count, Arch arch, uint8_t live_out = FLAGS_ALL) {
+        if (arch != Arch::X86 && arch != Arch::X86_64) return count;
+        const bool long_mode = arch == Arch::X86_64;
+
+        fold_push_pop(ir, count, long_mode);
+        propagate(ir, count, false);
+        mark_dead_flags(ir, count, live_out);
+        propagate(ir, count, true);
+        return compact(ir, count);
+    }
+
+    // Flags live on entry to a block, given those live on exit
+    static uint8_t live_in(const IRInstruction* ir, size_t count, Arch arch, uint8_t live_out) {
+        if (arch != Arch::X86 && arch != Arch::X86_64) return FLAGS_ALL;
+        uint8_t live = live_out;
+        for (size_t i = count; i-- > 0;) {
+            if (ir[i].attr & IR_ATTR_REMOVED) continue;
+            const FlagEffect e = flag_effect(ir[i]);
+            live = static_cast<uint8_t>((live & ~e.writes) | e.reads);
+        }
+        return live;
+    }
+
+private:
+    static constexpr uint8_t kStackPointer = REG_GPR0 + 4;
+    static constexpr uint8_t kCounter = REG_GPR0 + 1;       // RCX, decremented by LOOP*
+    static constexpr int kFoldWindow = 4;
+
+    struct FlagEffect {
+        uint8_t reads;
+        uint8_t writes;       // Always written
+        uint8_t may_write;    // Written for some inputs only (e.g. shift by CL)
+    };
+
+    static uint8_t kind(const IRInstruction& in, int slot) { return ir_operand_kind(in.info, slot); }
+
+    static uint8_t reg(const IRInstruction& in, int slot) {
+        const uint64_t v = slot == 0 ? in.op1 : slot == 1 ? in.op2 : in.op3;
+        return static_cast<uint8_t>(v);
+    }
+
+    static uint8_t cc_flags(uint64_t cc) {
+        switch (cc) {
+            case 2: case 3: return FLAG_CF;                       // B, AE
+            case 6: case 7: return FLAGS_ALL;                     // BE, A
+            case CC_X86_LOOP: case CC_X86_JCXZ: return 0;
+            default: return FLAG_OSZAP;                           // O, Z, S, P, L, LE, LOOPE/NE
+        }
+    }
+
+    static FlagEffect flag_effect(const IRInstruction& in) {
+        switch (in.opcode) {
+            case IROpcode::ADD: case IROpcode::SUB: case IROpcode::AND: case IROpcode::OR:
+            case IROpcode::XOR: case IROpcode::CMP: case IROpcode::TEST: case IROpcode::NEG:
+            case IROpcode::MUL: case IROpcode::DIV:
+                return { 0, FLAGS_ALL, 0 };
+            case IROpcode::ADC: case IROpcode::SBB:
+                return { FLAG_CF, FLAGS_ALL, 0 };
+            case IROpcode::INC: case IROpcode::DEC:
+                return { 0, FLAG_OSZAP, 0 };
+            case IROpcode::SHL: case IROpcode::SHR: case IROpcode::SAR:
+            case IROpcode::ROL: case IROpcode::ROR: {
+                // A zero count leaves every flag untouched
+                if (kind(in, 1) != OPK_IMM) return { 0, 0, FLAGS_ALL };
+                if ((in.op2 & (ir_width(in.info) == W64 ? 63 : 31)) == 0) return { 0, 0, 0 };
+                const bool rotate = in.opcode == IROpcode::ROL || in.opcode == IROpcode::ROR;
+                return rotate ? FlagEffect{ 0, FLAG_CF, FLAG_OSZAP } : FlagEffect{ 0, FLAGS_ALL, 0 };
+            }
+            case IROpcode::JE: case IROpcode::JNE:
+                return { FLAG_OSZAP, 0, 0 };
+            case IROpcode::JCC: case IROpcode::SETCC:
+                return { cc_flags(in.op2), 0, 0 };
+            case IROpcode::CMOV:
+                return { cc_flags(in.op3), 0, 0 };
+            case IROpcode::PUSH:
+                return { static_cast<uint8_t>(kind(in, 0) == OPK_NONE ? FLAGS_ALL : 0), 0, 0 };   // PUSHF
+            case IROpcode::POP:
+                return { 0, static_cast<uint8_t>(kind(in, 0) == OPK_NONE ? FLAGS_ALL : 0), 0 };   // POPF
+            case IROpcode::MOV: case IROpcode::MOVZX: case IROpcode::MOVSX: case IROpcode::LEA:
+            case IROpcode::XCHG: case IROpcode::LOAD: case IROpcode::STORE: case IROpcode::JMP:
+            case IROpcode::NOP: case IROpcode::NOT:
+            case IROpcode::V_ADD: case IROpcode::V_SUB: case IROpcode::V_MUL: case IROpcode::V_DIV:
+            case IROpcode::V_AND: case IROpcode::V_OR: case IROpcode::V_XOR: case IROpcode::V_MOV:
+                return { 0, 0, 0 };
+            default:
+                // CALL, RET, SYSCALL, TRAP, UNKNOWN, V_CMP: assume everything is read
+                return { FLAGS_ALL, 0, 0 };
+        }
+    }
+
+    static void mark_dead_flags(IRInstruction* ir, size_t count, uint8_t live_out) {
+        uint8_t live = live_out;
+        for (size_t i = count; i-- > 0;) {
+            IRInstruction& in = ir[i];
+            if (in.attr & IR_ATTR_REMOVED) continue;
+            const FlagEffect e = flag_effect(in);
+            const uint8_t touched = e.writes | e.may_write;
+            if (touched && !(touched & live)) {
+                in.attr |= IR_ATTR_FLAGS_DEAD;
+                // Compares exist only for their flags; a memory operand read here has no other use
+                if (in.opcode == IROpcode::CMP || in.opcode == IROpcode::TEST) in.attr |= IR_ATTR_REMOVED;
+            }
+            live = static_cast<uint8_t>((live & ~e.writes) | e.reads);
+        }
+    }
+
+    // True when `in` may write GPR `r` (explicitly or implicitly)
+    static bool writes_gpr(const IRInstruction& in, uint8_t r) {
+        switch (in.opcode) {
+            case IROpcode::CMP: case IROpcode::TEST: case IROpcode::STORE: case IROpcode::NOP:
+            case IROpcode::JE: case IROpcode::JNE: case IROpcode::JMP:
+                return false;
+            case IROpcode::JCC:
+                // LOOPNE/LOOPE/LOOP count RCX down; JCXZ only reads it
+                return r == kCounter && in.op2 >= CC_X86_LOOPNE && in.op2 <= CC_X86_LOOP;
+            case IROpcode::PUSH:
+                return r == kStackPointer;
+            case IROpcode::XCHG:
+                return writes_slot(in, 0, r) || writes_slot(in, 1, r);
+            case IROpcode::ADD: case IROpcode::SUB: case IROpcode::AND: case IROpcode::OR:
+            case IROpcode::XOR: case IROpcode::ADC: case IROpcode::SBB: case IROpcode::NEG:
+            case IROpcode::NOT: case IROpcode::INC: case IROpcode::DEC: case IROpcode::SHL:
+            case IROpcode::SHR: case IROpcode::SAR: case IROpcode::ROL: case IROpcode::ROR:
+            case IROpcode::MOV: case IROpcode::LEA: case IROpcode::CMOV: case IROpcode::SETCC:
+            case IROpcode::LOAD:
+                return writes_slot(in, 0, r);
+            case IROpcode::MOVZX: case IROpcode::MOVSX:
+                // Operand-less forms are CBW/CWDE/CDQE on the accumulator
+                return kind(in, 0) == OPK_NONE ? r == REG_GPR0 : writes_slot(in, 0, r);
+            case IROpcode::POP:
+                return r == kStackPointer || writes_slot(in, 0, r);
+            default:
+                // MUL/DIV (implicit RDX:RAX), CALL, SYSCALL, UNKNOWN, ...
+                return true;
+        }
+    }
+
+    static bool writes_slot(const IRInstruction& in, int slot, uint8_t r) {
+        if (kind(in, slot) != OPK_REG) return false;
+        const uint8_t id = reg(in, slot);
+        // AH..BH alias bits 8-15 of RAX..RBX
+        return id == r || (id >= REG_AH && id < REG_AH + 4 && id - REG_AH == r);
+    }
+
+    static bool touches_stack_or_memory(const IRInstruction& in) {
+        for (int slot = 0; slot < 3; slot++) {
+            if (kind(in, slot) == OPK_MEM) return true;
+            if (kind(in, slot) == OPK_REG && reg(in, slot) == kStackPointer) return true;
+        }
+        return false;
+    }
+
+    static bool is_control_flow(IROpcode op) {
+        switch (op) {
+            case IROpcode::JMP: case IROpcode::JE: case IROpcode::JNE: case IROpcode::JCC:
+            case IROpcode::CALL: case IROpcode::RET: case IROpcode::SYSCALL: case IROpcode::TRAP:
+            case IROpcode::UNKNOWN:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // PUSH src; ...; POP dst -> MOV dst, src when nothing in between uses the
+    // stack or memory, or changes src
+    static void fold_push_pop(IRInstruction* ir, size_t count, bool long_mode) {
+        const uint8_t stack_width = long_mode ? W64 : W32;
+        for (size_t i = 0; i < count; i++) {
+            IRInstruction& push = ir[i];
+            if (push.opcode != IROpcode::PUSH || ir_width(push.info) != stack_width) continue;
+            const uint8_t k = kind(push, 0);
+            const bool src_reg = k == OPK_REG && reg(push, 0) < 16 && reg(push, 0) != kStackPointer;
+            if (!src_reg && k != OPK_IMM) continue;
+
+            for (size_t j = i + 1; j < count && j <= i + kFoldWindow; j++) {
+                IRInstruction& next = ir[j];
+                if (next.attr & IR_ATTR_REMOVED) continue;
+                if (next.opcode == IROpcode::POP) {
+                    if (kind(next, 0) == OPK_REG && reg(next, 0) < 16 && reg(next, 0) != kStackPointer &&
+                        ir_width(next.info) == stack_width) {
+                        const uint8_t dst = reg(next, 0);
+                        if (src_reg && reg(push, 0) == dst) {
+                            next.attr |= IR_ATTR_REMOVED;
+                        } else {
+                            next.opcode = IROpcode::MOV;
+                            next.op2 = push.op1;
+                            next.info = ir_info(OPK_REG, k, OPK_NONE, stack_width);
+                        }
+                        push.attr |= IR_ATTR_REMOVED;
+                    }
+                    break;
+                }
+                if (is_control_flow(next.opcode) || next.opcode == IROpcode::PUSH || touches_stack_or_memory(next) ||
+                    (src_reg && writes_gpr(next, reg(push, 0)))) {
+                    break;
+                }
+            }
+        }
+    }
+
+    static uint64_t truncate(uint64_t v, uint8_t width) {
+        return width == W64 ? v : v & ((1ull << (8u << width)) - 1);
+    }
+
+    static uint64_t sign_extend(uint64_t v, uint8_t width) {
+        if (width == W64) return v;
+        const uint64_t sign = 1ull << ((8u << width) - 1);
+        v = truncate(v, width);
+        return (v ^ sign) - sign;
+    }
+
+    // Result of a two-operand ALU op at `width`, zero-extended into the register
+    static bool evaluate(IROpcode op, uint64_t a, uint64_t b, uint8_t width, uint64_t& out) {
+        const unsigned shift = static_cast<unsigned>(b & (width == W64 ? 63 : 31));
+        switch (op) {
+            case IROpcode::ADD: out = a + b; break;
+            case IROpcode::SUB: out = a - b; break;
+            case IROpcode::AND: out = a & b; break;
+            case IROpcode::OR: out = a | b; break;
+            case IROpcode::XOR: out = a ^ b; break;
+            case IROpcode::SHL: out = truncate(a, width) << shift; break;
+            case IROpcode::SHR: out = truncate(a, width) >> shift; break;
+            case IROpcode::SAR: out = static_cast<uint64_t>(static_cast<int64_t>(sign_extend(a, width)) >> shift); break;
+            case IROpcode::INC: out = a + 1; break;
+            case IROpcode::DEC: out = a - 1; break;
+            case IROpcode::NEG: out = 0 - a; break;
+            case IROpcode::NOT: out = ~a; break;
+            default: return false;
+        }
+        out = truncate(out, width);
+        return true;
+    }
+
+    static void to_mov_imm(IRInstruction& in, uint8_t width, uint64_t value) {
+        in.opcode = IROpcode::MOV;
+        in.op2 = sign_extend(value, width);
+        in.op3 = 0;
+        in.info = ir_info(OPK_REG, OPK_IMM, OPK_NONE, width);
+        in.attr &= static_cast<uint8_t>(~IR_ATTR_FLAGS_DEAD);
+    }
+
+    // Forward pass tracking GPRs with known values. Substitutes known source
+    // registers with immediates; with `fold`, also rewrites ALU operations on
+    // constants whose flags are dead into MOV.
+    static void propagate(IRInstruction* ir, size_t count, bool fold) {
+        uint64_t value[16];
+        uint32_t known = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            IRInstruction& in = ir[i];
+            if (in.attr & IR_ATTR_REMOVED) continue;
+            const uint8_t width = ir_width(in.info);
+            const bool wide = width >= W32;
+
+            // Source substitution
+            const bool subst = kind(in, 1) == OPK_REG && reg(in, 1) < 16 && (known >> reg(in, 1) & 1) &&
+                               kind(in, 2) == OPK_NONE;
+            switch (in.opcode) {
+                case IROpcode::ADD: case IROpcode::SUB: case IROpcode::AND: case IROpcode::OR:
+                case IROpcode::XOR: case IROpcode::ADC: case IROpcode::SBB: case IROpcode::CMP:
+                case IROpcode::TEST: case IROpcode::MOV: case IROpcode::STORE:
+                    // x86 has no ALU form with two immediates; xor r, r stays an idiom
+                    if (subst && wide && !(kind(in, 0) == OPK_REG && reg(in, 0) == reg(in, 1))) {
+                        in.op2 = sign_extend(value[reg(in, 1)], width);
+                        in.info = ir_info(kind(in, 0), OPK_IMM, OPK_NONE, width);
+                    }
+                    break;
+                case IROpcode::SHL: case IROpcode::SHR: case IROpcode::SAR:
+                case IROpcode::ROL: case IROpcode::ROR:
+                    if (subst) {
+                        in.op2 = value[reg(in, 1)] & 0xFF;
+                        in.info = ir_info(kind(in, 0), OPK_IMM, OPK_NONE, width);
+                    }
+                    break;
+                case IROpcode::PUSH:
+                    if (kind(in, 0) == OPK_REG && reg(in, 0) < 16 && (known >> reg(in, 0) & 1) && wide) {
+                        in.op1 = sign_extend(value[reg(in, 0)], width);
+                        in.info = ir_info(OPK_IMM, OPK_NONE, OPK_NONE, width);
+                    }
+                    break;
+                default:
+                    break;
+            }
+
+            // Value tracking for the destination
+            const bool dst_reg = kind(in, 0) == OPK_REG && reg(in, 0) < 16;
+            const uint8_t dst = dst_reg ? reg(in, 0) : 0;
+            const bool dst_known = dst_reg && (known >> dst & 1);
+            bool have = false;
+            uint64_t result = 0;
+
+            if (dst_reg && wide) {
+                if (in.opcode == IROpcode::MOV && kind(in, 1) == OPK_IMM && kind(in, 2) == OPK_NONE) {
+                    result = truncate(in.op2, width);
+                    have = true;
+                } else if ((in.opcode == IROpcode::XOR || in.opcode == IROpcode::SUB) &&
+                           kind(in, 1) == OPK_REG && reg(in, 1) == dst) {
+                    // Zeroing idioms
+                    result = 0;
+                    have = true;
+                } else if (dst_known && kind(in, 1) == OPK_IMM && kind(in, 2) == OPK_NONE) {
+                    have = evaluate(in.opcode, value[dst], in.op2, width, result);
+                } else if (dst_known && kind(in, 1) == OPK_NONE) {
+                    have = evaluate(in.opcode, value[dst], 0, width, result);
+                }
+            }
+
+            if (fold && have && in.opcode != IROpcode::MOV &&
+                (in.opcode == IROpcode::NOT || (in.attr & IR_ATTR_FLAGS_DEAD))) {
+                to_mov_imm(in, width, result);
+            }
+
+            // Invalidate everything this instruction may write, then record the result
+            for (uint8_t r = 0; r < 16; r++) {
+                if ((known >> r & 1) && writes_gpr(in, r)) known &= ~(1u << r);
+            }
+            if (have) {
+                value[dst] = result;
+                known |= 1u << dst;
+            }
+        }
+    }
+
+    static size_t compact(IRInstruction* ir, size_t count) {
+        size_t out = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (ir[i].attr & IR_ATTR_REMOVED) continue;
+            if (out != i) ir[out] = ir[i];
+            out++;
+        }
+        return out;
+    }
+};
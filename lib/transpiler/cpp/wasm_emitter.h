@@ -0,0 +1,1116 @@
+// Freestanding C++ Lifter - WebAssembly Emitter
+// Translates one lifted basic block into a WASM function in a single pass
+// over a caller-provided buffer:
+//   (func (param $state i32) (result i64))
+// $state points at a WasmGuestState in linear memory. Guest registers live
+// in i64 locals, loaded from the state on first read and stored back on
+// exit; the function returns the guest address to continue at. Guest
+// memory is linear memory offset by `guest_base`.
+//
+// Flags are lazy: the operands and result of the last flag-setting
+// operation are kept in locals, conditions in the same block are evaluated
+// from them directly, and the record is stored in the state on exit.
+// An instruction that cannot be lowered (or a condition whose flags were
+// set outside the block) ends the block early: the function returns that
+// instruction's address so the caller can interpret it.
+//
+// With a dirty map (a `dirty_pages`-byte table at linear `dirty_map`), every
+// guest store also sets the byte for the 4 KiB guest page it wrote, indexed
+// modulo the table size, so a runtime can find blocks whose code the
+// translated code overwrote before it runs them again.
+
+#pragma once
+
+#include "lifter.h"
+
+// Guest state shared with the runtime (mirrored in native-lifter.ts)
+struct WasmGuestState {
+    uint64_t gpr[32];       // Indexed by register id (REG_GPR0 + n)
+    uint32_t flag_kind;     // WasmFlagKind of the last flag-setting operation
+    uint32_t flag_width;    // OperandWidth it ran at
+    uint64_t flag_a;        // Operands and result, unnormalized
+    uint64_t flag_b;
+    uint64_t flag_result;
+};
+
+static_assert(offsetof(WasmGuestState, flag_kind) == 256, "state layout is shared with JS");
+static_assert(offsetof(WasmGuestState, flag_a) == 264, "state layout is shared with JS");
+
+enum WasmFlagKind : uint32_t {
+    WASM_FLAGS_NONE = 0,
+    WASM_FLAGS_SUB = 1,      // CMP/SUB/NEG: a - b
+    WASM_FLAGS_ADD = 2,      // a + b
+    WASM_FLAGS_LOGIC = 3,    // AND/OR/XOR/TEST: carry and overflow clear
+    WASM_FLAGS_RESULT = 4,   // Shifts: only zero and sign are derivable
+    WASM_FLAGS_UNKNOWN = 5,  // Flags changed in a way the record cannot describe
+    WASM_FLAGS_KEEP_CF = 6   // INC/DEC: zero and sign from the result, CF (0/1) kept in b
+};
+
+class WasmEmitter {
+public:
+    // `dirty_pages` is a power of two, or 0 for no dirty map
+    WasmEmitter(uint8_t* out, size_t capacity, Arch arch, uint32_t guest_base,
+                uint32_t dirty_map = 0, uint32_t dirty_pages = 0)
+        : out_(out), cap_(capacity), guest_base_(guest_base), dirty_map_(dirty_map), dirty_pages_(dirty_pages),
+          x86_(arch == Arch::X86 || arch == Arch::X86_64),
+          stack_width_(arch == Arch::X86 ? W32 : W64) {}
+
+    // Function body (locals + code) for the block. Returns the bytes
+    // written, or 0 if the buffer is too small or the first instruction
+    // cannot be lowered.
+    size_t emit_function(const IRInstruction* ir, size_t count) {
+        pos_ = 0;
+        overflow_ = false;
+        if (!body(ir, count) || overflow_) return 0;
+        return pos_;
+    }
+
+    // Complete module importing env.memory and exporting the block as "run"
+    size_t emit_module(const IRInstruction* ir, size_t count, bool shared_memory) {
+        pos_ = 0;
+        overflow_ = false;
+        static constexpr uint8_t kHeader[] = {
+            0x00, 0x61, 0x73, 0x6D, 0x01, 0x00, 0x00, 0x00,
+            0x01, 0x06, 0x01, 0x60, 0x01, 0x7F, 0x01, 0x7E,         // type 0: (i32) -> i64
+        };
+        for (uint8_t b : kHeader) put(b);
+
+        put(0x02);                                                  // import env.memory
+        const size_t imports = reserve_u32();
+        put(0x01);
+        name("env");
+        name("memory");
+        put(0x02);
+        if (shared_memory) {
+            put(0x03);
+            uleb(0);
+            uleb(65536);
+        } else {
+            put(0x00);
+            uleb(0);
+        }
+        patch_u32(imports, pos_ - imports - 5);
+
+        static constexpr uint8_t kFuncExport[] = {
+            0x03, 0x02, 0x01, 0x00,                                 // func 0: type 0
+            0x07, 0x07, 0x01, 0x03, 'r', 'u', 'n', 0x00, 0x00,      // export "run" = func 0
+        };
+        for (uint8_t b : kFuncExport) put(b);
+
+        put(0x0A);
+        const size_t section = reserve_u32();
+        put(0x01);
+        const size_t func = reserve_u32();
+        if (!body(ir, count) || overflow_) return 0;
+        patch_u32(func, pos_ - func - 5);
+        patch_u32(section, pos_ - section - 5);
+        return overflow_ ? 0 : pos_;
+    }
+
+private:
+    // WASM opcodes used below
+    enum : uint8_t {
+        OP_END = 0x0B, OP_DROP = 0x1A, OP_SELECT = 0x1B,
+        OP_LOCAL_GET = 0x20, OP_LOCAL_SET = 0x21, OP_LOCAL_TEE = 0x22,
+        OP_I32_STORE = 0x36, OP_I32_STORE8 = 0x3A, OP_I64_LOAD = 0x29, OP_I64_STORE = 0x37,
+        OP_I32_CONST = 0x41, OP_I64_CONST = 0x42,
+        OP_I32_EQZ = 0x45, OP_I32_ADD = 0x6A, OP_I32_AND = 0x71, OP_I32_OR = 0x72, OP_I32_SHR_U = 0x76, OP_I32_ROTL = 0x77, OP_I32_ROTR = 0x78,
+        OP_I64_EQZ = 0x50, OP_I64_LT_S = 0x53, OP_I64_LT_U = 0x54, OP_I64_GT_S = 0x55, OP_I64_GT_U = 0x56,
+        OP_I64_LE_S = 0x57, OP_I64_LE_U = 0x58, OP_I64_GE_S = 0x59, OP_I64_GE_U = 0x5A,
+        OP_I64_ADD = 0x7C, OP_I64_SUB = 0x7D, OP_I64_MUL = 0x7E, OP_I64_AND = 0x83, OP_I64_OR = 0x84,
+        OP_I64_XOR = 0x85, OP_I64_SHL = 0x86, OP_I64_SHR_S = 0x87, OP_I64_SHR_U = 0x88,
+        OP_I64_ROTL = 0x89, OP_I64_ROTR = 0x8A,
+        OP_I32_WRAP_I64 = 0xA7, OP_I64_EXTEND_I32_U = 0xAD,
+        OP_I64_EXTEND8_S = 0xC2, OP_I64_EXTEND16_S = 0xC3, OP_I64_EXTEND32_S = 0xC4
+    };
+
+    // Locals: 0 is $state, then two i32 and the fixed i64 scratch locals;
+    // guest registers are allocated after them on first use
+    enum : uint32_t {
+        L_STATE = 0,
+        L_ADDR = 1,     // i32 linear address reused by read-modify-write forms
+        L_SADDR = 2,    // i32 linear address of a store, for the dirty map
+        L_FA = 3,       // Lazy flags: operands and result
+        L_FB = 4,
+        L_FR = 5,
+        L_NPC = 6,      // Next guest PC, returned on exit
+        L_TMP = 7,      // Scratch within one helper
+        L_VAL = 8,      // Scratch for one instruction
+        L_MERGE = 9,    // Partial register writes
+        L_SVAL = 10,    // Value of a store, for the dirty map
+        L_FIRST_REG = 11
+    };
+
+    static constexpr uint32_t kDirtyPageShift = 12;
+
+    // Conditions in terms of the comparison a ? b they test
+    enum Pred : uint8_t {
+        P_EQ, P_NE, P_LTU, P_GEU, P_LEU, P_GTU, P_LTS, P_GES, P_LES, P_GTS, P_NEG, P_NNEG, P_NONE
+    };
+
+    // Restored when an instruction turns out not to be lowerable
+    struct Snapshot {
+        size_t pos;
+        uint32_t loaded;
+        uint32_t written;
+        uint32_t flag_kind;
+        uint8_t flag_width;
+        bool flags_dirty;
+    };
+
+    uint8_t* out_;
+    size_t cap_;
+    size_t pos_ = 0;
+    bool overflow_ = false;
+    bool ok_ = true;
+    const uint32_t guest_base_;
+    const uint32_t dirty_map_;
+    const uint32_t dirty_pages_;
+    const bool x86_;
+    const uint8_t stack_width_;
+
+    uint8_t local_[32] = {};     // Register id -> local index, 0 if unallocated
+    uint32_t next_local_ = L_FIRST_REG;
+    uint32_t loaded_ = 0;        // Registers read from the state
+    uint32_t written_ = 0;       // Registers to store back on exit
+    uint32_t flag_kind_ = WASM_FLAGS_NONE;
+    uint8_t flag_width_ = W64;
+    bool flags_dirty_ = false;   // Flags set in this block
+
+    // -----------------------------------------------------------------
+    // Byte output
+    // -----------------------------------------------------------------
+
+    void put(uint8_t b) {
+        if (pos_ < cap_) out_[pos_] = b;
+        else overflow_ = true;
+        pos_++;
+    }
+
+    void uleb(uint64_t v) {
+        do {
+            uint8_t b = v & 0x7F;
+            v >>= 7;
+            if (v) b |= 0x80;
+            put(b);
+        } while (v);
+    }
+
+    void sleb(int64_t v) {
+        for (;;) {
+            const uint8_t b = v & 0x7F;
+            v >>= 7;
+            if ((v == 0 && !(b & 0x40)) || (v == -1 && (b & 0x40))) {
+                put(b);
+                return;
+            }
+            put(b | 0x80);
+        }
+    }
+
+    // Five-byte LEB128 placeholder, filled in once the size is known
+    size_t reserve_u32() {
+        const size_t at = pos_;
+        for (int i = 0; i < 5; i++) put(0);
+        return at;
+    }
+
+    void patch_u32(size_t at, size_t v) {
+        if (at + 5 > cap_) return;
+        for (int i = 0; i < 5; i++) {
+            out_[at + i] = static_cast<uint8_t>(((v >> (7 * i)) & 0x7F) | (i < 4 ? 0x80 : 0));
+        }
+    }
+
+    void name(const char* s) {
+        size_t n = 0;
+        while (s[n]) n++;
+        uleb(n);
+        for (size_t i = 0; i < n; i++) put(static_cast<uint8_t>(s[i]));
+    }
+
+    void op(uint8_t code) { put(code); }
+    void local_get(uint32_t l) { put(OP_LOCAL_GET); uleb(l); }
+    void local_set(uint32_t l) { put(OP_LOCAL_SET); uleb(l); }
+    void local_tee(uint32_t l) { put(OP_LOCAL_TEE); uleb(l); }
+    void i32_const(int32_t v) { put(OP_I32_CONST); sleb(v); }
+    void i64_const(uint64_t v) { put(OP_I64_CONST); sleb(static_cast<int64_t>(v)); }
+
+    void memarg(uint8_t code, uint8_t align, uint32_t offset) {
+        put(code);
+        uleb(align);
+        uleb(offset);
+    }
+
+    void fail() { ok_ = false; }
+
+    // -----------------------------------------------------------------
+    // Block
+    // -----------------------------------------------------------------
+
+    bool body(const IRInstruction* ir, size_t count) {
+        for (uint8_t& l : local_) l = 0;
+        next_local_ = L_FIRST_REG;
+        loaded_ = written_ = 0;
+        flag_kind_ = WASM_FLAGS_NONE;
+        flags_dirty_ = false;
+
+        // Local declarations: 2 x i32, then the i64 locals (count patched)
+        put(0x02);
+        put(0x02);
+        put(0x7F);
+        const size_t decl = reserve_u32();
+        put(0x7E);
+
+        size_t lowered = 0;
+        bool ended = false;
+        uint64_t next_pc = 0;
+        for (size_t i = 0; i < count && !ended; i++) {
+            const IRInstruction& in = ir[i];
+            if (in.attr & IR_ATTR_REMOVED) continue;
+            const Snapshot snap = { pos_, loaded_, written_, flag_kind_, flag_width_, flags_dirty_ };
+            ok_ = true;
+            ended = lower(in);
+            if (!ok_) {
+                // Side exit: the caller runs this instruction itself
+                pos_ = snap.pos;
+                loaded_ = snap.loaded;
+                written_ = snap.written;
+                flag_kind_ = snap.flag_kind;
+                flag_width_ = snap.flag_width;
+                flags_dirty_ = snap.flags_dirty;
+                if (lowered == 0) return false;
+                next_pc = in.address;
+                ended = false;
+                break;
+            }
+            lowered++;
+            next_pc = in.address + in.size;
+        }
+        if (lowered == 0) return false;
+        if (!ended) {
+            i64_const(next_pc);
+            local_set(L_NPC);
+        }
+
+        epilogue();
+        patch_u32(decl, next_local_ - L_FA);
+        return true;
+    }
+
+    void epilogue() {
+        for (uint32_t r = 0; r < 32; r++) {
+            if (!(written_ & (1u << r))) continue;
+            local_get(L_STATE);
+            local_get(local_[r]);
+            memarg(OP_I64_STORE, 3, 8 * r);
+        }
+        if (flags_dirty_) {
+            local_get(L_STATE);
+            i32_const(static_cast<int32_t>(flag_kind_));
+            memarg(OP_I32_STORE, 2, offsetof(WasmGuestState, flag_kind));
+            local_get(L_STATE);
+            i32_const(flag_width_);
+            memarg(OP_I32_STORE, 2, offsetof(WasmGuestState, flag_width));
+            if (flag_kind_ != WASM_FLAGS_UNKNOWN) {
+                static constexpr uint32_t kLocals[3] = { L_FA, L_FB, L_FR };
+                for (uint32_t k = 0; k < 3; k++) {
+                    local_get(L_STATE);
+                    local_get(kLocals[k]);
+                    memarg(OP_I64_STORE, 3, static_cast<uint32_t>(offsetof(WasmGuestState, flag_a) + 8 * k));
+                }
+            }
+        }
+        local_get(L_NPC);
+        put(OP_END);
+    }
+
+    // Lowers one instruction; returns true if it ends the block
+    bool lower(const IRInstruction& in) {
+        switch (in.opcode) {
+            case IROpcode::NOP: return false;
+            case IROpcode::MOV: lower_mov(in); return false;
+            case IROpcode::LEA: lower_lea(in); return false;
+            case IROpcode::LOAD: lower_load(in); return false;
+            case IROpcode::STORE: lower_store(in); return false;
+            case IROpcode::ADD: case IROpcode::SUB: case IROpcode::MUL: case IROpcode::AND:
+            case IROpcode::OR: case IROpcode::XOR: case IROpcode::SHL: case IROpcode::SHR:
+            case IROpcode::SAR: case IROpcode::ROL: case IROpcode::ROR:
+                lower_alu(in);
+                return false;
+            case IROpcode::NEG: case IROpcode::NOT: case IROpcode::INC: case IROpcode::DEC:
+                lower_unary(in);
+                return false;
+            case IROpcode::CMP: case IROpcode::TEST: lower_compare(in); return false;
+            case IROpcode::XCHG: lower_xchg(in); return false;
+            case IROpcode::CMOV: lower_cmov(in); return false;
+            case IROpcode::SETCC: lower_setcc(in); return false;
+            case IROpcode::PUSH: lower_push(in); return false;
+            case IROpcode::POP: lower_pop(in); return false;
+            case IROpcode::JMP: lower_jmp(in); return true;
+            case IROpcode::JE: case IROpcode::JNE: case IROpcode::JCC: lower_branch(in); return true;
+            case IROpcode::CALL: lower_call(in); return true;
+            case IROpcode::RET: lower_ret(in); return true;
+            default: fail(); return true;
+        }
+    }
+
+    // -----------------------------------------------------------------
+    // Operands
+    // -----------------------------------------------------------------
+
+    static uint8_t kind(const IRInstruction& in, int slot) { return ir_operand_kind(in.info, slot); }
+
+    static uint64_t value(const IRInstruction& in, int slot) {
+        return slot == 0 ? in.op1 : slot == 1 ? in.op2 : in.op3;
+    }
+
+    static uint64_t width_mask(uint8_t width) {
+        return width == W64 ? ~0ull : (1ull << (8u << width)) - 1;
+    }
+
+    // Zero- or sign-extend the i64 on the stack from `width`
+    void norm_u(uint8_t width) {
+        if (width == W64) return;
+        i64_const(width_mask(width));
+        op(OP_I64_AND);
+    }
+
+    void norm_s(uint8_t width) {
+        static constexpr uint8_t kExtend[3] = { OP_I64_EXTEND8_S, OP_I64_EXTEND16_S, OP_I64_EXTEND32_S };
+        if (width != W64) op(kExtend[width]);
+    }
+
+    void extend(uint8_t width, bool sign) {
+        if (sign) norm_s(width);
+        else norm_u(width);
+    }
+
+    uint32_t reg_local(uint8_t r) {
+        if (!local_[r]) local_[r] = static_cast<uint8_t>(next_local_++);
+        return local_[r];
+    }
+
+    void read_reg(uint8_t r) {
+        if (r == REG_ZR) {
+            i64_const(0);
+            return;
+        }
+        if (r >= 32) {
+            fail();
+            i64_const(0);
+            return;
+        }
+        const uint32_t l = reg_local(r);
+        if (!((loaded_ | written_) & (1u << r))) {
+            local_get(L_STATE);
+            memarg(OP_I64_LOAD, 3, 8u * r);
+            local_set(l);
+            loaded_ |= 1u << r;
+        }
+        local_get(l);
+    }
+
+    // Consumes the i64 on the stack. 32-bit writes zero-extend; 8/16-bit
+    // writes (x86) merge into the low bits.
+    void write_reg(uint8_t r, uint8_t width) {
+        if (r == REG_ZR) {
+            op(OP_DROP);
+            return;
+        }
+        if (r >= 32) {
+            fail();
+            op(OP_DROP);
+            return;
+        }
+        if (width == W8 || width == W16) {
+            local_set(L_MERGE);
+            read_reg(r);
+            i64_const(~width_mask(width));
+            op(OP_I64_AND);
+            local_get(L_MERGE);
+            norm_u(width);
+            op(OP_I64_OR);
+        } else {
+            norm_u(width);
+        }
+        local_set(reg_local(r));
+        written_ |= 1u << r;
+    }
+
+    // Shifted/extended register operand (ARM64 modifiers above the id)
+    void read_shifted_reg(uint64_t v, uint8_t width) {
+        read_reg(static_cast<uint8_t>(v));
+        const uint8_t type = (v >> 8) & 3;
+        const uint8_t amount = (v >> 10) & 0x3F;
+        const uint8_t extend = (v >> 16) & 0xF;
+        if (extend) {
+            const uint8_t from = (extend - 1) & 3;
+            if (extend > 4) norm_s(from);
+            else norm_u(from);
+        }
+        if (!amount) return;
+        switch (type) {
+            case 0: i64_const(amount); op(OP_I64_SHL); break;
+            case 1: norm_u(width); i64_const(amount); op(OP_I64_SHR_U); break;
+            case 2: norm_s(width); i64_const(amount); op(OP_I64_SHR_S); break;
+            default:
+                if (width != W64) fail();
+                i64_const(amount);
+                op(OP_I64_ROTR);
+                break;
+        }
+    }
+
+    // Pushes the i64 value of operand `slot`, loading MEM operands at `width`
+    void read_operand(const IRInstruction& in, int slot, uint8_t width) {
+        const uint64_t v = value(in, slot);
+        switch (kind(in, slot)) {
+            case OPK_REG: read_shifted_reg(v, width); break;
+            case OPK_IMM: i64_const(v); break;
+            case OPK_MEM: address(in, v, false); load(width); break;
+            default: fail(); i64_const(0); break;
+        }
+    }
+
+    // Effective address as an i64. With `writeback`, pre/post-indexed forms
+    // update the base register.
+    void effective_address(const IRInstruction& in, uint64_t m, bool writeback) {
+        const uint8_t seg = (m >> 51) & 7;
+        if (seg == 5 || seg == 6) fail();                   // FS/GS bases are not modelled
+
+        const uint8_t base = mem_base(m);
+        const uint8_t index = mem_index(m);
+        const uint8_t mode = mem_mode(m);
+        const int32_t disp = mem_disp(m);
+
+        if (base == REG_PC) i64_const(x86_ ? in.address + in.size : in.address);
+        else if (base != REG_NONE) read_reg(base);
+        else i64_const(0);
+
+        if (mode == MEM_POST_INDEX && writeback && base < 32) {
+            // Access at the old base, then advance it
+            local_tee(L_TMP);
+            i64_const(static_cast<uint64_t>(static_cast<int64_t>(disp)));
+            op(OP_I64_ADD);
+            write_reg(base, W64);
+            local_get(L_TMP);
+            return;
+        }
+
+        if (index != REG_NONE) {
+            read_shifted_reg(static_cast<uint64_t>(index) | (((m >> 56) & 0xF) << 16), W64);
+            if (mem_scale(m)) {
+                i64_const(mem_scale(m));
+                op(OP_I64_SHL);
+            }
+            op(OP_I64_ADD);
+        }
+        if (disp) {
+            i64_const(static_cast<uint64_t>(static_cast<int64_t>(disp)));
+            op(OP_I64_ADD);
+        }
+        if (mode == MEM_PRE_INDEX && writeback && base < 32) {
+            local_tee(L_TMP);
+            write_reg(base, W64);
+            local_get(L_TMP);
+        }
+    }
+
+    // Guest address (i64) on the stack -> linear memory address (i32)
+    void to_linear() {
+        op(OP_I32_WRAP_I64);
+        if (guest_base_) {
+            i32_const(static_cast<int32_t>(guest_base_));
+            op(OP_I32_ADD);
+        }
+    }
+
+    void address(const IRInstruction& in, uint64_t m, bool writeback) {
+        effective_address(in, m, writeback);
+        to_linear();
+    }
+
+    // i32 address -> zero-extended i64
+    void load(uint8_t width, uint32_t offset = 0) {
+        static constexpr uint8_t kLoad[4] = { 0x31, 0x33, 0x35, OP_I64_LOAD };
+        memarg(kLoad[width], width, offset);
+    }
+
+    // [i32 address, i64 value] -> stored at `width`, the pages of its first
+    // and last byte marked in the dirty map
+    void store(uint8_t width, uint32_t offset = 0) {
+        static constexpr uint8_t kStore[4] = { 0x3C, 0x3D, 0x3E, OP_I64_STORE };
+        if (!dirty_pages_) return memarg(kStore[width], width, offset);
+        local_set(L_SVAL);
+        local_tee(L_SADDR);
+        local_get(L_SVAL);
+        memarg(kStore[width], width, offset);
+        mark_dirty(offset);
+        if (width != W8) mark_dirty(offset + (1u << width) - 1);
+    }
+
+    // dirty[((L_SADDR + offset - guest_base) >> 12) % dirty_pages] = 1
+    void mark_dirty(uint32_t offset) {
+        local_get(L_SADDR);
+        if (offset != guest_base_) {
+            i32_const(static_cast<int32_t>(offset - guest_base_));
+            op(OP_I32_ADD);
+        }
+        i32_const(kDirtyPageShift);
+        op(OP_I32_SHR_U);
+        i32_const(static_cast<int32_t>(dirty_pages_ - 1));
+        op(OP_I32_AND);
+        i32_const(1);
+        memarg(OP_I32_STORE8, 0, dirty_map_);
+    }
+
+    // Writes the i64 on the stack to operand slot 0 (REG, or MEM at L_ADDR)
+    void write_dest(const IRInstruction& in, uint8_t width) {
+        if (kind(in, 0) == OPK_REG) {
+            write_reg(static_cast<uint8_t>(in.op1), width);
+        } else {
+            local_set(L_VAL);
+            local_get(L_ADDR);
+            local_get(L_VAL);
+            store(width);
+        }
+    }
+
+    // Reads slot 0 for read-modify-write forms; MEM destinations leave
+    // their address in L_ADDR for write_dest
+    void read_dest(const IRInstruction& in, uint8_t width) {
+        if (kind(in, 0) == OPK_MEM) {
+            address(in, in.op1, false);
+            local_tee(L_ADDR);
+            load(width);
+        } else if (kind(in, 0) == OPK_REG) {
+            read_shifted_reg(in.op1, width);
+        } else {
+            fail();
+            i64_const(0);
+        }
+    }
+
+    void set_flags(uint32_t kind, uint8_t width) {
+        flag_kind_ = kind;
+        flag_width_ = width;
+        flags_dirty_ = true;
+    }
+
+    // -----------------------------------------------------------------
+    // Data movement and ALU
+    // -----------------------------------------------------------------
+
+    void lower_mov(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        if (kind(in, 0) == OPK_MEM) return lower_store(in);
+        if (kind(in, 0) != OPK_REG) return fail();
+        const uint8_t dst = static_cast<uint8_t>(in.op1);
+        if (kind(in, 2) == OPK_IMM) {
+            // MOVK: insert a 16-bit field
+            const uint64_t shift = in.op3 & 63;
+            read_reg(dst);
+            i64_const(~(0xFFFFull << shift));
+            op(OP_I64_AND);
+            i64_const((in.op2 & 0xFFFF) << shift);
+            op(OP_I64_OR);
+        } else {
+            read_operand(in, 1, w);
+        }
+        write_reg(dst, w);
+    }
+
+    void lower_lea(const IRInstruction& in) {
+        if (kind(in, 0) != OPK_REG) return fail();
+        if (kind(in, 1) == OPK_MEM) effective_address(in, in.op2, false);
+        else read_operand(in, 1, W64);
+        write_reg(static_cast<uint8_t>(in.op1), ir_width(in.info));
+    }
+
+    void lower_load(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        if (kind(in, 0) != OPK_REG || kind(in, 1) != OPK_MEM) return fail();
+        // ARM64 narrow loads extend into the whole register: LDR* zero-extends
+        // to 64 bits, LDRS* sign-extends to the 32- or 64-bit destination
+        const bool sign = in.attr & IR_ATTR_SIGNED;
+        const uint8_t dest_width = x86_ ? w
+            : sign && !(in.attr & IR_ATTR_WIDE) ? static_cast<uint8_t>(W32) : static_cast<uint8_t>(W64);
+        address(in, in.op2, true);
+        if (kind(in, 2) == OPK_REG) {
+            local_tee(L_ADDR);
+            load(w);
+            if (sign) norm_s(w);
+            write_reg(static_cast<uint8_t>(in.op1), dest_width);
+            local_get(L_ADDR);
+            load(w, 1u << w);
+            if (sign) norm_s(w);
+            write_reg(static_cast<uint8_t>(in.op3), dest_width);
+        } else {
+            load(w);
+            if (sign) norm_s(w);
+            write_reg(static_cast<uint8_t>(in.op1), dest_width);
+        }
+    }
+
+    void lower_store(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        if (kind(in, 0) != OPK_MEM) return fail();
+        address(in, in.op1, true);
+        if (kind(in, 2) == OPK_REG) {
+            local_tee(L_ADDR);
+            read_operand(in, 1, w);
+            store(w);
+            local_get(L_ADDR);
+            read_operand(in, 2, w);
+            store(w, 1u << w);
+        } else {
+            read_operand(in, 1, w);
+            store(w);
+        }
+    }
+
+    uint32_t alu_flags(const IRInstruction& in, int count_slot) const {
+        if (!x86_) {
+            // Only ADDS/SUBS/ANDS set flags; the plain forms leave them alone
+            if (!(in.attr & IR_ATTR_SETS_FLAGS)) return WASM_FLAGS_NONE;
+            switch (in.opcode) {
+                case IROpcode::ADD: return WASM_FLAGS_ADD;
+                case IROpcode::SUB: return WASM_FLAGS_SUB;
+                case IROpcode::AND: return WASM_FLAGS_LOGIC;
+                default: return WASM_FLAGS_UNKNOWN;
+            }
+        }
+        switch (in.opcode) {
+            case IROpcode::ADD: return WASM_FLAGS_ADD;
+            case IROpcode::SUB: return WASM_FLAGS_SUB;
+            case IROpcode::AND: case IROpcode::OR: case IROpcode::XOR: return WASM_FLAGS_LOGIC;
+            case IROpcode::SHL: case IROpcode::SHR: case IROpcode::SAR: case IROpcode::ROL: case IROpcode::ROR: {
+                // A zero count leaves the flags alone; CL may be zero
+                if (kind(in, count_slot) != OPK_IMM) return WASM_FLAGS_UNKNOWN;
+                const uint64_t count = value(in, count_slot) & (ir_width(in.info) == W64 ? 63 : 31);
+                if (!count) return WASM_FLAGS_NONE;
+                const bool rotate = in.opcode == IROpcode::ROL || in.opcode == IROpcode::ROR;
+                return rotate ? WASM_FLAGS_UNKNOWN : WASM_FLAGS_RESULT;
+            }
+            default: return WASM_FLAGS_UNKNOWN;   // IMUL: CF/OF only
+        }
+    }
+
+    void lower_alu(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        const bool three = kind(in, 2) != OPK_NONE;
+        const int a = three ? 1 : 0;
+        const int b = three ? 2 : 1;
+        if (kind(in, b) == OPK_NONE) return fail();               // x86 one-operand MUL
+        if (three && kind(in, 0) != OPK_REG) return fail();
+
+        const uint32_t flags = alu_flags(in, b);
+        const bool record = flags != WASM_FLAGS_NONE && flags != WASM_FLAGS_UNKNOWN
+            && !(in.attr & IR_ATTR_FLAGS_DEAD);
+        const bool rotate = in.opcode == IROpcode::ROL || in.opcode == IROpcode::ROR;
+        // SMULL/UMULL: 32-bit operands, 64-bit product
+        const bool wide = in.opcode == IROpcode::MUL && (in.attr & IR_ATTR_WIDE);
+        if (wide && !three) return fail();
+
+        if (rotate && w != W64) {
+            if (w != W32) return fail();
+            if (three) read_operand(in, a, w);
+            else read_dest(in, w);
+            op(OP_I32_WRAP_I64);
+            read_operand(in, b, w);
+            op(OP_I32_WRAP_I64);
+            op(in.opcode == IROpcode::ROL ? OP_I32_ROTL : OP_I32_ROTR);
+            op(OP_I64_EXTEND_I32_U);
+        } else {
+            if (three) read_operand(in, a, w);
+            else read_dest(in, w);
+            if (in.opcode == IROpcode::SHR) norm_u(w);
+            if (in.opcode == IROpcode::SAR) norm_s(w);
+            if (wide) extend(w, in.attr & IR_ATTR_SIGNED);
+            if (record) local_tee(L_FA);
+            read_operand(in, b, w);
+            if (wide) extend(w, in.attr & IR_ATTR_SIGNED);
+            const bool shift = in.opcode >= IROpcode::SHL && in.opcode <= IROpcode::ROR;
+            if (shift) {
+                i64_const(w == W64 ? 63 : 31);
+                op(OP_I64_AND);
+            }
+            if (record) local_tee(L_FB);
+            switch (in.opcode) {
+                case IROpcode::ADD: op(OP_I64_ADD); break;
+                case IROpcode::SUB: op(OP_I64_SUB); break;
+                case IROpcode::MUL: op(OP_I64_MUL); break;
+                case IROpcode::AND: op(OP_I64_AND); break;
+                case IROpcode::OR: op(OP_I64_OR); break;
+                case IROpcode::XOR: op(OP_I64_XOR); break;
+                case IROpcode::SHL: op(OP_I64_SHL); break;
+                case IROpcode::SHR: op(OP_I64_SHR_U); break;
+                case IROpcode::SAR: op(OP_I64_SHR_S); break;
+                case IROpcode::ROL: op(OP_I64_ROTL); break;
+                default: op(OP_I64_ROTR); break;
+            }
+            if (record) local_tee(L_FR);
+        }
+        write_dest(in, wide ? static_cast<uint8_t>(W64) : w);
+        if (flags != WASM_FLAGS_NONE && !(in.attr & IR_ATTR_FLAGS_DEAD)) set_flags(flags, w);
+    }
+
+    void lower_unary(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        const bool separate = kind(in, 1) != OPK_NONE;             // ARM64 NEG/MVN dst, src
+        if (separate && kind(in, 0) != OPK_REG) return fail();
+        const bool live = (x86_ || (in.attr & IR_ATTR_SETS_FLAGS)) && !(in.attr & IR_ATTR_FLAGS_DEAD);
+
+        switch (in.opcode) {
+            case IROpcode::NEG:
+                i64_const(0);
+                if (live) local_tee(L_FA);
+                if (separate) read_operand(in, 1, w);
+                else read_dest(in, w);
+                if (live) local_tee(L_FB);
+                op(OP_I64_SUB);
+                if (live) local_tee(L_FR);
+                break;
+            case IROpcode::NOT:
+                if (separate) read_operand(in, 1, w);
+                else read_dest(in, w);
+                i64_const(~0ull);
+                op(OP_I64_XOR);
+                break;
+            default:
+                if (!x86_) return fail();
+                if (live) keep_carry();
+                read_dest(in, w);
+                i64_const(1);
+                op(in.opcode == IROpcode::INC ? OP_I64_ADD : OP_I64_SUB);
+                if (live) local_tee(L_FR);
+                break;
+        }
+        write_dest(in, w);
+
+        if (!live || in.opcode == IROpcode::NOT) return;
+        if (in.opcode == IROpcode::NEG) set_flags(WASM_FLAGS_SUB, w);
+        else set_flags(flag_kind_ == WASM_FLAGS_RESULT ? WASM_FLAGS_RESULT : WASM_FLAGS_KEEP_CF, w);
+    }
+
+    // INC/DEC leave CF alone: carry it over from the flags they replace into
+    // L_FB. Flags set before the block are not known here, so an INC/DEC
+    // whose flags are live has to run outside it.
+    void keep_carry() {
+        if (!flags_dirty_) return fail();
+        switch (flag_kind_) {
+            case WASM_FLAGS_KEEP_CF: case WASM_FLAGS_RESULT:
+                return;                                             // Already in L_FB, or unknown
+            case WASM_FLAGS_UNKNOWN:
+                flag_kind_ = WASM_FLAGS_RESULT;                     // Zero and sign become known
+                return;
+            default:
+                condition(P_LTU);
+                op(OP_I64_EXTEND_I32_U);
+                local_set(L_FB);
+                return;
+        }
+    }
+
+    void lower_compare(const IRInstruction& in) {
+        if (in.attr & IR_ATTR_FLAGS_DEAD) return;
+        const uint8_t w = ir_width(in.info);
+        read_operand(in, 0, w);
+        local_tee(L_FA);
+        read_operand(in, 1, w);
+        local_tee(L_FB);
+        op(in.opcode == IROpcode::CMP ? OP_I64_SUB : OP_I64_AND);
+        local_set(L_FR);
+        set_flags(in.opcode == IROpcode::CMP ? WASM_FLAGS_SUB : WASM_FLAGS_LOGIC, w);
+    }
+
+    void lower_xchg(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        const int mem = kind(in, 0) == OPK_MEM ? 0 : kind(in, 1) == OPK_MEM ? 1 : -1;
+        if (mem < 0) {
+            if (kind(in, 0) != OPK_REG || kind(in, 1) != OPK_REG) return fail();
+            read_reg(static_cast<uint8_t>(in.op1));
+            local_set(L_VAL);
+            read_reg(static_cast<uint8_t>(in.op2));
+            write_reg(static_cast<uint8_t>(in.op1), w);
+            local_get(L_VAL);
+            write_reg(static_cast<uint8_t>(in.op2), w);
+            return;
+        }
+        const int r = 1 - mem;
+        if (kind(in, r) != OPK_REG) return fail();
+        address(in, value(in, mem), false);
+        local_tee(L_ADDR);
+        load(w);
+        local_set(L_VAL);
+        local_get(L_ADDR);
+        read_reg(static_cast<uint8_t>(value(in, r)));
+        store(w);
+        local_get(L_VAL);
+        write_reg(static_cast<uint8_t>(value(in, r)), w);
+    }
+
+    void lower_cmov(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        if (kind(in, 0) != OPK_REG || kind(in, 2) != OPK_IMM) return fail();
+        read_operand(in, 1, w);
+        read_reg(static_cast<uint8_t>(in.op1));
+        condition(pred_for(in.op3));
+        op(OP_SELECT);
+        write_reg(static_cast<uint8_t>(in.op1), w);
+    }
+
+    void lower_setcc(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        if (kind(in, 1) != OPK_IMM) return fail();
+        if (kind(in, 0) == OPK_MEM) {
+            address(in, in.op1, false);
+            local_set(L_ADDR);
+        }
+        if (in.attr & IR_ATTR_SIGNED) {
+            // CSETM: all ones when the condition holds
+            i64_const(~0ull);
+            i64_const(0);
+            condition(pred_for(in.op2));
+            op(OP_SELECT);
+        } else {
+            condition(pred_for(in.op2));
+            op(OP_I64_EXTEND_I32_U);
+        }
+        write_dest(in, w);
+    }
+
+    void lower_push(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        if (!x86_ || kind(in, 0) == OPK_NONE) return fail();       // PUSHF
+        read_operand(in, 0, w);
+        local_set(L_VAL);
+        adjust_stack(-(1 << w));
+        to_linear();
+        local_get(L_VAL);
+        store(w);
+    }
+
+    void lower_pop(const IRInstruction& in) {
+        const uint8_t w = ir_width(in.info);
+        if (!x86_ || kind(in, 0) == OPK_NONE) return fail();       // POPF
+        read_reg(kStackPointer);
+        to_linear();
+        load(w);
+        local_set(L_VAL);
+        adjust_stack(1 << w);
+        op(OP_DROP);
+        if (kind(in, 0) == OPK_MEM) {
+            address(in, in.op1, false);
+            local_set(L_ADDR);
+        }
+        local_get(L_VAL);
+        write_dest(in, w);
+    }
+
+    static constexpr uint8_t kStackPointer = REG_GPR0 + 4;
+    static constexpr uint8_t kLinkRegister = REG_GPR0 + 30;
+
+    // RSP += delta; leaves the new RSP on the stack
+    void adjust_stack(int64_t delta) {
+        read_reg(kStackPointer);
+        i64_const(static_cast<uint64_t>(delta));
+        op(OP_I64_ADD);
+        local_tee(L_TMP);
+        write_reg(kStackPointer, stack_width_);
+        local_get(L_TMP);
+    }
+
+    // -----------------------------------------------------------------
+    // Control flow
+    // -----------------------------------------------------------------
+
+    void branch_target(const IRInstruction& in) {
+        if (kind(in, 0) == OPK_NONE) return fail();
+        read_operand(in, 0, x86_ ? ir_width(in.info) : static_cast<uint8_t>(W64));
+        local_set(L_NPC);
+    }
+
+    void lower_jmp(const IRInstruction& in) {
+        branch_target(in);
+    }
+
+    void lower_call(const IRInstruction& in) {
+        const uint64_t ret = in.address + in.size;
+        branch_target(in);
+        if (x86_) {
+            adjust_stack(-(1 << stack_width_));
+            to_linear();
+            i64_const(ret);
+            store(stack_width_);
+        } else {
+            i64_const(ret);
+            write_reg(kLinkRegister, W64);
+        }
+    }
+
+    void lower_ret(const IRInstruction& in) {
+        if (!x86_) {
+            read_reg(static_cast<uint8_t>(in.op1));
+            local_set(L_NPC);
+            return;
+        }
+        const int64_t bytes = (1 << stack_width_) + (kind(in, 0) == OPK_IMM ? static_cast<int64_t>(in.op1) : 0);
+        read_reg(kStackPointer);
+        to_linear();
+        load(stack_width_);
+        local_set(L_NPC);
+        adjust_stack(bytes);
+        op(OP_DROP);
+    }
+
+    void lower_branch(const IRInstruction& in) {
+        if (kind(in, 0) != OPK_IMM) return fail();
+        i64_const(in.op1);
+        i64_const(in.address + in.size);
+
+        if (!x86_ && kind(in, 1) == OPK_REG) {
+            // CBZ/CBNZ, TBZ/TBNZ
+            read_reg(static_cast<uint8_t>(in.op2));
+            if (kind(in, 2) == OPK_IMM) {
+                i64_const(in.op3 & 63);
+                op(OP_I64_SHR_U);
+                i64_const(1);
+                op(OP_I64_AND);
+            } else {
+                norm_u(ir_width(in.info));
+            }
+            op(OP_I64_EQZ);
+            if (in.opcode == IROpcode::JNE) op(OP_I32_EQZ);
+        } else if (in.opcode == IROpcode::JE) {
+            condition(x86_ ? pred_for(4) : P_EQ);
+        } else if (in.opcode == IROpcode::JNE) {
+            condition(x86_ ? pred_for(5) : P_NE);
+        } else if (kind(in, 1) != OPK_IMM) {
+            fail();
+            i32_const(0);
+        } else if (x86_ && in.op2 >= CC_X86_LOOPNE) {
+            counter_condition(static_cast<uint8_t>(in.op2));
+        } else {
+            condition(pred_for(in.op2));
+        }
+        op(OP_SELECT);
+        local_set(L_NPC);
+    }
+
+    // LOOP/LOOPE/LOOPNE decrement (E/R)CX without touching flags; JCXZ tests it
+    void counter_condition(uint8_t cc) {
+        const uint8_t w = stack_width_;
+        const uint8_t rcx = REG_GPR0 + 1;
+        if (cc != CC_X86_JCXZ) {
+            read_reg(rcx);
+            i64_const(1);
+            op(OP_I64_SUB);
+            write_reg(rcx, w);
+        }
+        read_reg(rcx);
+        norm_u(w);
+        op(OP_I64_EQZ);
+        if (cc == CC_X86_JCXZ) return;
+        op(OP_I32_EQZ);
+        if (cc == CC_X86_LOOP) return;
+        condition(cc == CC_X86_LOOPE ? P_EQ : P_NE);
+        op(OP_I32_AND);
+    }
+
+    // Guest condition code -> predicate on the lazy flags
+    Pred pred_for(uint64_t cc) const {
+        if (x86_) {
+            static constexpr Pred kX86[16] = {
+                P_NONE, P_NONE, P_LTU, P_GEU, P_EQ, P_NE, P_LEU, P_GTU,
+                P_NEG, P_NNEG, P_NONE, P_NONE, P_LTS, P_GES, P_LES, P_GTS
+            };
+            return cc < 16 ? kX86[cc] : P_NONE;
+        }
+        static constexpr Pred kA64[14] = {
+            P_EQ, P_NE, P_GEU, P_LTU, P_NEG, P_NNEG, P_NONE, P_NONE,
+            P_GTU, P_LEU, P_GES, P_LTS, P_GTS, P_LES
+        };
+        return cc < 14 ? kA64[cc] : P_NONE;
+    }
+
+    // Pushes an i32 condition evaluated from the flags set in this block
+    void condition(Pred p) {
+        const uint8_t w = flag_width_;
+        const uint32_t k = flag_kind_;
+        if (p == P_NONE || !flags_dirty_ || k == WASM_FLAGS_UNKNOWN) {
+            fail();
+            i32_const(0);
+            return;
+        }
+
+        // Zero and sign come from the result for every kind
+        switch (p) {
+            case P_EQ: case P_NE:
+                local_get(L_FR);
+                norm_u(w);
+                op(OP_I64_EQZ);
+                if (p == P_NE) op(OP_I32_EQZ);
+                return;
+            case P_NEG: case P_NNEG:
+                local_get(L_FR);
+                norm_s(w);
+                i64_const(0);
+                op(p == P_NEG ? OP_I64_LT_S : OP_I64_GE_S);
+                return;
+            default:
+                break;
+        }
+
+        if (k == WASM_FLAGS_SUB) {
+            static constexpr uint8_t kCompare[P_NEG] = {
+                0, 0, OP_I64_LT_U, OP_I64_GE_U, OP_I64_LE_U, OP_I64_GT_U,
+                OP_I64_LT_S, OP_I64_GE_S, OP_I64_LE_S, OP_I64_GT_S
+            };
+            const bool sign = p >= P_LTS;
+            local_get(L_FA);
+            if (sign) norm_s(w); else norm_u(w);
+            local_get(L_FB);
+            if (sign) norm_s(w); else norm_u(w);
+            op(kCompare[p]);
+        } else if (k == WASM_FLAGS_ADD && (p == P_LTU || p == P_GEU)) {
+            // Carry out: the truncated sum wrapped below an operand. x86
+            // "below" is CF set; ARM64 "higher or same" is C set.
+            local_get(L_FR);
+            norm_u(w);
+            local_get(L_FA);
+            norm_u(w);
+            op((p == P_LTU) == x86_ ? OP_I64_LT_U : OP_I64_GE_U);
+        } else if (k == WASM_FLAGS_KEEP_CF && p >= P_LTU && p <= P_GTU) {
+            // x86 only: "below" is CF, "below or equal" is CF or ZF
+            local_get(L_FB);
+            op(OP_I32_WRAP_I64);
+            if (p == P_GEU || p == P_GTU) op(OP_I32_EQZ);
+            if (p == P_LEU || p == P_GTU) {
+                condition(p == P_LEU ? P_EQ : P_NE);
+                op(p == P_LEU ? OP_I32_OR : OP_I32_AND);
+            }
+        } else if (k == WASM_FLAGS_LOGIC) {
+            // Carry and overflow are clear. x86 "below" is CF set; ARM64
+            // "lower" is C clear.
+            switch (p) {
+                case P_LTU: i32_const(x86_ ? 0 : 1); break;
+                case P_GEU: i32_const(x86_ ? 1 : 0); break;
+                case P_LEU: if (x86_) condition(P_EQ); else i32_const(1); break;
+                case P_GTU: if (x86_) condition(P_NE); else i32_const(0); break;
+                case P_LTS: condition(P_NEG); break;
+                case P_GES: condition(P_NNEG); break;
+                default:
+                    local_get(L_FR);
+                    norm_s(w);
+                    i64_const(0);
+                    op(p == P_LES ? OP_I64_LE_S : OP_I64_GT_S);
+                    break;
+            }
+        } else {
+            fail();
+            i32_const(0);
+        }
+    }
+};
@@ -0,0 +1,403 @@
+// Freestanding C++ Lifter - x86 Opcode Tables
+// Compile-time tables for the 1-byte, 0F, 0F38 and 0F3A opcode maps.
+// Each entry describes the IR opcode, operand template and the
+// ModRM/immediate layout needed to compute instruction length.
+
+#pragma once
+
+#include "lifter.h"
+
+// Operand templates (Intel SDM notation in comments)
+enum X86Form : uint8_t {
+    XF_NONE,  // No explicit operands
+    XF_EG,    // Ev, Gv
+    XF_GE,    // Gv, Ev
+    XF_GEI,   // Gv, Ev, imm
+    XF_E,     // Ev
+    XF_EI,    // Ev, imm
+    XF_E1,    // Ev, 1
+    XF_ECL,   // Ev, CL
+    XF_AI,    // AL/eAX, imm
+    XF_Z,     // Register in opcode bits 0-2
+    XF_ZI,    // Register in opcode bits 0-2, imm
+    XF_ZA,    // Register in opcode bits 0-2, eAX
+    XF_I,     // imm
+    XF_J,     // Relative branch target
+    XF_AM,    // AL/eAX, moffs
+    XF_MA,    // moffs, AL/eAX
+    XF_ES,    // Ew, Sw
+    XF_SE,    // Sw, Ew
+    XF_VW,    // Vx, (Hx,) Wx  - vector destination first
+    XF_WV,    // Wx, Vx        - vector store form
+    XF_SEG    // Implicit segment register (id in X86OpInfo::group)
+};
+
+// Immediate layouts
+enum X86Imm : uint8_t {
+    XI_NONE,
+    XI_B,      // imm8
+    XI_W,      // imm16
+    XI_Z,      // imm16/32 by operand size
+    XI_V,      // imm16/32/64 by operand size (MOV r, imm)
+    XI_WB,     // imm16 + imm8 (ENTER)
+    XI_REL8,   // rel8
+    XI_RELZ,   // rel16/32
+    XI_MOFFS,  // Address-sized absolute offset
+    XI_FAR,    // ptr16:16/32
+    XI_GRP3    // imm8/16/32 only for TEST (/0, /1) of group 3
+};
+
+enum X86Flags : uint16_t {
+    XO_MODRM = 1 << 0,    // ModRM byte follows the opcode
+    XO_BYTE = 1 << 1,     // 8-bit operands
+    XO_D64 = 1 << 2,      // Defaults to 64-bit operand size in long mode
+    XO_INV64 = 1 << 3,    // Invalid in long mode
+    XO_PREFIX = 1 << 4,   // Legacy prefix byte
+    XO_GROUP = 1 << 5,    // IR opcode selected by ModRM.reg
+    XO_MOVLS = 1 << 6,    // MOV that becomes LOAD/STORE with a memory operand
+    XO_SRC8 = 1 << 7,     // MOVZX/MOVSX byte source
+    XO_SRC16 = 1 << 8,    // MOVZX/MOVSX word source
+    XO_CC = 1 << 9,       // Condition code in opcode bits 0-3
+    XO_ESCAPE = 1 << 10   // Opcode map escape (0F, 0F38, 0F3A)
+};
+
+struct X86OpInfo {
+    IROpcode op;
+    uint8_t form;
+    uint8_t imm;
+    uint16_t flags;
+    uint8_t group;
+};
+
+struct X86OpMap {
+    X86OpInfo e[256];
+};
+
+// ModRM.reg extension groups
+enum X86Group : uint8_t {
+    XG_NONE,
+    XG_1,      // 80-83
+    XG_1A,     // 8F
+    XG_2,      // C0/C1/D0-D3
+    XG_3,      // F6/F7
+    XG_4,      // FE
+    XG_5,      // FF
+    XG_11,     // C6/C7
+    XG_HINT,   // 0F 18-1F prefetch/hint NOPs
+    XG_COUNT
+};
+
+static constexpr IROpcode kX86Groups[XG_COUNT][8] = {
+    { IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN,
+      IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN },
+    { IROpcode::ADD, IROpcode::OR, IROpcode::ADC, IROpcode::SBB,
+      IROpcode::AND, IROpcode::SUB, IROpcode::XOR, IROpcode::CMP },
+    { IROpcode::POP, IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN,
+      IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN },
+    { IROpcode::ROL, IROpcode::ROR, IROpcode::UNKNOWN, IROpcode::UNKNOWN,   // RCL/RCR
+      IROpcode::SHL, IROpcode::SHR, IROpcode::SHL, IROpcode::SAR },
+    { IROpcode::TEST, IROpcode::TEST, IROpcode::NOT, IROpcode::NEG,
+      IROpcode::MUL, IROpcode::MUL, IROpcode::DIV, IROpcode::DIV },
+    { IROpcode::INC, IROpcode::DEC, IROpcode::UNKNOWN, IROpcode::UNKNOWN,
+      IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN },
+    { IROpcode::INC, IROpcode::DEC, IROpcode::CALL, IROpcode::CALL,
+      IROpcode::JMP, IROpcode::JMP, IROpcode::PUSH, IROpcode::UNKNOWN },
+    { IROpcode::MOV, IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN,
+      IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN, IROpcode::UNKNOWN },
+    { IROpcode::NOP, IROpcode::NOP, IROpcode::NOP, IROpcode::NOP,
+      IROpcode::NOP, IROpcode::NOP, IROpcode::NOP, IROpcode::NOP },
+};
+
+// Group members that default to 64-bit operand size in long mode (bit per ModRM.reg)
+static constexpr uint8_t kX86GroupD64[XG_COUNT] = {
+    0, 0, 0x01, 0, 0, 0, 0x54 /* CALL, JMP, PUSH */, 0, 0
+};
+
+static constexpr X86OpInfo x86_op(IROpcode op, uint8_t form = XF_NONE, uint8_t imm = XI_NONE,
+                                  uint16_t flags = 0, uint8_t group = XG_NONE) {
+    return X86OpInfo{ op, form, imm, flags, group };
+}
+
+static constexpr X86OpInfo x86_modrm(IROpcode op, uint8_t form = XF_NONE, uint8_t imm = XI_NONE,
+                                     uint16_t flags = 0, uint8_t group = XG_NONE) {
+    return X86OpInfo{ op, form, imm, static_cast<uint16_t>(flags | XO_MODRM), group };
+}
+
+static constexpr X86OpMap build_x86_one_byte_map() {
+    X86OpMap m{};
+    for (int i = 0; i < 256; i++) m.e[i] = x86_op(IROpcode::UNKNOWN);
+
+    // 00-3F: ALU block, eight operations with six encodings each
+    const IROpcode alu[8] = {
+        IROpcode::ADD, IROpcode::OR, IROpcode::ADC, IROpcode::SBB,
+        IROpcode::AND, IROpcode::SUB, IROpcode::XOR, IROpcode::CMP
+    };
+    for (int k = 0; k < 8; k++) {
+        const int b = k * 8;
+        m.e[b + 0] = x86_modrm(alu[k], XF_EG, XI_NONE, XO_BYTE);
+        m.e[b + 1] = x86_modrm(alu[k], XF_EG);
+        m.e[b + 2] = x86_modrm(alu[k], XF_GE, XI_NONE, XO_BYTE);
+        m.e[b + 3] = x86_modrm(alu[k], XF_GE);
+        m.e[b + 4] = x86_op(alu[k], XF_AI, XI_B, XO_BYTE);
+        m.e[b + 5] = x86_op(alu[k], XF_AI, XI_Z);
+    }
+    // PUSH/POP segment, BCD adjust (32-bit only)
+    m.e[0x06] = x86_op(IROpcode::PUSH, XF_SEG, XI_NONE, XO_INV64, REG_SEG0 + 0);
+    m.e[0x07] = x86_op(IROpcode::POP, XF_SEG, XI_NONE, XO_INV64, REG_SEG0 + 0);
+    m.e[0x0E] = x86_op(IROpcode::PUSH, XF_SEG, XI_NONE, XO_INV64, REG_SEG0 + 1);
+    m.e[0x0F] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_ESCAPE);
+    m.e[0x16] = x86_op(IROpcode::PUSH, XF_SEG, XI_NONE, XO_INV64, REG_SEG0 + 2);
+    m.e[0x17] = x86_op(IROpcode::POP, XF_SEG, XI_NONE, XO_INV64, REG_SEG0 + 2);
+    m.e[0x1E] = x86_op(IROpcode::PUSH, XF_SEG, XI_NONE, XO_INV64, REG_SEG0 + 3);
+    m.e[0x1F] = x86_op(IROpcode::POP, XF_SEG, XI_NONE, XO_INV64, REG_SEG0 + 3);
+    m.e[0x26] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x27] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);
+    m.e[0x2E] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x2F] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);
+    m.e[0x36] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x37] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);
+    m.e[0x3E] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x3F] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);
+
+    // 40-5F: INC/DEC r (REX in long mode), PUSH/POP r
+    for (int r = 0; r < 8; r++) {
+        m.e[0x40 + r] = x86_op(IROpcode::INC, XF_Z);
+        m.e[0x48 + r] = x86_op(IROpcode::DEC, XF_Z);
+        m.e[0x50 + r] = x86_op(IROpcode::PUSH, XF_Z, XI_NONE, XO_D64);
+        m.e[0x58 + r] = x86_op(IROpcode::POP, XF_Z, XI_NONE, XO_D64);
+    }
+
+    // 60-6F
+    m.e[0x60] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);        // PUSHA
+    m.e[0x61] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);        // POPA
+    m.e[0x62] = x86_modrm(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);     // BOUND (EVEX in long mode)
+    m.e[0x63] = x86_modrm(IROpcode::MOVSX, XF_GE);                            // MOVSXD (ARPL in 32-bit)
+    m.e[0x64] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x65] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x66] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x67] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0x68] = x86_op(IROpcode::PUSH, XF_I, XI_Z, XO_D64);
+    m.e[0x69] = x86_modrm(IROpcode::MUL, XF_GEI, XI_Z);
+    m.e[0x6A] = x86_op(IROpcode::PUSH, XF_I, XI_B, XO_D64);
+    m.e[0x6B] = x86_modrm(IROpcode::MUL, XF_GEI, XI_B);
+    // 6C-6F INS/OUTS stay UNKNOWN with no operands
+
+    // 70-7F: Jcc rel8
+    for (int cc = 0; cc < 16; cc++) {
+        m.e[0x70 + cc] = x86_op(IROpcode::JCC, XF_J, XI_REL8, XO_CC | XO_D64);
+    }
+
+    // 80-8F
+    m.e[0x80] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_B, XO_BYTE | XO_GROUP, XG_1);
+    m.e[0x81] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_Z, XO_GROUP, XG_1);
+    m.e[0x82] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_B, XO_BYTE | XO_GROUP | XO_INV64, XG_1);
+    m.e[0x83] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_B, XO_GROUP, XG_1);
+    m.e[0x84] = x86_modrm(IROpcode::TEST, XF_EG, XI_NONE, XO_BYTE);
+    m.e[0x85] = x86_modrm(IROpcode::TEST, XF_EG);
+    m.e[0x86] = x86_modrm(IROpcode::XCHG, XF_EG, XI_NONE, XO_BYTE);
+    m.e[0x87] = x86_modrm(IROpcode::XCHG, XF_EG);
+    m.e[0x88] = x86_modrm(IROpcode::MOV, XF_EG, XI_NONE, XO_BYTE | XO_MOVLS);
+    m.e[0x89] = x86_modrm(IROpcode::MOV, XF_EG, XI_NONE, XO_MOVLS);
+    m.e[0x8A] = x86_modrm(IROpcode::MOV, XF_GE, XI_NONE, XO_BYTE | XO_MOVLS);
+    m.e[0x8B] = x86_modrm(IROpcode::MOV, XF_GE, XI_NONE, XO_MOVLS);
+    m.e[0x8C] = x86_modrm(IROpcode::MOV, XF_ES);
+    m.e[0x8D] = x86_modrm(IROpcode::LEA, XF_GE);
+    m.e[0x8E] = x86_modrm(IROpcode::MOV, XF_SE);
+    m.e[0x8F] = x86_modrm(IROpcode::UNKNOWN, XF_E, XI_NONE, XO_GROUP | XO_D64, XG_1A);
+
+    // 90-9F
+    m.e[0x90] = x86_op(IROpcode::NOP);
+    for (int r = 1; r < 8; r++) m.e[0x90 + r] = x86_op(IROpcode::XCHG, XF_ZA);
+    m.e[0x98] = x86_op(IROpcode::MOVSX);                                      // CBW/CWDE/CDQE
+    m.e[0x9A] = x86_op(IROpcode::CALL, XF_NONE, XI_FAR, XO_INV64);
+    m.e[0x9B] = x86_op(IROpcode::NOP);                                        // FWAIT
+    m.e[0x9C] = x86_op(IROpcode::PUSH, XF_NONE, XI_NONE, XO_D64);             // PUSHF
+    m.e[0x9D] = x86_op(IROpcode::POP, XF_NONE, XI_NONE, XO_D64);              // POPF
+
+    // A0-AF
+    m.e[0xA0] = x86_op(IROpcode::LOAD, XF_AM, XI_MOFFS, XO_BYTE);
+    m.e[0xA1] = x86_op(IROpcode::LOAD, XF_AM, XI_MOFFS);
+    m.e[0xA2] = x86_op(IROpcode::STORE, XF_MA, XI_MOFFS, XO_BYTE);
+    m.e[0xA3] = x86_op(IROpcode::STORE, XF_MA, XI_MOFFS);
+    m.e[0xA8] = x86_op(IROpcode::TEST, XF_AI, XI_B, XO_BYTE);
+    m.e[0xA9] = x86_op(IROpcode::TEST, XF_AI, XI_Z);
+    // A4-A7, AA-AF string operations stay UNKNOWN with no operands
+
+    // B0-BF: MOV r, imm
+    for (int r = 0; r < 8; r++) {
+        m.e[0xB0 + r] = x86_op(IROpcode::MOV, XF_ZI, XI_B, XO_BYTE);
+        m.e[0xB8 + r] = x86_op(IROpcode::MOV, XF_ZI, XI_V);
+    }
+
+    // C0-CF
+    m.e[0xC0] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_B, XO_BYTE | XO_GROUP, XG_2);
+    m.e[0xC1] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_B, XO_GROUP, XG_2);
+    m.e[0xC2] = x86_op(IROpcode::RET, XF_I, XI_W, XO_D64);
+    m.e[0xC3] = x86_op(IROpcode::RET, XF_NONE, XI_NONE, XO_D64);
+    m.e[0xC4] = x86_modrm(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);     // LES (VEX3 prefix)
+    m.e[0xC5] = x86_modrm(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);     // LDS (VEX2 prefix)
+    m.e[0xC6] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_B, XO_BYTE | XO_GROUP | XO_MOVLS, XG_11);
+    m.e[0xC7] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_Z, XO_GROUP | XO_MOVLS, XG_11);
+    m.e[0xC8] = x86_op(IROpcode::UNKNOWN, XF_I, XI_WB);                       // ENTER
+    m.e[0xC9] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_D64);          // LEAVE
+    m.e[0xCA] = x86_op(IROpcode::RET, XF_I, XI_W);                            // RETF imm16
+    m.e[0xCB] = x86_op(IROpcode::RET);                                        // RETF
+    m.e[0xCC] = x86_op(IROpcode::TRAP);                                       // INT3
+    m.e[0xCD] = x86_op(IROpcode::SYSCALL, XF_I, XI_B);                        // INT imm8
+    m.e[0xCE] = x86_op(IROpcode::TRAP, XF_NONE, XI_NONE, XO_INV64);           // INTO
+
+    // D0-DF
+    m.e[0xD0] = x86_modrm(IROpcode::UNKNOWN, XF_E1, XI_NONE, XO_BYTE | XO_GROUP, XG_2);
+    m.e[0xD1] = x86_modrm(IROpcode::UNKNOWN, XF_E1, XI_NONE, XO_GROUP, XG_2);
+    m.e[0xD2] = x86_modrm(IROpcode::UNKNOWN, XF_ECL, XI_NONE, XO_BYTE | XO_GROUP, XG_2);
+    m.e[0xD3] = x86_modrm(IROpcode::UNKNOWN, XF_ECL, XI_NONE, XO_GROUP, XG_2);
+    m.e[0xD4] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_B, XO_INV64);           // AAM
+    m.e[0xD5] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_B, XO_INV64);           // AAD
+    m.e[0xD6] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_INV64);        // SALC
+    for (int x = 0xD8; x <= 0xDF; x++) m.e[x] = x86_modrm(IROpcode::UNKNOWN); // x87
+
+    // E0-EF
+    m.e[0xE0] = x86_op(IROpcode::JCC, XF_J, XI_REL8, XO_D64);                 // LOOPNE
+    m.e[0xE1] = x86_op(IROpcode::JCC, XF_J, XI_REL8, XO_D64);                 // LOOPE
+    m.e[0xE2] = x86_op(IROpcode::JCC, XF_J, XI_REL8, XO_D64);                 // LOOP
+    m.e[0xE3] = x86_op(IROpcode::JCC, XF_J, XI_REL8, XO_D64);                 // JCXZ
+    m.e[0xE4] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_B);                     // IN AL, imm8
+    m.e[0xE5] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_B);
+    m.e[0xE6] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_B);                     // OUT imm8, AL
+    m.e[0xE7] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_B);
+    m.e[0xE8] = x86_op(IROpcode::CALL, XF_J, XI_RELZ, XO_D64);
+    m.e[0xE9] = x86_op(IROpcode::JMP, XF_J, XI_RELZ, XO_D64);
+    m.e[0xEA] = x86_op(IROpcode::JMP, XF_NONE, XI_FAR, XO_INV64);
+    m.e[0xEB] = x86_op(IROpcode::JMP, XF_J, XI_REL8, XO_D64);
+
+    // F0-FF
+    m.e[0xF0] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0xF1] = x86_op(IROpcode::TRAP);                                       // INT1
+    m.e[0xF2] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0xF3] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_PREFIX);
+    m.e[0xF4] = x86_op(IROpcode::TRAP);                                       // HLT
+    m.e[0xF6] = x86_modrm(IROpcode::UNKNOWN, XF_E, XI_GRP3, XO_BYTE | XO_GROUP, XG_3);
+    m.e[0xF7] = x86_modrm(IROpcode::UNKNOWN, XF_E, XI_GRP3, XO_GROUP, XG_3);
+    m.e[0xFE] = x86_modrm(IROpcode::UNKNOWN, XF_E, XI_NONE, XO_BYTE | XO_GROUP, XG_4);
+    m.e[0xFF] = x86_modrm(IROpcode::UNKNOWN, XF_E, XI_NONE, XO_GROUP, XG_5);
+    return m;
+}
+
+static constexpr X86OpMap build_x86_0f_map() {
+    X86OpMap m{};
+    // Almost the whole 0F map takes a ModRM byte; the exceptions are listed below
+    for (int i = 0; i < 256; i++) m.e[i] = x86_modrm(IROpcode::UNKNOWN);
+
+    const int no_modrm[] = {
+        0x05, 0x06, 0x07, 0x08, 0x09, 0x0B, 0x0E, 0x30, 0x31, 0x32, 0x33, 0x34,
+        0x35, 0x37, 0x77, 0xA0, 0xA1, 0xA2, 0xA8, 0xA9, 0xAA
+    };
+    for (int x : no_modrm) m.e[x] = x86_op(IROpcode::UNKNOWN);
+
+    m.e[0x05] = x86_op(IROpcode::SYSCALL);
+    m.e[0x0B] = x86_op(IROpcode::TRAP);                                       // UD2
+    m.e[0x0D] = x86_modrm(IROpcode::NOP);                                     // PREFETCHW
+    m.e[0x0F] = x86_modrm(IROpcode::UNKNOWN, XF_NONE, XI_B);                  // 3DNow! (suffix opcode)
+    m.e[0x34] = x86_op(IROpcode::SYSCALL);                                    // SYSENTER
+    m.e[0x38] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_ESCAPE);
+    m.e[0x3A] = x86_op(IROpcode::UNKNOWN, XF_NONE, XI_NONE, XO_ESCAPE);
+
+    // 10-17, 28-2B: SSE moves
+    m.e[0x10] = x86_modrm(IROpcode::V_MOV, XF_VW);
+    m.e[0x11] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0x12] = x86_modrm(IROpcode::V_MOV, XF_VW);
+    m.e[0x13] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0x16] = x86_modrm(IROpcode::V_MOV, XF_VW);
+    m.e[0x17] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0x28] = x86_modrm(IROpcode::V_MOV, XF_VW);
+    m.e[0x29] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0x2B] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0x2E] = x86_modrm(IROpcode::V_CMP, XF_VW);                            // UCOMISS
+    m.e[0x2F] = x86_modrm(IROpcode::V_CMP, XF_VW);                            // COMISS
+
+    // 18-1F: prefetch, hint NOPs, ENDBR
+    for (int x = 0x18; x <= 0x1F; x++) m.e[x] = x86_modrm(IROpcode::NOP, XF_NONE, XI_NONE, XO_GROUP, XG_HINT);
+
+    // 40-4F: CMOVcc
+    for (int cc = 0; cc < 16; cc++) m.e[0x40 + cc] = x86_modrm(IROpcode::CMOV, XF_GE, XI_NONE, XO_CC);
+
+    // 50-5F: SSE arithmetic
+    m.e[0x54] = x86_modrm(IROpcode::V_AND, XF_VW);
+    m.e[0x56] = x86_modrm(IROpcode::V_OR, XF_VW);
+    m.e[0x57] = x86_modrm(IROpcode::V_XOR, XF_VW);
+    m.e[0x58] = x86_modrm(IROpcode::V_ADD, XF_VW);
+    m.e[0x59] = x86_modrm(IROpcode::V_MUL, XF_VW);
+    m.e[0x5C] = x86_modrm(IROpcode::V_SUB, XF_VW);
+    m.e[0x5E] = x86_modrm(IROpcode::V_DIV, XF_VW);
+
+    // 60-7F: MMX/SSE2 integer
+    m.e[0x6E] = x86_modrm(IROpcode::V_MOV, XF_VW);
+    m.e[0x6F] = x86_modrm(IROpcode::V_MOV, XF_VW);
+    for (int x = 0x70; x <= 0x73; x++) m.e[x] = x86_modrm(IROpcode::UNKNOWN, XF_VW, XI_B); // PSHUF*, shift groups
+    m.e[0x74] = x86_modrm(IROpcode::V_CMP, XF_VW);
+    m.e[0x75] = x86_modrm(IROpcode::V_CMP, XF_VW);
+    m.e[0x76] = x86_modrm(IROpcode::V_CMP, XF_VW);
+    m.e[0x7E] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0x7F] = x86_modrm(IROpcode::V_MOV, XF_WV);
+
+    // 80-8F: Jcc rel32, 90-9F: SETcc
+    for (int cc = 0; cc < 16; cc++) {
+        m.e[0x80 + cc] = x86_op(IROpcode::JCC, XF_J, XI_RELZ, XO_CC | XO_D64);
+        m.e[0x90 + cc] = x86_modrm(IROpcode::SETCC, XF_E, XI_NONE, XO_CC | XO_BYTE);
+    }
+
+    // A0-BF
+    m.e[0xA0] = x86_op(IROpcode::PUSH, XF_SEG, XI_NONE, XO_D64, REG_SEG0 + 4);
+    m.e[0xA1] = x86_op(IROpcode::POP, XF_SEG, XI_NONE, XO_D64, REG_SEG0 + 4);
+    m.e[0xA4] = x86_modrm(IROpcode::UNKNOWN, XF_EG, XI_B);                    // SHLD imm8
+    m.e[0xA8] = x86_op(IROpcode::PUSH, XF_SEG, XI_NONE, XO_D64, REG_SEG0 + 5);
+    m.e[0xA9] = x86_op(IROpcode::POP, XF_SEG, XI_NONE, XO_D64, REG_SEG0 + 5);
+    m.e[0xAC] = x86_modrm(IROpcode::UNKNOWN, XF_EG, XI_B);                    // SHRD imm8
+    m.e[0xAF] = x86_modrm(IROpcode::MUL, XF_GE);                              // IMUL Gv, Ev
+    m.e[0xB6] = x86_modrm(IROpcode::MOVZX, XF_GE, XI_NONE, XO_SRC8);
+    m.e[0xB7] = x86_modrm(IROpcode::MOVZX, XF_GE, XI_NONE, XO_SRC16);
+    m.e[0xB9] = x86_modrm(IROpcode::TRAP);                                    // UD1
+    m.e[0xBA] = x86_modrm(IROpcode::UNKNOWN, XF_EI, XI_B);                    // BT group
+    m.e[0xBE] = x86_modrm(IROpcode::MOVSX, XF_GE, XI_NONE, XO_SRC8);
+    m.e[0xBF] = x86_modrm(IROpcode::MOVSX, XF_GE, XI_NONE, XO_SRC16);
+
+    // C0-CF
+    m.e[0xC2] = x86_modrm(IROpcode::V_CMP, XF_VW, XI_B);                      // CMPPS
+    m.e[0xC4] = x86_modrm(IROpcode::UNKNOWN, XF_VW, XI_B);                    // PINSRW
+    m.e[0xC5] = x86_modrm(IROpcode::UNKNOWN, XF_GE, XI_B);                    // PEXTRW
+    m.e[0xC6] = x86_modrm(IROpcode::UNKNOWN, XF_VW, XI_B);                    // SHUFPS
+    for (int r = 0; r < 8; r++) m.e[0xC8 + r] = x86_op(IROpcode::UNKNOWN, XF_Z); // BSWAP
+
+    // D0-FF: SSE2 packed integer
+    m.e[0xD4] = x86_modrm(IROpcode::V_ADD, XF_VW);
+    m.e[0xD5] = x86_modrm(IROpcode::V_MUL, XF_VW);
+    m.e[0xD6] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0xDB] = x86_modrm(IROpcode::V_AND, XF_VW);
+    m.e[0xE7] = x86_modrm(IROpcode::V_MOV, XF_WV);
+    m.e[0xEB] = x86_modrm(IROpcode::V_OR, XF_VW);
+    m.e[0xEF] = x86_modrm(IROpcode::V_XOR, XF_VW);
+    m.e[0xF4] = x86_modrm(IROpcode::V_MUL, XF_VW);
+    for (int x = 0xF8; x <= 0xFB; x++) m.e[x] = x86_modrm(IROpcode::V_SUB, XF_VW);
+    for (int x = 0xFC; x <= 0xFE; x++) m.e[x] = x86_modrm(IROpcode::V_ADD, XF_VW);
+    m.e[0xFF] = x86_modrm(IROpcode::TRAP);                                    // UD0
+    return m;
+}
+
+// 0F38 and 0F3A are uniformly "ModRM" and "ModRM + imm8"; individual
+// semantics are not modelled yet, so they lift as correctly sized UNKNOWNs.
+static constexpr X86OpMap build_x86_0f38_map() {
+    X86OpMap m{};
+    for (int i = 0; i < 256; i++) m.e[i] = x86_modrm(IROpcode::UNKNOWN, XF_VW);
+    return m;
+}
+
+static constexpr X86OpMap build_x86_0f3a_map() {
+    X86OpMap m{};
+    for (int i = 0; i < 256; i++) m.e[i] = x86_modrm(IROpcode::UNKNOWN, XF_VW, XI_B);
+    return m;
+}
+
+static constexpr X86OpMap kX86OneByte = build_x86_one_byte_map();
+static constexpr X86OpMap kX86Map0F = build_x86_0f_map();
+static constexpr X86OpMap kX86Map0F38 = build_x86_0f38_map();
+static constexpr X86OpMap kX86Map0F3A = build_x86_0f3a_map();
@@ -0,0 +1,515 @@
+/**
+ * Lift Cache - Function-granular, content-addressed cache for lift_cfg output
+ *
+ * An image is opened once per lift job (openImage): its bytes are hashed in
+ * PAGE_BYTES pages, with crypto.subtle where available, and it gets an id,
+ * the caller's name for it or else the SHA-256 of its pages. A lifted
+ * function is stored under that id, the entry point and the lift limits,
+ * keyed by a SHA-256 over those and the digests of the pages its blocks were
+ * decoded from (each block plus the MAX_INSTRUCTION_BYTES read-ahead an
+ * instruction may look at past the block end). lift_cfg reads nothing else,
+ * so a lookup re-derives the key from the page digests and reuses the blocks
+ * and records when it still matches: re-lifting a patched binary under the
+ * same name only decodes the functions on pages that changed.
+ *
+ * Lookups are synchronous (NativeImage.liftFunction runs them, in the lift
+ * workers too) against the session's records. An image's records also go to
+ * the cluster CAS (lib/storage/wasm-cas.ts) as one artifact, written by
+ * persist() at the end of a job, and openImage() loads it back in a later
+ * session.
+ */
+
+import { getArtifactFromCas, hasArtifactInCas, putArtifactToCas } from '../storage/wasm-cas';
+import {
+  NATIVE_BLOCK_STRIDE,
+  NATIVE_IR_STRIDE,
+  NativeArch,
+  NativeCFG,
+  decodeBlockRecords,
+  decodeIRRecords,
+  encodeBlockRecords,
+  encodeIRRecords,
+} from './native-lifter';
+
+const MAX_INSTRUCTION_BYTES = 15;
+const PAGE_BYTES = 4096;
+const DIGEST_BYTES = 32;
+
+// Record: magic, block count, IR record count, reserved, the 32-byte key,
+// then the IRBlock and IRInstruction records in their native layout
+const RECORD_MAGIC = 0x3243464c; // "LFC2"
+const KEY_BYTES = 32;
+const RECORD_HEADER_BYTES = 16 + KEY_BYTES;
+// Image artifact: magic, function count, then per function a u32 length and
+// its UTF-8 location, a u32 length and its record
+const IMAGE_MAGIC = 0x3149464c; // "LFI1"
+const INDEX_KEY = 'bellum.lift.cache.v3';
+
+export interface LiftCacheOptions {
+  maxInstructions: number;
+  maxBlocks: number;
+  optimize: boolean;
+}
+
+// NativeImage.liftFunction's defaults
+export const DEFAULT_LIFT_OPTIONS: LiftCacheOptions = { maxInstructions: 65536, maxBlocks: 8192, optimize: false };
+
+/** A cached function as handed to a lift worker, located within its image */
+export interface LiftCacheEntry {
+  location: string;
+  record: Uint8Array;
+}
+
+/** An image's page digests and cached functions, to seed a lift worker's cache with */
+export interface LiftCacheSnapshot {
+  id: string;
+  arch: NativeArch;
+  baseAddress: number;
+  length: number;
+  pages: Uint8Array;
+  entries: LiftCacheEntry[];
+}
+
+export interface LiftCacheStats {
+  hits: number;
+  misses: number; // Includes stale entries whose bytes changed
+  stored: number;
+  persisted: number;
+  restored: number;
+}
+
+interface CachedFunction {
+  key: string;
+  cfg: NativeCFG;
+  record: Uint8Array;
+}
+
+// The functions cached for one image id, by location
+interface ImageRecords {
+  functions: Map<string, CachedFunction>;
+  restored: boolean;
+  dirty: boolean; // Stored to since the last persist()
+}
+
+// What a LiftCache shares with the images it opens
+interface CacheState {
+  readOnly: boolean;
+  stats: LiftCacheStats;
+  persistQueue: Promise<void>;
+}
+
+// SHA-256 over several pieces without joining them, synchronous so lookups
+// can run inside a lift
+const K = new Uint32Array([
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+]);
+
+class Sha256 {
+  private state = new Uint32Array([
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  ]);
+  private block = new Uint8Array(64);
+  private w = new Uint32Array(64);
+  private filled = 0;
+  private length = 0;
+
+  update(data: Uint8Array): this {
+    this.length += data.length;
+    for (let i = 0; i < data.length; ) {
+      const take = Math.min(64 - this.filled, data.length - i);
+      this.block.set(data.subarray(i, i + take), this.filled);
+      this.filled += take;
+      i += take;
+      if (this.filled === 64) {
+        this.compress();
+        this.filled = 0;
+      }
+    }
+    return this;
+  }
+
+  digest(): Uint8Array {
+    const bits = this.length * 8;
+    this.block[this.filled++] = 0x80;
+    if (this.filled > 56) {
+      this.block.fill(0, this.filled);
+      this.compress();
+      this.filled = 0;
+    }
+    this.block.fill(0, this.filled, 56);
+    const tail = new DataView(this.block.buffer);
+    tail.setUint32(56, Math.floor(bits / 0x100000000));
+    tail.setUint32(60, bits >>> 0);
+    this.compress();
+
+    const out = new Uint8Array(32);
+    const view = new DataView(out.buffer);
+    this.state.forEach((h, i) => view.setUint32(4 * i, h));
+    return out;
+  }
+
+  private compress() {
+    const w = this.w;
+    const b = this.block;
+    for (let i = 0; i < 16; i++) {
+      w[i] = (b[4 * i] << 24) | (b[4 * i + 1] << 16) | (b[4 * i + 2] << 8) | b[4 * i + 3];
+    }
+    for (let i = 16; i < 64; i++) {
+      const x = w[i - 15];
+      const y = w[i - 2];
+      const s0 = ((x >>> 7) | (x << 25)) ^ ((x >>> 18) | (x << 14)) ^ (x >>> 3);
+      const s1 = ((y >>> 17) | (y << 15)) ^ ((y >>> 19) | (y << 13)) ^ (y >>> 10);
+      w[i] = (w[i - 16] + s0 + w[i - 7] + s1) | 0;
+    }
+
+    const h = this.state;
+    let [a, bb, c, d, e, f, g, hh] = h;
+    for (let i = 0; i < 64; i++) {
+      const s1 = ((e >>> 6) | (e << 26)) ^ ((e >>> 11) | (e << 21)) ^ ((e >>> 25) | (e << 7));
+      const t1 = (hh + s1 + ((e & f) ^ (~e & g)) + K[i] + w[i]) | 0;
+      const s0 = ((a >>> 2) | (a << 30)) ^ ((a >>> 13) | (a << 19)) ^ ((a >>> 22) | (a << 10));
+      const t2 = (s0 + ((a & bb) ^ (a & c) ^ (bb & c))) | 0;
+      hh = g;
+      g = f;
+      f = e;
+      e = (d + t1) | 0;
+      d = c;
+      c = bb;
+      bb = a;
+      a = (t1 + t2) | 0;
+    }
+    h[0] += a;
+    h[1] += bb;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += hh;
+  }
+}
+
+function toHex(bytes: Uint8Array): string {
+  return Array.from(bytes, (b) => b.toString(16).padStart(2, '0')).join('');
+}
+
+// Lift parameters a key does not hash the bytes of, within an image
+function locationOf(entryPoint: number, options: LiftCacheOptions): string {
+  const { maxInstructions, maxBlocks, optimize } = options;
+  return `${entryPoint.toString(16)}:${maxInstructions}:${maxBlocks}:${optimize ? 1 : 0}`;
+}
+
+// SHA-256 of every PAGE_BYTES page of `code`, the last one short
+async function pageDigests(code: Uint8Array): Promise<Uint8Array> {
+  const count = Math.ceil(code.length / PAGE_BYTES);
+  const pages = new Uint8Array(count * DIGEST_BYTES);
+  const subtle = globalThis.crypto?.subtle;
+  const digests = await Promise.all(
+    Array.from({ length: count }, async (_, p) => {
+      // Copied: subtle.digest does not take views of shared memory
+      const page = code.slice(p * PAGE_BYTES, (p + 1) * PAGE_BYTES);
+      return subtle ? new Uint8Array(await subtle.digest('SHA-256', page)) : new Sha256().update(page).digest();
+    })
+  );
+  digests.forEach((digest, p) => pages.set(digest, p * DIGEST_BYTES));
+  return pages;
+}
+
+function toRecord(key: string, cfg: NativeCFG): Uint8Array {
+  const blocksOffset = RECORD_HEADER_BYTES;
+  const irOffset = blocksOffset + cfg.blocks.length * NATIVE_BLOCK_STRIDE;
+  const record = new Uint8Array(irOffset + cfg.instructions.length * NATIVE_IR_STRIDE);
+  const view = new DataView(record.buffer);
+  view.setUint32(0, RECORD_MAGIC, true);
+  view.setUint32(4, cfg.blocks.length, true);
+  view.setUint32(8, cfg.instructions.length, true);
+  for (let i = 0; i < KEY_BYTES; i++) record[16 + i] = parseInt(key.slice(2 * i, 2 * i + 2), 16);
+  encodeBlockRecords(view, blocksOffset, cfg.blocks);
+  encodeIRRecords(view, irOffset, cfg.instructions);
+  return record;
+}
+
+function fromRecord(record: Uint8Array): CachedFunction | null {
+  if (record.byteLength < RECORD_HEADER_BYTES) return null;
+  const view = new DataView(record.buffer, record.byteOffset, record.byteLength);
+  if (view.getUint32(0, true) !== RECORD_MAGIC) return null;
+  const blockCount = view.getUint32(4, true);
+  const irCount = view.getUint32(8, true);
+  const irOffset = RECORD_HEADER_BYTES + blockCount * NATIVE_BLOCK_STRIDE;
+  if (record.byteLength !== irOffset + irCount * NATIVE_IR_STRIDE) return null;
+  return {
+    key: toHex(record.subarray(16, 16 + KEY_BYTES)),
+    cfg: {
+      blocks: decodeBlockRecords(view, RECORD_HEADER_BYTES, blockCount),
+      instructions: decodeIRRecords(view, irOffset, irCount),
+    },
+    record,
+  };
+}
+
+function packImage(functions: [string, CachedFunction][]): Uint8Array {
+  const encoder = new TextEncoder();
+  const locations = functions.map(([location]) => encoder.encode(location));
+  const size = functions.reduce((sum, [, cached], i) => sum + 8 + locations[i].length + cached.record.length, 8);
+  const packed = new Uint8Array(size);
+  const view = new DataView(packed.buffer);
+  view.setUint32(0, IMAGE_MAGIC, true);
+  view.setUint32(4, functions.length, true);
+  let pos = 8;
+  functions.forEach(([, cached], i) => {
+    view.setUint32(pos, locations[i].length, true);
+    packed.set(locations[i], pos + 4);
+    pos += 4 + locations[i].length;
+    view.setUint32(pos, cached.record.length, true);
+    packed.set(cached.record, pos + 4);
+    pos += 4 + cached.record.length;
+  });
+  return packed;
+}
+
+// The functions of a packImage() artifact; an entry that does not parse is skipped
+function unpackImage(packed: Uint8Array): Map<string, CachedFunction> {
+  const functions = new Map<string, CachedFunction>();
+  const view = new DataView(packed.buffer, packed.byteOffset, packed.byteLength);
+  if (packed.byteLength < 8 || view.getUint32(0, true) !== IMAGE_MAGIC) return functions;
+  const decoder = new TextDecoder();
+  let pos = 8;
+  for (let i = view.getUint32(4, true); i > 0 && pos + 4 <= packed.byteLength; i--) {
+    const locationEnd = pos + 4 + view.getUint32(pos, true);
+    if (locationEnd + 4 > packed.byteLength) break;
+    const recordEnd = locationEnd + 4 + view.getUint32(locationEnd, true);
+    if (recordEnd > packed.byteLength) break;
+    const cached = fromRecord(packed.subarray(locationEnd + 4, recordEnd));
+    if (cached) functions.set(decoder.decode(packed.subarray(pos + 4, locationEnd)), cached);
+    pos = recordEnd;
+  }
+  return functions;
+}
+
+function readIndex(): Record<string, string> {
+  try {
+    const raw = window.localStorage.getItem(INDEX_KEY);
+    if (!raw) return {};
+    const j = JSON.parse(raw);
+    return j && typeof j === 'object' ? (j as Record<string, string>) : {};
+  } catch {
+    return {};
+  }
+}
+
+function writeIndex(index: Record<string, string>) {
+  try {
+    window.localStorage.setItem(INDEX_KEY, JSON.stringify(index));
+  } catch {
+    // ignore
+  }
+}
+
+/**
+ * One image's view of a LiftCache, from LiftCache.openImage (or seed() in a
+ * lift worker). Lookups and stores are against the bytes it was opened over.
+ */
+export class LiftCacheImage {
+  constructor(
+    readonly id: string,
+    readonly arch: NativeArch,
+    readonly baseAddress: number,
+    readonly length: number,
+    private readonly pages: Uint8Array,
+    private readonly records: ImageRecords,
+    private readonly state: CacheState
+  ) {}
+
+  /**
+   * The cached lift of the function at `entryPoint`, or null when there is
+   * none or the pages it was decoded from have changed
+   */
+  lookup(entryPoint: number, options: LiftCacheOptions): NativeCFG | null {
+    const location = locationOf(entryPoint, options);
+    const cached = this.records.functions.get(location);
+    if (!cached || this.functionKey(location, cached.cfg.blocks) !== cached.key) {
+      this.state.stats.misses++;
+      return null;
+    }
+    this.state.stats.hits++;
+    return { ...cached.cfg, fromCache: true };
+  }
+
+  /**
+   * Record a fresh lift of the function at `entryPoint`; persist() writes it
+   * to the CAS
+   */
+  store(entryPoint: number, options: LiftCacheOptions, cfg: NativeCFG) {
+    // An empty lift has no bytes to key it by
+    if (this.state.readOnly || cfg.blocks.length === 0) return;
+    const location = locationOf(entryPoint, options);
+    const key = this.functionKey(location, cfg.blocks);
+    if (this.records.functions.get(location)?.key === key) return;
+
+    const cfgOnly = { blocks: cfg.blocks, instructions: cfg.instructions };
+    this.records.functions.set(location, { key, cfg: cfgOnly, record: toRecord(key, cfg) });
+    this.records.dirty = true;
+    this.state.stats.stored++;
+  }
+
+  snapshot(): LiftCacheSnapshot {
+    const entries: LiftCacheEntry[] = [];
+    this.records.functions.forEach((cached, location) => entries.push({ location, record: cached.record }));
+    return { id: this.id, arch: this.arch, baseAddress: this.baseAddress, length: this.length, pages: this.pages, entries };
+  }
+
+  /**
+   * Write the image's functions to the CAS as one artifact, if any were
+   * stored since the last call, and point the index at it. Call once a lift
+   * job is done; the browser only.
+   */
+  persist(): Promise<void> {
+    const { records, state } = this;
+    if (state.readOnly || !records.dirty || typeof window === 'undefined') return state.persistQueue;
+    records.dirty = false;
+    const functions = Array.from(records.functions);
+
+    // Serialized: the index is read-modify-write in localStorage
+    state.persistQueue = state.persistQueue.then(async () => {
+      try {
+        const packed = packImage(functions);
+        const { artifactId } = await putArtifactToCas(packed.buffer as ArrayBuffer, {
+          prefix: 'lift',
+          extension: 'bin',
+          mimeType: 'application/octet-stream',
+        });
+        const index = readIndex();
+        index[this.id] = artifactId;
+        writeIndex(index);
+        state.stats.persisted += functions.length;
+      } catch {
+        // The session still holds the records; the next persist() retries
+        records.dirty = true;
+      }
+    });
+    return state.persistQueue;
+  }
+
+  /**
+   * Key of the function at `location` whose blocks are `blocks`, over the
+   * digests of the pages they span. A block range clipped by the image end
+   * is hashed with its clipped length, so growing the image past it changes
+   * the key.
+   */
+  private functionKey(location: string, blocks: NativeCFG['blocks']): string {
+    const hash = new Sha256().update(new TextEncoder().encode(`${this.id}:${location}`));
+    const range = new DataView(new ArrayBuffer(20));
+    const clip = (offset: number) => Math.min(Math.max(offset, 0), this.length);
+    const pages = new Set<number>();
+    for (const block of blocks) {
+      const start = clip(block.start - this.baseAddress);
+      const end = Math.max(start, clip(block.end - this.baseAddress + MAX_INSTRUCTION_BYTES));
+      range.setBigUint64(0, BigInt(block.start), true);
+      range.setBigUint64(8, BigInt(block.end), true);
+      range.setUint32(16, end - start, true);
+      hash.update(new Uint8Array(range.buffer));
+      if (end > start) {
+        for (let p = Math.floor(start / PAGE_BYTES); p <= Math.floor((end - 1) / PAGE_BYTES); p++) pages.add(p);
+      }
+    }
+    const page = new DataView(new ArrayBuffer(4));
+    for (const p of Array.from(pages).sort((a, b) => a - b)) {
+      page.setUint32(0, p, true);
+      hash.update(new Uint8Array(page.buffer)).update(this.pages.subarray(p * DIGEST_BYTES, (p + 1) * DIGEST_BYTES));
+    }
+    return toHex(hash.digest());
+  }
+}
+
+export class LiftCache {
+  /**
+   * A read-only cache only serves lookups (e.g. a lift worker's, seeded by
+   * the thread that stores what the workers lift)
+   */
+  constructor(readOnly: boolean = false) {
+    this.state = {
+      readOnly,
+      stats: { hits: 0, misses: 0, stored: 0, persisted: 0, restored: 0 },
+      persistQueue: Promise.resolve(),
+    };
+  }
+
+  private readonly state: CacheState;
+  private images = new Map<string, ImageRecords>();
+
+  /**
+   * Open `code` (guest address `baseAddress`) for lookups and stores. The
+   * image is identified by `name` when given, so a patched build under the
+   * same name keeps the functions whose pages did not change, and by its
+   * content otherwise. The functions persisted for it in earlier sessions
+   * are loaded on the first open.
+   */
+  async openImage(code: Uint8Array, baseAddress: number, arch: NativeArch, name?: string): Promise<LiftCacheImage> {
+    const pages = await pageDigests(code);
+    const id = `${arch}:${baseAddress.toString(16)}:${name ?? toHex(new Sha256().update(pages).digest())}`;
+    const records = this.recordsOf(id);
+    if (!records.restored) {
+      records.restored = true;
+      await this.restore(id, records);
+    }
+    return new LiftCacheImage(id, arch, baseAddress, code.length, pages, records, this.state);
+  }
+
+  /**
+   * An image from another cache's snapshot(), its entries added (not
+   * persisted again)
+   */
+  seed(snapshot: LiftCacheSnapshot): LiftCacheImage {
+    const records = this.recordsOf(snapshot.id);
+    records.restored = true;
+    for (const { location, record } of snapshot.entries) {
+      const cached = fromRecord(record);
+      if (cached) records.functions.set(location, cached);
+    }
+    const { id, arch, baseAddress, length, pages } = snapshot;
+    return new LiftCacheImage(id, arch, baseAddress, length, pages, records, this.state);
+  }
+
+  getStats(): LiftCacheStats {
+    return { ...this.state.stats };
+  }
+
+  clear() {
+    this.images.clear();
+  }
+
+  private recordsOf(id: string): ImageRecords {
+    let records = this.images.get(id);
+    if (!records) {
+      records = { functions: new Map(), restored: false, dirty: false };
+      this.images.set(id, records);
+    }
+    return records;
+  }
+
+  // One artifact per image; lookups only see records in memory
+  private async restore(id: string, records: ImageRecords): Promise<void> {
+    if (typeof window === 'undefined') return;
+    const artifactId = readIndex()[id];
+    if (!artifactId || !hasArtifactInCas(artifactId)) return;
+    try {
+      const { bytes } = await getArtifactFromCas(artifactId);
+      unpackImage(bytes).forEach((cached, location) => {
+        if (records.functions.has(location)) return;
+        records.functions.set(location, cached);
+        this.state.stats.restored++;
+      });
+    } catch {
+      // Lifted again on a miss
+    }
+  }
+}
+
+export const liftCache = new LiftCache();
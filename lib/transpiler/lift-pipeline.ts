@@ -0,0 +1,267 @@
+/**
+ * Lift Pipeline - Lifts and compiles guest basic blocks off the main thread
+ *
+ * Three workers run the stages decode -> optimize -> emit (see
+ * workers/lift-pipeline-worker.ts), connected by SpscRings in
+ * SharedArrayBuffers, so decoding block N+1 overlaps optimizing N and
+ * emitting and compiling N-1. The main thread only posts the job and
+ * receives compiled WebAssembly.Modules as they stream out of the last
+ * stage; it never waits on a ring. Without cross-origin isolation the
+ * stages run in turn on the main thread, yielding at every compile.
+ */
+
+import type { PipelineStage, PipelineStageJob, PipelineStageStats, PipelineWorkerMessage } from '@/workers/lift-pipeline-worker';
+import { nativeCounters } from '../performance/native-counters';
+import {
+  NATIVE_IR_STRIDE,
+  NativeArch,
+  NativeImage,
+  emitNativeModule,
+  initNativeLifter,
+  optimizeNativeRecords,
+} from './native-lifter';
+import { SpscRing } from './spsc-ring';
+
+export type { PipelineStage, PipelineStageStats } from '@/workers/lift-pipeline-worker';
+
+export interface PipelineModule {
+  entry: number;
+  module: WebAssembly.Module | null; // null when the first instruction cannot be translated
+}
+
+export interface LiftPipelineOptions {
+  maxInstructions?: number; // Per block
+  ringBytes?: number; // Per ring; at least two maximal blocks
+  guestBase?: number;
+  sharedMemory?: boolean;
+}
+
+export interface LiftPipelineStats {
+  blocks: number;
+  compiled: number;
+  timeMs: number;
+  stages: Partial<Record<PipelineStage, PipelineStageStats>>;
+}
+
+const STAGES: PipelineStage[] = ['decode', 'optimize', 'emit'];
+
+function sharedMemoryAvailable(): boolean {
+  return typeof SharedArrayBuffer !== 'undefined' && (globalThis as any).crossOriginIsolated === true;
+}
+
+export class LiftPipeline {
+  private workers: Worker[] = [];
+  private busy = false;
+  private lastStats: LiftPipelineStats | null = null;
+
+  isBusy(): boolean {
+    return this.busy;
+  }
+
+  /**
+   * Stats of the last finished job; per-stage native counters are also
+   * reported to lib/performance as 'pipeline:<stage>'
+   */
+  getStats(): LiftPipelineStats | null {
+    return this.lastStats;
+  }
+
+  /**
+   * Lift, optimize, emit and compile the basic block at each of `entries`
+   * (guest addresses, `code[0]` at `baseAddress`), yielding the modules in
+   * completion order
+   */
+  async *compile(
+    code: Uint8Array,
+    baseAddress: number,
+    arch: NativeArch,
+    entries: number[],
+    options: LiftPipelineOptions = {}
+  ): AsyncGenerator<PipelineModule> {
+    if (this.busy) throw new Error('LiftPipeline is already running a job');
+    this.busy = true;
+    const startTime = performance.now();
+    const stats: LiftPipelineStats = { blocks: entries.length, compiled: 0, timeMs: 0, stages: {} };
+    try {
+      const modules = sharedMemoryAvailable()
+        ? this.compileStaged(code, baseAddress, arch, entries, options, stats)
+        : this.compileSequential(code, baseAddress, arch, entries, options, stats);
+      for await (const result of modules) {
+        if (result.module) stats.compiled++;
+        yield result;
+      }
+      stats.timeMs = performance.now() - startTime;
+      this.lastStats = stats;
+      for (const [stage, stageStats] of Object.entries(stats.stages)) {
+        nativeCounters.register(`pipeline:${stage}`, () => stageStats!.counters);
+      }
+    } finally {
+      this.busy = false;
+    }
+  }
+
+  private ensureWorkers() {
+    while (this.workers.length < STAGES.length) {
+      this.workers.push(
+        new Worker(new URL('../../workers/lift-pipeline-worker.ts', import.meta.url), { type: 'module' })
+      );
+    }
+  }
+
+  private async *compileStaged(
+    code: Uint8Array,
+    baseAddress: number,
+    arch: NativeArch,
+    entries: number[],
+    options: LiftPipelineOptions,
+    stats: LiftPipelineStats
+  ): AsyncGenerator<PipelineModule> {
+    if (entries.length === 0) return;
+    this.ensureWorkers();
+    const { maxInstructions = 256, guestBase = 0, sharedMemory = false } = options;
+    const ringBytes = Math.max(options.ringBytes ?? 1 << 20, 4 * (maxInstructions * NATIVE_IR_STRIDE + 8));
+    const jobId = crypto.randomUUID();
+
+    const shared = new SharedArrayBuffer(code.length);
+    new Uint8Array(shared).set(code);
+    const decoded = SpscRing.allocate(ringBytes);
+    const optimized = SpscRing.allocate(ringBytes);
+
+    // Worker messages, handed to the generator below as they arrive
+    const queue: PipelineModule[] = [];
+    let wake = null as (() => void) | null;
+    let failure = null as Error | null;
+    let running = STAGES.length;
+    let received = 0;
+    const notify = () => {
+      wake?.();
+      wake = null;
+    };
+
+    this.workers.forEach((worker, index) => {
+      const stage = STAGES[index];
+      worker.onmessage = (event: MessageEvent<PipelineWorkerMessage>) => {
+        const message = event.data;
+        if (message.jobId !== jobId) return;
+        switch (message.type) {
+          case 'module':
+            queue.push({ entry: entries[message.index], module: message.module });
+            received++;
+            break;
+          case 'done':
+            stats.stages[message.stage] = message.stats;
+            running--;
+            break;
+          case 'error':
+            failure = new Error(`Pipeline ${message.stage} stage: ${message.error}`);
+            break;
+        }
+        notify();
+      };
+      worker.onerror = (event) => {
+        failure = new Error(`Pipeline ${stage} worker: ${event.message}`);
+        notify();
+      };
+
+      const job: PipelineStageJob = {
+        type: 'run',
+        jobId,
+        stage,
+        arch,
+        input: stage === 'optimize' ? decoded : stage === 'emit' ? optimized : undefined,
+        output: stage === 'decode' ? decoded : stage === 'optimize' ? optimized : undefined,
+        code: stage === 'decode' ? shared : undefined,
+        codeLength: code.length,
+        baseAddress,
+        entries: stage === 'decode' ? entries : undefined,
+        maxInstructions,
+        guestBase,
+        sharedMemory,
+      };
+      worker.postMessage(job);
+    });
+
+    let finished = false;
+    try {
+      while (running > 0 || queue.length) {
+        if (failure) throw failure;
+        if (queue.length) {
+          yield queue.shift()!;
+          continue;
+        }
+        await new Promise<void>((resolve) => (wake = resolve));
+      }
+      if (received !== entries.length) throw new Error('Pipeline finished without every block');
+      finished = true;
+    } finally {
+      this.workers.forEach((worker) => {
+        worker.onmessage = null;
+        worker.onerror = null;
+      });
+      // A failed stage, or a consumer that stopped iterating early, can leave
+      // the stages running or blocked on a ring: restart them
+      if (!finished) this.destroy();
+    }
+  }
+
+  private async *compileSequential(
+    code: Uint8Array,
+    baseAddress: number,
+    arch: NativeArch,
+    entries: number[],
+    options: LiftPipelineOptions,
+    stats: LiftPipelineStats
+  ): AsyncGenerator<PipelineModule> {
+    if (!(await initNativeLifter())) throw new Error('Native lifter unavailable');
+    const image = NativeImage.load(code, baseAddress, arch);
+    if (!image) throw new Error('Native lifter unavailable');
+
+    const busy = { decode: 0, optimize: 0, emit: 0 };
+    try {
+      for (const entry of entries) {
+        let start = performance.now();
+        // Copied out: the next lifter call reuses the scratch they are in
+        const records = image.liftBlockRecords(entry, options.maxInstructions).slice();
+        busy.decode += performance.now() - start;
+        start = performance.now();
+        const optimized = (records.length && optimizeNativeRecords(records, arch)?.slice()) || records;
+        busy.optimize += performance.now() - start;
+        start = performance.now();
+        const bytes = emitNativeModule(optimized, arch, options);
+        const module = bytes ? await WebAssembly.compile(bytes) : null;
+        busy.emit += performance.now() - start;
+        yield { entry, module };
+      }
+    } finally {
+      image.release();
+    }
+    for (const stage of STAGES) {
+      stats.stages[stage] = { items: entries.length, busyMs: busy[stage], waitMs: 0, counters: null };
+    }
+  }
+
+  /**
+   * Terminate the stage workers
+   */
+  destroy() {
+    this.workers.forEach((worker) => worker.terminate());
+    this.workers = [];
+  }
+}
+
+// Singleton instance
+let pipeline: LiftPipeline | null = null;
+
+export function getLiftPipeline(): LiftPipeline {
+  if (!pipeline) {
+    pipeline = new LiftPipeline();
+  }
+  return pipeline;
+}
+
+export function destroyLiftPipeline() {
+  if (pipeline) {
+    pipeline.destroy();
+    pipeline = null;
+  }
+}
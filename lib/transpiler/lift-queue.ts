@@ -0,0 +1,167 @@
+/**
+ * Lift Queue - Lock-free work queue in a SharedArrayBuffer for parallel lifting
+ *
+ * Each worker owns a Chase-Lev deque of function entry offsets (relative to
+ * the image base): the owner pushes and pops at the bottom, idle workers
+ * steal from the top of the others. A shared open-addressing set makes sure
+ * every entry point is queued once however many callers discover it, and a
+ * pending counter (queued + in progress) detects global completion.
+ *
+ * Layout (Int32 slots):
+ *   [0] pending  [1] doorbell (bumped on push, for Atomics.wait)
+ *   [2] worker count  [3] deque capacity  [4] seen-set capacity
+ *   per worker LINE slots: [top, bottom]   (one cache line each)
+ *   per worker deque buffers, then the seen set (offset + 1, 0 = empty)
+ */
+
+const PENDING = 0;
+const DOORBELL = 1;
+const WORKERS = 2;
+const DEQUE_CAPACITY = 3;
+const SEEN_CAPACITY = 4;
+const HEADER = 16;
+const LINE = 16;
+
+export const QUEUE_EMPTY = -1;
+
+export class SharedLiftQueue {
+  private readonly slots: Int32Array;
+  private readonly workerCount: number;
+  private readonly dequeCapacity: number;
+  private readonly seenCapacity: number;
+  private readonly dequeBase: number;
+  private readonly seenBase: number;
+
+  /**
+   * Capacities are rounded up to powers of two
+   */
+  static allocate(workerCount: number, dequeCapacity: number = 1 << 16, seenCapacity: number = 1 << 18): SharedArrayBuffer {
+    const deque = nextPow2(dequeCapacity);
+    const seen = nextPow2(seenCapacity);
+    const buffer = new SharedArrayBuffer(4 * (HEADER + workerCount * (LINE + deque) + seen));
+    const slots = new Int32Array(buffer);
+    slots[WORKERS] = workerCount;
+    slots[DEQUE_CAPACITY] = deque;
+    slots[SEEN_CAPACITY] = seen;
+    return buffer;
+  }
+
+  constructor(buffer: SharedArrayBuffer) {
+    this.slots = new Int32Array(buffer);
+    this.workerCount = this.slots[WORKERS];
+    this.dequeCapacity = this.slots[DEQUE_CAPACITY];
+    this.seenCapacity = this.slots[SEEN_CAPACITY];
+    this.dequeBase = HEADER + this.workerCount * LINE;
+    this.seenBase = this.dequeBase + this.workerCount * this.dequeCapacity;
+  }
+
+  get workers(): number {
+    return this.workerCount;
+  }
+
+  /**
+   * Queue `offset` on `worker`'s deque unless it was queued before. Only the
+   * owning worker (or the main thread before workers start) may push to a
+   * deque; on 'full' the caller keeps the entry, lifts it itself and then
+   * calls complete().
+   */
+  push(worker: number, offset: number): 'queued' | 'duplicate' | 'full' {
+    if (!this.markSeen(offset)) return 'duplicate';
+    Atomics.add(this.slots, PENDING, 1);
+
+    const line = HEADER + worker * LINE;
+    const b = Atomics.load(this.slots, line + 1);
+    const t = Atomics.load(this.slots, line);
+    if (b - t >= this.dequeCapacity) return 'full';
+
+    Atomics.store(this.slots, this.dequeBase + worker * this.dequeCapacity + (b & (this.dequeCapacity - 1)), offset);
+    Atomics.store(this.slots, line + 1, b + 1);
+    Atomics.add(this.slots, DOORBELL, 1);
+    Atomics.notify(this.slots, DOORBELL);
+    return 'queued';
+  }
+
+  /**
+   * Owner side: newest entry of `worker`'s deque, or QUEUE_EMPTY
+   */
+  pop(worker: number): number {
+    const line = HEADER + worker * LINE;
+    const b = Atomics.load(this.slots, line + 1) - 1;
+    Atomics.store(this.slots, line + 1, b);
+    const t = Atomics.load(this.slots, line);
+    if (t > b) {
+      Atomics.store(this.slots, line + 1, b + 1);
+      return QUEUE_EMPTY;
+    }
+    let x = Atomics.load(this.slots, this.dequeBase + worker * this.dequeCapacity + (b & (this.dequeCapacity - 1)));
+    if (t === b) {
+      // Last entry: race thieves for it
+      if (Atomics.compareExchange(this.slots, line, t, t + 1) !== t) x = QUEUE_EMPTY;
+      Atomics.store(this.slots, line + 1, b + 1);
+    }
+    return x;
+  }
+
+  /**
+   * Thief side: oldest entry from another worker's deque, trying each victim once
+   */
+  steal(thief: number): number {
+    for (let i = 1; i < this.workerCount; i++) {
+      const victim = (thief + i) % this.workerCount;
+      const line = HEADER + victim * LINE;
+      for (;;) {
+        const t = Atomics.load(this.slots, line);
+        const b = Atomics.load(this.slots, line + 1);
+        if (t >= b) break;
+        const x = Atomics.load(this.slots, this.dequeBase + victim * this.dequeCapacity + (t & (this.dequeCapacity - 1)));
+        if (Atomics.compareExchange(this.slots, line, t, t + 1) === t) return x;
+        // Lost the race to the owner or another thief; retry this victim
+      }
+    }
+    return QUEUE_EMPTY;
+  }
+
+  /**
+   * Mark one popped or stolen entry (or a kept 'full' one) as lifted
+   */
+  complete() {
+    if (Atomics.sub(this.slots, PENDING, 1) === 1) {
+      Atomics.add(this.slots, DOORBELL, 1);
+      Atomics.notify(this.slots, DOORBELL);
+    }
+  }
+
+  isFinished(): boolean {
+    return Atomics.load(this.slots, PENDING) === 0;
+  }
+
+  /**
+   * Block until something is pushed or everything completes (worker threads only)
+   */
+  waitForWork(timeoutMs: number = 5) {
+    const ring = Atomics.load(this.slots, DOORBELL);
+    if (this.isFinished()) return;
+    Atomics.wait(this.slots, DOORBELL, ring, timeoutMs);
+  }
+
+  // Returns false if `offset` was already present. A full set admits
+  // everything: duplicates then only cost a redundant lift.
+  private markSeen(offset: number): boolean {
+    const mask = this.seenCapacity - 1;
+    const key = offset + 1;
+    let h = Math.imul(key, 0x9e3779b1) >>> 0;
+    for (let probe = 0; probe < this.seenCapacity; probe++, h++) {
+      const slot = this.seenBase + (h & mask);
+      const prev = Atomics.compareExchange(this.slots, slot, 0, key);
+      if (prev === 0) return true;
+      if (prev === key) return false;
+    }
+    return true;
+  }
+}
+
+function nextPow2(n: number): number {
+  let p = 1;
+  while (p < n) p <<= 1;
+  return p;
+}
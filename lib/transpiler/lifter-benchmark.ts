@@ -0,0 +1,189 @@
+/**
+ * Lifter Benchmark - Runs the WASM build of cpp/lifter_bench.cpp over a
+ * corpus of code sections and, on the same bytes, x86-full.ts for
+ * comparison on x86. arm-full.ts only decodes A32, so ARM64 has no
+ * TypeScript number.
+ */
+
+import { loadNativeAndInstantiate } from '../wasm/loader';
+import { x86DecoderFull } from './lifter/decoders/x86-full';
+import { Decoder } from './lifter/types';
+import { NATIVE_BLOCK_STRIDE, NATIVE_IR_STRIDE, NativeArch } from './native-lifter';
+
+export interface LifterBenchSection {
+  arch: NativeArch;
+  code: Uint8Array;
+  address: number;
+  name?: string;
+}
+
+export interface LifterBenchResult {
+  arch: NativeArch;
+  sections: number;
+  bytes: number; // Per iteration
+  instructions: number; // Per iteration
+  instructionsPerSecond: number;
+  bytesPerSecond: number;
+  unknownRate: number; // Fraction of records with IROpcode.UNKNOWN
+  functions: number; // lift_cfg calls behind the peaks below
+  cfgPeakRecords: number; // Most IR records one lift_cfg function used
+  cfgPeakBlocks: number; // Most blocks one lift_cfg function used
+  streamPeakRecords: number; // Most records one drain after a 64 KiB stream feed returned
+  tsInstructionsPerSecond: number | null; // TypeScript decoder on the same sections
+}
+
+interface LifterBenchExports {
+  memory: WebAssembly.Memory;
+  __heap_base?: WebAssembly.Global;
+  lifter_bench(
+    code: number,
+    length: number,
+    entryPoint: bigint,
+    archId: number,
+    ir: number,
+    maxOut: number,
+    iterations: number,
+    stats: number
+  ): number;
+  lifter_bench_peaks(
+    code: number,
+    length: number,
+    entryPoint: bigint,
+    archId: number,
+    ir: number,
+    maxOut: number,
+    blocks: number,
+    maxBlocks: number,
+    streamMem: number,
+    streamBytes: number,
+    stats: number
+  ): number;
+  lifter_stream_bytes(capacity: number): number;
+}
+
+// sizeof(LiftBenchStats) on wasm32
+const STATS_BYTES = 48;
+
+function ensureMemory(exports: LifterBenchExports, end: number) {
+  const needed = end - exports.memory.buffer.byteLength;
+  if (needed > 0) exports.memory.grow(Math.ceil(needed / 65536));
+}
+
+function tsDecoderFor(arch: NativeArch): Decoder | null {
+  switch (arch) {
+    case NativeArch.X86:
+    case NativeArch.X86_64:
+      return x86DecoderFull;
+    default:
+      // ARM64 included: arm-full.ts decodes A32, not the A64 bytes
+      return null;
+  }
+}
+
+/**
+ * Instructions/s of the TypeScript decoder walking each section block by block
+ */
+function benchmarkTsDecoder(sections: LifterBenchSection[], iterations: number): number | null {
+  const decoder = tsDecoderFor(sections[0].arch);
+  if (!decoder) return null;
+  let instructions = 0;
+  const start = performance.now();
+  for (let it = 0; it < iterations; it++) {
+    for (const section of sections) {
+      let offset = 0;
+      while (offset < section.code.length) {
+        const block = decoder.decode(section.code, offset, section.address + offset);
+        instructions += block.instructions.length;
+        offset += Math.max(1, block.endAddr - (section.address + offset));
+      }
+    }
+  }
+  const seconds = (performance.now() - start) / 1000;
+  return seconds > 0 ? instructions / seconds : null;
+}
+
+/**
+ * Benchmark the native lifter per architecture. Returns null when
+ * /wasm/lifter-bench.wasm is not available.
+ */
+export async function benchmarkNativeLifter(
+  corpus: LifterBenchSection[],
+  iterations: number = 10,
+  maxInstructions: number = 65536,
+  compareTs: boolean = true,
+  maxBlocks: number = 8192
+): Promise<LifterBenchResult[] | null> {
+  const exports = (await loadNativeAndInstantiate('lifter-bench')) as LifterBenchExports | null;
+  if (!exports || typeof exports.lifter_bench !== 'function') return null;
+
+  const base = ((exports.__heap_base ? Number(exports.__heap_base.value) : 65536) + 7) & ~7;
+  const results: LifterBenchResult[] = [];
+
+  for (const arch of [NativeArch.X86, NativeArch.X86_64, NativeArch.ARM64, NativeArch.RISCV]) {
+    const sections = corpus.filter((s) => s.arch === arch && s.code.length > 0);
+    if (!sections.length) continue;
+
+    const largest = Math.max(...sections.map((s) => s.code.length));
+    const statsPtr = base;
+    const irPtr = statsPtr + STATS_BYTES;
+    const blocksPtr = irPtr + maxInstructions * NATIVE_IR_STRIDE;
+    const streamPtr = blocksPtr + maxBlocks * NATIVE_BLOCK_STRIDE;
+    const streamBytes = (exports.lifter_stream_bytes(maxInstructions) + 7) & ~7;
+    const codePtr = streamPtr + streamBytes;
+    ensureMemory(exports, codePtr + largest);
+    new Uint8Array(exports.memory.buffer, statsPtr, STATS_BYTES).fill(0);
+
+    let seconds = 0;
+    for (const section of sections) {
+      new Uint8Array(exports.memory.buffer).set(section.code, codePtr);
+      const entry = BigInt(section.address);
+      // Warm-up into a separate stats block, not counted, then the high-water marks
+      const warmPtr = (codePtr + largest + 7) & ~7;
+      ensureMemory(exports, warmPtr + STATS_BYTES);
+      exports.lifter_bench(codePtr, section.code.length, entry, arch, irPtr, maxInstructions, 1, warmPtr);
+      exports.lifter_bench_peaks(
+        codePtr, section.code.length, entry, arch, irPtr, maxInstructions, blocksPtr, maxBlocks, streamPtr, streamBytes, statsPtr
+      );
+
+      const start = performance.now();
+      exports.lifter_bench(codePtr, section.code.length, entry, arch, irPtr, maxInstructions, iterations, statsPtr);
+      seconds += (performance.now() - start) / 1000;
+    }
+
+    const view = new DataView(exports.memory.buffer, statsPtr, STATS_BYTES);
+    const bytes = Number(view.getBigUint64(0, true));
+    const instructions = Number(view.getBigUint64(8, true));
+    const unknown = Number(view.getBigUint64(16, true));
+    const functions = view.getUint32(28, true);
+
+    results.push({
+      arch,
+      sections: sections.length,
+      bytes: bytes / iterations,
+      instructions: instructions / iterations,
+      instructionsPerSecond: seconds > 0 ? instructions / seconds : 0,
+      bytesPerSecond: seconds > 0 ? bytes / seconds : 0,
+      unknownRate: instructions ? unknown / instructions : 0,
+      functions,
+      cfgPeakRecords: view.getUint32(32, true),
+      cfgPeakBlocks: view.getUint32(36, true),
+      streamPeakRecords: view.getUint32(40, true),
+      tsInstructionsPerSecond: compareTs ? benchmarkTsDecoder(sections, iterations) : null,
+    });
+  }
+
+  console.table(
+    results.map((r) => ({
+      arch: NativeArch[r.arch],
+      sections: r.sections,
+      'Minstr/s': (r.instructionsPerSecond / 1e6).toFixed(2),
+      'MB/s': (r.bytesPerSecond / (1 << 20)).toFixed(2),
+      unknown: `${(r.unknownRate * 100).toFixed(3)}%`,
+      'cfg records': r.cfgPeakRecords,
+      'cfg blocks': r.cfgPeakBlocks,
+      'stream drain': r.streamPeakRecords,
+      'TS Minstr/s': r.tsInstructionsPerSecond === null ? '-' : (r.tsInstructionsPerSecond / 1e6).toFixed(2),
+    }))
+  );
+  return results;
+}
@@ -2,12 +2,15 @@
  * Instruction Lifter - Lifts machine code to Platform-Agnostic IR
  */
 
+// Numeric values mirror `enum class IROpcode` in cpp/lifter.h
 export enum IROpcode {
   ADD = 0, SUB, MUL, DIV, AND, OR, XOR, SHL, SHR,
+  SAR, ROL, ROR, ADC, SBB, NEG, NOT, INC, DEC, CMP, TEST,
+  MOV, MOVZX, MOVSX, LEA, XCHG, CMOV, SETCC,
   LOAD, STORE, PUSH, POP,
-  JMP, JE, JNE, CALL, RET,
-  V_ADD, V_SUB, V_MUL,
-  SYSCALL, UNKNOWN
+  JMP, JE, JNE, JCC, CALL, RET,
+  V_ADD, V_SUB, V_MUL, V_DIV, V_AND, V_OR, V_XOR, V_MOV, V_CMP,
+  SYSCALL, NOP, TRAP, UNKNOWN
 }
 
 export interface IRInstruction {
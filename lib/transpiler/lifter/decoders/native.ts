@@ -0,0 +1,169 @@
+/**
+ * Native Decoder - Runs the WASM lifter (cpp/lifter.cpp) behind the Decoder
+ * interface, falling back to a TypeScript decoder when the module is not loaded.
+ */
+
+import { Decoder, BasicBlock, IRInstruction, IROperand } from '../types';
+import { IROpcode } from '../../lifter';
+import {
+    IRAttr,
+    NativeArch,
+    NativeIRInstruction,
+    OperandKind,
+    isNativeLifterReady,
+    liftCfgNative,
+    liftNativeView,
+    operandKind,
+} from '../../native-lifter';
+import type { LiftCacheImage } from '../../lift-cache';
+
+const MAX_BLOCK_INSTRUCTIONS = 100;
+const FUNCTION_LIFT = { maxInstructions: 65536, maxBlocks: 8192, optimize: true };
+const MAX_INSTRUCTION_BYTES = 15;
+const SLOTS: Array<'op1' | 'op2' | 'op3'> = ['op1', 'op2', 'op3'];
+
+export class NativeDecoder implements Decoder {
+    constructor(readonly arch: NativeArch, private readonly fallback: Decoder) {}
+
+    decode(buffer: Uint8Array, offset: number, addr: number): BasicBlock {
+        if (!isNativeLifterReady()) {
+            return this.fallback.decode(buffer, offset, addr);
+        }
+
+        const window = buffer.subarray(offset, offset + MAX_BLOCK_INSTRUCTIONS * MAX_INSTRUCTION_BYTES);
+        const view = liftNativeView(window, addr, this.arch, MAX_BLOCK_INSTRUCTIONS);
+        if (!view) {
+            return this.fallback.decode(buffer, offset, addr);
+        }
+
+        const instructions: IRInstruction[] = [];
+        let endAddr = addr;
+        let successors: number[] = [];
+
+        for (let i = 0; i < view.count; i++) {
+            const info = view.info[i];
+            const ir = this.makeIR(instructions.length, view.opcodes[i], view.address(i), view.sizes[i], info);
+            for (const slot of [0, 1, 2] as const) {
+                const kind = operandKind(info, slot);
+                if (kind === OperandKind.NONE) continue;
+                const index = view.operandIndex(i, slot);
+                ir[SLOTS[slot]] = kind === OperandKind.MEM
+                    ? { type: 'mem', value: memHex(view.operandPool[index + 1], view.operandPool[index]) }
+                    : { type: kind === OperandKind.REG ? 'reg' : 'imm', value: view.operandValue(i, slot) };
+            }
+            instructions.push(ir);
+            endAddr = view.address(i) + view.sizes[i];
+
+            const direct = operandKind(info, 0) === OperandKind.IMM;
+            const terminator = this.successorsOf(view.opcodes[i], direct, view.operandValue(i, 0), endAddr);
+            if (terminator) {
+                successors = terminator;
+                break;
+            }
+            successors = [endAddr];
+        }
+
+        return { id: addr, startAddr: addr, endAddr, instructions, successors };
+    }
+
+    /**
+     * Lift the whole function at `entryPoint` in one native call (code[0] at
+     * address 0), with the native peephole pass applied. Returns null when
+     * the native lifter cannot be used, in which case callers walk blocks
+     * through decode(). With a `cache` opened over `binary`, an unchanged
+     * function is not lifted again.
+     */
+    liftFunction(binary: Uint8Array, entryPoint: number, cache: LiftCacheImage | null = null): BasicBlock[] | null {
+        if (!isNativeLifterReady()) return null;
+        const { maxInstructions, maxBlocks, optimize } = FUNCTION_LIFT;
+        const cfg = cache?.lookup(entryPoint, FUNCTION_LIFT)
+            ?? liftCfgNative(binary, 0, entryPoint, this.arch, maxInstructions, maxBlocks, optimize);
+        if (!cfg || cfg.blocks.length === 0) return null;
+        if (!cfg.fromCache) cache?.store(entryPoint, FUNCTION_LIFT, cfg);
+
+        return cfg.blocks.map((block) => {
+            const instructions: IRInstruction[] = [];
+            for (let i = 0; i < block.irCount; i++) {
+                instructions.push(this.toIR(cfg.instructions[block.firstIr + i], i));
+            }
+            return {
+                id: block.start,
+                startAddr: block.start,
+                endAddr: block.end,
+                instructions,
+                successors: block.successors.map((succ) => cfg.blocks[succ].start),
+            };
+        });
+    }
+
+    /**
+     * Successors if an instruction with this opcode ends a block, otherwise null
+     */
+    private successorsOf(opcode: IROpcode, direct: boolean, target: number, next: number): number[] | null {
+        switch (opcode) {
+            case IROpcode.JMP:
+                return direct ? [target] : [];
+            case IROpcode.JE:
+            case IROpcode.JNE:
+            case IROpcode.JCC:
+                return direct ? [next, target] : [next];
+            case IROpcode.RET:
+            case IROpcode.TRAP:
+            case IROpcode.UNKNOWN:
+                return [];
+            default:
+                return null;
+        }
+    }
+
+    private makeIR(id: number, opcode: IROpcode, addr: number, size: number, info: number, attr = 0): IRInstruction {
+        return {
+            id,
+            opcode: IROpcode[opcode].toLowerCase(),
+            addr,
+            meta: { size, width: 8 << (info >> 6), flagsDead: (attr & IRAttr.FLAGS_DEAD) !== 0 },
+        };
+    }
+
+    private toIR(native: NativeIRInstruction, id: number): IRInstruction {
+        const operands = [native.op1, native.op2, native.op3];
+        const ir = this.makeIR(id, native.opcode, native.address, native.size, native.info, native.attr);
+        SLOTS.forEach((slot, i) => {
+            const operand = this.toOperand(operandKind(native.info, i as 0 | 1 | 2), operands[i]);
+            if (operand) ir[slot] = operand;
+        });
+        return ir;
+    }
+
+    private toOperand(kind: OperandKind, value: bigint): IROperand | null {
+        switch (kind) {
+            case OperandKind.REG:
+                return { type: 'reg', value: Number(value) };
+            case OperandKind.IMM:
+                return { type: 'imm', value: Number(BigInt.asIntN(64, value)) };
+            case OperandKind.MEM:
+                return { type: 'mem', value: `0x${value.toString(16)}` };
+            default:
+                return null;
+        }
+    }
+}
+
+/**
+ * Fallback for an architecture with no TypeScript decoder: each block is one
+ * UNKNOWN instruction with no successors, so the code traps rather than being
+ * lifted by a decoder for another instruction set
+ */
+export class TrapDecoder implements Decoder {
+    constructor(private readonly instructionSize: number) {}
+
+    decode(_buffer: Uint8Array, _offset: number, addr: number): BasicBlock {
+        const endAddr = addr + this.instructionSize;
+        const trap: IRInstruction = { id: 0, opcode: 'unknown', addr, meta: { size: this.instructionSize } };
+        return { id: addr, startAddr: addr, endAddr, instructions: [trap], successors: [] };
+    }
+}
+
+function memHex(high: number, low: number): string {
+    return high ? `0x${high.toString(16)}${low.toString(16).padStart(8, '0')}` : `0x${low.toString(16)}`;
+}
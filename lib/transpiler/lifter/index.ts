@@ -4,3 +4,4 @@ export * from './types';
 export * from './decoders/x86';
 export * from './decoders/arm';
 
+export * from './decoders/native';
@@ -1,6 +1,9 @@
 import { Arch, FunctionIR, BasicBlock, Decoder } from './types';
-import { X86Decoder } from './decoders/x86';
 import { ARMDecoder } from './decoders/arm';
+import { X86DecoderFull } from './decoders/x86-full';
+import { NativeDecoder, TrapDecoder } from './decoders/native';
+import { NativeArch, initNativeLifter, isNativeLifterReady } from '../native-lifter';
+import { liftCache } from '../lift-cache';
 
 // Re-export IROpcode for convenience if it were an enum, but it's not defined here.
 // However, to fix the import error in wasm_compiler.ts, we should export it if it exists.
@@ -12,8 +15,13 @@ export class FreestandingLifter {
     private decoders: Map<Arch, Decoder> = new Map();
     
     constructor() {
-        this.decoders.set(Arch.X86, new X86Decoder());
+        // x86 runs on the WASM lifter when available, the TS decoder otherwise
+        const x86Fallback = new X86DecoderFull();
+        this.decoders.set(Arch.X86, new NativeDecoder(NativeArch.X86, x86Fallback));
+        this.decoders.set(Arch.X64, new NativeDecoder(NativeArch.X86_64, x86Fallback));
         this.decoders.set(Arch.ARM, new ARMDecoder());
+        // No TypeScript AArch64 decoder: without the WASM lifter, ARM64 code traps
+        this.decoders.set(Arch.ARM64, new NativeDecoder(NativeArch.ARM64, new TrapDecoder(4)));
     }
 
     /**
@@ -22,10 +30,30 @@ export class FreestandingLifter {
     async lift(binary: Uint8Array, arch: Arch, entryPoint: number): Promise<FunctionIR> {
         const decoder = this.decoders.get(arch);
         if (!decoder) throw new Error(`Unsupported architecture: ${arch}`);
+        await initNativeLifter();
 
         console.log(`Lifter: Starting lift for ${arch} at 0x${entryPoint.toString(16)}`);
 
         const blocks = new Map<number, BasicBlock>();
+
+        // The native lifter discovers the whole CFG in a single call, unless
+        // the cache still holds this function's lift for the same bytes
+        let native: BasicBlock[] | null = null;
+        if (decoder instanceof NativeDecoder && isNativeLifterReady()) {
+            const cache = await liftCache.openImage(binary, 0, decoder.arch);
+            native = decoder.liftFunction(binary, entryPoint, cache);
+            void cache.persist();
+        }
+        if (native) {
+            for (const block of native) blocks.set(block.id, block);
+            return {
+                name: `func_${entryPoint.toString(16)}`,
+                entryBlock: entryPoint,
+                blocks,
+                signature: 'void()'
+            };
+        }
+
         const queue = [entryPoint];
         const visited = new Set<number>();
 
@@ -2,6 +2,7 @@ export enum Arch {
     X86 = 'x86',
     X64 = 'x64',
     ARM = 'arm',
+    ARM64 = 'arm64',
     THUMB = 'thumb',
     RISCV = 'riscv',
     MIPS = 'mips',
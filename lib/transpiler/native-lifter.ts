@@ -0,0 +1,946 @@
+/**
+ * Native Lifter - Binding for the freestanding C++ lifter (cpp/lifter.cpp)
+ * Loaded from /wasm/lifter(-simd).wasm (see loadNativeWasmModule); callers
+ * fall back to the TypeScript decoders when the module is unavailable.
+ */
+
+import { nativeCounters, NativeCounters, readNativeCounters } from '../performance/native-counters';
+import { loadNativeAndInstantiate } from '../wasm/loader';
+import { getSharedLinearMemory, SharedSlice } from '../wasm/shared-memory';
+import { IROpcode } from './lifter';
+import type { LiftCacheImage } from './lift-cache';
+
+// Matches `enum class Arch` in cpp/lifter.h
+export enum NativeArch {
+  X86 = 0,
+  ARM64 = 1,
+  RISCV = 2,
+  X86_64 = 3,
+}
+
+// Matches `enum OperandKind` in cpp/lifter.h
+export enum OperandKind {
+  NONE = 0,
+  REG = 1,
+  IMM = 2,
+  MEM = 3,
+}
+
+// Matches `enum IRAttr` in cpp/lifter.h
+export enum IRAttr {
+  FLAGS_DEAD = 1 << 0,
+  REMOVED = 1 << 1,
+  SETS_FLAGS = 1 << 2, // ARM64 ADDS/SUBS/ANDS/...
+  SIGNED = 1 << 3, // LDRS*, SMULL, CSETM
+  WIDE = 1 << 4, // 64-bit result of narrower operands
+}
+
+// Matches `enum IRBlockFlags` in cpp/lifter.h
+export enum BlockFlags {
+  LIFTED = 1 << 0,
+  RET = 1 << 1,
+  INDIRECT = 1 << 2,
+  TRAP = 1 << 3,
+  EXTERNAL = 1 << 4,
+  TRUNCATED = 1 << 5,
+}
+
+// Matches `enum WasmFlagKind` in cpp/wasm_emitter.h
+export enum GuestFlagKind {
+  NONE = 0,
+  SUB = 1,
+  ADD = 2,
+  LOGIC = 3,
+  RESULT = 4,
+  UNKNOWN = 5,
+  KEEP_CF = 6,
+}
+
+// struct WasmGuestState: gpr[32] (u64), flag kind/width (u32), flag a/b/result (u64)
+export const GUEST_STATE_BYTES = 288;
+export const GUEST_STATE_FLAGS = 256;
+
+// sizeof(IRInstruction) and sizeof(IRBlock) on wasm32
+export const NATIVE_IR_STRIDE = 48;
+export const NATIVE_BLOCK_STRIDE = 40;
+export const BLOCK_NONE = 0xffffffff;
+
+export interface NativeIRInstruction {
+  opcode: IROpcode;
+  address: number;
+  size: number;
+  info: number; // Operand kinds (2 bits each) + width code (bits 6-7)
+  attr: number; // IRAttr bits from the decoder and the peephole pass
+  op1: bigint;
+  op2: bigint;
+  op3: bigint;
+}
+
+export interface NativeBlock {
+  start: number;
+  end: number;
+  firstIr: number;
+  irCount: number;
+  successors: number[]; // Block indices; fallthrough first for conditional branches
+  flags: number;
+}
+
+export interface NativeCFG {
+  blocks: NativeBlock[];
+  // Indexed through each block's firstIr/irCount; optimized lifts leave
+  // unused records between blocks
+  instructions: NativeIRInstruction[];
+  fromCache?: boolean; // Served by a LiftCache instead of lifted
+}
+
+interface LifterExports {
+  memory: WebAssembly.Memory;
+  __heap_base?: WebAssembly.Global;
+  lifter_attach_arena?(arena: number): number;
+  lifter_alloc?(size: number): number;
+  lifter_free?(ptr: number): void;
+  get_counters?(reset: number): number;
+  lift_code_multi_arch(
+    code: number,
+    length: number,
+    entryPoint: bigint,
+    archId: number,
+    outIr: number,
+    maxOut: number
+  ): number;
+  lift_basic_block(
+    code: number,
+    length: number,
+    entryPoint: bigint,
+    archId: number,
+    outIr: number,
+    maxOut: number
+  ): number;
+  lift_code_soa(
+    code: number,
+    length: number,
+    entryPoint: bigint,
+    archId: number,
+    out: number,
+    maxOut: number,
+    poolWords: number
+  ): number;
+  lifter_stream_bytes(capacity: number): number;
+  lifter_stream_create(mem: number, bytes: number, entryPoint: bigint, archId: number): number;
+  lifter_stream_feed(stream: number, code: number, length: number): number;
+  lifter_stream_drain(stream: number, outIr: number, maxOut: number): number;
+  lifter_stream_finish(stream: number): number;
+  lifter_stream_pc(stream: number): bigint;
+  lifter_stream_pending(stream: number): number;
+  lifter_stream_destroy(stream: number): void;
+  lift_cfg(
+    code: number,
+    length: number,
+    baseAddress: bigint,
+    entryPoint: bigint,
+    archId: number,
+    outIr: number,
+    maxOut: number,
+    outBlocks: number,
+    maxBlocks: number,
+    outIrCount: number
+  ): number;
+  optimize_cfg?(ir: number, blocks: number, blockCount: number, archId: number): void;
+  optimize_ir?(ir: number, count: number, archId: number): number;
+  emit_wasm_module?(
+    ir: number,
+    count: number,
+    archId: number,
+    guestBase: number,
+    sharedMemory: number,
+    dirtyMap: number,
+    dirtyPages: number,
+    out: number,
+    capacity: number
+  ): number;
+  lift_and_emit?(
+    code: number,
+    length: number,
+    entryPoint: bigint,
+    archId: number,
+    guestBase: number,
+    sharedMemory: number,
+    dirtyMap: number,
+    dirtyPages: number,
+    irScratch: number,
+    maxIr: number,
+    out: number,
+    capacity: number
+  ): number;
+}
+
+let lifterExports: LifterExports | null = null;
+let initPromise: Promise<boolean> | null = null;
+
+/**
+ * Load the native lifter module (safe to call repeatedly)
+ */
+export function initNativeLifter(): Promise<boolean> {
+  if (!initPromise) {
+    initPromise = (async () => {
+      try {
+        const shared = getSharedLinearMemory();
+        const exports = await loadNativeAndInstantiate('lifter', shared.imports('NativeLifter'));
+        if (exports && typeof exports.lift_code_multi_arch === 'function') {
+          lifterExports = exports as LifterExports;
+          if (lifterExports.lifter_attach_arena && lifterExports.lifter_alloc && lifterExports.lifter_free) {
+            shared.attach('lifter', lifterExports.memory, lifterExports.lifter_attach_arena, {
+              alloc: lifterExports.lifter_alloc,
+              free: lifterExports.lifter_free,
+            });
+          }
+          nativeCounters.register('lift', getNativeLifterCounters);
+          return true;
+        }
+      } catch {
+        // Expected when the native build has not been produced
+      }
+      console.log('[NativeLifter] Using TypeScript decoders (WASM not available)');
+      return false;
+    })();
+  }
+  return initPromise;
+}
+
+export function isNativeLifterReady(): boolean {
+  return lifterExports !== null;
+}
+
+/**
+ * Per-opcode-class instruction counts, UNKNOWN fallbacks and bytes lifted
+ * since the last reset (lib/performance/native-counters.ts), or null
+ * before the module is loaded
+ */
+export function getNativeLifterCounters(reset = false): NativeCounters | null {
+  return lifterExports ? readNativeCounters(lifterExports, lifterExports.memory, reset) : null;
+}
+
+export function operandKind(info: number, slot: 0 | 1 | 2): OperandKind {
+  return (info >> (slot * 2)) & 3;
+}
+
+// Builds with lifter_alloc take every region from the native heap (the
+// shared arena when attached): long-lived regions get their own block, and
+// per-call scratch reuses one block, replaced when a call needs more.
+// Older builds stack the long-lived regions above the heap base, with the
+// scratch area where they end.
+const reservations: Array<{ ptr: number; end: number; live: boolean }> = [];
+let scratchBlock = { ptr: 0, bytes: 0 };
+
+function heapBase(exports: LifterExports): number {
+  return exports.__heap_base ? Number(exports.__heap_base.value) : 65536;
+}
+
+function ensureMemory(exports: LifterExports, end: number) {
+  const needed = end - exports.memory.buffer.byteLength;
+  if (needed > 0) {
+    exports.memory.grow(Math.ceil(needed / 65536));
+  }
+}
+
+function reservedTop(exports: LifterExports): number {
+  return reservations.length ? reservations[reservations.length - 1].end : heapBase(exports);
+}
+
+function heapAlloc(exports: LifterExports, bytes: number): number {
+  const ptr = exports.lifter_alloc!(Math.max(bytes, 1));
+  if (!ptr) throw new Error(`Native lifter: cannot allocate ${bytes} bytes`);
+  return ptr;
+}
+
+/**
+ * Reserve `bytes` of scratch space, growing memory as needed. Valid until
+ * the next call.
+ */
+function scratch(exports: LifterExports, bytes: number): number {
+  if (exports.lifter_alloc) {
+    if (scratchBlock.bytes < bytes) {
+      exports.lifter_free!(scratchBlock.ptr);
+      // Cleared first, so a failed allocation leaves no freed block behind
+      scratchBlock = { ptr: 0, bytes: 0 };
+      scratchBlock = { ptr: heapAlloc(exports, bytes), bytes };
+    }
+    return scratchBlock.ptr;
+  }
+  const base = (reservedTop(exports) + 7) & ~7;
+  ensureMemory(exports, base + bytes);
+  return base;
+}
+
+function reserve(exports: LifterExports, bytes: number): number {
+  if (exports.lifter_alloc) return heapAlloc(exports, bytes);
+  const ptr = (reservedTop(exports) + 7) & ~7;
+  ensureMemory(exports, ptr + bytes);
+  reservations.push({ ptr, end: ptr + bytes, live: true });
+  return ptr;
+}
+
+// Stacked regions are reclaimed once every region above them is released too
+function release(exports: LifterExports, ptr: number) {
+  if (exports.lifter_free) {
+    exports.lifter_free(ptr);
+    return;
+  }
+  const region = reservations.find((r) => r.ptr === ptr);
+  if (region) region.live = false;
+  while (reservations.length && !reservations[reservations.length - 1].live) {
+    reservations.pop();
+  }
+}
+
+/**
+ * Lift `code` linearly from `entryPoint`. Returns null when the native
+ * module is not loaded.
+ */
+export function liftNative(
+  code: Uint8Array,
+  entryPoint: number,
+  arch: NativeArch,
+  maxInstructions: number = code.length
+): NativeIRInstruction[] | null {
+  const exports = lifterExports;
+  if (!exports) return null;
+
+  const codeBytes = (code.length + 7) & ~7;
+  const codePtr = scratch(exports, codeBytes + maxInstructions * NATIVE_IR_STRIDE);
+  const irPtr = codePtr + codeBytes;
+  new Uint8Array(exports.memory.buffer).set(code, codePtr);
+
+  const count = exports.lift_code_multi_arch(
+    codePtr,
+    code.length,
+    BigInt(entryPoint),
+    arch,
+    irPtr,
+    maxInstructions
+  );
+
+  return readInstructions(exports, irPtr, count);
+}
+
+/**
+ * Struct-of-arrays view over WASM memory written by lift_code_soa (layout in
+ * cpp/lifter.h). The arrays alias module memory, so a view is only valid
+ * until the next native lift call.
+ */
+export class NativeIRView {
+  readonly opcodes: Uint8Array;
+  readonly sizes: Uint8Array;
+  readonly info: Uint8Array;
+  readonly addresses: Uint32Array; // Relative to entryPoint
+  readonly operandOffsets: Uint32Array;
+  readonly operandPool: Uint32Array;
+
+  constructor(
+    buffer: ArrayBuffer,
+    base: number,
+    maxInstructions: number,
+    poolWords: number,
+    readonly count: number,
+    readonly entryPoint: number
+  ) {
+    this.opcodes = new Uint8Array(buffer, base, count);
+    this.sizes = new Uint8Array(buffer, base + maxInstructions, count);
+    this.info = new Uint8Array(buffer, base + 2 * maxInstructions, count);
+    const words = base + ((3 * maxInstructions + 3) & ~3);
+    this.addresses = new Uint32Array(buffer, words, count);
+    this.operandOffsets = new Uint32Array(buffer, words + 4 * maxInstructions, count + 1);
+    this.operandPool = new Uint32Array(buffer, words + 8 * maxInstructions + 4, poolWords);
+  }
+
+  address(i: number): number {
+    return this.entryPoint + this.addresses[i];
+  }
+
+  /**
+   * Pool index of operand `slot` of instruction `i`, or -1 when absent
+   */
+  operandIndex(i: number, slot: 0 | 1 | 2): number {
+    const info = this.info[i];
+    if (operandKind(info, slot) === OperandKind.NONE) return -1;
+    let index = this.operandOffsets[i];
+    for (let s = 0; s < slot; s++) index += operandWords(operandKind(info, s as 0 | 1));
+    return index;
+  }
+
+  /**
+   * REG id or sign-extended IMM of operand `slot` (MEM operands: use operandPool)
+   */
+  operandValue(i: number, slot: 0 | 1 | 2): number {
+    const index = this.operandIndex(i, slot);
+    if (index < 0) return 0;
+    if (operandKind(this.info[i], slot) === OperandKind.REG) return this.operandPool[index];
+    return (this.operandPool[index + 1] | 0) * 0x100000000 + this.operandPool[index];
+  }
+}
+
+export function operandWords(kind: OperandKind): number {
+  return kind === OperandKind.NONE ? 0 : kind === OperandKind.REG ? 1 : 2;
+}
+
+/**
+ * Lift `code` linearly from `entryPoint` into parallel typed arrays, with no
+ * per-instruction allocation. Returns null when the native module (or this
+ * export) is not loaded.
+ */
+export function liftNativeView(
+  code: Uint8Array,
+  entryPoint: number,
+  arch: NativeArch,
+  maxInstructions: number = code.length,
+  poolWords: number = maxInstructions * 4
+): NativeIRView | null {
+  const exports = lifterExports;
+  if (!exports || typeof exports.lift_code_soa !== 'function') return null;
+
+  const codeBytes = (code.length + 7) & ~7;
+  const soaBytes = ((3 * maxInstructions + 3) & ~3) + 4 * (2 * maxInstructions + 1 + poolWords);
+  const codePtr = scratch(exports, codeBytes + soaBytes);
+  const soaPtr = codePtr + codeBytes;
+  new Uint8Array(exports.memory.buffer).set(code, codePtr);
+
+  const count = exports.lift_code_soa(
+    codePtr,
+    code.length,
+    BigInt(entryPoint),
+    arch,
+    soaPtr,
+    maxInstructions,
+    poolWords
+  );
+  return new NativeIRView(exports.memory.buffer, soaPtr, maxInstructions, poolWords, count, entryPoint);
+}
+
+/**
+ * Recursive-descent lift of the function at `entryPoint`, with `code[0]` at
+ * guest address `baseAddress`. Blocks and their IR come back in one call.
+ * Returns null when the native module (or this export) is not loaded.
+ */
+export function liftCfgNative(
+  code: Uint8Array,
+  baseAddress: number,
+  entryPoint: number,
+  arch: NativeArch,
+  maxInstructions: number = 65536,
+  maxBlocks: number = 8192,
+  optimize: boolean = false
+): NativeCFG | null {
+  const exports = lifterExports;
+  if (!exports || typeof exports.lift_cfg !== 'function') return null;
+
+  const codeBytes = (code.length + 7) & ~7;
+  const codePtr = scratch(exports, codeBytes + cfgScratchBytes(maxInstructions, maxBlocks));
+  new Uint8Array(exports.memory.buffer).set(code, codePtr);
+  return runCfg(
+    exports, codePtr, code.length, codePtr + codeBytes, baseAddress, entryPoint, arch, maxInstructions, maxBlocks, optimize
+  );
+}
+
+/**
+ * A code image kept resident in the lifter's memory, so that lifting many
+ * functions from one image copies the bytes once
+ */
+export class NativeImage {
+  private constructor(
+    private readonly exports: LifterExports,
+    private ptr: number,
+    readonly length: number,
+    readonly baseAddress: number,
+    readonly arch: NativeArch,
+    private readonly owned: boolean = true
+  ) {}
+
+  /**
+   * Returns null when the native module (or lift_cfg) is not loaded
+   */
+  static load(code: Uint8Array, baseAddress: number, arch: NativeArch): NativeImage | null {
+    const exports = lifterExports;
+    if (!exports || typeof exports.lift_cfg !== 'function') return null;
+    const ptr = reserve(exports, code.length);
+    new Uint8Array(exports.memory.buffer).set(code, ptr);
+    return new NativeImage(exports, ptr, code.length, baseAddress, arch);
+  }
+
+  /**
+   * An image over bytes already in the shared memory (e.g. a block the
+   * neural codec decompressed into it), lifted in place with no copy. The
+   * slice stays the caller's: release() only detaches the image. Returns
+   * null unless the loaded lifter is on the shared memory.
+   */
+  static fromShared(slice: SharedSlice, baseAddress: number, arch: NativeArch): NativeImage | null {
+    const exports = lifterExports;
+    if (!exports || typeof exports.lift_cfg !== 'function') return null;
+    if (!getSharedLinearMemory().has('lifter')) return null;
+    return new NativeImage(exports, slice.ptr, slice.len, baseAddress, arch, false);
+  }
+
+  /**
+   * CFG of the function at `entryPoint`. With a `cache` opened over this
+   * image's bytes, a function whose bytes are unchanged since it was cached
+   * is not lifted again, and a fresh lift is added to it.
+   */
+  liftFunction(
+    entryPoint: number,
+    maxInstructions: number = 65536,
+    maxBlocks: number = 8192,
+    optimize: boolean = false,
+    cache: LiftCacheImage | null = null
+  ): NativeCFG {
+    if (!this.ptr) throw new Error('NativeImage used after release()');
+    if (cache && (cache.arch !== this.arch || cache.baseAddress !== this.baseAddress || cache.length !== this.length)) {
+      throw new Error('LiftCacheImage was opened over a different image');
+    }
+    const options = { maxInstructions, maxBlocks, optimize };
+    const cached = cache?.lookup(entryPoint, options);
+    if (cached) return cached;
+
+    const out = scratch(this.exports, cfgScratchBytes(maxInstructions, maxBlocks));
+    const cfg = runCfg(
+      this.exports, this.ptr, this.length, out, this.baseAddress, entryPoint, this.arch, maxInstructions, maxBlocks, optimize
+    );
+    cache?.store(entryPoint, options, cfg);
+    return cfg;
+  }
+
+  // The image bytes, re-viewed per call since the memory may have grown
+  private bytes(): Uint8Array {
+    return new Uint8Array(this.exports.memory.buffer, this.ptr, this.length);
+  }
+
+  /**
+   * Raw IR records (NATIVE_IR_STRIDE bytes each) of the basic block at
+   * `entryPoint`, from lift_basic_block: cut after the first branch, call,
+   * return, trap or system call, as lift_and_emit would lift it. A view of
+   * lifter memory, valid until the next lifter call; empty when nothing
+   * decodes there.
+   */
+  liftBlockRecords(entryPoint: number, maxInstructions: number = 256): Uint8Array {
+    if (!this.ptr) throw new Error('NativeImage used after release()');
+    const irPtr = scratch(this.exports, maxInstructions * NATIVE_IR_STRIDE);
+    const offset = entryPoint - this.baseAddress;
+    if (offset < 0 || offset >= this.length) return new Uint8Array(this.exports.memory.buffer, irPtr, 0);
+    const count = this.exports.lift_basic_block(
+      this.ptr + offset,
+      this.length - offset,
+      BigInt(entryPoint),
+      this.arch,
+      irPtr,
+      maxInstructions
+    );
+    return new Uint8Array(this.exports.memory.buffer, irPtr, count * NATIVE_IR_STRIDE);
+  }
+
+  /**
+   * liftBlockRecords for a hot block: lifts the CFG reachable from
+   * `entryPoint` and runs the CFG-wide peephole pass (optimize_cfg), so
+   * flag results no successor reads are dropped, then returns the entry
+   * block's records. The block may end earlier than liftBlockRecords' when
+   * a branch targets its middle. Empty when nothing decodes.
+   */
+  liftOptimizedBlockRecords(entryPoint: number, maxInstructions: number = 4096, maxBlocks: number = 512): Uint8Array {
+    if (!this.ptr) throw new Error('NativeImage used after release()');
+    if (typeof this.exports.optimize_cfg !== 'function') return this.liftBlockRecords(entryPoint);
+    const irPtr = scratch(this.exports, cfgScratchBytes(maxInstructions, maxBlocks));
+    const blockPtr = irPtr + maxInstructions * NATIVE_IR_STRIDE;
+    const blockCount = this.exports.lift_cfg(
+      this.ptr,
+      this.length,
+      BigInt(this.baseAddress),
+      BigInt(entryPoint),
+      this.arch,
+      irPtr,
+      maxInstructions,
+      blockPtr,
+      maxBlocks,
+      blockPtr + maxBlocks * NATIVE_BLOCK_STRIDE
+    );
+    this.exports.optimize_cfg(irPtr, blockPtr, blockCount, this.arch);
+
+    const view = new DataView(this.exports.memory.buffer);
+    for (let i = 0; i < blockCount; i++) {
+      const p = blockPtr + i * NATIVE_BLOCK_STRIDE;
+      if (Number(view.getBigUint64(p, true)) !== entryPoint) continue;
+      const first = irPtr + view.getUint32(p + 16, true) * NATIVE_IR_STRIDE;
+      return new Uint8Array(this.exports.memory.buffer, first, view.getUint32(p + 20, true) * NATIVE_IR_STRIDE);
+    }
+    return new Uint8Array(0);
+  }
+
+  release() {
+    if (!this.ptr) return;
+    if (this.owned) release(this.exports, this.ptr);
+    this.ptr = 0;
+  }
+}
+
+function cfgScratchBytes(maxInstructions: number, maxBlocks: number): number {
+  return maxInstructions * NATIVE_IR_STRIDE + maxBlocks * NATIVE_BLOCK_STRIDE + 8;
+}
+
+// Run lift_cfg over code already in module memory, with the IR, block table
+// and IR count laid out from `outPtr`. With `optimize`, the peephole pass
+// (cpp/peephole.h) runs before anything is read back.
+function runCfg(
+  exports: LifterExports,
+  codePtr: number,
+  length: number,
+  outPtr: number,
+  baseAddress: number,
+  entryPoint: number,
+  arch: NativeArch,
+  maxInstructions: number,
+  maxBlocks: number,
+  optimize: boolean
+): NativeCFG {
+  const irPtr = outPtr;
+  const blockPtr = irPtr + maxInstructions * NATIVE_IR_STRIDE;
+  const countPtr = blockPtr + maxBlocks * NATIVE_BLOCK_STRIDE;
+
+  const blockCount = exports.lift_cfg(
+    codePtr,
+    length,
+    BigInt(baseAddress),
+    BigInt(entryPoint),
+    arch,
+    irPtr,
+    maxInstructions,
+    blockPtr,
+    maxBlocks,
+    countPtr
+  );
+  if (optimize && typeof exports.optimize_cfg === 'function') {
+    exports.optimize_cfg(irPtr, blockPtr, blockCount, arch);
+  }
+
+  const view = new DataView(exports.memory.buffer);
+  return {
+    blocks: decodeBlockRecords(view, blockPtr, blockCount),
+    instructions: decodeIRRecords(view, irPtr, view.getUint32(countPtr, true)),
+  };
+}
+
+function readInstructions(exports: LifterExports, irPtr: number, count: number): NativeIRInstruction[] {
+  return decodeIRRecords(new DataView(exports.memory.buffer), irPtr, count);
+}
+
+/**
+ * `count` IRInstruction records (NATIVE_IR_STRIDE bytes each) at `offset`
+ */
+export function decodeIRRecords(view: DataView, offset: number, count: number): NativeIRInstruction[] {
+  const out: NativeIRInstruction[] = new Array(count);
+  for (let i = 0; i < count; i++) {
+    const p = offset + i * NATIVE_IR_STRIDE;
+    out[i] = {
+      opcode: view.getInt32(p, true),
+      address: Number(view.getBigUint64(p + 8, true)),
+      size: view.getUint8(p + 16),
+      info: view.getUint8(p + 17),
+      attr: view.getUint8(p + 18),
+      op1: view.getBigUint64(p + 24, true),
+      op2: view.getBigUint64(p + 32, true),
+      op3: view.getBigUint64(p + 40, true),
+    };
+  }
+  return out;
+}
+
+/**
+ * Writes `instructions` at `offset` in the layout decodeIRRecords reads
+ */
+export function encodeIRRecords(view: DataView, offset: number, instructions: NativeIRInstruction[]) {
+  instructions.forEach((instr, i) => {
+    const p = offset + i * NATIVE_IR_STRIDE;
+    view.setInt32(p, instr.opcode, true);
+    view.setBigUint64(p + 8, BigInt(instr.address), true);
+    view.setUint8(p + 16, instr.size);
+    view.setUint8(p + 17, instr.info);
+    view.setUint8(p + 18, instr.attr);
+    view.setBigUint64(p + 24, instr.op1, true);
+    view.setBigUint64(p + 32, instr.op2, true);
+    view.setBigUint64(p + 40, instr.op3, true);
+  });
+}
+
+/**
+ * `count` IRBlock records (NATIVE_BLOCK_STRIDE bytes each) at `offset`
+ */
+export function decodeBlockRecords(view: DataView, offset: number, count: number): NativeBlock[] {
+  const blocks: NativeBlock[] = new Array(count);
+  for (let i = 0; i < count; i++) {
+    const p = offset + i * NATIVE_BLOCK_STRIDE;
+    const successors: number[] = [];
+    for (const succ of [view.getUint32(p + 24, true), view.getUint32(p + 28, true)]) {
+      if (succ !== BLOCK_NONE) successors.push(succ);
+    }
+    blocks[i] = {
+      start: Number(view.getBigUint64(p, true)),
+      end: Number(view.getBigUint64(p + 8, true)),
+      firstIr: view.getUint32(p + 16, true),
+      irCount: view.getUint32(p + 20, true),
+      successors,
+      flags: view.getUint32(p + 32, true),
+    };
+  }
+  return blocks;
+}
+
+/**
+ * Writes `blocks` at `offset` in the layout decodeBlockRecords reads
+ */
+export function encodeBlockRecords(view: DataView, offset: number, blocks: NativeBlock[]) {
+  blocks.forEach((block, i) => {
+    const p = offset + i * NATIVE_BLOCK_STRIDE;
+    view.setBigUint64(p, BigInt(block.start), true);
+    view.setBigUint64(p + 8, BigInt(block.end), true);
+    view.setUint32(p + 16, block.firstIr, true);
+    view.setUint32(p + 20, block.irCount, true);
+    view.setUint32(p + 24, block.successors[0] ?? BLOCK_NONE, true);
+    view.setUint32(p + 28, block.successors[1] ?? BLOCK_NONE, true);
+    view.setUint32(p + 32, block.flags, true);
+    view.setUint32(p + 36, 0, true);
+  });
+}
+
+/**
+ * Resumable lift over a code section of any size. The native handle keeps
+ * the PC and any partial instruction between feeds, and decodes into a
+ * fixed ring, so memory stays bounded by the ring and chunk sizes.
+ */
+export class NativeLiftStream {
+  private handle = 0;
+  private region = 0;
+
+  private constructor(private readonly exports: LifterExports, readonly ringCapacity: number) {}
+
+  /**
+   * Returns null when the native module (or the stream exports) is not loaded
+   */
+  static create(entryPoint: number, arch: NativeArch, ringCapacity: number = 4096): NativeLiftStream | null {
+    const exports = lifterExports;
+    if (!exports || typeof exports.lifter_stream_create !== 'function') return null;
+
+    const stream = new NativeLiftStream(exports, ringCapacity);
+    const bytes = exports.lifter_stream_bytes(ringCapacity);
+    stream.region = reserve(exports, bytes);
+    stream.handle = exports.lifter_stream_create(stream.region, bytes, BigInt(entryPoint), arch);
+    if (!stream.handle) {
+      release(exports, stream.region);
+      return null;
+    }
+    return stream;
+  }
+
+  /**
+   * Decode from `chunk`, which continues the bytes fed so far. Returns the
+   * number of bytes consumed; the rest must be fed again after draining.
+   */
+  feed(chunk: Uint8Array): number {
+    const exports = this.requireOpen();
+    const ptr = scratch(exports, chunk.length);
+    new Uint8Array(exports.memory.buffer).set(chunk, ptr);
+    return exports.lifter_stream_feed(this.handle, ptr, chunk.length);
+  }
+
+  drain(maxInstructions: number = this.ringCapacity): NativeIRInstruction[] {
+    const exports = this.requireOpen();
+    const ptr = scratch(exports, maxInstructions * NATIVE_IR_STRIDE);
+    const count = exports.lifter_stream_drain(this.handle, ptr, maxInstructions);
+    return readInstructions(exports, ptr, count);
+  }
+
+  /**
+   * End of input: a partial instruction still held becomes one UNKNOWN
+   * record spanning its bytes. Returns the records added; 0 while bytes are
+   * pending means the ring is full and must be drained first.
+   */
+  finish(): number {
+    return this.requireOpen().lifter_stream_finish(this.handle);
+  }
+
+  /** Address of the first byte not yet covered by a lifted instruction */
+  get pc(): number {
+    return Number(this.requireOpen().lifter_stream_pc(this.handle));
+  }
+
+  /** Bytes held back as a partial instruction */
+  get pending(): number {
+    return this.requireOpen().lifter_stream_pending(this.handle);
+  }
+
+  destroy() {
+    if (!this.handle) return;
+    this.exports.lifter_stream_destroy(this.handle);
+    release(this.exports, this.region);
+    this.handle = 0;
+  }
+
+  private requireOpen(): LifterExports {
+    if (!this.handle) throw new Error('NativeLiftStream used after destroy()');
+    return this.exports;
+  }
+}
+
+/**
+ * Lift `code` in bounded chunks, yielding IR batches as the ring fills so a
+ * consumer (e.g. the WASM compiler) can work while lifting continues.
+ * A truncated instruction at the end of `code` arrives as a final UNKNOWN
+ * record. Yields nothing when the native lifter is unavailable.
+ */
+export async function* liftNativeStream(
+  code: Uint8Array,
+  entryPoint: number,
+  arch: NativeArch,
+  chunkBytes: number = 64 * 1024,
+  ringCapacity: number = 4096
+): AsyncGenerator<NativeIRInstruction[]> {
+  const stream = NativeLiftStream.create(entryPoint, arch, ringCapacity);
+  if (!stream) return;
+  try {
+    let offset = 0;
+    while (offset < code.length) {
+      const chunk = code.subarray(offset, Math.min(offset + chunkBytes, code.length));
+      offset += stream.feed(chunk);
+      const batch = stream.drain();
+      if (batch.length) yield batch;
+    }
+    if (stream.pending > 0) {
+      stream.finish();
+      yield stream.drain();
+    }
+  } finally {
+    stream.destroy();
+  }
+}
+
+/**
+ * Direct call targets in `cfg` that fall inside [baseAddress, baseAddress + length)
+ */
+export function directCallTargets(cfg: NativeCFG, baseAddress: number, length: number): number[] {
+  const targets: number[] = [];
+  for (const instr of cfg.instructions) {
+    if (instr.opcode !== IROpcode.CALL || operandKind(instr.info, 0) !== OperandKind.IMM) continue;
+    const target = Number(instr.op1);
+    if (target >= baseAddress && target < baseAddress + length) targets.push(target);
+  }
+  return targets;
+}
+
+export interface NativeBlockModuleOptions {
+  guestBase?: number; // Linear memory offset of guest address 0
+  sharedMemory?: boolean; // Import env.memory as a shared memory
+  dirtyMap?: number; // Linear offset of a dirtyPages-byte map stores mark their 4 KiB guest pages in
+  dirtyPages?: number; // Power of two; 0 (the default) emits no marking
+  maxInstructions?: number;
+  capacity?: number; // Output buffer bytes
+}
+
+/**
+ * Lift the basic block at `entryPoint` (`code[0]`) and translate it into a
+ * WASM module in one native call. The module imports env.memory and exports
+ * run(state: i32) -> i64, which executes the block against the guest state
+ * at `state` (GUEST_STATE_BYTES) and returns the next guest PC. Returns null
+ * when the native module (or this export) is unavailable or the first
+ * instruction cannot be translated.
+ */
+export function liftBlockToWasm(
+  code: Uint8Array,
+  entryPoint: number,
+  arch: NativeArch,
+  options: NativeBlockModuleOptions = {}
+): Uint8Array | null {
+  const exports = lifterExports;
+  if (!exports || typeof exports.lift_and_emit !== 'function') return null;
+
+  const {
+    guestBase = 0,
+    sharedMemory = false,
+    dirtyMap = 0,
+    dirtyPages = 0,
+    maxInstructions = 256,
+    capacity = 64 * 1024,
+  } = options;
+  const codeBytes = (code.length + 7) & ~7;
+  const irBytes = maxInstructions * NATIVE_IR_STRIDE;
+  const codePtr = scratch(exports, codeBytes + irBytes + capacity);
+  const irPtr = codePtr + codeBytes;
+  const outPtr = irPtr + irBytes;
+  new Uint8Array(exports.memory.buffer).set(code, codePtr);
+
+  const length = exports.lift_and_emit(
+    codePtr,
+    code.length,
+    BigInt(entryPoint),
+    arch,
+    guestBase,
+    sharedMemory ? 1 : 0,
+    dirtyMap,
+    dirtyPages,
+    irPtr,
+    maxInstructions,
+    outPtr,
+    capacity
+  );
+  if (length <= 0) return null;
+  // Copied into an ArrayBuffer of its own, as WebAssembly.compile expects
+  const bytes = new Uint8Array(length);
+  bytes.set(new Uint8Array(exports.memory.buffer, outPtr, length));
+  return bytes;
+}
+
+/**
+ * Peephole pass (optimize_ir) over the raw records of one block, e.g. from
+ * NativeImage.liftBlockRecords, copied out of lifter memory first (this
+ * call may grow it, detaching views). Returns a view of lifter memory holding the
+ * optimized records, valid until the next lifter call, or null when the
+ * module (or the export) is not loaded.
+ */
+export function optimizeNativeRecords(records: Uint8Array, arch: NativeArch): Uint8Array | null {
+  const exports = lifterExports;
+  if (!exports || typeof exports.optimize_ir !== 'function') return null;
+  const ptr = scratch(exports, records.length);
+  new Uint8Array(exports.memory.buffer).set(records, ptr);
+  const count = exports.optimize_ir(ptr, records.length / NATIVE_IR_STRIDE, arch);
+  return new Uint8Array(exports.memory.buffer, ptr, count * NATIVE_IR_STRIDE);
+}
+
+/**
+ * The block module of liftBlockToWasm, emitted (emit_wasm_module) from IR
+ * records that were lifted and optimized separately (held outside lifter
+ * memory, as for optimizeNativeRecords). Returns null when the
+ * module (or the export) is not loaded or the first instruction cannot be
+ * translated.
+ */
+export function emitNativeModule(
+  records: Uint8Array,
+  arch: NativeArch,
+  options: NativeBlockModuleOptions = {}
+): Uint8Array | null {
+  const exports = lifterExports;
+  if (!exports || typeof exports.emit_wasm_module !== 'function' || records.length === 0) return null;
+
+  const { guestBase = 0, sharedMemory = false, dirtyMap = 0, dirtyPages = 0, capacity = 64 * 1024 } = options;
+  const irPtr = scratch(exports, records.length + capacity);
+  const outPtr = irPtr + records.length;
+  new Uint8Array(exports.memory.buffer).set(records, irPtr);
+
+  const length = exports.emit_wasm_module(
+    irPtr,
+    records.length / NATIVE_IR_STRIDE,
+    arch,
+    guestBase,
+    sharedMemory ? 1 : 0,
+    dirtyMap,
+    dirtyPages,
+    outPtr,
+    capacity
+  );
+  if (length <= 0) return null;
+  const bytes = new Uint8Array(length);
+  bytes.set(new Uint8Array(exports.memory.buffer, outPtr, length));
+  return bytes;
+}
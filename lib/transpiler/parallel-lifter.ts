@@ -0,0 +1,243 @@
+/**
+ * Parallel Lifter - Lifts every function reachable from a set of entry points
+ * across a pool of lift workers sharing one SharedLiftQueue. Workers follow
+ * direct call targets as they go and steal from each other to balance
+ * uneven function sizes. Falls back to a single-threaded walk on the main
+ * thread when SharedArrayBuffer is unavailable (no cross-origin isolation).
+ * Functions whose bytes are unchanged since an earlier lift are served from
+ * the lift cache on either path instead of being lifted again.
+ */
+
+import type { LiftJob, LiftWorkerMessage, LiftedFunction } from '@/workers/lift-worker';
+import { SharedLiftQueue } from './lift-queue';
+import { DEFAULT_LIFT_OPTIONS, LiftCacheImage, liftCache } from './lift-cache';
+import { NativeArch, NativeImage, directCallTargets, initNativeLifter } from './native-lifter';
+
+export type { LiftedFunction } from '@/workers/lift-worker';
+
+export interface ParallelLiftResult {
+  functions: Map<number, LiftedFunction>;
+  workers: number;
+  stolen: number;
+  timeMs: number;
+}
+
+function sharedMemoryAvailable(): boolean {
+  return typeof SharedArrayBuffer !== 'undefined' && (globalThis as any).crossOriginIsolated === true;
+}
+
+export class ParallelLifter {
+  private workers: Worker[] = [];
+  private workerCount: number;
+  private busy = false;
+
+  constructor(workerCount: number = navigator.hardwareConcurrency || 4) {
+    this.workerCount = Math.max(1, Math.min(workerCount, 16)); // Max 16 workers
+  }
+
+  get size(): number {
+    return this.workers.length;
+  }
+
+  isBusy(): boolean {
+    return this.busy;
+  }
+
+  /**
+   * Lift the functions at `entryPoints` (guest addresses) and everything they
+   * call directly, with `code[0]` at `baseAddress`. `imageName` identifies
+   * the image in the lift cache across builds (see LiftCache.openImage).
+   */
+  async liftImage(
+    code: Uint8Array,
+    baseAddress: number,
+    arch: NativeArch,
+    entryPoints: number[],
+    batchSize: number = 64,
+    imageName?: string
+  ): Promise<ParallelLiftResult> {
+    if (this.busy) throw new Error('ParallelLifter is already running a job');
+    this.busy = true;
+    let cache: LiftCacheImage | null = null;
+    try {
+      cache = await liftCache.openImage(code, baseAddress, arch, imageName);
+      if (sharedMemoryAvailable()) {
+        try {
+          return await this.liftShared(code, baseAddress, arch, entryPoints, batchSize, cache);
+        } catch (error) {
+          // The pool is gone (see liftShared); the image can still be lifted here
+          console.warn('[ParallelLifter] Worker pool failed, lifting on this thread:', error);
+        }
+      }
+      return await this.liftSequential(code, baseAddress, arch, entryPoints, cache);
+    } finally {
+      // One artifact per job, whatever was lifted before a failure included
+      void cache?.persist();
+      this.busy = false;
+    }
+  }
+
+  private ensureWorkers() {
+    while (this.workers.length < this.workerCount) {
+      this.workers.push(new Worker(new URL('../../workers/lift-worker.ts', import.meta.url), { type: 'module' }));
+    }
+  }
+
+  private liftShared(
+    code: Uint8Array,
+    baseAddress: number,
+    arch: NativeArch,
+    entryPoints: number[],
+    batchSize: number,
+    cache: LiftCacheImage
+  ): Promise<ParallelLiftResult> {
+    this.ensureWorkers();
+    const startTime = performance.now();
+    const jobId = crypto.randomUUID();
+
+    const shared = new SharedArrayBuffer(code.length);
+    new Uint8Array(shared).set(code);
+    // Deques start with room for every seed, so seeding never reports 'full'
+    const perWorker = Math.ceil(entryPoints.length / this.workers.length);
+    const queueBuffer = SharedLiftQueue.allocate(this.workers.length, Math.max(1 << 16, 2 * perWorker));
+    const queue = new SharedLiftQueue(queueBuffer);
+
+    // Seed round-robin; workers have not started, so any deque may be pushed
+    let seeded = 0;
+    for (const entry of entryPoints) {
+      if (entry < baseAddress || entry >= baseAddress + code.length) continue;
+      if (queue.push(seeded % queue.workers, entry - baseAddress) === 'queued') seeded++;
+    }
+
+    const functions = new Map<number, LiftedFunction>();
+    if (seeded === 0) {
+      return Promise.resolve({ functions, workers: this.workers.length, stolen: 0, timeMs: 0 });
+    }
+
+    // Every worker gets the cached functions of this image to skip
+    const snapshot = cache.snapshot();
+    const workerCount = this.workers.length;
+    return new Promise((resolve, reject) => {
+      let running = workerCount;
+      let stolen = 0;
+
+      let settled = false;
+      const finish = (error?: Error) => {
+        if (settled) return;
+        settled = true;
+        this.workers.forEach((worker) => {
+          worker.onmessage = null;
+          worker.onerror = null;
+          worker.onmessageerror = null;
+        });
+        if (error) {
+          // A failed worker leaves its entry pending forever: restart the pool
+          this.destroy();
+          reject(error);
+        } else {
+          resolve({ functions, workers: workerCount, stolen, timeMs: performance.now() - startTime });
+        }
+      };
+
+      this.workers.forEach((worker, index) => {
+        worker.onmessage = (event: MessageEvent<LiftWorkerMessage>) => {
+          const message = event.data;
+          if (message.jobId !== jobId) return;
+          switch (message.type) {
+            case 'functions':
+              for (const fn of message.functions) {
+                functions.set(fn.entry, fn);
+                if (!fn.fromCache) cache.store(fn.entry, DEFAULT_LIFT_OPTIONS, fn);
+              }
+              break;
+            case 'done':
+              stolen += message.stolen;
+              if (--running === 0) finish();
+              break;
+            case 'error':
+              finish(new Error(`Lift worker ${message.worker}: ${message.error}`));
+              break;
+          }
+        };
+        // A worker that fails to load or throws outside a job never reports 'done'
+        worker.onerror = (event) => {
+          event.preventDefault();
+          finish(new Error(`Lift worker ${index}: ${event.message || 'failed to load'}`));
+        };
+        worker.onmessageerror = () => finish(new Error(`Lift worker ${index}: message could not be deserialized`));
+
+        const job: LiftJob = {
+          type: 'lift',
+          jobId,
+          worker: index,
+          queue: queueBuffer,
+          code: shared,
+          codeLength: code.length,
+          baseAddress,
+          arch,
+          batchSize,
+          cache: snapshot,
+        };
+        worker.postMessage(job);
+      });
+    });
+  }
+
+  private async liftSequential(
+    code: Uint8Array,
+    baseAddress: number,
+    arch: NativeArch,
+    entryPoints: number[],
+    cache: LiftCacheImage
+  ): Promise<ParallelLiftResult> {
+    const startTime = performance.now();
+    const functions = new Map<number, LiftedFunction>();
+    if (!(await initNativeLifter())) throw new Error('Native lifter unavailable');
+    const image = NativeImage.load(code, baseAddress, arch);
+    if (!image) throw new Error('Native lifter unavailable');
+
+    try {
+      const seen = new Set<number>();
+      const work = entryPoints.filter((entry) => entry >= baseAddress && entry < baseAddress + code.length);
+      while (work.length) {
+        const entry = work.pop()!;
+        if (seen.has(entry)) continue;
+        seen.add(entry);
+        const { maxInstructions, maxBlocks, optimize } = DEFAULT_LIFT_OPTIONS;
+        const cfg = image.liftFunction(entry, maxInstructions, maxBlocks, optimize, cache);
+        functions.set(entry, { entry, blocks: cfg.blocks, instructions: cfg.instructions, fromCache: cfg.fromCache });
+        for (const target of directCallTargets(cfg, baseAddress, code.length)) {
+          if (!seen.has(target)) work.push(target);
+        }
+      }
+    } finally {
+      image.release();
+    }
+    return { functions, workers: 1, stolen: 0, timeMs: performance.now() - startTime };
+  }
+
+  /**
+   * Terminate all workers
+   */
+  destroy() {
+    this.workers.forEach((worker) => worker.terminate());
+    this.workers = [];
+  }
+}
+
+// Singleton instance
+let pool: ParallelLifter | null = null;
+
+export function getParallelLifter(): ParallelLifter {
+  if (!pool) {
+    pool = new ParallelLifter();
+  }
+  return pool;
+}
+
+export function destroyParallelLifter() {
+  if (pool) {
+    pool.destroy();
+    pool = null;
+  }
+}
@@ -0,0 +1,171 @@
+/**
+ * SPSC Ring - Single-producer single-consumer message ring in a
+ * SharedArrayBuffer, connecting two pipeline stages on different threads
+ *
+ * Messages are variable-length byte payloads tagged with a 32-bit id. The
+ * producer only writes `head`, the consumer only writes `tail`, so neither
+ * side takes a lock; each waits on the other's index with Atomics.wait when
+ * the ring is full or empty (worker threads only; waitForDataAsync is the
+ * non-blocking form).
+ *
+ * Layout (Int32 slots, then data):
+ *   [0] head (bytes written)   [16] tail (bytes read)   (one cache line each)
+ *   [32] capacity (bytes, power of two)   [33] closed
+ *   data: records of [length, id] + payload padded to 8 bytes; a record
+ *   that would straddle the end is preceded by a WRAP marker and starts
+ *   again at offset 0
+ */
+
+const HEAD = 0;
+const TAIL = 16;
+const CAPACITY = 32;
+const CLOSED = 33;
+const HEADER_BYTES = 4 * 48;
+const RECORD_HEADER = 8;
+const WRAP = -1;
+
+export interface RingMessage {
+  id: number;
+  payload: Uint8Array; // View into the ring, valid until consume()
+}
+
+export class SpscRing {
+  private readonly slots: Int32Array;
+  private readonly data: Uint8Array;
+  private readonly view: DataView;
+  private readonly capacity: number;
+  private readonly mask: number;
+
+  /**
+   * Capacity is rounded up to a power of two; payloads may be up to half of it
+   */
+  static allocate(capacity: number = 1 << 20): SharedArrayBuffer {
+    let bytes = 64;
+    while (bytes < capacity) bytes <<= 1;
+    const buffer = new SharedArrayBuffer(HEADER_BYTES + bytes);
+    new Int32Array(buffer)[CAPACITY] = bytes;
+    return buffer;
+  }
+
+  constructor(buffer: SharedArrayBuffer) {
+    this.slots = new Int32Array(buffer, 0, HEADER_BYTES / 4);
+    this.capacity = this.slots[CAPACITY];
+    this.mask = this.capacity - 1;
+    this.data = new Uint8Array(buffer, HEADER_BYTES, this.capacity);
+    this.view = new DataView(buffer, HEADER_BYTES, this.capacity);
+  }
+
+  get maxPayload(): number {
+    return this.capacity / 2 - RECORD_HEADER;
+  }
+
+  /**
+   * Producer side: enqueue `payload` under `id`, or return false when the
+   * ring has no room for it yet
+   */
+  tryPush(id: number, payload: Uint8Array): boolean {
+    if (payload.length > this.maxPayload) throw new Error(`SpscRing: ${payload.length}-byte message exceeds maxPayload`);
+    const head = Atomics.load(this.slots, HEAD);
+    const tail = Atomics.load(this.slots, TAIL);
+    const at = head & this.mask;
+    const record = RECORD_HEADER + ((payload.length + 7) & ~7);
+    // Records never straddle the end: pad to offset 0 first
+    const skip = at + record > this.capacity ? this.capacity - at : 0;
+    if (((head - tail) | 0) + skip + record > this.capacity) return false;
+
+    let start = at;
+    if (skip) {
+      this.view.setInt32(at, WRAP, true);
+      start = 0;
+    }
+    this.view.setInt32(start, payload.length, true);
+    this.view.setUint32(start + 4, id >>> 0, true);
+    this.data.set(payload, start + RECORD_HEADER);
+    // Publishing head releases the record to the consumer
+    Atomics.store(this.slots, HEAD, (head + skip + record) | 0);
+    Atomics.notify(this.slots, HEAD);
+    return true;
+  }
+
+  /**
+   * Producer side: tryPush, blocking while the consumer frees space (worker
+   * threads only)
+   */
+  push(id: number, payload: Uint8Array) {
+    while (!this.tryPush(id, payload)) {
+      Atomics.wait(this.slots, TAIL, Atomics.load(this.slots, TAIL), 50);
+    }
+  }
+
+  /**
+   * Producer side: no more messages; the consumer drains what is queued
+   */
+  close() {
+    Atomics.store(this.slots, CLOSED, 1);
+    Atomics.notify(this.slots, HEAD);
+  }
+
+  /**
+   * Consumer side: the oldest message without removing it, or null when
+   * the ring is empty
+   */
+  peek(): RingMessage | null {
+    let tail = Atomics.load(this.slots, TAIL);
+    const head = Atomics.load(this.slots, HEAD);
+    if (tail === head) return null;
+    let at = tail & this.mask;
+    if (this.view.getInt32(at, true) === WRAP) {
+      tail = (tail + this.capacity - at) | 0;
+      Atomics.store(this.slots, TAIL, tail);
+      at = 0;
+    }
+    const length = this.view.getInt32(at, true);
+    return {
+      id: this.view.getUint32(at + 4, true),
+      payload: this.data.subarray(at + RECORD_HEADER, at + RECORD_HEADER + length),
+    };
+  }
+
+  /**
+   * Consumer side: drop the message returned by peek()
+   */
+  consume() {
+    const tail = Atomics.load(this.slots, TAIL);
+    const length = this.view.getInt32(tail & this.mask, true);
+    Atomics.store(this.slots, TAIL, (tail + RECORD_HEADER + ((length + 7) & ~7)) | 0);
+    Atomics.notify(this.slots, TAIL);
+  }
+
+  /**
+   * Consumer side: closed and fully drained
+   */
+  isFinished(): boolean {
+    return Atomics.load(this.slots, CLOSED) === 1 && Atomics.load(this.slots, HEAD) === Atomics.load(this.slots, TAIL);
+  }
+
+  /**
+   * Consumer side: block until a message arrives or the ring closes (worker
+   * threads only)
+   */
+  waitForData(timeoutMs: number = 50) {
+    const head = Atomics.load(this.slots, HEAD);
+    if (head !== Atomics.load(this.slots, TAIL) || Atomics.load(this.slots, CLOSED)) return;
+    Atomics.wait(this.slots, HEAD, head, timeoutMs);
+  }
+
+  /**
+   * waitForData without blocking the thread, so its event loop keeps
+   * running (Atomics.waitAsync, or a short timer where it is missing)
+   */
+  async waitForDataAsync(timeoutMs: number = 50): Promise<void> {
+    const head = Atomics.load(this.slots, HEAD);
+    if (head !== Atomics.load(this.slots, TAIL) || Atomics.load(this.slots, CLOSED)) return;
+    const waitAsync = (Atomics as any).waitAsync;
+    if (typeof waitAsync === 'function') {
+      const result = waitAsync(this.slots, HEAD, head, timeoutMs);
+      if (result.async) await result.value;
+    } else {
+      await new Promise((resolve) => setTimeout(resolve, 1));
+    }
+  }
+}
@@ -14,108 +14,15 @@ export interface AnimatedSprite {
   frameRate: number; // milliseconds per frame
 }
 
+// Creatures drawn from Piskel exports instead of pixel maps: their frames
+// live in the sprite atlas (lib/ui/sprite-atlas, built by
+// scripts/pack-sprite-atlas.js), keyed by the same names
+export const ATLAS_SPRITE_FRAME_RATES: Record<string, number> = {
+  fish: 120,
+  jellyfish: 160,
+};
+
 export const ANIMATED_FISH_SPRITES: Record<string, AnimatedSprite> = {
-  fish: {
-    frameRate: 120,
-    frames: [
-      // Frame 1 - Fins neutral
-      [
-        '................xxxxx...',
-        '..............xx####ox..',
-        '............xx######oox.',
-        '..........xx########o+x.',
-        '........xx##x#######o+x.',
-        '......xx###x########o+x.',
-        '....xx#####x########o+x.',
-        '...x######x#########o#x.',
-        '..x###xx###########oo#x.',
-        '.x####x############o##x.',
-        'x#####x###########o###x.',
-        'x####x###########o####x.',
-        '.x##x###########o####x..',
-        '..xxx##########o####x...',
-        '....xxx#######o###xx....',
-        '......xxxxxxxx##xx......'
-      ],
-      // Frame 2 - Top fin up, tail flexed
-      [
-        '................xxxxx...',
-        '..............xx####ox..',
-        '............xx######oox.',
-        '..........xx#####x##o+x.',
-        '........xx##x###x###o+x.',
-        '......xx###x#x######o+x.',
-        '....xx#####x########o+x.',
-        '...x######x#########o#x.',
-        '..x###xx###########oo#x.',
-        '.x####x############o##x.',
-        'x#####x###########o###x.',
-        'x####x##########oo####x.',
-        '.x##x##########o#####x..',
-        '..xxx#########o####xx...',
-        '....xxx######o###xxx....',
-        '......xxxxxxx##xx.......'
-      ],
-      // Frame 3 - Fins neutral (middle)
-      [
-        '................xxxxx...',
-        '..............xx####ox..',
-        '............xx######oox.',
-        '..........xx########o+x.',
-        '........xx##x#######o+x.',
-        '......xx###x########o+x.',
-        '....xx#####x########o+x.',
-        '...x######x#########o#x.',
-        '..x###xx###########oo#x.',
-        '.x####x############o##x.',
-        'x#####x###########o###x.',
-        'x####x###########o####x.',
-        '.x##x###########o####x..',
-        '..xxx##########o####x...',
-        '....xxx#######o###xx....',
-        '......xxxxxxxx##xx......'
-      ],
-      // Frame 4 - Bottom fin down, tail flexed opposite
-      [
-        '................xxxxx...',
-        '..............xx####ox..',
-        '............xx######oox.',
-        '..........xx########o+x.',
-        '........xx##x#######o+x.',
-        '......xx###x########o+x.',
-        '....xx#####x########o+x.',
-        '...x######x#########o#x.',
-        '..x###xx###########oo#x.',
-        '.x####x############o##x.',
-        'x#####x##########oo###x.',
-        'x####x##########o#####x.',
-        '.x##x###########x####x..',
-        '..xxx##########o####x...',
-        '....xxx#######o##xxx....',
-        '......xxxxxxxx#xx.......'
-      ],
-      // Frame 5 - Return to neutral
-      [
-        '................xxxxx...',
-        '..............xx####ox..',
-        '............xx######oox.',
-        '..........xx########o+x.',
-        '........xx##x#######o+x.',
-        '......xx###x########o+x.',
-        '....xx#####x########o+x.',
-        '...x######x#########o#x.',
-        '..x###xx###########oo#x.',
-        '.x####x############o##x.',
-        'x#####x###########o###x.',
-        'x####x###########o####x.',
-        '.x##x###########o####x..',
-        '..xxx##########o####x...',
-        '....xxx#######o###xx....',
-        '......xxxxxxxx##xx......'
-      ]
-    ]
-  },
-  
   clownfish: {
     frameRate: 100,
     frames: [
@@ -355,117 +262,6 @@ export const ANIMATED_FISH_SPRITES: Record<string, AnimatedSprite> = {
     ]
   },
   
-  jellyfish: {
-    frameRate: 160,
-    frames: [
-      // Frame 1 - Bell contracted, tentacles down (inspired by jellyfish.c)
-      [
-        '.......xxxxxx.......',
-        '.....xx#oo###xx.....',
-        '....x##oooo###x.....',
-        '...x###o##o####x....',
-        '..x###########o#x...',
-        '..x#############x...',
-        '..x#############x...',
-        '..x###o#####o###x...',
-        '...x###########x....',
-        '....x#########x.....',
-        '.....xx#####xx......',
-        '......xxxxxxx.......',
-        '.....x#x.x#x.x#x....',
-        '.....x#x.x#x.x#x....',
-        '....x#x..x#x..x#x...',
-        '....x#x..x#x..x#x...',
-        '...x#x...x#x...x#x..',
-        '...xxx...xxx...xxx..'
-      ],
-      // Frame 2 - Bell expanding, tentacles spreading
-      [
-        '.......xxxxxx.......',
-        '.....xx#oo###xx.....',
-        '....x##oooo###x.....',
-        '...x###o##o####x....',
-        '..x###########o#x...',
-        '..x#############x...',
-        '..x#############x...',
-        '..x###o#####o###x...',
-        '...x###########x....',
-        '....x#########x.....',
-        '.....xx#####xx......',
-        '......xxxxxxx.......',
-        '....x#x..x#x..x#x...',
-        '...x#x...x#x...x#x..',
-        '..x#x....x#x....x#x.',
-        '..x#x....x#x....x#x.',
-        '.x#x.....x#x.....x#x',
-        '.xxx.....xxx.....xxx'
-      ],
-      // Frame 3 - Bell fully expanded, tentacles wide (like jellyfish.c frame 3)
-      [
-        '......xxxxxxxx......',
-        '....xx########xx....',
-        '...x############x...',
-        '..x##############x..',
-        '..x##o########o##x..',
-        '..x####o####o####x..',
-        '...x##o######o##x...',
-        '....x##o####o##x....',
-        '.....x#o####o#x.....',
-        '......x######x......',
-        '.......x####x.......',
-        '........xxxx........',
-        '...x#x..x#x..x#x....',
-        '..x#x...x#x...x#x...',
-        '.x#x....x#x....x#x..',
-        'x#x.....x#x.....x#x.',
-        'x#x.....x#x.....x#x.',
-        'xxx.....xxx.....xxx.'
-      ],
-      // Frame 4 - Bell contracting, tentacles coming together
-      [
-        '.......xxxxxx.......',
-        '.....xx#oo###xx.....',
-        '....x##oooo###x.....',
-        '...x###o##o####x....',
-        '..x###########o#x...',
-        '..x#############x...',
-        '..x#############x...',
-        '..x###o#####o###x...',
-        '...x###########x....',
-        '....x#########x.....',
-        '.....xx#####xx......',
-        '......xxxxxxx.......',
-        '....x#x..x#x..x#x...',
-        '...x#x...x#x...x#x..',
-        '..x#x....x#x....x#x.',
-        '..x#x....x#x....x#x.',
-        '.x#x.....x#x.....x#x',
-        '.xxx.....xxx.....xxx'
-      ],
-      // Frame 5 - Back to contracted (smooth loop)
-      [
-        '.......xxxxxx.......',
-        '.....xx#oo###xx.....',
-        '....x##oooo###x.....',
-        '...x###o##o####x....',
-        '..x###########o#x...',
-        '..x#############x...',
-        '..x#############x...',
-        '..x###o#####o###x...',
-        '...x###########x....',
-        '....x#########x.....',
-        '.....xx#####xx......',
-        '......xxxxxxx.......',
-        '.....x#x.x#x.x#x....',
-        '.....x#x.x#x.x#x....',
-        '....x#x..x#x..x#x...',
-        '....x#x..x#x..x#x...',
-        '...x#x...x#x...x#x..',
-        '...xxx...xxx...xxx..'
-      ]
-    ]
-  },
-  
   manta: {
     frameRate: 180,
     frames: [
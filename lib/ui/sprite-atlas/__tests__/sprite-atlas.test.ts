@@ -0,0 +1,145 @@
+/**
+ * Sprite Atlas Tests
+ * Atlases packed by scripts/pack-sprite-atlas.js decoded back through
+ * SpriteAtlas: palette, row tokens, frame boxes and spans, and the
+ * generated sprite-atlas-data.ts against the Piskel sources
+ */
+
+import { describe, it, expect } from '@jest/globals';
+import * as fs from 'fs';
+import * as path from 'path';
+import { SpriteAtlas, getSpriteAtlas } from '../sprite-atlas';
+
+interface PackerSprite {
+  name: string;
+  width: number;
+  height: number;
+  frames: number[][];
+}
+
+// eslint-disable-next-line @typescript-eslint/no-var-requires
+const packer = require('../../../../scripts/pack-sprite-atlas') as {
+  piskelDir: string;
+  parsePiskel(file: string): PackerSprite;
+  packAtlas(sprites: PackerSprite[]): Uint8Array;
+};
+
+// 0xAABBGGRR words, as Piskel exports them
+const RED = 0xff0000ff;
+const GREEN = 0xff00ff00;
+const BLUE = 0xffff0000;
+const HALF = 0x80112233;
+const CLEAR = 0x00ffffff; // Transparent, whatever its colour bits
+
+function sprite(name: string, width: number, height: number, frames: number[][]): PackerSprite {
+  return { name, width, height, frames };
+}
+
+// The frame as the decoder should return it: transparent pixels become 0
+function expected(frame: number[]): Uint32Array {
+  return Uint32Array.from(frame, (pixel) => (pixel >>> 24 === 0 ? 0 : pixel));
+}
+
+function decoded(atlas: SpriteAtlas, name: string, frame: number, palette?: number[]): Uint32Array {
+  const rgba = atlas.decodeFrame(name, frame, palette);
+  expect(rgba).not.toBeNull();
+  return new Uint32Array(rgba!.buffer);
+}
+
+// 200 x 4: an empty first row, then a row with a one-pixel gap inside a
+// literal run and a longer gap that becomes a skip, then a row of 200
+// literal pixels (two runs), then an empty row. The second frame is empty.
+function stripFrames(): number[][] {
+  const width = 200;
+  const frame = new Array<number>(width * 4).fill(0);
+  frame[width + 2] = RED;
+  frame[width + 3] = CLEAR;
+  frame[width + 4] = GREEN;
+  frame[width + 5] = GREEN;
+  frame[width + 6] = GREEN;
+  frame[width + 12] = BLUE;
+  for (let x = 0; x < width; x++) frame[2 * width + x] = x % 2 ? GREEN : RED;
+  return [frame, new Array<number>(width * 4).fill(CLEAR)];
+}
+
+describe('SpriteAtlas', () => {
+  const strip = sprite('strip', 200, 4, stripFrames());
+  const dot = sprite('dot', 3, 3, [[0, 0, 0, 0, HALF, RED, 0, 0, 0]]);
+  const bytes = packer.packAtlas([strip, dot]);
+  const atlas = new SpriteAtlas(bytes);
+
+  it('reads the header, names and palettes', () => {
+    expect(new DataView(bytes.buffer, bytes.byteOffset).getUint32(0, true)).toBe(0x31415053); // "SPA1"
+    expect([...atlas.sprites.keys()]).toEqual(['strip', 'dot']);
+
+    const info = atlas.sprites.get('strip')!;
+    expect(info.index).toBe(0);
+    expect([info.width, info.height, info.frames.length]).toEqual([200, 4, 2]);
+    expect(info.paletteSize).toBe(4);
+    expect(Array.from(info.palette)).toEqual([0, RED, GREEN, BLUE, ...new Array(12).fill(0)]);
+    expect(Array.from(atlas.sprites.get('dot')!.palette.subarray(0, 3))).toEqual([0, HALF, RED]);
+  });
+
+  it('stores each frame box and the opaque span of its rows', () => {
+    const [full, empty] = atlas.sprites.get('strip')!.frames;
+    expect([full.x0, full.y0, full.x1, full.y1]).toEqual([0, 1, 200, 3]);
+    expect(Array.from(full.spans)).toEqual([2, 13, 0, 200]);
+    expect([empty.x0, empty.y0, empty.x1, empty.y1]).toEqual([0, 0, 0, 0]);
+    expect(empty.spans.length).toBe(0);
+
+    const only = atlas.sprites.get('dot')!.frames[0];
+    expect([only.x0, only.y0, only.x1, only.y1]).toEqual([1, 1, 3, 2]);
+    expect(Array.from(only.spans)).toEqual([1, 3]);
+  });
+
+  it('codes gaps as skips or literal zeros and splits long runs', () => {
+    const frame = atlas.sprites.get('strip')!.frames[0];
+    // Row 1: skip 2; literal 5 (red, gap, 3 green); skip 5; literal 1 (blue);
+    // skip 187 as 128 + 59
+    const row = Array.from(bytes.subarray(frame.stream, frame.stream + 10));
+    expect(row).toEqual([0x01, 0x84, 0x01, 0x22, 0x02, 0x04, 0x80, 0x03, 0x7f, 0x3a]);
+    // Row 2: literal 128, then literal 72
+    expect(bytes[frame.stream + 10]).toBe(0xff);
+    expect(bytes[frame.stream + 10 + 1 + 64]).toBe(0x80 | 71);
+  });
+
+  it('decodes every frame back to its pixels', () => {
+    for (const source of [strip, dot]) {
+      source.frames.forEach((frame, f) => {
+        expect(decoded(atlas, source.name, f)).toEqual(expected(frame));
+      });
+    }
+    expect(atlas.decodeFrame('strip', 2)).toBeNull();
+    expect(atlas.decodeFrame('missing', 0)).toBeNull();
+  });
+
+  it('recolours by palette index, keeping index 0 transparent', () => {
+    const pixels = decoded(atlas, 'strip', 0, [0xffffffff, 0xff000000]);
+    expect(pixels[200 + 2]).toBe(0xff000000); // Index 1
+    expect(pixels[200 + 4]).toBe(GREEN); // Past the override
+    expect(pixels[0]).toBe(0);
+  });
+
+  it('rejects more than 15 opaque colours', () => {
+    const colours = Array.from({ length: 16 }, (_, i) => (0xff000000 | (i + 1)) >>> 0);
+    expect(() => packer.packAtlas([sprite('busy', 16, 1, [colours])])).toThrow(/more than 15 opaque colours/);
+  });
+
+  it('matches the Piskel sources in the generated atlas', () => {
+    const generated = getSpriteAtlas();
+    const files = fs.readdirSync(packer.piskelDir).filter((file) => file.endsWith('.c'));
+    expect(generated.sprites.size).toBe(files.length);
+    for (const file of files) {
+      const source = packer.parsePiskel(path.join(packer.piskelDir, file));
+      const info = generated.sprites.get(source.name);
+      expect(info && [info.width, info.height, info.frames.length]).toEqual([
+        source.width,
+        source.height,
+        source.frames.length,
+      ]);
+      source.frames.forEach((frame, f) => {
+        expect(decoded(generated, source.name, f)).toEqual(expected(frame));
+      });
+    }
+  });
+});
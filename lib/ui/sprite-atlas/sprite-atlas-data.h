@@ -0,0 +1,153 @@
+// Generated by scripts/pack-sprite-atlas.js from lib/ui/sprite-atlas/piskel - do not edit
+// fish 32x32x5, jellyfish 32x32x5
+
+#pragma once
+
+#define SPRITE_ATLAS_MAX_PIXELS 1024
+
+static const uint8_t sprite_atlas_data[2292] __attribute__((aligned(4))) = {
+    0x53, 0x50, 0x41, 0x31, 0x02, 0x00, 0x00, 0x00, 0x30, 0x00, 0x00, 0x00, 0x20, 0x00, 0x20, 0x00,
+    0x05, 0x00, 0x02, 0x00, 0x38, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0xf0, 0x02, 0x00, 0x00,
+    0x20, 0x00, 0x20, 0x00, 0x05, 0x00, 0x02, 0x00, 0xfc, 0x02, 0x00, 0x00, 0x3c, 0x03, 0x00, 0x00,
+    0x66, 0x69, 0x73, 0x68, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7e, 0x00, 0x00, 0x00,
+    0xfc, 0x00, 0x00, 0x00, 0x71, 0x01, 0x00, 0x00, 0xef, 0x01, 0x00, 0x00, 0x5f, 0x02, 0x00, 0x00,
+    0x08, 0x07, 0x17, 0x13, 0x15, 0x17, 0x0b, 0x17, 0x0a, 0x17, 0x09, 0x17, 0x09, 0x17, 0x09, 0x17,
+    0x08, 0x17, 0x08, 0x17, 0x09, 0x12, 0x0b, 0x11, 0x0d, 0x11, 0x10, 0x11, 0x14, 0x81, 0x11, 0x08,
+    0x0a, 0x85, 0x11, 0x11, 0x11, 0x03, 0x81, 0x11, 0x08, 0x09, 0x8c, 0x11, 0x11, 0x11, 0x11, 0x00,
+    0x11, 0x01, 0x08, 0x08, 0x8d, 0x11, 0x11, 0x11, 0x11, 0x01, 0x11, 0x11, 0x08, 0x08, 0x8d, 0x11,
+    0x10, 0x11, 0x11, 0x11, 0x11, 0x11, 0x08, 0x08, 0x8d, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x08, 0x07, 0x8e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x10, 0x11, 0x01, 0x08, 0x07, 0x89, 0x11, 0x11,
+    0x11, 0x11, 0x11, 0x02, 0x81, 0x11, 0x08, 0x08, 0x88, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0d, 0x0a,
+    0x85, 0x11, 0x11, 0x11, 0x0e, 0x0c, 0x83, 0x11, 0x11, 0x0e, 0x0f, 0x80, 0x01, 0x0e, 0x08, 0x07,
+    0x17, 0x13, 0x15, 0x17, 0x0b, 0x17, 0x0a, 0x17, 0x09, 0x17, 0x09, 0x17, 0x09, 0x17, 0x08, 0x17,
+    0x08, 0x17, 0x09, 0x12, 0x0b, 0x11, 0x0d, 0x11, 0x10, 0x11, 0x14, 0x81, 0x11, 0x08, 0x0a, 0x85,
+    0x11, 0x11, 0x11, 0x03, 0x81, 0x11, 0x08, 0x09, 0x8c, 0x11, 0x11, 0x11, 0x11, 0x00, 0x11, 0x01,
+    0x08, 0x08, 0x8d, 0x11, 0x11, 0x11, 0x11, 0x01, 0x11, 0x11, 0x08, 0x08, 0x8d, 0x11, 0x10, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x08, 0x08, 0x8d, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x08, 0x07,
+    0x8e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x10, 0x11, 0x01, 0x08, 0x07, 0x89, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x02, 0x81, 0x11, 0x08, 0x08, 0x88, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0d, 0x0a, 0x85, 0x11,
+    0x11, 0x11, 0x0e, 0x0c, 0x83, 0x11, 0x11, 0x0e, 0x0f, 0x80, 0x01, 0x0e, 0x08, 0x07, 0x16, 0x13,
+    0x14, 0x16, 0x0b, 0x16, 0x0a, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x08, 0x14, 0x08, 0x12,
+    0x09, 0x12, 0x0b, 0x11, 0x0d, 0x11, 0x10, 0x11, 0x13, 0x81, 0x11, 0x09, 0x0a, 0x85, 0x11, 0x11,
+    0x11, 0x02, 0x81, 0x11, 0x09, 0x09, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x10, 0x01, 0x0a, 0x08, 0x8b,
+    0x11, 0x11, 0x11, 0x11, 0x01, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x10, 0x11, 0x11, 0x11, 0x11, 0x0a,
+    0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x07, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x10, 0x0b, 0x07, 0x89, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0d, 0x08, 0x88, 0x11, 0x11, 0x11, 0x11,
+    0x01, 0x0d, 0x0a, 0x85, 0x11, 0x11, 0x11, 0x0e, 0x0c, 0x83, 0x11, 0x11, 0x0e, 0x0f, 0x80, 0x01,
+    0x0e, 0x08, 0x07, 0x17, 0x13, 0x15, 0x17, 0x0b, 0x17, 0x0a, 0x17, 0x09, 0x17, 0x09, 0x17, 0x09,
+    0x17, 0x08, 0x17, 0x08, 0x17, 0x09, 0x12, 0x0b, 0x11, 0x0d, 0x11, 0x10, 0x11, 0x14, 0x81, 0x11,
+    0x08, 0x0a, 0x85, 0x11, 0x11, 0x11, 0x03, 0x81, 0x11, 0x08, 0x09, 0x8c, 0x11, 0x11, 0x11, 0x11,
+    0x00, 0x11, 0x01, 0x08, 0x08, 0x8d, 0x11, 0x11, 0x11, 0x11, 0x01, 0x11, 0x11, 0x08, 0x08, 0x8d,
+    0x11, 0x10, 0x11, 0x11, 0x11, 0x11, 0x11, 0x08, 0x08, 0x8d, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x08, 0x07, 0x8e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x10, 0x11, 0x01, 0x08, 0x07, 0x89, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x02, 0x81, 0x11, 0x08, 0x08, 0x88, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0d,
+    0x0a, 0x85, 0x11, 0x11, 0x11, 0x0e, 0x0c, 0x83, 0x11, 0x11, 0x0e, 0x0f, 0x80, 0x01, 0x0e, 0x08,
+    0x08, 0x16, 0x13, 0x0b, 0x11, 0x0a, 0x12, 0x09, 0x15, 0x09, 0x16, 0x09, 0x16, 0x08, 0x16, 0x08,
+    0x16, 0x09, 0x15, 0x0b, 0x11, 0x0d, 0x11, 0x10, 0x11, 0x0a, 0x85, 0x11, 0x11, 0x11, 0x0e, 0x09,
+    0x87, 0x11, 0x11, 0x11, 0x11, 0x0d, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x01, 0x11, 0x0a, 0x08,
+    0x8c, 0x11, 0x10, 0x11, 0x11, 0x11, 0x11, 0x01, 0x09, 0x08, 0x8c, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x01, 0x09, 0x07, 0x8d, 0x11, 0x11, 0x11, 0x11, 0x11, 0x10, 0x11, 0x09, 0x07, 0x8d, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x00, 0x11, 0x09, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x01, 0x10, 0x0a,
+    0x0a, 0x85, 0x11, 0x11, 0x11, 0x0e, 0x0c, 0x83, 0x11, 0x11, 0x0e, 0x0f, 0x80, 0x01, 0x0e, 0x00,
+    0x6a, 0x65, 0x6c, 0x6c, 0x79, 0x66, 0x69, 0x73, 0x68, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x35, 0x01, 0x00, 0x00, 0x54, 0x02, 0x00, 0x00, 0x31, 0x03, 0x00, 0x00, 0x64, 0x04, 0x00, 0x00,
+    0x9f, 0x05, 0x00, 0x00, 0x09, 0x05, 0x17, 0x20, 0x0d, 0x12, 0x0c, 0x13, 0x0a, 0x14, 0x09, 0x14,
+    0x09, 0x14, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x14, 0x09, 0x14,
+    0x09, 0x14, 0x0a, 0x15, 0x0a, 0x16, 0x0a, 0x17, 0x0a, 0x17, 0x0a, 0x17, 0x0a, 0x17, 0x0a, 0x17,
+    0x0a, 0x16, 0x0a, 0x16, 0x0a, 0x16, 0x09, 0x16, 0x09, 0x17, 0x12, 0x17, 0x15, 0x16, 0x0c, 0x84,
+    0x11, 0x11, 0x01, 0x0d, 0x0b, 0x86, 0x11, 0x11, 0x11, 0x01, 0x0c, 0x09, 0x89, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11,
+    0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b,
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a,
+    0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x0a, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x09, 0x8a, 0x01,
+    0x10, 0x01, 0x10, 0x10, 0x01, 0x0a, 0x09, 0x83, 0x01, 0x10, 0x02, 0x84, 0x01, 0x10, 0x01, 0x09,
+    0x09, 0x87, 0x01, 0x10, 0x01, 0x10, 0x02, 0x81, 0x11, 0x08, 0x09, 0x80, 0x01, 0x02, 0x84, 0x01,
+    0x10, 0x01, 0x02, 0x80, 0x01, 0x08, 0x09, 0x80, 0x01, 0x02, 0x80, 0x01, 0x02, 0x84, 0x11, 0x00,
+    0x01, 0x08, 0x09, 0x80, 0x01, 0x03, 0x87, 0x01, 0x10, 0x01, 0x10, 0x08, 0x09, 0x80, 0x01, 0x03,
+    0x87, 0x01, 0x10, 0x00, 0x11, 0x08, 0x09, 0x80, 0x01, 0x02, 0x81, 0x11, 0x02, 0x82, 0x01, 0x01,
+    0x09, 0x09, 0x80, 0x01, 0x02, 0x80, 0x01, 0x03, 0x82, 0x01, 0x01, 0x09, 0x09, 0x80, 0x01, 0x02,
+    0x80, 0x01, 0x02, 0x83, 0x01, 0x10, 0x09, 0x08, 0x81, 0x11, 0x02, 0x80, 0x01, 0x02, 0x83, 0x01,
+    0x10, 0x09, 0x08, 0x81, 0x11, 0x02, 0x80, 0x01, 0x02, 0x84, 0x01, 0x10, 0x01, 0x08, 0x11, 0x80,
+    0x01, 0x02, 0x80, 0x01, 0x08, 0x14, 0x80, 0x01, 0x09, 0x05, 0x05, 0x19, 0x1d, 0x0d, 0x12, 0x0c,
+    0x13, 0x0a, 0x14, 0x09, 0x14, 0x09, 0x14, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09,
+    0x15, 0x09, 0x14, 0x09, 0x14, 0x09, 0x14, 0x0a, 0x15, 0x0a, 0x16, 0x0a, 0x17, 0x0a, 0x17, 0x0a,
+    0x17, 0x0a, 0x19, 0x09, 0x19, 0x08, 0x19, 0x07, 0x19, 0x06, 0x19, 0x05, 0x15, 0x0c, 0x84, 0x11,
+    0x11, 0x01, 0x0d, 0x0b, 0x86, 0x11, 0x11, 0x11, 0x01, 0x0c, 0x09, 0x89, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x01, 0x0b, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08,
+    0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x0a, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x09, 0x8a, 0x01, 0x10,
+    0x01, 0x10, 0x10, 0x01, 0x0a, 0x09, 0x83, 0x01, 0x10, 0x02, 0x84, 0x01, 0x10, 0x01, 0x09, 0x09,
+    0x87, 0x01, 0x10, 0x01, 0x10, 0x02, 0x81, 0x11, 0x08, 0x09, 0x80, 0x01, 0x02, 0x84, 0x01, 0x10,
+    0x01, 0x02, 0x80, 0x01, 0x08, 0x09, 0x80, 0x01, 0x02, 0x80, 0x01, 0x02, 0x84, 0x11, 0x00, 0x01,
+    0x08, 0x09, 0x85, 0x01, 0x11, 0x11, 0x02, 0x80, 0x01, 0x02, 0x81, 0x11, 0x06, 0x08, 0x83, 0x11,
+    0x10, 0x05, 0x80, 0x01, 0x03, 0x80, 0x01, 0x06, 0x07, 0x84, 0x11, 0x00, 0x01, 0x05, 0x81, 0x11,
+    0x02, 0x80, 0x01, 0x06, 0x06, 0x81, 0x11, 0x02, 0x80, 0x01, 0x06, 0x80, 0x01, 0x02, 0x80, 0x01,
+    0x06, 0x05, 0x81, 0x11, 0x03, 0x80, 0x01, 0x06, 0x80, 0x01, 0x02, 0x80, 0x01, 0x06, 0x04, 0x80,
+    0x01, 0x05, 0x80, 0x01, 0x06, 0x80, 0x01, 0x0a, 0x05, 0x05, 0x1a, 0x17, 0x0d, 0x12, 0x0c, 0x13,
+    0x0a, 0x14, 0x09, 0x14, 0x09, 0x14, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15,
+    0x09, 0x14, 0x05, 0x14, 0x05, 0x14, 0x05, 0x18, 0x05, 0x19, 0x05, 0x19, 0x05, 0x1a, 0x0b, 0x1a,
+    0x0c, 0x84, 0x11, 0x11, 0x01, 0x0d, 0x0b, 0x86, 0x11, 0x11, 0x11, 0x01, 0x0c, 0x09, 0x89, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a,
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a,
+    0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x11, 0x0a, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x04, 0x8e, 0x11,
+    0x00, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x04, 0x8e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x01, 0x0b, 0x04, 0x80, 0x01, 0x02, 0x8e, 0x11, 0x00, 0x11, 0x00, 0x01, 0x11, 0x11, 0x01,
+    0x07, 0x04, 0x80, 0x01, 0x02, 0x84, 0x11, 0x10, 0x01, 0x02, 0x80, 0x01, 0x04, 0x81, 0x11, 0x06,
+    0x04, 0x80, 0x01, 0x03, 0x82, 0x01, 0x01, 0x03, 0x81, 0x11, 0x04, 0x80, 0x01, 0x06, 0x04, 0x80,
+    0x01, 0x05, 0x80, 0x01, 0x04, 0x81, 0x11, 0x03, 0x81, 0x11, 0x05, 0x0a, 0x81, 0x11, 0x05, 0x80,
+    0x01, 0x04, 0x80, 0x01, 0x05, 0x05, 0x05, 0x1b, 0x1e, 0x0d, 0x12, 0x0c, 0x13, 0x0a, 0x14, 0x09,
+    0x14, 0x09, 0x14, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x14, 0x09,
+    0x14, 0x09, 0x14, 0x08, 0x18, 0x07, 0x19, 0x06, 0x19, 0x06, 0x1a, 0x05, 0x1a, 0x05, 0x1a, 0x06,
+    0x1b, 0x07, 0x1b, 0x07, 0x1b, 0x07, 0x1b, 0x0e, 0x1b, 0x0e, 0x0f, 0x0c, 0x84, 0x11, 0x11, 0x01,
+    0x0d, 0x0b, 0x86, 0x11, 0x11, 0x11, 0x01, 0x0c, 0x09, 0x89, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0b,
+    0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x01, 0x0b, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08,
+    0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01,
+    0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x07, 0x8f, 0x11, 0x01, 0x10, 0x01,
+    0x10, 0x10, 0x11, 0x11, 0x07, 0x06, 0x86, 0x11, 0x11, 0x10, 0x01, 0x02, 0x80, 0x01, 0x04, 0x81,
+    0x11, 0x06, 0x05, 0x86, 0x11, 0x00, 0x01, 0x01, 0x03, 0x81, 0x11, 0x04, 0x80, 0x01, 0x06, 0x05,
+    0x80, 0x01, 0x04, 0x80, 0x01, 0x04, 0x81, 0x11, 0x03, 0x81, 0x11, 0x05, 0x04, 0x81, 0x11, 0x03,
+    0x81, 0x11, 0x05, 0x80, 0x01, 0x04, 0x80, 0x01, 0x05, 0x04, 0x81, 0x11, 0x03, 0x80, 0x01, 0x06,
+    0x80, 0x01, 0x04, 0x80, 0x01, 0x05, 0x05, 0x81, 0x11, 0x02, 0x81, 0x11, 0x05, 0x80, 0x01, 0x04,
+    0x81, 0x11, 0x04, 0x06, 0x80, 0x01, 0x03, 0x81, 0x11, 0x04, 0x80, 0x01, 0x05, 0x80, 0x01, 0x04,
+    0x06, 0x80, 0x01, 0x04, 0x81, 0x11, 0x03, 0x81, 0x11, 0x04, 0x80, 0x01, 0x04, 0x06, 0x80, 0x01,
+    0x05, 0x80, 0x01, 0x04, 0x81, 0x11, 0x03, 0x80, 0x01, 0x04, 0x0d, 0x80, 0x01, 0x05, 0x80, 0x01,
+    0x03, 0x80, 0x01, 0x04, 0x0d, 0x80, 0x01, 0x10, 0x07, 0x05, 0x18, 0x1f, 0x0d, 0x12, 0x0c, 0x13,
+    0x0a, 0x14, 0x09, 0x14, 0x09, 0x14, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15, 0x09, 0x15,
+    0x09, 0x14, 0x09, 0x14, 0x09, 0x14, 0x08, 0x16, 0x09, 0x16, 0x09, 0x16, 0x09, 0x16, 0x09, 0x16,
+    0x09, 0x16, 0x09, 0x17, 0x08, 0x18, 0x08, 0x18, 0x07, 0x18, 0x07, 0x18, 0x07, 0x18, 0x0e, 0x0f,
+    0x0c, 0x84, 0x11, 0x11, 0x01, 0x0d, 0x0b, 0x86, 0x11, 0x11, 0x11, 0x01, 0x0c, 0x09, 0x89, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a,
+    0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a,
+    0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11,
+    0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x08, 0x8b, 0x11, 0x11, 0x11,
+    0x11, 0x11, 0x11, 0x0a, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11,
+    0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x08, 0x8a, 0x11, 0x11, 0x11, 0x11, 0x11, 0x01, 0x0b, 0x07,
+    0x8d, 0x11, 0x01, 0x10, 0x01, 0x10, 0x10, 0x11, 0x09, 0x08, 0x84, 0x11, 0x10, 0x01, 0x02, 0x80,
+    0x01, 0x02, 0x80, 0x01, 0x09, 0x08, 0x84, 0x01, 0x10, 0x01, 0x02, 0x84, 0x11, 0x00, 0x01, 0x09,
+    0x08, 0x80, 0x01, 0x02, 0x80, 0x01, 0x03, 0x83, 0x01, 0x10, 0x09, 0x08, 0x80, 0x01, 0x02, 0x80,
+    0x01, 0x03, 0x83, 0x01, 0x10, 0x09, 0x08, 0x80, 0x01, 0x02, 0x80, 0x01, 0x03, 0x83, 0x01, 0x10,
+    0x09, 0x08, 0x80, 0x01, 0x02, 0x80, 0x01, 0x03, 0x80, 0x01, 0x02, 0x80, 0x01, 0x08, 0x07, 0x80,
+    0x01, 0x03, 0x81, 0x11, 0x02, 0x80, 0x01, 0x02, 0x81, 0x11, 0x07, 0x07, 0x80, 0x01, 0x04, 0x80,
+    0x01, 0x02, 0x81, 0x11, 0x02, 0x80, 0x01, 0x07, 0x06, 0x80, 0x01, 0x05, 0x80, 0x01, 0x03, 0x80,
+    0x01, 0x02, 0x80, 0x01, 0x07, 0x06, 0x80, 0x01, 0x04, 0x81, 0x11, 0x02, 0x80, 0x01, 0x03, 0x80,
+    0x01, 0x07, 0x06, 0x80, 0x01, 0x04, 0x80, 0x01, 0x03, 0x80, 0x01, 0x03, 0x80, 0x01, 0x07, 0x0d,
+    0x80, 0x01, 0x10, 0x00,
+};
@@ -0,0 +1,37 @@
+// Generated by scripts/pack-sprite-atlas.js from lib/ui/sprite-atlas/piskel - do not edit
+// fish 32x32x5, jellyfish 32x32x5
+
+// The same bytes as sprite_atlas_data in sprite-atlas-data.h, base64 encoded
+export const SPRITE_ATLAS_BASE64 =
+  'U1BBMQIAAAAwAAAAIAAgAAUAAgA4AAAAeAAAAPACAAAgACAABQACAPwCAAA8AwAAZmlzaAAAAAAAAAAAAAAA/wAAAAAAAAAA' +
+  'AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAH4AAAD8AAAAcQEAAO8BAABfAgAA' +
+  'CAcXExUXCxcKFwkXCRcJFwgXCBcJEgsRDREQERSBEQgKhREREQOBEQgJjBEREREAEQEICI0RERERARERCAiNERAREREREQgI' +
+  'jREREREREREIB44RERERERARAQgHiRERERERAoERCAiIEREREQENCoUREREODIMREQ4PgAEOCAcXExUXCxcKFwkXCRcJFwgX' +
+  'CBcJEgsRDREQERSBEQgKhREREQOBEQgJjBEREREAEQEICI0RERERARERCAiNERAREREREQgIjREREREREREIB44RERERERAR' +
+  'AQgHiRERERERAoERCAiIEREREQENCoUREREODIMREQ4PgAEOCAcWExQWCxYKFQkVCRUJFQgUCBIJEgsRDREQEROBEQkKhRER' +
+  'EQKBEQkJihEREREQAQoIixEREREBEQoIixEQEREREQoIixEREREREQoHixEREREREAsHiRERERERDQiIEREREQENCoUREREO' +
+  'DIMREQ4PgAEOCAcXExUXCxcKFwkXCRcJFwgXCBcJEgsRDREQERSBEQgKhREREQOBEQgJjBEREREAEQEICI0RERERARERCAiN' +
+  'ERAREREREQgIjREREREREREIB44RERERERARAQgHiRERERERAoERCAiIEREREQENCoUREREODIMREQ4PgAEOCAgWEwsRChIJ' +
+  'FQkWCRYIFggWCRULEQ0REBEKhREREQ4JhxERERENCIsRERERAREKCIwREBEREREBCQiMERERERERAQkHjREREREREBEJB40R' +
+  'EREREQARCQiLEREREQEQCgqFERERDgyDEREOD4ABDgBqZWxseWZpc2gAAAAAAAAAAAAA/wAAAAAAAAAAAAAAAAAAAAAAAAAA' +
+  'AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAADUBAABUAgAAMQMAAGQEAACfBQAACQUXIA0SDBMKFAkU' +
+  'CRQJFQkVCRUJFQkVCRQJFAkUChUKFgoXChcKFwoXChcKFgoWChYJFgkXEhcVFgyEEREBDQuGERERAQwJiRERERERCwiKERER' +
+  'EREBCwiKEREREREBCwiLERERERERCgiLERERERERCgiLERERERERCgiLERERERERCgiLERERERERCgiKEREREREBCwiKERER' +
+  'EREBCwiKEREREREBCwmKARABEBABCgmDARAChAEQAQkJhwEQARACgREICYABAoQBEAECgAEICYABAoABAoQRAAEICYABA4cB' +
+  'EAEQCAmAAQOHARAAEQgJgAECgRECggEBCQmAAQKAAQOCAQEJCYABAoABAoMBEAkIgRECgAECgwEQCQiBEQKAAQKEARABCBGA' +
+  'AQKAAQgUgAEJBQUZHQ0SDBMKFAkUCRQJFQkVCRUJFQkVCRQJFAkUChUKFgoXChcKFwoZCRkIGQcZBhkFFQyEEREBDQuGERER' +
+  'AQwJiRERERERCwiKEREREREBCwiKEREREREBCwiLERERERERCgiLERERERERCgiLERERERERCgiLERERERERCgiLERERERER' +
+  'CgiKEREREREBCwiKEREREREBCwiKEREREREBCwmKARABEBABCgmDARAChAEQAQkJhwEQARACgREICYABAoQBEAECgAEICYAB' +
+  'AoABAoQRAAEICYUBERECgAECgREGCIMREAWAAQOAAQYHhBEAAQWBEQKAAQYGgRECgAEGgAECgAEGBYERA4ABBoABAoABBgSA' +
+  'AQWAAQaAAQoFBRoXDRIMEwoUCRQJFAkVCRUJFQkVCRUJFAUUBRQFGAUZBRkFGgsaDIQREQENC4YREREBDAmJERERERELCIoR' +
+  'EREREQELCIoREREREQELCIsREREREREKCIsREREREREKCIsREREREREKCIsREREREREKCIsREREREREKCIoREREREQELBI4R' +
+  'ABERERERAQsEjhEREREREREBCwSAAQKOEQARAAEREQEHBIABAoQREAECgAEEgREGBIABA4IBAQOBEQSAAQYEgAEFgAEEgRED' +
+  'gREFCoERBYABBIABBQUFGx4NEgwTChQJFAkUCRUJFQkVCRUJFQkUCRQJFAgYBxkGGQYaBRoFGgYbBxsHGwcbDhsODwyEEREB' +
+  'DQuGERERAQwJiRERERERCwiKEREREREBCwiKEREREREBCwiLERERERERCgiLERERERERCgiLERERERERCgiLERERERERCgiL' +
+  'ERERERERCgiKEREREREBCwiKEREREREBCwiKEREREREBCwePEQEQARAQEREHBoYRERABAoABBIERBgWGEQABAQOBEQSAAQYF' +
+  'gAEEgAEEgREDgREFBIERA4ERBYABBIABBQSBEQOAAQaAAQSAAQUFgRECgREFgAEEgREEBoABA4ERBIABBYABBAaAAQSBEQOB' +
+  'EQSAAQQGgAEFgAEEgREDgAEEDYABBYABA4ABBA2AARAHBRgfDRIMEwoUCRQJFAkVCRUJFQkVCRUJFAkUCRQIFgkWCRYJFgkW' +
+  'CRYJFwgYCBgHGAcYBxgODwyEEREBDQuGERERAQwJiRERERERCwiKEREREREBCwiKEREREREBCwiLERERERERCgiLERERERER' +
+  'CgiLERERERERCgiLERERERERCgiLERERERERCgiKEREREREBCwiKEREREREBCwiKEREREREBCweNEQEQARAQEQkIhBEQAQKA' +
+  'AQKAAQkIhAEQAQKEEQABCQiAAQKAAQODARAJCIABAoABA4MBEAkIgAECgAEDgwEQCQiAAQKAAQOAAQKAAQgHgAEDgRECgAEC' +
+  'gREHB4ABBIABAoERAoABBwaAAQWAAQOAAQKAAQcGgAEEgRECgAEDgAEHBoABBIABA4ABA4ABBw2AARAA';
@@ -0,0 +1,157 @@
+// Freestanding C Sprite Atlas - Blitter Tests
+// blit_rgba and sprite_blit against a per-pixel reference, placed partly
+// or wholly off the framebuffer on every side, scaled and mirrored.
+//
+// Native: cc -O1 -g -fsanitize=address,undefined sprite-atlas-test.c -o sprite-atlas-test
+//         ./sprite-atlas-test
+// Exits non-zero and names every failing check. Native builds take the
+// scalar blend.
+
+#include "sprite-atlas.c"
+
+#include <stdio.h>
+#include <string.h>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                                \
+    do {                                                                           \
+        if (!(cond)) {                                                             \
+            fprintf(stderr, "%s:%d: %s: CHECK(%s)\n", __FILE__, __LINE__,          \
+                    __func__, #cond);                                              \
+            failures++;                                                            \
+        }                                                                          \
+    } while (0)
+
+#define DST_W 40
+#define DST_H 30
+
+// Opaque background with varying colour and alpha bytes
+static void fill_background(uint32_t* dst) {
+    for (int i = 0; i < DST_W * DST_H; i++) dst[i] = 0x80000000u | (uint32_t)i * 0x010203u;
+}
+
+// Source pixel covering each destination pixel, blended one at a time
+static void reference_blit(const uint32_t* src, int width, int height, uint32_t* dst, int x, int y,
+                           int scale, unsigned flags) {
+    for (int dy = 0; dy < DST_H; dy++) {
+        for (int dx = 0; dx < DST_W; dx++) {
+            if (dx < x || dy < y) continue;
+            int sx = (dx - x) / scale;
+            const int sy = (dy - y) / scale;
+            if (sx >= width || sy >= height) continue;
+            if (flags & SPRITE_BLIT_FLIP_X) sx = width - 1 - sx;
+            dst[dy * DST_W + dx] = blend_pixel(src[sy * width + sx], dst[dy * DST_W + dx]);
+        }
+    }
+}
+
+static void test_blend_pixel() {
+    CHECK(blend_pixel(0x00FFFFFFu, 0x12345678u) == 0x12345678u);  // Transparent keeps dst
+    CHECK(blend_pixel(0xFF0000FFu, 0x12345678u) == 0xFF0000FFu);  // Opaque replaces it
+    // Half over opaque black: colours halve, alpha stays opaque
+    CHECK(blend_pixel(0x80FFFFFFu, 0xFF000000u) == 0xFF808080u);
+    // Half over transparent: alpha becomes the source's
+    CHECK(blend_pixel(0x80FF0000u, 0x00000000u) == 0x80800000u);
+}
+
+// A small RGBA frame with transparent, translucent and opaque pixels, in
+// every position the clip can cut it
+static void test_blit_clips_on_every_side() {
+    enum { W = 5, H = 4 };
+    uint32_t src[W * H];
+    for (int i = 0; i < W * H; i++) {
+        const uint32_t alpha = i % 3 == 0 ? 0x00u : i % 3 == 1 ? 0x80u : 0xFFu;
+        src[i] = alpha << 24 | (uint32_t)(i * 37 + 11) << 8 | (uint32_t)(i * 13);
+    }
+    uint32_t got[DST_W * DST_H], want[DST_W * DST_H];
+    int cases = 0;
+    for (int scale = 1; scale <= 3; scale++) {
+        for (unsigned flags = 0; flags <= SPRITE_BLIT_FLIP_X; flags++) {
+            for (int y = -H * scale - 1; y <= DST_H + 1; y += 3) {
+                for (int x = -W * scale - 1; x <= DST_W + 1; x += 2) {
+                    fill_background(got);
+                    fill_background(want);
+                    CHECK(blit_rgba(src, W, H, 0, got, DST_W, DST_H, x, y, scale, flags) == 0);
+                    reference_blit(src, W, H, want, x, y, scale, flags);
+                    if (memcmp(got, want, sizeof(got)) != 0) {
+                        fprintf(stderr, "  blit at (%d, %d) scale %d flags %u\n", x, y, scale, flags);
+                        CHECK(!"blit matches the reference");
+                    }
+                    cases++;
+                }
+            }
+        }
+    }
+    CHECK(cases > 1000);
+}
+
+// Atlas frames cull rows and columns outside the box and spans; the result
+// must still equal a plain blit of the decoded frame
+static void test_atlas_blit_matches_decoded_frame() {
+    static uint32_t decoded[SPRITE_ATLAS_MAX_PIXELS];
+    uint32_t got[DST_W * DST_H], want[DST_W * DST_H];
+    for (int sprite = 0; sprite < sprite_count(); sprite++) {
+        const int width = sprite_width(sprite), height = sprite_height(sprite);
+        for (int frame = 0; frame < sprite_frame_count(sprite); frame++) {
+            CHECK(sprite_decode_frame(sprite, frame, decoded, width) == width * height);
+            for (int scale = 1; scale <= 2; scale++) {
+                for (unsigned flags = 0; flags <= SPRITE_BLIT_FLIP_X; flags++) {
+                    const int placements[][2] = {
+                        { 0, 0 }, { -7, -9 }, { DST_W - 10, DST_H - 6 }, { -width * scale + 3, 5 },
+                        { 4, -height * scale + 2 }, { DST_W, 0 }, { 0, -height * scale },
+                    };
+                    for (size_t p = 0; p < sizeof(placements) / sizeof(placements[0]); p++) {
+                        const int x = placements[p][0], y = placements[p][1];
+                        fill_background(got);
+                        fill_background(want);
+                        CHECK(sprite_blit(sprite, frame, got, DST_W, DST_H, x, y, scale, flags) == 0);
+                        reference_blit(decoded, width, height, want, x, y, scale, flags);
+                        if (memcmp(got, want, sizeof(got)) != 0) {
+                            fprintf(stderr, "  %s frame %d at (%d, %d) scale %d flags %u\n", sprite_name(sprite),
+                                    frame, x, y, scale, flags);
+                            CHECK(!"atlas blit matches the decoded frame");
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void test_blit_rejects_bad_arguments() {
+    uint32_t src[4] = { 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu };
+    static uint32_t wide[SPRITE_MAX_SPAN + 1];
+    uint32_t dst[DST_W * DST_H];
+    fill_background(dst);
+    CHECK(blit_rgba(src, 2, 2, 0, dst, DST_W, DST_H, 0, 0, 0, 0) == -1);
+    CHECK(blit_rgba(src, 0, 2, 0, dst, DST_W, DST_H, 0, 0, 1, 0) == -1);
+    CHECK(blit_rgba(src, 2, 2, 0, 0, DST_W, DST_H, 0, 0, 1, 0) == -1);
+    CHECK(blit_rgba(src, 2, 2, 0, dst, 0, DST_H, 0, 0, 1, 0) == -1);
+    CHECK(sprite_blit(-1, 0, dst, DST_W, DST_H, 0, 0, 1, 0) == -1);
+    CHECK(sprite_blit(0, sprite_frame_count(0), dst, DST_W, DST_H, 0, 0, 1, 0) == -1);
+    // A clipped span wider than the row buffer
+    CHECK(blit_rgba(src, 2, 1, 0, wide, SPRITE_MAX_SPAN + 1, 1, 0, 0, SPRITE_MAX_SPAN, 0) == -1);
+
+    // Entirely off the framebuffer: nothing written
+    uint32_t before[DST_W * DST_H];
+    memcpy(before, dst, sizeof(dst));
+    CHECK(blit_rgba(src, 2, 2, 0, dst, DST_W, DST_H, DST_W, 0, 1, 0) == 0);
+    CHECK(blit_rgba(src, 2, 2, 0, dst, DST_W, DST_H, -2, -2, 1, 0) == 0);
+    CHECK(blit_rgba(src, 2, 2, 0, dst, DST_W, DST_H, 0x7FFFFFF0, 0, 3, 0) == 0);
+    CHECK(memcmp(before, dst, sizeof(dst)) == 0);
+}
+
+int main(void) {
+    test_blend_pixel();
+    test_blit_clips_on_every_side();
+    test_atlas_blit_matches_decoded_frame();
+    test_blit_rejects_bad_arguments();
+
+    if (failures) {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    puts("sprite-atlas-test: all checks passed");
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Freestanding C Sprite Atlas
+// Every creature's animation frames in one palette-indexed, run-length
+// coded atlas (see sprite-atlas.h), with a frame decoder and a blitter
+// (sprite-blit.h) for the JS side
+//
+// To compile: node scripts/build-native-wasm.js, or by hand:
+// clang --target=wasm32 -O3 -nostdlib -Wl,--no-entry -Wl,--export-dynamic sprite-atlas.c -o sprite-atlas.wasm
+// Add -msimd128 for the SIMD128 blend (sprite-atlas-simd.wasm).
+
+#include "sprite-atlas.h"
+#include "sprite-atlas-data.h"
+#include "sprite-blit.h"
+
+static uint32_t frame_buffer[SPRITE_ATLAS_MAX_PIXELS];
+
+static const SpriteEntry* sprite_entry(int sprite) {
+    const SpriteAtlasHeader* header = (const SpriteAtlasHeader*)sprite_atlas_data;
+    if (sprite < 0 || (uint32_t)sprite >= header->sprite_count) return 0;
+    return (const SpriteEntry*)(sprite_atlas_data + sizeof(SpriteAtlasHeader)) + sprite;
+}
+
+// Decodes one row's tokens into `width` pixels; returns the byte after them
+static const uint8_t* decode_row(const uint8_t* stream, const uint32_t* palette, int width, uint32_t* out) {
+    int x = 0;
+    while (x < width) {
+        const uint8_t token = *stream++;
+        const int run = (token & (SPRITE_TOKEN_LITERAL - 1)) + 1;
+        if (!(token & SPRITE_TOKEN_LITERAL)) {
+            for (int i = 0; i < run; i++) out[x + i] = 0;
+        } else {
+            for (int i = 0; i + 1 < run; i += 2) {
+                const uint8_t pair = *stream++;
+                out[x + i] = palette[pair & 0x0F];
+                out[x + i + 1] = palette[pair >> 4];
+            }
+            if (run & 1) out[x + run - 1] = palette[*stream++ & 0x0F];
+        }
+        x += run;
+    }
+    return stream;
+}
+
+WASM_EXPORT int sprite_count(void) {
+    return (int)((const SpriteAtlasHeader*)sprite_atlas_data)->sprite_count;
+}
+
+// NUL-terminated name, or NULL for an invalid index
+WASM_EXPORT const char* sprite_name(int sprite) {
+    const SpriteEntry* entry = sprite_entry(sprite);
+    return entry ? (const char*)sprite_atlas_data + entry->name : 0;
+}
+
+WASM_EXPORT int sprite_width(int sprite) {
+    const SpriteEntry* entry = sprite_entry(sprite);
+    return entry ? entry->width : 0;
+}
+
+WASM_EXPORT int sprite_height(int sprite) {
+    const SpriteEntry* entry = sprite_entry(sprite);
+    return entry ? entry->height : 0;
+}
+
+WASM_EXPORT int sprite_frame_count(int sprite) {
+    const SpriteEntry* entry = sprite_entry(sprite);
+    return entry ? entry->frame_count : 0;
+}
+
+// Scratch frame large enough for any sprite in the atlas
+WASM_EXPORT uint32_t* sprite_frame_buffer(void) {
+    return frame_buffer;
+}
+
+static const SpriteFrameBox* frame_box(const SpriteEntry* entry, int frame) {
+    const uint32_t* offsets = (const uint32_t*)(sprite_atlas_data + entry->frames);
+    return (const SpriteFrameBox*)((const uint8_t*)(offsets + entry->frame_count + 1) + offsets[frame]);
+}
+
+/**
+ * Decode a frame as RGBA words into `out`, `stride` pixels per row (NULL
+ * decodes into sprite_frame_buffer() with stride = width). Transparent
+ * pixels are written as 0. Returns width * height, or -1 for an invalid
+ * sprite or frame.
+ */
+WASM_EXPORT int sprite_decode_frame(int sprite, int frame, uint32_t* out, int stride) {
+    const SpriteEntry* entry = sprite_entry(sprite);
+    if (!entry || frame < 0 || frame >= entry->frame_count) return -1;
+    if (!out) {
+        out = frame_buffer;
+        stride = entry->width;
+    }
+    const uint32_t* palette = (const uint32_t*)(sprite_atlas_data + entry->palette);
+    const SpriteFrameBox* box = frame_box(entry, frame);
+    const uint8_t* stream = sprite_frame_stream(box);
+    for (int y = 0; y < entry->height; y++) {
+        uint32_t* row = out + (size_t)y * stride;
+        if (y < box->y0 || y >= box->y1) {
+            for (int x = 0; x < entry->width; x++) row[x] = 0;
+        } else {
+            stream = decode_row(stream, palette, entry->width, row);
+        }
+    }
+    return entry->width * entry->height;
+}
+
+/**
+ * Opaque bounding box of a frame packed as x0 | y0 << 8 | x1 << 16 | y1 << 24
+ * (x1, y1 exclusive; 0 for an empty frame), or -1 for an invalid frame
+ */
+WASM_EXPORT int sprite_frame_box(int sprite, int frame) {
+    const SpriteEntry* entry = sprite_entry(sprite);
+    if (!entry || frame < 0 || frame >= entry->frame_count) return -1;
+    const SpriteFrameBox* box = frame_box(entry, frame);
+    return (int)((uint32_t)box->x0 | (uint32_t)box->y0 << 8 | (uint32_t)box->x1 << 16 | (uint32_t)box->y1 << 24);
+}
+
+/**
+ * Composite a frame into `dst` (dst_width x dst_height RGBA words) at
+ * (x, y), scaled by `scale` and mirrored with SPRITE_BLIT_FLIP_X. Returns 0,
+ * or -1 for an invalid sprite, frame or size.
+ */
+WASM_EXPORT int sprite_blit(int sprite, int frame, uint32_t* dst, int dst_width, int dst_height,
+                            int x, int y, int scale, unsigned flags) {
+    if (sprite_decode_frame(sprite, frame, 0, 0) < 0) return -1;
+    const SpriteEntry* entry = sprite_entry(sprite);
+    const SpriteFrameBox* box = frame_box(entry, frame);
+    return blit_rgba(frame_buffer, entry->width, entry->height, box, dst, dst_width, dst_height, x, y, scale, flags);
+}
+
+// sprite_blit for a caller's RGBA frame, e.g. one laid out like new_piskel_data
+WASM_EXPORT int sprite_blit_rgba(const uint32_t* src, int width, int height, uint32_t* dst, int dst_width,
+                                 int dst_height, int x, int y, int scale, unsigned flags) {
+    return blit_rgba(src, width, height, 0, dst, dst_width, dst_height, x, y, scale, flags);
+}
+
+#ifdef __wasm__
+extern unsigned char __heap_base;
+
+/**
+ * Framebuffer of width x height RGBA words at the heap base, growing linear
+ * memory as needed. Every call returns the same region, so JS keeps one
+ * target and re-creates its views after the memory grows. Returns NULL when
+ * memory cannot grow.
+ */
+WASM_EXPORT uint32_t* sprite_target(int width, int height) {
+    if (width <= 0 || height <= 0) return 0;
+    const uintptr_t base = ((uintptr_t)&__heap_base + 15) & ~(uintptr_t)15;
+    const size_t end = base + (size_t)width * (size_t)height * sizeof(uint32_t);
+    const size_t have = __builtin_wasm_memory_size(0) * 65536;
+    if (end > have && __builtin_wasm_memory_grow(0, (end - have + 65535) / 65536) == (size_t)-1) return 0;
+    return (uint32_t*)base;
+}
+#endif
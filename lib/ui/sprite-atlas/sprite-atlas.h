@@ -0,0 +1,72 @@
+// Freestanding C Sprite Atlas - Format Definitions
+// Included by sprite-atlas.c; the atlas itself is generated into
+// sprite-atlas-data.h by scripts/pack-sprite-atlas.js
+// No stdlib dependencies to ensure smooth WASM compilation
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define WASM_EXPORT __attribute__((visibility("default")))
+
+// ---------------------------------------------------------------------------
+// Atlas layout (little-endian, every offset from the start of the atlas)
+//
+//   SpriteAtlasHeader
+//   SpriteEntry[sprite_count]
+//   per sprite: NUL-terminated name, RGBA palette (16 uint32 words, 4-byte
+//   aligned), frame offsets (uint32 x frame_count + 1, relative to the first
+//   frame) and the frames
+//
+// Palette index 0 is always transparent (0x00000000). A sprite uses at most
+// 16 colours and unused palette words are zero, so any 4-bit index reads
+// inside the palette. Sprites are at most 255 pixels wide and high.
+//
+// A frame starts with a SpriteFrameBox around its opaque pixels, then one
+// SpriteSpan per box row (y0 to y1 - 1), then the pixel stream of those rows
+// top to bottom; rows outside the box are transparent. Each row is a run of
+// tokens covering exactly `width` pixels:
+//   0x00-0x7F  skip token + 1 transparent pixels
+//   0x80-0xFF  (token & 0x7F) + 1 literal pixels, followed by their 4-bit
+//              palette indices two per byte, low nibble first
+// Runs never cross rows, so a frame decodes into any stride.
+// ---------------------------------------------------------------------------
+
+#define SPRITE_ATLAS_MAGIC 0x31415053u  // "SPA1"
+#define SPRITE_MAX_PALETTE 16
+#define SPRITE_TOKEN_LITERAL 0x80
+#define SPRITE_TOKEN_MAX_RUN 128
+#define SPRITE_MAX_DIM 255
+
+typedef struct {
+    uint32_t magic;
+    uint32_t sprite_count;
+} SpriteAtlasHeader;
+
+typedef struct {
+    uint32_t name;           // Offset of the name
+    uint16_t width;
+    uint16_t height;
+    uint16_t frame_count;
+    uint16_t palette_size;
+    uint32_t palette;        // Offset of the 16 RGBA palette words
+    uint32_t frames;         // Offset of frame_count + 1 stream offsets
+} SpriteEntry;
+
+typedef struct {
+    uint8_t x0, y0;          // Opaque bounding box, x1 and y1 exclusive;
+    uint8_t x1, y1;          // all zero for an empty frame
+} SpriteFrameBox;
+
+typedef struct {
+    uint8_t start, end;      // Opaque extent of a box row, equal when it has none
+} SpriteSpan;
+
+static inline const SpriteSpan* sprite_frame_spans(const SpriteFrameBox* box) {
+    return (const SpriteSpan*)(box + 1);
+}
+
+static inline const uint8_t* sprite_frame_stream(const SpriteFrameBox* box) {
+    return (const uint8_t*)(sprite_frame_spans(box) + (box->y1 - box->y0));
+}
@@ -0,0 +1,282 @@
+/**
+ * Sprite Atlas - The Piskel frames of every creature, palette-indexed and
+ * run-length coded by scripts/pack-sprite-atlas.js (format in
+ * sprite-atlas.h). Frames decode in JS from sprite-atlas-data.ts; when
+ * /wasm/sprite-atlas.wasm (sprite-atlas.c) is loaded, the same atlas also
+ * blits into a framebuffer in WASM memory.
+ */
+
+import { loadNativeAndInstantiate } from '../../wasm/loader';
+import { SPRITE_ATLAS_BASE64 } from './sprite-atlas-data';
+
+interface SpriteAtlasExports {
+  memory: WebAssembly.Memory;
+  sprite_count(): number;
+  sprite_decode_frame(sprite: number, frame: number, out: number, stride: number): number;
+  sprite_blit(
+    sprite: number,
+    frame: number,
+    dst: number,
+    dstWidth: number,
+    dstHeight: number,
+    x: number,
+    y: number,
+    scale: number,
+    flags: number
+  ): number;
+  sprite_target(width: number, height: number): number;
+}
+
+const ATLAS_MAGIC = 0x31415053; // "SPA1"
+const HEADER_BYTES = 8;
+const ENTRY_BYTES = 20;
+const PALETTE_WORDS = 16;
+const LITERAL = 0x80;
+
+// SpriteBlitFlags in sprite-blit.h
+const SPRITE_BLIT_FLIP_X = 1;
+
+/**
+ * Opaque bounding box of a frame (x1, y1 exclusive; all zero when empty)
+ * and, for each box row, the [start, end) extent of its opaque pixels
+ */
+export interface AtlasFrame {
+  x0: number;
+  y0: number;
+  x1: number;
+  y1: number;
+  spans: Uint8Array; // start, end per row y0..y1 - 1
+  stream: number; // Offset of the row tokens in the atlas
+}
+
+export interface AtlasSprite {
+  index: number;
+  name: string;
+  width: number;
+  height: number;
+  palette: Uint32Array; // 16 RGBA words (0xAABBGGRR), index 0 transparent
+  paletteSize: number;
+  frames: AtlasFrame[];
+}
+
+function decodeBase64(base64: string): Uint8Array {
+  if (typeof atob === 'function') return Uint8Array.from(atob(base64), (c) => c.charCodeAt(0));
+  return new Uint8Array(Buffer.from(base64, 'base64'));
+}
+
+function parseAtlas(bytes: Uint8Array): AtlasSprite[] {
+  const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+  if (view.getUint32(0, true) !== ATLAS_MAGIC) throw new Error('Sprite atlas: bad magic');
+
+  const sprites: AtlasSprite[] = [];
+  const count = view.getUint32(4, true);
+  for (let s = 0; s < count; s++) {
+    const entry = HEADER_BYTES + s * ENTRY_BYTES;
+    const nameStart = view.getUint32(entry, true);
+    const nameEnd = bytes.indexOf(0, nameStart);
+    const frameCount = view.getUint16(entry + 8, true);
+    const paletteOffset = view.getUint32(entry + 12, true);
+    const offsets = view.getUint32(entry + 16, true);
+    const firstFrame = offsets + 4 * (frameCount + 1);
+
+    const palette = new Uint32Array(PALETTE_WORDS);
+    for (let i = 0; i < PALETTE_WORDS; i++) palette[i] = view.getUint32(paletteOffset + 4 * i, true);
+
+    const frames: AtlasFrame[] = [];
+    for (let f = 0; f < frameCount; f++) {
+      const at = firstFrame + view.getUint32(offsets + 4 * f, true);
+      const [x0, y0, x1, y1] = bytes.subarray(at, at + 4);
+      const rows = y1 - y0;
+      frames.push({
+        x0,
+        y0,
+        x1,
+        y1,
+        spans: bytes.subarray(at + 4, at + 4 + 2 * rows),
+        stream: at + 4 + 2 * rows,
+      });
+    }
+
+    sprites.push({
+      index: s,
+      name: new TextDecoder().decode(bytes.subarray(nameStart, nameEnd)),
+      width: view.getUint16(entry + 4, true),
+      height: view.getUint16(entry + 6, true),
+      palette,
+      paletteSize: view.getUint16(entry + 10, true),
+      frames,
+    });
+  }
+  return sprites;
+}
+
+export class SpriteAtlas {
+  readonly sprites = new Map<string, AtlasSprite>();
+  private exports: SpriteAtlasExports | null = null;
+  private targetPtr = 0;
+  private targetWidth = 0;
+  private targetHeight = 0;
+
+  constructor(private bytes: Uint8Array) {
+    for (const sprite of parseAtlas(bytes)) this.sprites.set(sprite.name, sprite);
+  }
+
+  /**
+   * Use the WASM module for blitting; its atlas must be the same build
+   */
+  attach(exports: SpriteAtlasExports): void {
+    if (exports.sprite_count() === this.sprites.size) this.exports = exports;
+  }
+
+  get hasBlitter(): boolean {
+    return this.exports !== null;
+  }
+
+  /**
+   * RGBA bytes of one frame (width * height * 4, ready for ImageData), or
+   * null for an unknown sprite or frame. `palette` replaces the sprite's
+   * colours by index (index 0 stays transparent), e.g. to tint a species.
+   */
+  decodeFrame(name: string, frame: number, palette?: ArrayLike<number>): Uint8ClampedArray | null {
+    const sprite = this.sprites.get(name);
+    const info = sprite?.frames[frame];
+    if (!sprite || !info) return null;
+
+    const colours = new Uint32Array(PALETTE_WORDS);
+    for (let i = 1; i < PALETTE_WORDS; i++) colours[i] = palette && i < palette.length ? palette[i] : sprite.palette[i];
+
+    const pixels = new Uint32Array(sprite.width * sprite.height);
+    const bytes = this.bytes;
+    let at = info.stream;
+    for (let y = info.y0; y < info.y1; y++) {
+      const row = y * sprite.width;
+      let x = 0;
+      while (x < sprite.width) {
+        const token = bytes[at++];
+        const run = (token & (LITERAL - 1)) + 1;
+        if (token & LITERAL) {
+          for (let i = 0; i < run; i++) {
+            const pair = bytes[at + (i >> 1)];
+            pixels[row + x + i] = colours[i & 1 ? pair >> 4 : pair & 0x0f];
+          }
+          at += (run + 1) >> 1;
+        }
+        x += run;
+      }
+    }
+    return new Uint8ClampedArray(pixels.buffer);
+  }
+
+  /**
+   * All frames of a sprite as PNG data URLs, each pixel scaled to a
+   * `scale` x `scale` block (the same output as createSprite in sprites.ts)
+   */
+  frameDataUrls(name: string, scale: number = 3, palette?: ArrayLike<number>): string[] {
+    const sprite = this.sprites.get(name);
+    if (!sprite || typeof document === 'undefined') return [];
+
+    const source = document.createElement('canvas');
+    source.width = sprite.width;
+    source.height = sprite.height;
+    const sourceCtx = source.getContext('2d');
+    const canvas = document.createElement('canvas');
+    canvas.width = sprite.width * scale;
+    canvas.height = sprite.height * scale;
+    const ctx = canvas.getContext('2d');
+    if (!sourceCtx || !ctx) return [];
+    ctx.imageSmoothingEnabled = false;
+
+    const urls: string[] = [];
+    for (let f = 0; f < sprite.frames.length; f++) {
+      const rgba = this.decodeFrame(name, f, palette);
+      if (!rgba) break;
+      sourceCtx.putImageData(new ImageData(rgba, sprite.width, sprite.height), 0, 0);
+      ctx.clearRect(0, 0, canvas.width, canvas.height);
+      ctx.drawImage(source, 0, 0, canvas.width, canvas.height);
+      urls.push(canvas.toDataURL('image/png'));
+    }
+    return urls;
+  }
+
+  /**
+   * Size the WASM framebuffer that blit() composites into. Its contents are
+   * undefined until clearTarget(). Returns false without the WASM module or
+   * when memory cannot grow.
+   */
+  setTarget(width: number, height: number): boolean {
+    this.targetPtr = this.exports ? this.exports.sprite_target(width, height) : 0;
+    this.targetWidth = this.targetPtr ? width : 0;
+    this.targetHeight = this.targetPtr ? height : 0;
+    return this.targetPtr !== 0;
+  }
+
+  clearTarget(rgba: number = 0): void {
+    if (!this.exports || !this.targetPtr) return;
+    new Uint32Array(this.exports.memory.buffer, this.targetPtr, this.targetWidth * this.targetHeight).fill(rgba);
+  }
+
+  /**
+   * Alpha-blend a frame into the target with its top-left corner at (x, y),
+   * each pixel scaled to a `scale` x `scale` block and optionally mirrored.
+   * Off-target parts are clipped, and rows outside the frame's box skipped.
+   */
+  blit(name: string, frame: number, x: number, y: number, scale: number = 1, flip: boolean = false): boolean {
+    const sprite = this.sprites.get(name);
+    if (!sprite || !this.exports || !this.targetPtr) return false;
+    return (
+      this.exports.sprite_blit(
+        sprite.index,
+        frame,
+        this.targetPtr,
+        this.targetWidth,
+        this.targetHeight,
+        Math.round(x),
+        Math.round(y),
+        scale,
+        flip ? SPRITE_BLIT_FLIP_X : 0
+      ) === 0
+    );
+  }
+
+  /**
+   * The target as ImageData for putImageData; it views WASM memory, so take
+   * it again after setTarget()
+   */
+  targetImage(): ImageData | null {
+    if (!this.exports || !this.targetPtr) return null;
+    const bytes = new Uint8ClampedArray(this.exports.memory.buffer, this.targetPtr, this.targetWidth * this.targetHeight * 4);
+    return new ImageData(bytes, this.targetWidth, this.targetHeight);
+  }
+}
+
+let atlas: SpriteAtlas | null = null;
+let blitterPromise: Promise<SpriteAtlas> | null = null;
+
+/**
+ * The atlas with the JS decoder; no WASM needed
+ */
+export function getSpriteAtlas(): SpriteAtlas {
+  if (!atlas) atlas = new SpriteAtlas(decodeBase64(SPRITE_ATLAS_BASE64));
+  return atlas;
+}
+
+/**
+ * getSpriteAtlas() with the WASM blitter attached when
+ * /wasm/sprite-atlas.wasm is available (see SpriteAtlas.hasBlitter)
+ */
+export function loadSpriteAtlas(): Promise<SpriteAtlas> {
+  if (!blitterPromise) {
+    blitterPromise = (async () => {
+      const sprites = getSpriteAtlas();
+      try {
+        const exports = (await loadNativeAndInstantiate('sprite-atlas')) as SpriteAtlasExports | null;
+        if (exports && typeof exports.sprite_blit === 'function') sprites.attach(exports);
+      } catch {
+        // Expected when the native build has not been produced
+      }
+      if (!sprites.hasBlitter) console.log('[SpriteAtlas] WASM blitter not available');
+      return sprites;
+    })();
+  }
+  return blitterPromise;
+}
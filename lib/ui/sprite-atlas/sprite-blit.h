@@ -0,0 +1,140 @@
+// Freestanding C Sprite Atlas - Blitter
+// Source-over compositing of RGBA frames (the Piskel 0xAABBGGRR word
+// layout) into an RGBA framebuffer, with integer scaling, horizontal flip
+// and clipping. Included by sprite-atlas.c.
+//
+// Each blend computes, per channel, (s * a + d * (255 - a)) / 255 rounded,
+// with s = 255 for the alpha channel so the result alpha is
+// a + d_a * (1 - a). The SIMD128 path handles four destination pixels per
+// step and skips groups whose source pixels are all transparent.
+
+#pragma once
+
+#include "sprite-atlas.h"
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#define SPRITE_SIMD 1
+#else
+#define SPRITE_SIMD 0
+#endif
+
+enum SpriteBlitFlags {
+    SPRITE_BLIT_FLIP_X = 1u << 0
+};
+
+#define SPRITE_MAX_SPAN 4096  // Widest clipped destination span of one blit
+
+static uint32_t blit_span[SPRITE_MAX_SPAN];
+
+static inline uint32_t blend_channel(uint32_t s, uint32_t d, uint32_t a) {
+    uint32_t t = s * a + d * (255 - a) + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+static inline uint32_t blend_pixel(uint32_t src, uint32_t dst) {
+    const uint32_t a = src >> 24;
+    if (a == 0) return dst;
+    if (a == 255) return src;
+    return blend_channel(src & 0xFF, dst & 0xFF, a)
+        | blend_channel((src >> 8) & 0xFF, (dst >> 8) & 0xFF, a) << 8
+        | blend_channel((src >> 16) & 0xFF, (dst >> 16) & 0xFF, a) << 16
+        | blend_channel(255, dst >> 24, a) << 24;
+}
+
+#if SPRITE_SIMD
+// Per 16-bit lane of one half: (s * a + d * (255 - a) + 128) / 255
+static inline v128_t blend_u16x8(v128_t s, v128_t d, v128_t a) {
+    const v128_t inv = wasm_i16x8_sub(wasm_i16x8_splat(255), a);
+    v128_t t = wasm_i16x8_add(wasm_i16x8_add(wasm_i16x8_mul(s, a), wasm_i16x8_mul(d, inv)), wasm_i16x8_splat(128));
+    return wasm_u16x8_shr(wasm_i16x8_add(t, wasm_u16x8_shr(t, 8)), 8);
+}
+
+static inline v128_t blend_x4(v128_t src, v128_t dst) {
+    // Alpha of each pixel in all four of its bytes; the source alpha byte
+    // becomes 255 so the alpha channel blends like a colour
+    const v128_t a = wasm_i8x16_shuffle(src, src, 3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+    const v128_t s = wasm_v128_or(src, wasm_i32x4_splat((int32_t)0xFF000000u));
+    v128_t lo = blend_u16x8(wasm_u16x8_extend_low_u8x16(s), wasm_u16x8_extend_low_u8x16(dst),
+                            wasm_u16x8_extend_low_u8x16(a));
+    v128_t hi = blend_u16x8(wasm_u16x8_extend_high_u8x16(s), wasm_u16x8_extend_high_u8x16(dst),
+                            wasm_u16x8_extend_high_u8x16(a));
+    return wasm_u8x16_narrow_i16x8(lo, hi);
+}
+#endif
+
+// Composite `count` span pixels onto one destination row
+static void blend_span(const uint32_t* span, int count, uint32_t* dst) {
+    int i = 0;
+#if SPRITE_SIMD
+    const v128_t alpha = wasm_i32x4_splat((int32_t)0xFF000000u);
+    for (; i + 4 <= count; i += 4) {
+        const v128_t src = wasm_v128_load(span + i);
+        const v128_t a = wasm_v128_and(src, alpha);
+        if (!wasm_v128_any_true(a)) continue;
+        if (wasm_i32x4_all_true(wasm_i32x4_eq(a, alpha))) {
+            wasm_v128_store(dst + i, src);
+            continue;
+        }
+        wasm_v128_store(dst + i, blend_x4(src, wasm_v128_load(dst + i)));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = blend_pixel(span[i], dst[i]);
+    }
+}
+
+/**
+ * Composite a width x height RGBA frame into the dst_width x dst_height
+ * framebuffer with its top-left corner at (x, y), each source pixel covering
+ * scale x scale destination pixels. Parts outside the framebuffer are
+ * clipped. With a frame box (atlas frames), rows outside it are culled and
+ * each row is expanded and blended over its opaque span only. Returns 0, or
+ * -1 for invalid sizes or a clipped span wider than SPRITE_MAX_SPAN.
+ */
+static int blit_rgba(const uint32_t* src, int width, int height, const SpriteFrameBox* box,
+                     uint32_t* dst, int dst_width, int dst_height, int x, int y, int scale, unsigned flags) {
+    if (!src || !dst || width <= 0 || height <= 0 || dst_width <= 0 || dst_height <= 0 || scale <= 0) return -1;
+    const int64_t right = (int64_t)x + (int64_t)width * scale;
+    const int64_t bottom = (int64_t)y + (int64_t)height * scale;
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    const int x1 = right > dst_width ? dst_width : (int)right;
+    int y1 = bottom > dst_height ? dst_height : (int)bottom;
+    if (x0 >= x1 || y0 >= y1) return 0;
+    if (x1 - x0 > SPRITE_MAX_SPAN) return -1;
+
+    const SpriteSpan* spans = 0;
+    if (box) {
+        if (box->y0 >= box->y1) return 0;
+        spans = sprite_frame_spans(box);
+        if ((int64_t)y + (int64_t)box->y0 * scale > y0) y0 = y + box->y0 * scale;
+        if ((int64_t)y + (int64_t)box->y1 * scale < y1) y1 = y + box->y1 * scale;
+    }
+
+    int row = -1, begin = x0, end = x1;
+    for (int dy = y0; dy < y1; dy++) {
+        const int sy = (dy - y) / scale;
+        if (sy != row) {
+            // Expand the source row once for the `scale` rows it covers
+            row = sy;
+            begin = x0;
+            end = x1;
+            if (spans) {
+                const SpriteSpan span = spans[sy - box->y0];
+                const int from = (flags & SPRITE_BLIT_FLIP_X) ? width - span.end : span.start;
+                const int to = (flags & SPRITE_BLIT_FLIP_X) ? width - span.start : span.end;
+                if ((int64_t)x + (int64_t)from * scale > begin) begin = x + from * scale;
+                if ((int64_t)x + (int64_t)to * scale < end) end = x + to * scale;
+            }
+            const uint32_t* line = src + (size_t)sy * width;
+            for (int dx = begin; dx < end; dx++) {
+                int sx = (dx - x) / scale;
+                if (flags & SPRITE_BLIT_FLIP_X) sx = width - 1 - sx;
+                blit_span[dx - begin] = line[sx];
+            }
+        }
+        if (begin < end) blend_span(blit_span, end - begin, dst + (size_t)dy * dst_width + begin);
+    }
+    return 0;
+}
@@ -118,6 +118,66 @@ export async function loadAndInstantiate(
   return instance.exports;
 }
 
+/**
+ * Build of a native module from scripts/build-native-wasm.js: name.wasm,
+ * name-simd.wasm or name-simd-threads.wasm
+ */
+export type NativeWasmVariant = 'baseline' | 'simd' | 'simd-threads';
+
+export interface NativeWasmOptions {
+  threads?: boolean; // Prefer the threaded build (shared memory required)
+}
+
+const NATIVE_VARIANT_SUFFIX: Record<NativeWasmVariant, string> = {
+  baseline: '',
+  simd: '-simd',
+  'simd-threads': '-simd-threads',
+};
+
+/**
+ * The variants of `name` this engine can run, best first
+ */
+export function nativeWasmVariants(options: NativeWasmOptions = {}): NativeWasmVariant[] {
+  const variants: NativeWasmVariant[] = [];
+  if (isWasmSimdSupported()) {
+    if (options.threads && isWasmThreadsSupported()) variants.push('simd-threads');
+    variants.push('simd');
+  }
+  variants.push('baseline');
+  return variants;
+}
+
+/**
+ * Compile the best available build of /wasm/<name>*.wasm, falling back from
+ * the threaded to the SIMD to the baseline build. Returns null when none
+ * has been built.
+ */
+export async function loadNativeWasmModule(
+  name: string,
+  options: NativeWasmOptions = {}
+): Promise<{ module: WebAssembly.Module; variant: NativeWasmVariant } | null> {
+  for (const variant of nativeWasmVariants(options)) {
+    const module = await loadWasmModule({ wasmPath: `/wasm/${name}${NATIVE_VARIANT_SUFFIX[variant]}.wasm` });
+    if (module instanceof WebAssembly.Module) return { module, variant };
+  }
+  return null;
+}
+
+/**
+ * loadAndInstantiate for a native module: the exports of its best
+ * available build, or null
+ */
+export async function loadNativeAndInstantiate(
+  name: string,
+  imports: WebAssembly.Imports = {},
+  options: NativeWasmOptions = {}
+): Promise<any> {
+  const loaded = await loadNativeWasmModule(name, options);
+  if (!loaded) return null;
+  const instance = await instantiateWasm(loaded.module, imports);
+  return instance.exports;
+}
+
 /**
  * Preload WASM modules in parallel (for faster init)
  */
@@ -151,6 +211,43 @@ export function isWasmSupported(): boolean {
   return false;
 }
 
+let simdSupported: boolean | null = null;
+
+/**
+ * Check for SIMD128, by validating a function that returns a v128
+ */
+export function isWasmSimdSupported(): boolean {
+  if (simdSupported === null) {
+    try {
+      simdSupported = WebAssembly.validate(
+        new Uint8Array([
+          0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, // Header
+          0x01, 0x05, 0x01, 0x60, 0x00, 0x01, 0x7b, // Type: () -> v128
+          0x03, 0x02, 0x01, 0x00, // Function
+          0x0a, 0x0a, 0x01, 0x08, 0x00, 0x41, 0x00, 0xfd, 0x0f, 0xfd, 0x62, 0x0b, // i32.const 0; i8x16.splat; i8x16.popcnt
+        ])
+      );
+    } catch (e) {
+      simdSupported = false;
+    }
+  }
+  return simdSupported;
+}
+
+/**
+ * Check for shared memory; threaded builds also need a cross-origin
+ * isolated page to post it to workers
+ */
+export function isWasmThreadsSupported(): boolean {
+  if (typeof SharedArrayBuffer === 'undefined') return false;
+  if (typeof crossOriginIsolated !== 'undefined' && !crossOriginIsolated) return false;
+  try {
+    return new WebAssembly.Memory({ initial: 1, maximum: 1, shared: true }).buffer instanceof SharedArrayBuffer;
+  } catch (e) {
+    return false;
+  }
+}
+
 /**
  * Get WASM module cache stats
  */
@@ -0,0 +1,71 @@
+// Native Performance Counters
+// Hot-path counters for the native modules (lifter.cpp, wasm-codec.c),
+// read by JS through each module's get_counters() export as one fixed
+// NativeCounters struct (decoded by lib/performance/native-counters.ts).
+//
+// Counting is compiled in only with -DNATIVE_COUNTERS=1 (build-native-wasm.js
+// --counters); otherwise COUNTER_ADD expands to nothing, its arguments are
+// never evaluated, and get_counters() reports enabled = 0 with only the
+// allocator stats, which the arena keeps anyway.
+
+#pragma once
+
+#include <stdint.h>
+#include "wasm-arena.h"
+
+#ifndef NATIVE_COUNTERS
+#define NATIVE_COUNTERS 0
+#endif
+
+#define NATIVE_COUNTERS_VERSION 1
+
+// Lifted instruction classes, following the groups of IROpcode
+enum {
+    OPCLASS_ALU = 0,
+    OPCLASS_DATA = 1,
+    OPCLASS_MEMORY = 2,
+    OPCLASS_CONTROL = 3,
+    OPCLASS_SIMD = 4,
+    OPCLASS_SYSTEM = 5,
+    OPCLASS_UNKNOWN = 6,       // Decoder fallbacks: bytes the lifter could not classify
+    OPCLASS_SLOTS = 8          // Array size, padded; keep the layout below fixed
+};
+
+// 128 bytes, every field at a fixed offset; a new version only appends
+typedef struct {
+    uint32_t version;          // NATIVE_COUNTERS_VERSION
+    uint32_t enabled;          // Built with NATIVE_COUNTERS
+    uint64_t instructions[OPCLASS_SLOTS];  // Lifter: instructions decoded per class
+    uint64_t bytes_lifted;     // Lifter: bytes covered by decoded instructions
+    uint64_t matmul_flops;     // Codec: 2 per multiply-add in the layers
+    uint64_t blocks_encoded;   // Codec
+    uint64_t blocks_decoded;
+    uint64_t heap_live_bytes;  // The module's arena (every module's, when shared)
+    uint64_t heap_peak_bytes;  // High-water mark of heap_live_bytes
+    uint64_t heap_reserved_bytes;
+} NativeCounters;
+
+#if NATIVE_COUNTERS
+#define COUNTER_ADD(counters, field, n) ((counters).field += (uint64_t)(n))
+#else
+#define COUNTER_ADD(counters, field, n) ((void)0)
+#endif
+
+/**
+ * Fill `snapshot` from a module's live counters and its arena, then clear
+ * the live counters when `reset` is set (the arena keeps its own stats)
+ */
+static inline NativeCounters* counters_snapshot(NativeCounters* live, const WasmArena* arena,
+                                                NativeCounters* snapshot, int reset) {
+    *snapshot = *live;
+    snapshot->version = NATIVE_COUNTERS_VERSION;
+    snapshot->enabled = NATIVE_COUNTERS;
+    snapshot->heap_live_bytes = arena->stats.live_bytes;
+    snapshot->heap_peak_bytes = arena->stats.peak_live_bytes;
+    snapshot->heap_reserved_bytes = arena->stats.reserved_bytes;
+    if (reset) {
+        uint8_t* bytes = (uint8_t*)live;
+        for (size_t i = 0; i < sizeof(NativeCounters); i++) bytes[i] = 0;
+    }
+    return snapshot;
+}
@@ -0,0 +1,216 @@
+// Freestanding Shared Arena
+// Power-of-two size-class heap used by the native modules (lifter.cpp,
+// wasm-codec.c). Its state lives in linear memory, so modules instantiated
+// on one imported memory (lib/wasm/shared-memory.ts) allocate from the same
+// heap and can hand each other, and JS, blocks as (ptr, len) pairs with no
+// copies. C and C++; no stdlib in WASM builds.
+//
+// Blocks come from a bump region and return to a free list of their class,
+// so a steady workload keeps reusing the same blocks and memory only grows
+// to its peak working set. In WASM the bump region is the end of linear
+// memory, grown on demand; native builds draw it from the host allocator in
+// chunks, so heap stats match. A bounded arena's region stops at a fixed
+// limit instead: modules built for a shared memory define ARENA_HEAP_LIMIT
+// as the end of their window, so their own heap never reaches the next
+// module's data or the shared arena before they attach to it.
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef __wasm__
+#include <stdlib.h>
+#endif
+
+#define ARENA_MAGIC 0x414E5241u  // "ARNA"
+#define ARENA_MIN_SHIFT 5        // Smallest block: 32 bytes including the header
+#define ARENA_CLASSES 26         // Up to 1 GB blocks
+#define ARENA_HEADER 16          // Keeps payloads 16-byte aligned for v128 loads
+#define ARENA_WASM_PAGE 65536
+#define ARENA_NATIVE_CHUNK ((size_t)1 << 22)
+
+typedef struct {
+    uint64_t live_bytes;       // Block bytes (headers included) currently allocated
+    uint64_t peak_live_bytes;
+    uint64_t reserved_bytes;   // Bump region handed out to size classes so far
+    uint64_t allocations;      // Successful allocations
+    uint64_t frees;
+} HeapStats;
+
+typedef struct {
+    uint32_t magic;            // ARENA_MAGIC once initialized
+    uint32_t lock;             // Spinlock for threaded builds sharing the arena
+    uintptr_t top;             // Bump region [top, end)
+    uintptr_t end;
+    uintptr_t limit;           // Fixed end of the bump region, 0 when unbounded
+    void* free_lists[ARENA_CLASSES];
+    HeapStats stats;
+} WasmArena;
+
+#ifdef __wasm__
+#ifdef __cplusplus
+extern "C" unsigned char __heap_base;
+#else
+extern unsigned char __heap_base;
+#endif
+#endif
+
+/**
+ * Start an empty arena whose bump region begins at `base`. In WASM the
+ * region runs to the end of linear memory and grows with it; natively pass
+ * 0 to allocate host chunks on demand.
+ */
+static inline void arena_init(WasmArena* arena, uintptr_t base) {
+    uint8_t* bytes = (uint8_t*)arena;
+    for (size_t i = 0; i < sizeof(WasmArena); i++) bytes[i] = 0;
+    arena->top = (base + ARENA_HEADER - 1) & ~(uintptr_t)(ARENA_HEADER - 1);
+#ifdef __wasm__
+    arena->end = (uintptr_t)__builtin_wasm_memory_size(0) * ARENA_WASM_PAGE;
+#else
+    arena->end = arena->top;
+#endif
+    arena->magic = ARENA_MAGIC;
+}
+
+/**
+ * Start an empty arena over [base, limit) that never grows past `limit`.
+ * In WASM linear memory grows up to `limit` as needed; natively the caller
+ * owns the region.
+ */
+static inline void arena_init_bounded(WasmArena* arena, uintptr_t base, uintptr_t limit) {
+    arena_init(arena, base);
+    arena->limit = limit > arena->top ? limit : arena->top;
+#ifndef __wasm__
+    arena->end = arena->limit;
+#endif
+}
+
+/**
+ * A module's own arena over its heap (__heap_base in WASM, up to
+ * ARENA_HEAP_LIMIT when defined), initialized on first use
+ */
+static inline void arena_init_heap(WasmArena* arena) {
+    if (arena->magic == ARENA_MAGIC) return;
+#if defined(__wasm__) && defined(ARENA_HEAP_LIMIT)
+    arena_init_bounded(arena, (uintptr_t)&__heap_base, ARENA_HEAP_LIMIT);
+#elif defined(__wasm__)
+    arena_init(arena, (uintptr_t)&__heap_base);
+#else
+    arena_init(arena, 0);
+#endif
+}
+
+/**
+ * Arena whose header is at `arena` and whose bump region follows it, set up
+ * by whichever module attaches first. Every module on the memory attaches
+ * the same address.
+ */
+static inline WasmArena* arena_attach(WasmArena* arena) {
+    if (!arena) return 0;
+    if (arena->magic != ARENA_MAGIC) arena_init(arena, (uintptr_t)(arena + 1));
+    return arena;
+}
+
+static inline void arena_lock(WasmArena* arena) {
+    // Without the atomics feature these lower to plain loads and stores
+    while (__atomic_exchange_n(&arena->lock, 1u, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+static inline void arena_unlock(WasmArena* arena) {
+    __atomic_store_n(&arena->lock, 0u, __ATOMIC_RELEASE);
+}
+
+static inline int arena_size_class(size_t size) {
+    if (size > ((size_t)1 << (ARENA_MIN_SHIFT + ARENA_CLASSES - 1)) - ARENA_HEADER) return -1;
+    int c = 0;
+    while (((size_t)1 << (ARENA_MIN_SHIFT + c)) < size + ARENA_HEADER) c++;
+    return c;
+}
+
+#ifdef __wasm__
+// Another module may have grown the memory since `end` was last read
+static inline void* arena_bump(WasmArena* arena, size_t bytes) {
+    arena->end = (uintptr_t)__builtin_wasm_memory_size(0) * ARENA_WASM_PAGE;
+    if (arena->limit) {
+        if (bytes > arena->limit - arena->top) return 0;
+        if (arena->end > arena->limit) arena->end = arena->limit;
+    }
+    if (bytes > arena->end - arena->top) {
+        size_t pages = (bytes - (arena->end - arena->top) + ARENA_WASM_PAGE - 1) / ARENA_WASM_PAGE;
+        if (__builtin_wasm_memory_grow(0, pages) == (size_t)-1) return 0;
+        arena->end += pages * ARENA_WASM_PAGE;
+    }
+    void* block = (void*)arena->top;
+    arena->top += bytes;
+    arena->stats.reserved_bytes += bytes;
+    return block;
+}
+#else
+// Chunks are never returned to the host; the tail of a chunk too small for
+// the next block is abandoned, like the end of linear memory would be
+static inline void* arena_bump(WasmArena* arena, size_t bytes) {
+    if (bytes > arena->end - arena->top) {
+        if (arena->limit) return 0;
+        size_t chunk = bytes > ARENA_NATIVE_CHUNK ? bytes : ARENA_NATIVE_CHUNK;
+        uint8_t* region = (uint8_t*)malloc(chunk + ARENA_HEADER);
+        if (!region) return 0;
+        arena->top = ((uintptr_t)region + ARENA_HEADER - 1) & ~(uintptr_t)(ARENA_HEADER - 1);
+        arena->end = arena->top + chunk;
+    }
+    void* block = (void*)arena->top;
+    arena->top += bytes;
+    arena->stats.reserved_bytes += bytes;
+    return block;
+}
+#endif
+
+/**
+ * At least `size` bytes, 16-byte aligned, or NULL when memory cannot grow
+ */
+static inline void* arena_alloc(WasmArena* arena, size_t size) {
+    const int c = arena_size_class(size);
+    if (c < 0) return 0;
+    const size_t block_bytes = (size_t)1 << (ARENA_MIN_SHIFT + c);
+    arena_lock(arena);
+    uint8_t* block = (uint8_t*)arena->free_lists[c];
+    if (block) {
+        arena->free_lists[c] = *(void**)block;
+    } else {
+        block = (uint8_t*)arena_bump(arena, block_bytes);
+        if (!block) {
+            arena_unlock(arena);
+            return 0;
+        }
+    }
+    *(uint32_t*)block = (uint32_t)c;
+    arena->stats.allocations++;
+    arena->stats.live_bytes += block_bytes;
+    if (arena->stats.live_bytes > arena->stats.peak_live_bytes) arena->stats.peak_live_bytes = arena->stats.live_bytes;
+    arena_unlock(arena);
+    return block + ARENA_HEADER;
+}
+
+/**
+ * Return a block from any module on the same arena; NULL is ignored
+ */
+static inline void arena_free(WasmArena* arena, void* ptr) {
+    if (!ptr) return;
+    uint8_t* block = (uint8_t*)ptr - ARENA_HEADER;
+    const uint32_t c = *(uint32_t*)block;
+    arena_lock(arena);
+    *(void**)block = arena->free_lists[c];
+    arena->free_lists[c] = block;
+    arena->stats.frees++;
+    arena->stats.live_bytes -= (uint64_t)1 << (ARENA_MIN_SHIFT + c);
+    arena_unlock(arena);
+}
+
+/**
+ * Usable bytes of a block from arena_alloc
+ */
+static inline size_t arena_block_size(const void* ptr) {
+    const uint32_t c = *(const uint32_t*)((const uint8_t*)ptr - ARENA_HEADER);
+    return ((size_t)1 << (ARENA_MIN_SHIFT + c)) - ARENA_HEADER;
+}
@@ -0,0 +1,106 @@
+/**
+ * Shared Linear Memory - One WebAssembly.Memory imported by the native
+ * modules (lifter, neural codec), with the allocator arena of
+ * lib/wasm/native/wasm-arena.h above their static data. Buffers live in it
+ * as (ptr, len) slices, so one module's output is the next one's input and
+ * JS reads them through views, without copying bytes between memories.
+ */
+
+// Mirrors SHARED_ARENA_BASE and SHARED_MEMORY_PAGES in
+// scripts/build-native-wasm.js, which links each module's data and stack
+// into a window below the arena - keep in sync
+export const SHARED_ARENA_BASE = 0x100000;
+export const SHARED_MEMORY_PAGES = 16384;
+const INITIAL_PAGES = 256;
+
+/**
+ * `len` bytes at `ptr` in the shared memory. A slice stays valid until it
+ * is freed; views of it (view()) only until the memory next grows.
+ */
+export interface SharedSlice {
+  ptr: number;
+  len: number;
+}
+
+interface ArenaAllocator {
+  alloc(size: number): number;
+  free(ptr: number): void;
+}
+
+export class SharedLinearMemory {
+  readonly memory = new WebAssembly.Memory({ initial: INITIAL_PAGES, maximum: SHARED_MEMORY_PAGES });
+  private allocator: ArenaAllocator | null = null;
+  private modules = new Set<string>();
+
+  /**
+   * Import object for a module joining this memory
+   */
+  imports(name: string): WebAssembly.Imports {
+    return {
+      env: {
+        memory: this.memory,
+        abort: () => console.error(`[${name}] Aborted`),
+      },
+    };
+  }
+
+  /**
+   * Put a module instantiated with imports() on the shared arena, before it
+   * allocates anything. `memory` is the module's exported memory, if any: a
+   * build with its own memory is left alone. Its alloc/free serve alloc()
+   * when it is the first module attached. Returns false when not attached.
+   */
+  attach(
+    name: string,
+    memory: WebAssembly.Memory | undefined,
+    attachArena: (arena: number) => number,
+    allocator: ArenaAllocator
+  ): boolean {
+    if (memory !== undefined && memory !== this.memory) return false;
+    if (attachArena(SHARED_ARENA_BASE) !== 0) return false;
+    if (!this.allocator) this.allocator = allocator;
+    this.modules.add(name);
+    return true;
+  }
+
+  has(name: string): boolean {
+    return this.modules.has(name);
+  }
+
+  /**
+   * A block of `len` bytes from the arena, or null before any module is
+   * attached or when memory cannot grow
+   */
+  alloc(len: number): SharedSlice | null {
+    if (!this.allocator) return null;
+    const ptr = this.allocator.alloc(Math.max(len, 1));
+    return ptr ? { ptr, len } : null;
+  }
+
+  free(slice: SharedSlice): void {
+    this.allocator?.free(slice.ptr);
+  }
+
+  /**
+   * Copy `bytes` into a new slice: the one copy where data enters from JS
+   */
+  write(bytes: Uint8Array): SharedSlice | null {
+    const slice = this.alloc(bytes.length);
+    if (slice) this.view(slice).set(bytes);
+    return slice;
+  }
+
+  view(slice: SharedSlice): Uint8Array {
+    return new Uint8Array(this.memory.buffer, slice.ptr, slice.len);
+  }
+}
+
+let sharedMemory: SharedLinearMemory | null = null;
+
+/**
+ * The memory every native module of this page joins
+ */
+export function getSharedLinearMemory(): SharedLinearMemory {
+  if (!sharedMemory) sharedMemory = new SharedLinearMemory();
+  return sharedMemory;
+}
@@ -4,6 +4,7 @@
  */
 
 import { getCompressionPool, destroyCompressionPool } from './compression-pool';
+import { getParallelLifter, destroyParallelLifter, ParallelLifter } from '../transpiler/parallel-lifter';
 
 export interface WorkerStats {
   compression: {
@@ -16,6 +17,10 @@ export interface WorkerStats {
   animation: {
     initialized: boolean;
   };
+  lifting: {
+    workers: number;
+    busy: boolean;
+  };
   totalMemory: number;
 }
 
@@ -48,11 +53,19 @@ class WorkerManager {
     console.log('✅ WASM Worker Pool initialized');
   }
   
+  /**
+   * Lift worker pool (workers start on the first parallel lift)
+   */
+  getLiftPool(): ParallelLifter {
+    return getParallelLifter();
+  }
+
   /**
    * Get worker statistics
    */
   getStats(): WorkerStats {
     const compressionPool = getCompressionPool();
+    const liftPool = getParallelLifter();
     
     return {
       compression: {
@@ -65,6 +78,10 @@ class WorkerManager {
       animation: {
         initialized: true,
       },
+      lifting: {
+        workers: liftPool.size,
+        busy: liftPool.isBusy(),
+      },
       totalMemory: (performance as any).memory?.usedJSHeapSize || 0,
     };
   }
@@ -74,6 +91,7 @@ class WorkerManager {
    */
   destroy(): void {
     destroyCompressionPool();
+    destroyParallelLifter();
     this.initialized = false;
     console.log('🛑 WASM Worker Pool destroyed');
   }
@@ -0,0 +1,325 @@
+#!/usr/bin/env node
+
+// Builds the freestanding C/C++ modules (lifter, neural codec, sprite atlas
+// and their benchmarks) into public/wasm with clang's wasm32 target: -O3,
+// LTO, then wasm-opt when Binaryen is installed. Every module gets a
+// baseline build (name.wasm) and a SIMD128 build (name-simd.wasm); with
+// --threads, modules that support it also get name-simd-threads.wasm.
+// loadNativeWasmModule in lib/wasm/loader.ts picks the best variant the
+// engine supports.
+//
+// The lifter and sprite atlas need no C library. The codec and its bench
+// use memcpy, memset and libm, so they link against a WASI sysroot:
+// install wasi-sdk and set WASI_SDK_PATH (or WASI_SYSROOT).
+//
+// The lifter and codec builds import env.memory and link their data and
+// stack into fixed windows of it (SHARED_WINDOWS), so both can run on the
+// one memory created by lib/wasm/shared-memory.ts and allocate from the
+// arena (lib/wasm/native/wasm-arena.h) above the windows.
+//
+// --counters compiles in the hot-path counters behind each module's
+// get_counters() export (lib/wasm/native/native-counters.h); without it they
+// cost nothing.
+//
+// Usage: node scripts/build-native-wasm.js [--threads] [--counters] [--no-lto] [--no-wasm-opt] [--only=lifter,wasm-codec]
+
+const { execFileSync } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+const root = path.join(__dirname, '..');
+const publicWasmDir = path.join(root, 'public', 'wasm');
+
+const WASM_PAGE = 65536;
+
+// Shared memory layout, mirrored by lib/wasm/shared-memory.ts - keep in
+// sync. Each window holds one module's static data followed by its stack;
+// the arena header sits at SHARED_ARENA_BASE with the heap above it.
+const SHARED_WINDOWS = {
+  lifter: [0x10000, 0x80000],
+  'wasm-codec': [0x80000, 0xf0000],
+};
+const SHARED_ARENA_BASE = 0x100000;
+const SHARED_MEMORY_PAGES = 16384;
+const STACK_BYTES = 65536;
+
+const CODEC_EXPORTS = [
+  'malloc',
+  'free',
+  'encode',
+  'decode',
+  'encode_batch',
+  'decode_batch',
+  'encode_quantized_batch',
+  'decode_quantized_batch',
+  'init_model',
+  'codec_buffer',
+  'classify_blocks',
+  'rle_encode',
+  'rle_decode',
+  'cdc_chunk',
+  'fingerprint_chunks',
+  'codec_heap_stats',
+  'codec_attach_arena',
+  'get_counters',
+];
+
+const CODEC_THREAD_EXPORTS = ['codec_set_threads', 'codec_thread_stack', 'codec_worker', '__stack_pointer'];
+
+// exports: explicit export list; without one, every WASM_EXPORT symbol is
+// exported. memoryPages: import env.memory with this maximum (the size the
+// JS side creates) instead of exporting the module's own memory. shared:
+// link into the module's SHARED_WINDOWS entry.
+const modules = [
+  { name: 'lifter', source: 'lib/transpiler/cpp/lifter.cpp', memoryPages: SHARED_MEMORY_PAGES, shared: true },
+  { name: 'lifter-bench', source: 'lib/transpiler/cpp/lifter_bench.cpp' },
+  {
+    name: 'wasm-codec',
+    source: 'lib/nacho/storage/neural/wasm-codec.c',
+    libc: true,
+    exports: CODEC_EXPORTS,
+    memoryPages: SHARED_MEMORY_PAGES,
+    shared: true,
+    threads: true,
+  },
+  {
+    name: 'codec-bench',
+    source: 'lib/nacho/storage/neural/codec-bench.c',
+    libc: true,
+    exports: [...CODEC_EXPORTS, 'codec_bench'],
+    memoryPages: 16384,
+  },
+  { name: 'sprite-atlas', source: 'lib/ui/sprite-atlas/sprite-atlas.c' },
+];
+
+const args = process.argv.slice(2);
+const threads = args.includes('--threads');
+const counters = args.includes('--counters');
+const lto = !args.includes('--no-lto');
+const optimize = !args.includes('--no-wasm-opt');
+const onlyArg = args.find((arg) => arg.startsWith('--only='));
+const only = onlyArg ? onlyArg.slice('--only='.length).split(',') : null;
+
+const wasiSdk = process.env.WASI_SDK_PATH;
+const sysroot = process.env.WASI_SYSROOT || (wasiSdk ? path.join(wasiSdk, 'share', 'wasi-sysroot') : null);
+const clang = wasiSdk ? path.join(wasiSdk, 'bin', 'clang') : 'clang';
+const clangxx = wasiSdk ? path.join(wasiSdk, 'bin', 'clang++') : 'clang++';
+
+function run(command, commandArgs) {
+  execFileSync(command, commandArgs, { cwd: root, stdio: ['ignore', 'inherit', 'inherit'] });
+}
+
+function succeeds(command, commandArgs) {
+  try {
+    execFileSync(command, commandArgs, { stdio: 'ignore' });
+    return true;
+  } catch (error) {
+    return false;
+  }
+}
+
+// clang must have the wasm32 backend and find wasm-ld
+function probeClang() {
+  const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'native-wasm-'));
+  const source = path.join(dir, 'probe.c');
+  fs.writeFileSync(source, 'int probe(void) { return 0; }\n');
+  const ok = succeeds(clang, [
+    '--target=wasm32',
+    '-nostdlib',
+    '-Wl,--no-entry',
+    '-Wl,--export-all',
+    source,
+    '-o',
+    path.join(dir, 'probe.wasm'),
+  ]);
+  fs.rmSync(dir, { recursive: true, force: true });
+  return ok;
+}
+
+function variantsOf(module) {
+  const variants = [
+    { suffix: '', flags: [] },
+    { suffix: '-simd', flags: ['-msimd128'] },
+  ];
+  if (threads && module.threads) {
+    variants.push({ suffix: '-simd-threads', flags: ['-msimd128', '-matomics'], threads: true });
+  }
+  return variants;
+}
+
+function compileArgs(module, variant) {
+  const cxx = module.source.endsWith('.cpp');
+  const flags = ['-O3', '-fvisibility=hidden', ...variant.flags];
+  // memcpy/memset lower to memory.copy/memory.fill rather than libc calls
+  flags.push('-mbulk-memory');
+  if (cxx) flags.push('-std=c++17', '-fno-exceptions', '-fno-rtti');
+  if (counters) flags.push('-DNATIVE_COUNTERS=1');
+  if (lto) flags.push('-flto', '-Wl,--lto-O3');
+
+  if (module.libc) {
+    const target = variant.threads ? 'wasm32-wasip1-threads' : 'wasm32-wasip1';
+    flags.push(`--target=${target}`, `--sysroot=${sysroot}`, '-nostartfiles');
+  } else {
+    flags.push('--target=wasm32', '-nostdlib');
+  }
+
+  flags.push('-Wl,--no-entry', '-Wl,--strip-debug');
+  if (module.exports) {
+    const exports = variant.threads ? [...module.exports, ...CODEC_THREAD_EXPORTS] : module.exports;
+    for (const name of exports) flags.push(`-Wl,--export=${name}`);
+  } else {
+    flags.push('-Wl,--export-dynamic', '-Wl,--export=__heap_base');
+  }
+  if (module.memoryPages) {
+    flags.push('-Wl,--import-memory', `-Wl,--max-memory=${module.memoryPages * WASM_PAGE}`);
+    if (!module.exports) flags.push('-Wl,--export-memory');
+    if (variant.threads) flags.push('-Wl,--shared-memory');
+  }
+  if (module.shared) {
+    // Until it attaches to the shared arena, the module's own heap stays in its window
+    flags.push(`-DARENA_HEAP_LIMIT=0x${SHARED_WINDOWS[module.name][1].toString(16)}`);
+    // The stack goes after the data, inside the window; older wasm-ld put it first
+    flags.push(`-Wl,--global-base=${SHARED_WINDOWS[module.name][0]}`, '-Wl,--no-stack-first', `-Wl,-z,stack-size=${STACK_BYTES}`);
+    flags.push('-Wl,--export=__data_end', '-Wl,--export=__heap_base');
+  }
+  return { compiler: cxx ? clangxx : clang, flags };
+}
+
+function readLeb(bytes, at) {
+  let value = 0;
+  let shift = 0;
+  let byte;
+  do {
+    byte = bytes[at++];
+    value += (byte & 0x7f) * 2 ** shift;
+    shift += 7;
+  } while (byte & 0x80);
+  return [value, at];
+}
+
+// Initial values of the exported i32.const globals of a module
+function exportedGlobals(bytes) {
+  const inits = [];
+  const exports = {};
+  let importedGlobals = 0;
+  let at = 8;
+  while (at < bytes.length) {
+    const id = bytes[at];
+    let size;
+    [size, at] = readLeb(bytes, at + 1);
+    const end = at + size;
+    let count;
+    let p;
+    if (id === 2 || id === 6 || id === 7) [count, p] = readLeb(bytes, at);
+    for (let i = 0; id === 2 && i < count; i++) {
+      // Imports: skip module and field names, then the descriptor
+      for (let name = 0; name < 2; name++) {
+        let length;
+        [length, p] = readLeb(bytes, p);
+        p += length;
+      }
+      const kind = bytes[p++];
+      if (kind === 0) [, p] = readLeb(bytes, p);
+      else if (kind === 1) p = skipLimits(bytes, p + 1);
+      else if (kind === 2) p = skipLimits(bytes, p);
+      else if (kind === 3) {
+        p += 2;
+        importedGlobals++;
+      }
+    }
+    for (let i = 0; id === 6 && i < count; i++) {
+      p += 2; // Type and mutability
+      let value = null;
+      if (bytes[p] === 0x41) {
+        let raw;
+        [raw, p] = readLeb(bytes, p + 1);
+        value = raw;
+      }
+      while (bytes[p] !== 0x0b) p++;
+      p++;
+      inits.push(value);
+    }
+    for (let i = 0; id === 7 && i < count; i++) {
+      let length;
+      [length, p] = readLeb(bytes, p);
+      const name = Buffer.from(bytes.subarray(p, p + length)).toString('utf8');
+      p += length;
+      const kind = bytes[p++];
+      let index;
+      [index, p] = readLeb(bytes, p);
+      if (kind === 3) exports[name] = index;
+    }
+    at = end;
+  }
+  const values = {};
+  for (const [name, index] of Object.entries(exports)) values[name] = inits[index - importedGlobals] ?? null;
+  return values;
+}
+
+function skipLimits(bytes, p) {
+  const flags = bytes[p++];
+  [, p] = readLeb(bytes, p);
+  if (flags & 1) [, p] = readLeb(bytes, p);
+  return p;
+}
+
+// Asserts the layout compileArgs asks for: data and stack end inside the
+// module's window, with the stack after the data (a stack-first layout would
+// put every module's stack at 0)
+function checkWindow(module, output) {
+  const [start, end] = SHARED_WINDOWS[module.name];
+  const { __data_end: dataEnd, __heap_base: heapBase } = exportedGlobals(fs.readFileSync(output));
+  if (dataEnd == null || heapBase == null) throw new Error('__data_end/__heap_base not exported');
+  if (heapBase - dataEnd < STACK_BYTES) throw new Error('stack is not placed after the data despite --no-stack-first');
+  if (heapBase > end) {
+    throw new Error(`data and stack end at 0x${heapBase.toString(16)}, past the window 0x${start.toString(16)}-0x${end.toString(16)}`);
+  }
+}
+
+if (!probeClang()) {
+  console.log('⚠️  clang with the wasm32 target (and wasm-ld) not found. Install LLVM or wasi-sdk:');
+  console.log('   https://github.com/WebAssembly/wasi-sdk/releases (then set WASI_SDK_PATH)');
+  console.log('⏭️  Skipping native WASM build (will use JS fallbacks)');
+  process.exit(0);
+}
+
+const haveSysroot = sysroot && fs.existsSync(sysroot);
+const haveWasmOpt = optimize && succeeds('wasm-opt', ['--version']);
+if (optimize && !haveWasmOpt) console.log('⚠️  wasm-opt not found; modules stay as linked (install binaryen)');
+
+if (!fs.existsSync(publicWasmDir)) {
+  fs.mkdirSync(publicWasmDir, { recursive: true });
+}
+
+console.log('🔧 Building native WASM modules...\n');
+
+let built = 0;
+for (const module of modules) {
+  if (only && !only.includes(module.name)) continue;
+  if (module.libc && !haveSysroot) {
+    console.log(`⏭️  Skipping ${module.name} (needs a WASI sysroot; set WASI_SDK_PATH or WASI_SYSROOT)`);
+    continue;
+  }
+
+  for (const variant of variantsOf(module)) {
+    const output = path.join(publicWasmDir, `${module.name}${variant.suffix}.wasm`);
+    const { compiler, flags } = compileArgs(module, variant);
+    console.log(`📦 Building ${path.basename(output)}...`);
+    try {
+      run(compiler, [...flags, path.join(root, module.source), '-o', output]);
+      if (module.shared) checkWindow(module, output);
+      if (haveWasmOpt) {
+        // Features come from the target_features section clang writes
+        run('wasm-opt', ['-O3', output, '-o', output]);
+      }
+      console.log(`✅ ${path.basename(output)} (${fs.statSync(output).size} bytes)\n`);
+      built++;
+    } catch (error) {
+      console.error(`❌ Failed to build ${path.basename(output)}:`, error.message);
+      process.exit(1);
+    }
+  }
+}
+
+console.log(`✨ Built ${built} native WASM modules`);
@@ -0,0 +1,247 @@
+#!/usr/bin/env node
+
+// Packs the Piskel C exports in lib/ui/sprite-atlas/piskel into the sprite
+// atlas (format in lib/ui/sprite-atlas/sprite-atlas.h), with each frame's
+// bounding box and per-row opaque spans, and writes it twice: as
+// sprite-atlas-data.h for the WASM module and as sprite-atlas-data.ts for
+// the JS decoder. Each export becomes one sprite named after its file.
+//
+// Usage: node scripts/pack-sprite-atlas.js
+// Required as a module it only exports the packer.
+
+const fs = require('fs');
+const path = require('path');
+
+const atlasDir = path.join(__dirname, '..', 'lib', 'ui', 'sprite-atlas');
+const piskelDir = path.join(atlasDir, 'piskel');
+const headerFile = path.join(atlasDir, 'sprite-atlas-data.h');
+const moduleFile = path.join(atlasDir, 'sprite-atlas-data.ts');
+
+const ATLAS_MAGIC = 0x31415053; // "SPA1"
+const HEADER_BYTES = 8;
+const ENTRY_BYTES = 20;
+const PALETTE_WORDS = 16;
+const LITERAL = 0x80;
+const MAX_RUN = 128;
+const MIN_SKIP = 3; // Shorter transparent gaps stay inside a literal run
+const MAX_DIM = 255; // Boxes and spans are stored as bytes
+
+function parsePiskel(file) {
+  const source = fs.readFileSync(file, 'utf8');
+  const define = (name) => {
+    const match = source.match(new RegExp(`#define\\s+\\w*_${name}\\s+(\\d+)`));
+    if (!match) throw new Error(`${file}: missing *_${name}`);
+    return Number(match[1]);
+  };
+  const frameCount = define('FRAME_COUNT');
+  const width = define('FRAME_WIDTH');
+  const height = define('FRAME_HEIGHT');
+  if (width > MAX_DIM || height > MAX_DIM) throw new Error(`${file}: frames over ${MAX_DIM} pixels`);
+
+  const body = source.slice(source.indexOf('= {'));
+  const pixels = (body.match(/0x[0-9a-fA-F]{8}/g) || []).map((hex) => parseInt(hex, 16) >>> 0);
+  if (pixels.length !== frameCount * width * height) {
+    throw new Error(`${file}: expected ${frameCount * width * height} pixels, found ${pixels.length}`);
+  }
+  const frames = [];
+  for (let f = 0; f < frameCount; f++) {
+    frames.push(pixels.slice(f * width * height, (f + 1) * width * height));
+  }
+  return { name: path.basename(file, '.c'), width, height, frames };
+}
+
+// Alpha is the top byte of Piskel's 0xAABBGGRR words
+const isTransparent = (pixel) => pixel >>> 24 === 0;
+
+function buildPalette(sprite) {
+  const palette = [0];
+  const index = new Map([[0, 0]]);
+  for (const frame of sprite.frames) {
+    for (const pixel of frame) {
+      if (isTransparent(pixel) || index.has(pixel)) continue;
+      if (palette.length === PALETTE_WORDS) {
+        throw new Error(`${sprite.name}: more than ${PALETTE_WORDS - 1} opaque colours`);
+      }
+      index.set(pixel, palette.length);
+      palette.push(pixel);
+    }
+  }
+  return { palette, index };
+}
+
+// Row tokens: transparent gaps of MIN_SKIP or more (or at either end) become
+// skips, everything else literal runs of 4-bit indices
+function encodeRow(row, index, out) {
+  let x = 0;
+  while (x < row.length) {
+    let gap = 0;
+    while (x + gap < row.length && isTransparent(row[x + gap])) gap++;
+    if (gap && (gap >= MIN_SKIP || x === 0 || x + gap === row.length)) {
+      for (let left = gap; left > 0; left -= MAX_RUN) out.push(Math.min(left, MAX_RUN) - 1);
+      x += gap;
+      continue;
+    }
+
+    let end = x + gap;
+    while (end < row.length && end - x < MAX_RUN) {
+      let ahead = 0;
+      while (end + ahead < row.length && isTransparent(row[end + ahead])) ahead++;
+      if (ahead >= MIN_SKIP || end + ahead === row.length) break;
+      end += Math.max(ahead, 1);
+    }
+    end = Math.min(end, x + MAX_RUN);
+
+    const run = end - x;
+    out.push(LITERAL | (run - 1));
+    for (let i = 0; i < run; i += 2) {
+      const lo = isTransparent(row[x + i]) ? 0 : index.get(row[x + i]);
+      const hi = i + 1 < run && !isTransparent(row[x + i + 1]) ? index.get(row[x + i + 1]) : 0;
+      out.push(lo | (hi << 4));
+    }
+    x = end;
+  }
+}
+
+// Opaque extent of each row ([start, end), 0/0 when empty) and the frame's
+// bounding box
+function frameBounds(sprite, frame) {
+  const spans = [];
+  let x0 = sprite.width, y0 = sprite.height, x1 = 0, y1 = 0;
+  for (let y = 0; y < sprite.height; y++) {
+    const row = frame.slice(y * sprite.width, (y + 1) * sprite.width);
+    const start = row.findIndex((pixel) => !isTransparent(pixel));
+    if (start < 0) {
+      spans.push([0, 0]);
+      continue;
+    }
+    let end = row.length;
+    while (isTransparent(row[end - 1])) end--;
+    spans.push([start, end]);
+    x0 = Math.min(x0, start);
+    x1 = Math.max(x1, end);
+    y0 = Math.min(y0, y);
+    y1 = y + 1;
+  }
+  return y1 ? { x0, y0, x1, y1, spans: spans.slice(y0, y1) } : { x0: 0, y0: 0, x1: 0, y1: 0, spans: [] };
+}
+
+// Box, spans of the box rows, then the tokens of the box rows
+function encodeFrame(sprite, frame, index) {
+  const { x0, y0, x1, y1, spans } = frameBounds(sprite, frame);
+  const out = [x0, y0, x1, y1];
+  for (const [start, end] of spans) out.push(start, end);
+  for (let y = y0; y < y1; y++) {
+    encodeRow(frame.slice(y * sprite.width, (y + 1) * sprite.width), index, out);
+  }
+  return out;
+}
+
+function packAtlas(sprites) {
+  const bytes = [];
+  const align4 = () => {
+    while (bytes.length & 3) bytes.push(0);
+  };
+  const u16 = (at, value) => {
+    bytes[at] = value & 0xff;
+    bytes[at + 1] = (value >>> 8) & 0xff;
+  };
+  const u32 = (at, value) => {
+    for (let i = 0; i < 4; i++) bytes[at + i] = (value >>> (8 * i)) & 0xff;
+  };
+  const pushU32 = (value) => {
+    bytes.push(0, 0, 0, 0);
+    u32(bytes.length - 4, value);
+  };
+
+  pushU32(ATLAS_MAGIC);
+  pushU32(sprites.length);
+  for (let i = 0; i < sprites.length * ENTRY_BYTES; i++) bytes.push(0);
+
+  sprites.forEach((sprite, s) => {
+    const entry = HEADER_BYTES + s * ENTRY_BYTES;
+    const { palette, index } = buildPalette(sprite);
+
+    u32(entry, bytes.length);
+    for (const ch of Buffer.from(sprite.name, 'utf8')) bytes.push(ch);
+    bytes.push(0);
+    align4();
+
+    u16(entry + 4, sprite.width);
+    u16(entry + 6, sprite.height);
+    u16(entry + 8, sprite.frames.length);
+    u16(entry + 10, palette.length);
+    u32(entry + 12, bytes.length);
+    for (let i = 0; i < PALETTE_WORDS; i++) pushU32(palette[i] || 0);
+
+    u32(entry + 16, bytes.length);
+    const streams = sprite.frames.map((frame) => encodeFrame(sprite, frame, index));
+    let offset = 0;
+    for (const stream of streams) {
+      pushU32(offset);
+      offset += stream.length;
+    }
+    pushU32(offset);
+    for (const stream of streams) bytes.push(...stream);
+    align4();
+  });
+  return Uint8Array.from(bytes);
+}
+
+function emitHeader(atlas, sprites, summary) {
+  const maxPixels = Math.max(...sprites.map((s) => s.width * s.height));
+  const lines = [];
+  for (let i = 0; i < atlas.length; i += 16) {
+    lines.push(
+      '    ' +
+        Array.from(atlas.subarray(i, i + 16), (b) => `0x${b.toString(16).padStart(2, '0')}`).join(', ') +
+        ','
+    );
+  }
+  return `// Generated by scripts/pack-sprite-atlas.js from lib/ui/sprite-atlas/piskel - do not edit
+// ${summary}
+
+#pragma once
+
+#define SPRITE_ATLAS_MAX_PIXELS ${maxPixels}
+
+static const uint8_t sprite_atlas_data[${atlas.length}] __attribute__((aligned(4))) = {
+${lines.join('\n')}
+};
+`;
+}
+
+function emitModule(atlas, summary) {
+  const base64 = Buffer.from(atlas).toString('base64');
+  const lines = [];
+  for (let i = 0; i < base64.length; i += 96) lines.push(`  '${base64.slice(i, i + 96)}'`);
+  return `// Generated by scripts/pack-sprite-atlas.js from lib/ui/sprite-atlas/piskel - do not edit
+// ${summary}
+
+// The same bytes as sprite_atlas_data in sprite-atlas-data.h, base64 encoded
+export const SPRITE_ATLAS_BASE64 =
+${lines.join(' +\n')};
+`;
+}
+
+function main() {
+  const sprites = fs
+    .readdirSync(piskelDir)
+    .filter((file) => file.endsWith('.c'))
+    .sort()
+    .map((file) => parsePiskel(path.join(piskelDir, file)));
+
+  const atlas = packAtlas(sprites);
+  const summary = sprites.map((s) => `${s.name} ${s.width}x${s.height}x${s.frames.length}`).join(', ');
+  fs.writeFileSync(headerFile, emitHeader(atlas, sprites, summary));
+  fs.writeFileSync(moduleFile, emitModule(atlas, summary));
+
+  const rawBytes = sprites.reduce((sum, s) => sum + s.frames.length * s.width * s.height * 4, 0);
+  console.log(
+    `Packed ${sprites.length} sprites: ${atlas.length} bytes (raw RGBA ${rawBytes} bytes, ${(rawBytes / atlas.length).toFixed(1)}x)`
+  );
+}
+
+// The tests pack their own sprites and read the Piskel sources back
+module.exports = { piskelDir, parsePiskel, packAtlas };
+
+if (require.main === module) main();
@@ -6,6 +6,22 @@
  * 45. WASM shared memory for multi-threaded subsystems.
  */
 
+import {
+    emitNativeModule,
+    initNativeLifter,
+    liftBlockToWasm,
+    NATIVE_IR_STRIDE,
+    NativeArch,
+    NativeImage,
+    optimizeNativeRecords,
+} from '@/lib/transpiler/native-lifter';
+
+/**
+ * Translated guest block: runs against the guest state at `state` and
+ * returns the next guest PC
+ */
+export type GuestBlockFn = (state: number) => bigint;
+
 export class TieredWasmJit {
     private baselineCache: Map<string, WebAssembly.Module> = new Map();
     private optimizedCache: Map<string, WebAssembly.Module> = new Map();
@@ -25,6 +41,41 @@ export class TieredWasmJit {
         return await WebAssembly.instantiate(wasmModule);
     }
 
+    /**
+     * Compile a guest basic block straight from machine code: the native
+     * lifter decodes and emits the WASM module in one call, with no IR
+     * objects in JS. Returns null when the native lifter is unavailable or
+     * cannot translate the block's first instruction.
+     */
+    async compileGuestBlock(
+        id: string,
+        code: Uint8Array,
+        entryPoint: number,
+        arch: NativeArch,
+        memory: WebAssembly.Memory,
+        guestBase: number = 0
+    ): Promise<GuestBlockFn | null> {
+        let wasmModule = this.baselineCache.get(id);
+        if (!wasmModule) {
+            if (!(await initNativeLifter())) return null;
+            const shared = typeof SharedArrayBuffer !== 'undefined' && memory.buffer instanceof SharedArrayBuffer;
+            const bytes = liftBlockToWasm(code, entryPoint, arch, { guestBase, sharedMemory: shared });
+            if (!bytes) return null;
+            wasmModule = await WebAssembly.compile(bytes);
+            this.baselineCache.set(id, wasmModule);
+        }
+        const instance = await WebAssembly.instantiate(wasmModule, { env: { memory } });
+        return instance.exports.run as GuestBlockFn;
+    }
+
+    /**
+     * Lazy tier over guest code in `options.memory`: blocks are translated
+     * only when execution first reaches them (see LazyBlockTier)
+     */
+    createLazyTier(options: LazyTierOptions): LazyBlockTier {
+        return new LazyBlockTier(options);
+    }
+
     /**
      * Record execution usage to trigger Tier 2
      */
@@ -65,3 +116,340 @@ export class TieredWasmJit {
         // If assumption fails (trap), we would fallback to baseline
     }
 }
+
+export interface LazyTierOptions {
+    arch: NativeArch;
+    memory: WebAssembly.Memory; // Guest memory, imported by every block as env.memory
+    guestBase?: number; // Linear memory offset of guest address 0
+    window?: number; // Guest code bytes handed to the lifter per translation
+    hotThreshold?: number; // Executions before the optimized retranslation
+    capacity?: number; // Cached blocks before the cache is flushed
+    // Linear offset of a dirtyPages-byte map the blocks' stores mark; by
+    // default the tier grows `memory` by one page (65536 map entries) for it
+    dirtyMap?: number;
+    dirtyPages?: number; // Power of two
+}
+
+export interface LazyTierStats {
+    blocks: number;
+    translations: number;
+    promotions: number;
+    invalidations: number;
+    flushes: number;
+    lookups: number; // Hash table lookups
+    chained: number; // Dispatches that followed a chain link instead
+    untranslatable: number; // PCs whose first instruction has no translation
+}
+
+interface TranslationBlock {
+    pc: number;
+    end: number; // Guest address past the last instruction
+    run: GuestBlockFn;
+    source: Uint8Array; // Guest bytes it was translated from
+    executions: number;
+    optimized: boolean;
+    valid: boolean;
+    slots: number[]; // Dirty map entries of the pages it covers
+    // Successors seen at run time, followed without a lookup next time
+    links: { pc: number; block: TranslationBlock }[];
+}
+
+// Pages index blocks by the guest bytes they cover, for invalidation;
+// division rather than shifts keeps 64-bit guest addresses intact. The
+// page size is the emitter's dirty map granularity.
+const TB_PAGE_BYTES = 4096;
+const TB_MAX_LINKS = 2;
+const WASM_PAGE_BYTES = 65536;
+
+/**
+ * Lazy translation tier: the block at the guest PC is lifted, emitted and
+ * compiled on first execution, then cached by guest address. Dispatch
+ * follows per-block chain links to the successors seen so far, so hot
+ * loops skip the hash table. Blocks executed hotThreshold times are
+ * retranslated from a CFG-wide lift (flag results no successor reads are
+ * dropped) and swapped in place.
+ *
+ * Emitted blocks store to guest memory directly and mark the pages they
+ * write in a dirty map; before a block runs, a marked page it covers has
+ * its blocks' bytes compared and the changed ones dropped, so code patched
+ * by translated code is retranslated. Writes made outside translated code
+ * (the caller's interpreter, DMA) must still be reported through hasCode
+ * and invalidate.
+ */
+export class LazyBlockTier {
+    private blocks: Map<number, TranslationBlock> = new Map();
+    // By dirty map entry, so pages that alias in the map share a set
+    private pages: Map<number, Set<TranslationBlock>> = new Map();
+    private untranslatable: Set<number> = new Set();
+    private stats: LazyTierStats = {
+        blocks: 0, translations: 0, promotions: 0, invalidations: 0,
+        flushes: 0, lookups: 0, chained: 0, untranslatable: 0,
+    };
+    private readonly arch: NativeArch;
+    private readonly memory: WebAssembly.Memory;
+    private readonly guestBase: number;
+    private readonly window: number;
+    private readonly hotThreshold: number;
+    private readonly capacity: number;
+    private readonly sharedMemory: boolean;
+    private readonly dirtyMap: number;
+    private readonly dirtyPages: number;
+    private dirty: Uint8Array;
+
+    constructor(options: LazyTierOptions) {
+        this.arch = options.arch;
+        this.memory = options.memory;
+        this.guestBase = options.guestBase ?? 0;
+        this.window = options.window ?? 4096;
+        this.hotThreshold = options.hotThreshold ?? 100;
+        this.capacity = options.capacity ?? 1 << 16;
+        this.sharedMemory = typeof SharedArrayBuffer !== 'undefined' && this.memory.buffer instanceof SharedArrayBuffer;
+        this.dirtyPages = options.dirtyPages ?? WASM_PAGE_BYTES;
+        if ((this.dirtyPages & (this.dirtyPages - 1)) !== 0 || this.dirtyPages <= 0) {
+            throw new Error('LazyBlockTier: dirtyPages must be a power of two');
+        }
+        if (options.dirtyMap !== undefined) {
+            this.dirtyMap = options.dirtyMap;
+        } else {
+            // Past the guest's memory; RangeError when it cannot grow
+            this.dirtyMap = this.memory.grow(Math.ceil(this.dirtyPages / WASM_PAGE_BYTES)) * WASM_PAGE_BYTES;
+        }
+        this.dirty = new Uint8Array(this.memory.buffer, this.dirtyMap, this.dirtyPages);
+    }
+
+    /**
+     * Run translated blocks from `pc` against the guest state at `state`
+     * until execution reaches code with no translation or `maxBlocks` have
+     * run. Returns the guest PC to continue at: the caller interprets the
+     * instruction there, then calls execute again.
+     */
+    async execute(state: number, pc: number, maxBlocks: number = 1 << 16): Promise<number> {
+        if (!(await initNativeLifter())) return pc;
+        let prev: TranslationBlock | null = null;
+        for (let n = 0; n < maxBlocks; n++) {
+            let block = prev ? this.follow(prev, pc) : null;
+            if (block && this.checkDirty(block)) {
+                this.stats.chained++;
+            } else {
+                this.stats.lookups++;
+                block = this.blocks.get(pc) ?? null;
+                if (block && !this.checkDirty(block)) block = null;
+                block ??= await this.translate(pc, false);
+                if (!block) return pc;
+                if (prev?.valid) this.link(prev, block);
+            }
+
+            const next = Number(block.run(state));
+            if (++block.executions === this.hotThreshold && !block.optimized) void this.promote(block);
+            prev = block;
+            pc = next;
+        }
+        return pc;
+    }
+
+    /**
+     * Whether a cached block was translated from the page holding `address`;
+     * a cheap filter for the write path before calling invalidate
+     */
+    hasCode(address: number): boolean {
+        return this.pages.has(this.slotOf(pageOf(address)));
+    }
+
+    /**
+     * Drop every block translated from bytes in [address, address + length),
+     * after guest code there was overwritten
+     */
+    invalidate(address: number, length: number = 1) {
+        const end = address + length;
+        for (let page = pageOf(address); page <= pageOf(end - 1); page++) {
+            const blocks = this.pages.get(this.slotOf(page));
+            if (!blocks) continue;
+            for (const block of Array.from(blocks)) {
+                if (block.pc < end && block.end > address) this.drop(block);
+            }
+        }
+        // A write may also make a failed PC translatable
+        for (const pc of Array.from(this.untranslatable)) {
+            if (pc >= address && pc < end) this.untranslatable.delete(pc);
+        }
+    }
+
+    /**
+     * Drop every block (e.g. on a guest address-space switch)
+     */
+    flush() {
+        this.blocks.forEach((block) => (block.valid = false));
+        this.blocks.clear();
+        this.pages.clear();
+        this.untranslatable.clear();
+        this.stats.flushes++;
+    }
+
+    getStats(): LazyTierStats {
+        return { ...this.stats, blocks: this.blocks.size, untranslatable: this.untranslatable.size };
+    }
+
+    /**
+     * Whether `block` may run: a page it covers that a translated store
+     * marked has the bytes of its blocks compared first, and the changed
+     * ones dropped
+     */
+    private checkDirty(block: TranslationBlock): boolean {
+        const dirty = this.dirtyView();
+        for (const slot of block.slots) {
+            if (dirty[slot]) this.revalidate(slot);
+        }
+        return block.valid;
+    }
+
+    private revalidate(slot: number) {
+        this.dirtyView()[slot] = 0;
+        const blocks = this.pages.get(slot);
+        for (const block of blocks ? Array.from(blocks) : []) {
+            if (!sameBytes(this.guestBytes(block.pc, block.source.length), block.source)) this.drop(block);
+        }
+        // A patch may also make a failed PC translatable
+        for (const pc of Array.from(this.untranslatable)) {
+            if (this.slotOf(pageOf(pc)) === slot) this.untranslatable.delete(pc);
+        }
+    }
+
+    // Re-viewed when the memory has grown (detaching or replacing its buffer)
+    private dirtyView(): Uint8Array {
+        if (this.dirty.buffer !== this.memory.buffer) {
+            this.dirty = new Uint8Array(this.memory.buffer, this.dirtyMap, this.dirtyPages);
+        }
+        return this.dirty;
+    }
+
+    private slotOf(page: number): number {
+        return page % this.dirtyPages;
+    }
+
+    // Chain links are checked for validity here, so dropping a block never
+    // has to find the blocks that link to it
+    private follow(prev: TranslationBlock, pc: number): TranslationBlock | null {
+        for (const link of prev.links) {
+            if (link.pc === pc && link.block.valid) return link.block;
+        }
+        return null;
+    }
+
+    private link(prev: TranslationBlock, block: TranslationBlock) {
+        prev.links = prev.links.filter((link) => link.block.valid);
+        if (prev.links.length >= TB_MAX_LINKS) prev.links.shift();
+        prev.links.push({ pc: block.pc, block });
+    }
+
+    // Guest code from `pc` up to `length` bytes, or to the end of memory
+    private guestBytes(pc: number, length: number = this.window): Uint8Array {
+        const start = this.guestBase + pc;
+        const end = Math.min(start + length, this.memory.buffer.byteLength);
+        return start < end ? new Uint8Array(this.memory.buffer.slice(start, end)) : new Uint8Array(0);
+    }
+
+    // The baseline translation (same lift and peephole pass as
+    // liftBlockToWasm), or with `optimized` the CFG-wide one
+    private async translate(pc: number, optimized: boolean): Promise<TranslationBlock | null> {
+        if (this.untranslatable.has(pc)) return null;
+        const code = this.guestBytes(pc);
+        const image = code.length ? NativeImage.load(code, pc, this.arch) : null;
+        if (!image) return null;
+
+        let records: Uint8Array;
+        try {
+            // Copied out: each lifter call may grow its memory
+            records = optimized
+                ? image.liftOptimizedBlockRecords(pc).slice()
+                : image.liftBlockRecords(pc).slice();
+        } finally {
+            image.release();
+        }
+        if (!optimized && records.length) records = optimizeNativeRecords(records, this.arch)?.slice() ?? records;
+        const bytes = emitNativeModule(records, this.arch, {
+            guestBase: this.guestBase,
+            sharedMemory: this.sharedMemory,
+            dirtyMap: this.dirtyMap,
+            dirtyPages: this.dirtyPages,
+        });
+        if (!bytes) {
+            if (!optimized) this.untranslatable.add(pc);
+            return null;
+        }
+
+        const wasmModule = await WebAssembly.compile(bytes);
+        const instance = await WebAssembly.instantiate(wasmModule, { env: { memory: this.memory } });
+        this.stats.translations++;
+        const view = new DataView(records.buffer, records.byteOffset, records.byteLength);
+        const last = records.length - NATIVE_IR_STRIDE;
+        const end = Number(view.getBigUint64(last + 8, true)) + view.getUint8(last + 16);
+        const block: TranslationBlock = {
+            pc,
+            end,
+            run: instance.exports.run as GuestBlockFn,
+            source: code.slice(0, end - pc),
+            executions: 0,
+            optimized,
+            valid: true,
+            slots: [],
+            links: [],
+        };
+        for (let page = pageOf(pc); page <= pageOf(end - 1); page++) {
+            const slot = this.slotOf(page);
+            if (!block.slots.includes(slot)) block.slots.push(slot);
+        }
+        if (!optimized) this.insert(block);
+        return block;
+    }
+
+    private insert(block: TranslationBlock) {
+        // Another execute() may have translated the same PC meanwhile
+        const existing = this.blocks.get(block.pc);
+        if (existing) this.drop(existing);
+        if (this.blocks.size >= this.capacity) this.flush();
+        this.blocks.set(block.pc, block);
+        for (const slot of block.slots) {
+            let blocks = this.pages.get(slot);
+            if (!blocks) this.pages.set(slot, (blocks = new Set()));
+            blocks.add(block);
+        }
+    }
+
+    private drop(block: TranslationBlock) {
+        block.valid = false;
+        if (this.blocks.get(block.pc) === block) this.blocks.delete(block.pc);
+        for (const slot of block.slots) {
+            const blocks = this.pages.get(slot);
+            blocks?.delete(block);
+            if (blocks && blocks.size === 0) this.pages.delete(slot);
+        }
+        this.stats.invalidations++;
+    }
+
+    // Swap in the optimized translation, unless the block was dropped or
+    // its bytes changed behind an unreported write in the meantime
+    private async promote(block: TranslationBlock) {
+        const fresh = this.guestBytes(block.pc, block.source.length);
+        if (!sameBytes(fresh, block.source)) {
+            if (block.valid) this.drop(block);
+            return;
+        }
+        const optimized = await this.translate(block.pc, true);
+        if (!optimized || !block.valid || optimized.end > block.end) return;
+        block.run = optimized.run;
+        block.optimized = true;
+        this.stats.promotions++;
+    }
+}
+
+function pageOf(address: number): number {
+    return Math.floor(address / TB_PAGE_BYTES);
+}
+
+function sameBytes(a: Uint8Array, b: Uint8Array): boolean {
+    if (a.length !== b.length) return false;
+    for (let i = 0; i < a.length; i++) {
+        if (a[i] !== b[i]) return false;
+    }
+    return true;
+}
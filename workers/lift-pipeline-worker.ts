@@ -0,0 +1,174 @@
+/**
+ * Lift Pipeline Web Worker
+ * Runs one stage of the lift-and-compile pipeline (lib/transpiler/lift-pipeline.ts)
+ * with its own native lifter instance:
+ *   decode:   entry points -> raw IR records (lift_basic_block)
+ *   optimize: IR records -> peephole-optimized IR records (optimize_ir)
+ *   emit:     IR records -> block module (emit_wasm_module) -> WebAssembly.compile
+ * Stages hand records on through SpscRings, tagged with the entry's index.
+ */
+
+import { SpscRing } from '@/lib/transpiler/spsc-ring';
+import {
+  NativeArch,
+  NativeImage,
+  emitNativeModule,
+  getNativeLifterCounters,
+  initNativeLifter,
+  optimizeNativeRecords,
+} from '@/lib/transpiler/native-lifter';
+import type { NativeCounters } from '@/lib/performance/native-counters';
+
+export type PipelineStage = 'decode' | 'optimize' | 'emit';
+
+export interface PipelineStageJob {
+  type: 'run';
+  jobId: string;
+  stage: PipelineStage;
+  arch: NativeArch;
+  input?: SharedArrayBuffer; // Ring from the previous stage (optimize, emit)
+  output?: SharedArrayBuffer; // Ring to the next stage (decode, optimize)
+  // decode
+  code?: SharedArrayBuffer;
+  codeLength?: number;
+  baseAddress?: number;
+  entries?: number[];
+  maxInstructions?: number;
+  // emit
+  guestBase?: number;
+  sharedMemory?: boolean;
+}
+
+export interface PipelineStageStats {
+  items: number;
+  busyMs: number; // Time spent in native calls and compiles
+  waitMs: number; // Time blocked on an empty or full ring
+  counters: NativeCounters | null; // This stage's lifter, for the job
+}
+
+export type PipelineWorkerMessage =
+  | { type: 'module'; jobId: string; index: number; module: WebAssembly.Module | null }
+  | { type: 'done'; jobId: string; stage: PipelineStage; stats: PipelineStageStats }
+  | { type: 'error'; jobId: string; stage: PipelineStage; error: string };
+
+function post(message: PipelineWorkerMessage) {
+  self.postMessage(message);
+}
+
+const EMPTY = new Uint8Array(0);
+
+function decode(job: PipelineStageJob, stats: PipelineStageStats) {
+  const output = new SpscRing(job.output!);
+  const image = NativeImage.load(new Uint8Array(job.code!, 0, job.codeLength!), job.baseAddress!, job.arch);
+  if (!image) throw new Error('native lifter unavailable');
+  try {
+    job.entries!.forEach((entry, index) => {
+      const start = performance.now();
+      const records = image.liftBlockRecords(entry, job.maxInstructions);
+      stats.busyMs += performance.now() - start;
+      const pushed = performance.now();
+      output.push(index, records);
+      stats.waitMs += performance.now() - pushed;
+      stats.items++;
+    });
+  } finally {
+    image.release();
+    output.close();
+  }
+}
+
+function optimize(job: PipelineStageJob, stats: PipelineStageStats) {
+  const input = new SpscRing(job.input!);
+  const output = new SpscRing(job.output!);
+  try {
+    for (;;) {
+      const message = input.peek();
+      if (!message) {
+        if (input.isFinished()) break;
+        const start = performance.now();
+        input.waitForData();
+        stats.waitMs += performance.now() - start;
+        continue;
+      }
+      const start = performance.now();
+      const records = message.payload.length ? optimizeNativeRecords(message.payload, job.arch) ?? message.payload : EMPTY;
+      stats.busyMs += performance.now() - start;
+      const pushed = performance.now();
+      // Records stay in lifter memory until the next call, so push first
+      output.push(message.id, records);
+      stats.waitMs += performance.now() - pushed;
+      input.consume();
+      stats.items++;
+    }
+  } finally {
+    output.close();
+  }
+}
+
+// Compiles are left in flight while the next records are emitted, so this
+// loop never blocks the worker's event loop
+async function emit(job: PipelineStageJob, stats: PipelineStageStats) {
+  const input = new SpscRing(job.input!);
+  const compiles: Promise<void>[] = [];
+  for (;;) {
+    const message = input.peek();
+    if (!message) {
+      if (input.isFinished()) break;
+      const start = performance.now();
+      await input.waitForDataAsync();
+      stats.waitMs += performance.now() - start;
+      continue;
+    }
+    const start = performance.now();
+    const bytes = emitNativeModule(message.payload, job.arch, {
+      guestBase: job.guestBase,
+      sharedMemory: job.sharedMemory,
+    });
+    stats.busyMs += performance.now() - start;
+    const index = message.id;
+    input.consume();
+    stats.items++;
+
+    if (!bytes) {
+      post({ type: 'module', jobId: job.jobId, index, module: null });
+      continue;
+    }
+    const compileStart = performance.now();
+    compiles.push(
+      WebAssembly.compile(bytes).then((module) => {
+        stats.busyMs += performance.now() - compileStart;
+        post({ type: 'module', jobId: job.jobId, index, module });
+      })
+    );
+  }
+  await Promise.all(compiles);
+}
+
+self.onmessage = async (event: MessageEvent<PipelineStageJob>) => {
+  const job = event.data;
+  const stats: PipelineStageStats = { items: 0, busyMs: 0, waitMs: 0, counters: null };
+
+  try {
+    if (!(await initNativeLifter())) throw new Error('native lifter unavailable');
+    getNativeLifterCounters(true);
+    switch (job.stage) {
+      case 'decode':
+        decode(job, stats);
+        break;
+      case 'optimize':
+        optimize(job, stats);
+        break;
+      case 'emit':
+        await emit(job, stats);
+        break;
+    }
+    stats.counters = getNativeLifterCounters(true);
+    post({ type: 'done', jobId: job.jobId, stage: job.stage, stats });
+  } catch (error: any) {
+    // Unblock the next stage, which would otherwise wait for more records
+    if (job.output) new SpscRing(job.output).close();
+    post({ type: 'error', jobId: job.jobId, stage: job.stage, error: error?.message || 'Pipeline stage failed' });
+  }
+};
+
+export {};
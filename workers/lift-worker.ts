@@ -0,0 +1,108 @@
+/**
+ * Lift Web Worker
+ * Pulls function entry points from a SharedLiftQueue and lifts them with its
+ * own native lifter instance, whose memory serves as this worker's IR arena
+ */
+
+import { SharedLiftQueue, QUEUE_EMPTY } from '@/lib/transpiler/lift-queue';
+import { DEFAULT_LIFT_OPTIONS, LiftCache, LiftCacheSnapshot } from '@/lib/transpiler/lift-cache';
+import {
+  NativeArch,
+  NativeBlock,
+  NativeIRInstruction,
+  NativeImage,
+  directCallTargets,
+  initNativeLifter,
+} from '@/lib/transpiler/native-lifter';
+
+export interface LiftJob {
+  type: 'lift';
+  jobId: string;
+  worker: number;
+  queue: SharedArrayBuffer;
+  code: SharedArrayBuffer;
+  codeLength: number;
+  baseAddress: number;
+  arch: NativeArch;
+  batchSize: number;
+  cache: LiftCacheSnapshot; // The main thread's cached functions of this image
+}
+
+export interface LiftedFunction {
+  entry: number;
+  blocks: NativeBlock[];
+  instructions: NativeIRInstruction[];
+  fromCache?: boolean; // Not lifted: the main thread already holds it
+}
+
+export type LiftWorkerMessage =
+  | { type: 'functions'; jobId: string; worker: number; functions: LiftedFunction[] }
+  | { type: 'done'; jobId: string; worker: number; lifted: number; stolen: number; timeMs: number }
+  | { type: 'error'; jobId: string; worker: number; error: string };
+
+// Seeded per job; the main thread stores what the workers lift
+const cache = new LiftCache(true);
+
+function post(message: LiftWorkerMessage) {
+  self.postMessage(message);
+}
+
+self.onmessage = async (event: MessageEvent<LiftJob>) => {
+  const job = event.data;
+  const startTime = performance.now();
+  let image: NativeImage | null = null;
+
+  try {
+    if (!(await initNativeLifter())) throw new Error('native lifter unavailable');
+    image = NativeImage.load(new Uint8Array(job.code, 0, job.codeLength), job.baseAddress, job.arch);
+    if (!image) throw new Error('native lifter unavailable');
+    cache.clear();
+    const cached = cache.seed(job.cache);
+
+    const queue = new SharedLiftQueue(job.queue);
+    // Entries that did not fit in our deque; never visible to thieves
+    const overflow: number[] = [];
+    let batch: LiftedFunction[] = [];
+    let lifted = 0;
+    let stolen = 0;
+
+    for (;;) {
+      let offset = overflow.length ? overflow.pop()! : queue.pop(job.worker);
+      if (offset === QUEUE_EMPTY) {
+        offset = queue.steal(job.worker);
+        if (offset !== QUEUE_EMPTY) stolen++;
+      }
+      if (offset === QUEUE_EMPTY) {
+        if (queue.isFinished()) break;
+        queue.waitForWork();
+        continue;
+      }
+
+      const entry = job.baseAddress + offset;
+      const { maxInstructions, maxBlocks, optimize } = DEFAULT_LIFT_OPTIONS;
+      const cfg = image.liftFunction(entry, maxInstructions, maxBlocks, optimize, cached);
+      // Publish callees before completing, so pending never drops to zero early
+      for (const target of directCallTargets(cfg, job.baseAddress, job.codeLength)) {
+        if (queue.push(job.worker, target - job.baseAddress) === 'full') overflow.push(target - job.baseAddress);
+      }
+      batch.push({ entry, blocks: cfg.blocks, instructions: cfg.instructions, fromCache: cfg.fromCache });
+      lifted++;
+      queue.complete();
+
+      if (batch.length >= job.batchSize) {
+        post({ type: 'functions', jobId: job.jobId, worker: job.worker, functions: batch });
+        batch = [];
+      }
+    }
+
+    if (batch.length) post({ type: 'functions', jobId: job.jobId, worker: job.worker, functions: batch });
+    post({ type: 'done', jobId: job.jobId, worker: job.worker, lifted, stolen, timeMs: performance.now() - startTime });
+  } catch (error: any) {
+    post({ type: 'error', jobId: job.jobId, worker: job.worker, error: error?.message || 'Lift failed' });
+  } finally {
+    image?.release();
+    cache.clear();
+  }
+};
+
+export {};
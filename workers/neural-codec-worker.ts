@@ -0,0 +1,30 @@
+/**
+ * Neural Codec Web Worker
+ * Instantiates the threaded build of wasm-codec.c on the memory shared with
+ * WANeuralCodec and parks in codec_worker(), computing its slice of the
+ * output rows of every layer
+ */
+
+export interface NeuralCodecWorkerInit {
+  module: WebAssembly.Module;
+  memory: WebAssembly.Memory;
+  index: number; // 1 .. threads - 1; the instance calling encode/decode is 0
+  stackTop: number; // From codec_thread_stack()
+}
+
+self.onmessage = async (event: MessageEvent<NeuralCodecWorkerInit>) => {
+  const { module, memory, index, stackTop } = event.data;
+
+  const instance = await WebAssembly.instantiate(module, {
+    env: {
+      memory,
+      abort: () => console.error('[NeuralCodecWorker] Aborted'),
+    },
+  });
+  const exports = instance.exports as any;
+
+  // Every instance starts on the linker's stack; move this one to its own
+  exports.__stack_pointer.value = stackTop;
+  // Blocks in memory.atomic.wait between layers and never returns
+  exports.codec_worker(index);
+};